@@ -0,0 +1,103 @@
+#pragma once
+
+/**
+ * @file audio_buffer.h
+ * @brief Float planar audio block shared by the processing stages
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace rtc
+{
+namespace audio
+{
+
+/**
+ * @brief Planar float audio, scaled to [-1, 1)
+ *
+ * One contiguous plane per channel. Storage is sized for a maximum frame
+ * count up front and only grows when a longer block arrives, so a buffer
+ * reused frame after frame never allocates. Conversion to and from
+ * interleaved int16 is vectorized; int16 output is rounded and saturated,
+ * float planes are not clipped.
+ */
+class AudioBuffer
+{
+ public:
+  AudioBuffer() = default;
+  AudioBuffer(size_t channels, size_t max_frames);
+
+  /**
+   * @brief Change the channel count and reserve max_frames per channel
+   *
+   * frames() becomes 0.
+   */
+  void reset(size_t channels, size_t max_frames);
+
+  [[nodiscard]] size_t channels() const
+  {
+    return channels_;
+  }
+  [[nodiscard]] size_t frames() const
+  {
+    return frames_;
+  }
+
+  /**
+   * @brief Set the frame count; grows the storage past the capacity
+   */
+  void set_frames(size_t frames);
+
+  // The first frames() samples of a channel
+  [[nodiscard]] std::span<float> channel(size_t index)
+  {
+    return {data_.data() + index * capacity_, frames_};
+  }
+  [[nodiscard]] std::span<const float> channel(size_t index) const
+  {
+    return {data_.data() + index * capacity_, frames_};
+  }
+
+  /**
+   * @brief Deinterleave whole frames; frames() becomes their count
+   */
+  void copy_from(std::span<const int16_t> interleaved);
+  void copy_from(std::span<const float> interleaved);
+
+  /**
+   * @brief Interleave frames() frames into the front of `interleaved`
+   */
+  void copy_to(std::span<int16_t> interleaved) const;
+  void copy_to(std::span<float> interleaved) const;
+
+  /**
+   * @brief Mean of the channels, frames() samples into `mono`
+   */
+  void downmix(std::span<float> mono) const;
+
+  /**
+   * @brief Copy `mono` to every channel, zeroing frames past its end
+   */
+  void upmix(std::span<const float> mono);
+
+ private:
+  size_t channels_ = 0;
+  size_t frames_ = 0;
+  size_t capacity_ = 0;  // Frames per plane
+  std::vector<float> data_;
+};
+
+/**
+ * @brief Interleaved int16 <-> float conversion, scaled like AudioBuffer
+ *
+ * Converts as many samples as both spans hold; int16 output is rounded and
+ * saturated.
+ */
+void int16_to_float(std::span<const int16_t> in, std::span<float> out);
+void float_to_int16(std::span<const float> in, std::span<int16_t> out);
+
+}  // namespace audio
+}  // namespace rtc
@@ -2,7 +2,7 @@
 
 /**
  * @file audio_capture.h
- * @brief Cross-platform audio capture using PortAudio
+ * @brief Cross-platform audio capture and playback (PortAudio, ALSA or files)
  */
 
 #include <cstdint>
@@ -31,6 +31,16 @@ struct AudioDevice
   bool is_default_output = false;
 };
 
+/**
+ * @brief Where captured audio comes from and played audio goes
+ */
+enum class AudioBackend
+{
+  PORTAUDIO,  // Sound card through PortAudio
+  ALSA,       // Linux sound card, mmap access with short periods (needs HAVE_ALSA)
+  FILE        // WAV or raw 16-bit PCM file, for headless runs and benchmarks
+};
+
 /**
  * @brief Audio capture configuration
  */
@@ -41,6 +51,29 @@ struct AudioCaptureConfig
   int channels = 1;            // Number of channels
   int frame_duration_ms = 20;  // Frame duration (10, 20, 40, 60)
   int buffer_frames = 4;       // Number of frames to buffer
+  int device_rate = 0;         // Device rate in Hz, resampled to sample_rate (0 = same)
+
+  AudioBackend backend = AudioBackend::PORTAUDIO;
+  std::string device_name;  // ALSA PCM name ("" = "default")
+  int period_frames = 0;    // ALSA period in device frames (0 = 5 ms)
+  std::string file_path;    // FILE: WAV (its header sets the rate), else raw s16le at device rate
+  bool realtime = true;     // FILE: pace reads at the device rate, else as fast as consumed
+  bool loop = false;        // FILE: rewind at the end instead of stopping
+};
+
+/**
+ * @brief Audio playback configuration
+ */
+struct AudioPlaybackConfig
+{
+  AudioBackend backend = AudioBackend::PORTAUDIO;
+  int device_id = -1;       // PortAudio device (-1 for default)
+  std::string device_name;  // ALSA PCM name ("" = "default")
+  int sample_rate = 48000;  // Sample rate in Hz
+  int channels = 1;         // Number of channels
+  int period_frames = 0;    // Frames per device period (0 = 5 ms on ALSA, 10 ms for files)
+  std::string file_path;    // FILE: WAV when it ends in ".wav", else raw s16le
+  bool realtime = true;     // FILE: pull periods at the sample rate, else back to back
 };
 
 /**
@@ -51,6 +84,13 @@ struct AudioCaptureConfig
 using AudioCaptureCallback =
     std::function<void(std::span<const int16_t> samples, int64_t timestamp)>;
 
+/**
+ * @brief Callback filling the next block of playback audio
+ * @param samples One device period (16-bit signed, interleaved if stereo); all
+ *        of it must be written
+ */
+using AudioRenderCallback = std::function<void(std::span<int16_t> samples)>;
+
 /**
  * @brief Cross-platform audio capture
  */
@@ -110,7 +150,7 @@ class AudioCapture
   void close();
 
   /**
-   * @brief Check if capturing
+   * @brief Check if capturing; false once a file source without loop has ended
    */
   [[nodiscard]] bool is_capturing() const;
 
@@ -146,11 +186,29 @@ class AudioPlayback
    */
   [[nodiscard]] bool open(int device_id, int sample_rate, int channels);
 
+  /**
+   * @brief Open a playback device or file
+   * @param config Playback configuration
+   * @return True if successful
+   */
+  [[nodiscard]] bool open(AudioPlaybackConfig config);
+
   /**
    * @brief Start playback
    */
   [[nodiscard]] bool start();
 
+  /**
+   * @brief Start playback paced by the device clock
+   *
+   * Instead of draining what write() queued, the device asks for each period
+   * as it needs it, so the caller produces audio at exactly the sound card's
+   * rate. write() has no effect in this mode.
+   * @param callback Called on the audio thread for every period
+   * @return True if successful
+   */
+  [[nodiscard]] bool start(AudioRenderCallback callback);
+
   /**
    * @brief Write samples to playback buffer
    * @param samples PCM samples (16-bit signed)
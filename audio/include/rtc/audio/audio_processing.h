@@ -3,6 +3,10 @@
 /**
  * @file audio_processing.h
  * @brief Audio processing pipeline: AEC, NS, AGC
+ *
+ * Every stage works in place on float planes (AudioBuffer). The int16
+ * overloads convert through a buffer the stage keeps, for standalone use;
+ * AudioProcessor converts once per frame and runs all stages on floats.
  */
 
 #include <cstdint>
@@ -10,6 +14,8 @@
 #include <span>
 #include <vector>
 
+#include "rtc/audio/audio_buffer.h"
+
 namespace rtc
 {
 namespace audio
@@ -24,7 +30,7 @@ struct AecConfig
   int channels = 1;
   int frame_duration_ms = 20;
   int filter_length_ms = 128;  // Echo tail length
-  bool enable_delay_agnostic = true;
+  bool enable_delay_agnostic = true;  // Estimate render/capture delay (up to 500 ms)
   bool enable_extended_filter = true;
 };
 
@@ -66,11 +72,24 @@ struct AgcConfig
   Mode mode = Mode::ADAPTIVE_DIGITAL;
 };
 
+/**
+ * @brief Voice activity detection configuration
+ */
+struct VadConfig
+{
+  int sample_rate = 48000;
+  int channels = 1;
+  int hangover_ms = 200;  // Voice flag held after the last speech block
+};
+
 /**
  * @brief Acoustic Echo Cancellation (AEC)
  *
- * Removes echo caused by speaker-to-microphone coupling.
- * Uses WebRTC AEC3-style algorithm.
+ * Removes echo caused by speaker-to-microphone coupling with a
+ * partitioned-block frequency-domain NLMS filter, followed by a residual
+ * echo suppressor. Processing runs on the mono downmix in 5 ms blocks and
+ * delays the capture by one block. analyze_render() and process_capture()
+ * may be called from different threads.
  */
 class EchoCanceller
 {
@@ -93,18 +112,27 @@ class EchoCanceller
    * @param playback_samples Samples being played back
    */
   void analyze_render(std::span<const int16_t> playback_samples);
+  void analyze_render(const AudioBuffer& playback);
 
   /**
    * @brief Process a captured frame (near-end)
    * @param capture_samples Captured microphone samples (modified in-place)
    */
   void process_capture(std::span<int16_t> capture_samples);
+  void process_capture(AudioBuffer& capture);
 
   /**
    * @brief Get estimated echo return loss enhancement (ERLE) in dB
    */
   [[nodiscard]] float get_erle() const;
 
+  /**
+   * @brief Get the estimated render-to-capture delay in milliseconds
+   *
+   * Always 0 unless AecConfig::enable_delay_agnostic is set.
+   */
+  [[nodiscard]] int get_delay_ms() const;
+
   /**
    * @brief Reset state
    */
@@ -118,8 +146,9 @@ class EchoCanceller
 /**
  * @brief Noise Suppression (NS)
  *
- * Reduces background noise in captured audio.
- * Based on RNNoise or WebRTC NS.
+ * Reduces background noise in captured audio with spectral gains over a
+ * minimum-statistics noise estimate. Processing runs on the mono downmix in
+ * 10 ms hops and delays the signal by one hop.
  */
 class NoiseSuppressor
 {
@@ -142,6 +171,7 @@ class NoiseSuppressor
    * @param samples Audio samples (modified in-place)
    */
   void process(std::span<int16_t> samples);
+  void process(AudioBuffer& samples);
 
   /**
    * @brief Set suppression level
@@ -150,6 +180,8 @@ class NoiseSuppressor
 
   /**
    * @brief Get voice activity probability (0.0 - 1.0)
+   *
+   * Smoothed speech presence over 100 Hz - 4 kHz from the latest hops.
    */
   [[nodiscard]] float get_voice_probability() const;
 
@@ -166,8 +198,12 @@ class NoiseSuppressor
 /**
  * @brief Automatic Gain Control (AGC)
  *
- * Normalizes audio levels for consistent volume.
- * Based on WebRTC AGC.
+ * Normalizes audio levels for consistent volume: a speech-gated peak
+ * level estimate sets a gain of up to compression_gain_db towards
+ * target_level_dbfs, followed by a 5 ms look-ahead limiter at -1 dBFS that
+ * delays the signal by 5 ms. There is no analog mic control, so
+ * ADAPTIVE_ANALOG behaves as ADAPTIVE_DIGITAL; FIXED_DIGITAL applies
+ * compression_gain_db as is.
  */
 class GainController
 {
@@ -190,9 +226,12 @@ class GainController
    * @param samples Audio samples (modified in-place)
    */
   void process(std::span<int16_t> samples);
+  void process(AudioBuffer& samples);
 
   /**
    * @brief Set target output level in dBFS
+   *
+   * The level speech peaks are brought to, within compression_gain_db.
    */
   void set_target_level(int level_dbfs);
 
@@ -216,10 +255,61 @@ class GainController
   std::unique_ptr<Impl> impl_;
 };
 
+/**
+ * @brief Voice Activity Detection (VAD)
+ *
+ * Lightweight per-frame speech flag for the RFC 6464 audio level extension
+ * and similar signalling: 10 ms blocks of speech-band (200 Hz - 3.4 kHz)
+ * energy are compared against a tracked noise floor. Speech must last two
+ * blocks to start, which rejects clicks, and is held for hangover_ms after.
+ * Samples are only read, so there is no delay.
+ */
+class VoiceActivityDetector
+{
+ public:
+  explicit VoiceActivityDetector(VadConfig config = {});
+  ~VoiceActivityDetector();
+
+  // Disable copy
+  VoiceActivityDetector(const VoiceActivityDetector&) = delete;
+  VoiceActivityDetector& operator=(const VoiceActivityDetector&) = delete;
+
+  /**
+   * @brief Initialize the detector
+   * @return True if successful
+   */
+  [[nodiscard]] bool initialize();
+
+  /**
+   * @brief Analyze a frame
+   * @return Whether the frame holds speech
+   */
+  bool process(std::span<const int16_t> samples);
+  bool process(const AudioBuffer& samples);
+
+  /**
+   * @brief Decision for the latest frame
+   */
+  [[nodiscard]] bool is_voice_detected() const;
+
+  /**
+   * @brief Reset state
+   */
+  void reset();
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
 /**
  * @brief Complete audio processing pipeline
  *
- * Combines AEC, NS, and AGC in the correct order.
+ * Combines AEC, NS, VAD and AGC in that order. Each frame is converted to
+ * float planes on the way in and back to int16 on the way out; in between,
+ * rate conversion included, everything runs on floats in buffers sized by
+ * initialize() for frames up to 60 ms, so steady-state processing does not
+ * allocate.
  */
 class AudioProcessor
 {
@@ -232,6 +322,14 @@ class AudioProcessor
     AecConfig aec_config;
     NsConfig ns_config;
     AgcConfig agc_config;
+    bool enable_vad = true;
+    VadConfig vad_config;
+
+    // Rate of the frames passed in (0 = aec_config.sample_rate). At another rate,
+    // render and capture are resampled to aec_config's rate and channels, which the
+    // stages share, and capture is resampled back. initialize() copies that rate and
+    // channel count into ns_config, agc_config and vad_config.
+    int stream_rate = 0;
   };
 
   explicit AudioProcessor(Config config = {});
@@ -253,6 +351,13 @@ class AudioProcessor
    */
   void process_capture_frame(std::span<int16_t> samples);
 
+  /**
+   * @brief Process captured audio into a separate output
+   * @param input Audio samples, only read
+   * @param output Room for input.size() samples; may be input itself
+   */
+  void process_capture_frame(std::span<const int16_t> input, std::span<int16_t> output);
+
   /**
    * @brief Enable/disable individual components
    */
@@ -260,6 +365,13 @@ class AudioProcessor
   void set_ns_enabled(bool enabled);
   void set_agc_enabled(bool enabled);
 
+  /**
+   * @brief Whether the latest capture frame holds speech
+   *
+   * Judged after noise suppression, before gain. Always true without a VAD.
+   */
+  [[nodiscard]] bool is_voice_detected() const;
+
   /**
    * @brief Reset all components
    */
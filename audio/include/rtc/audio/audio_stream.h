@@ -11,8 +11,15 @@
 #include <span>
 #include <string>
 
+#include "rtc/audio/audio_capture.h"
+#include "rtc/rtp_packet.h"
+
 namespace rtc
 {
+
+class MetricHistogram;
+class MetricsExporter;
+
 namespace audio
 {
 
@@ -28,6 +35,23 @@ struct AudioStreamConfig
   bool enable_aec = true;
   bool enable_ns = true;
   bool enable_agc = true;
+
+  // Pace playout by the sound card (AudioPlayback callback) rather than a
+  // timer; headless streams keep the timer and hand frames to the playback
+  // callback only
+  bool device_playout = false;
+
+  // Device backend for capture and device playout; FILE reads capture_file
+  // and writes playback_file, which lets the whole pipeline run offline
+  AudioBackend backend = AudioBackend::PORTAUDIO;
+  std::string capture_file;
+  std::string playback_file;
+  bool realtime = true;  // FILE capture: pace at the sample rate, else as fast as processed
+
+  // Record encode time and jitter buffer delay into its predefined histograms
+  MetricsExporter* metrics = nullptr;
+
+  uint32_t remote_ssrc = 0;  // Of the received stream, for flight recorder events
 };
 
 /**
@@ -43,13 +67,23 @@ struct AudioStreamStats
   float jitter_ms = 0.0f;
   float current_bitrate_kbps = 0.0f;
   float audio_level_dbfs = -96.0f;
+  uint64_t fec_recovered = 0;         // Lost frames rebuilt from the next packet's FEC
+  uint64_t concealed_frames = 0;      // Lost or late frames filled by PLC
+  uint64_t comfort_noise_frames = 0;  // Sender silent (DTX), not counted as loss
+  uint64_t accelerated_samples = 0;   // Removed by time stretching to cut delay
+  uint64_t expanded_samples = 0;      // Inserted by time stretching to build delay
+  float playout_delay_ms = 0.0f;      // Jitter buffer plus decoded, not yet played
+  float clock_drift_ppm = 0.0f;       // Sender clock against playout, corrected by resampling
 };
 
 /**
  * @brief Callback for encoded audio ready to send
+ * @param level Level and voice flag of the packet's audio, for the RFC 6464
+ *        header extension (RtpPacketBuilder::add_audio_level)
  */
 using AudioSendCallback =
-    std::function<void(std::span<const uint8_t> opus_data, uint32_t timestamp, uint16_t sequence)>;
+    std::function<void(std::span<const uint8_t> opus_data, uint32_t timestamp, uint16_t sequence,
+                       RtpAudioLevel level)>;
 
 /**
  * @brief Callback for decoded audio ready for playback
@@ -128,6 +162,18 @@ class AudioStream
    */
   virtual float audio_level() const = 0;
 
+  /**
+   * @brief Record per-frame encode time in milliseconds
+   * @see MetricsExporter::encode_time_histogram
+   */
+  virtual void set_encode_time_histogram(MetricHistogram histogram) = 0;
+
+  /**
+   * @brief Record jitter buffer delay in milliseconds
+   * @see MetricsExporter::jitter_buffer_delay_histogram
+   */
+  virtual void set_jitter_delay_histogram(MetricHistogram histogram) = 0;
+
  protected:
   AudioStream() = default;
 };
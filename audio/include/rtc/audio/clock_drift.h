@@ -0,0 +1,73 @@
+#pragma once
+
+/**
+ * @file clock_drift.h
+ * @brief Sender RTP clock versus local playout clock drift estimation
+ */
+
+#include <cstdint>
+#include <memory>
+
+namespace rtc
+{
+namespace audio
+{
+
+/**
+ * @brief Clock drift estimator configuration
+ */
+struct ClockDriftConfig
+{
+  int sample_rate = 48000;        // RTP and playout clock rate
+  double window_seconds = 60.0;   // Regression memory
+  double max_drift_ppm = 1000.0;  // Larger estimates are clamped
+};
+
+/**
+ * @brief Estimates how fast a sender's RTP clock runs against local playout
+ *
+ * Each packet arrival pairs its RTP timestamp with the playout position at
+ * that moment, in frames the output clock (sound card or timer) has
+ * consumed. The slope of a least-squares line through the least-delayed
+ * pair of each second, with exponential forgetting over window_seconds, is
+ * the clock ratio; queueing delay barely moves it. A timestamp more than a second off
+ * the line (sender restart, new stream) starts over.
+ *
+ * Not thread-safe.
+ */
+class ClockDriftEstimator
+{
+ public:
+  explicit ClockDriftEstimator(ClockDriftConfig config = {});
+  ~ClockDriftEstimator();
+
+  // Disable copy
+  ClockDriftEstimator(const ClockDriftEstimator&) = delete;
+  ClockDriftEstimator& operator=(const ClockDriftEstimator&) = delete;
+
+  /**
+   * @brief Record a packet arrival
+   * @param rtp_timestamp The packet's RTP timestamp
+   * @param playout_position Output frames consumed when it arrived
+   */
+  void on_packet(uint32_t rtp_timestamp, double playout_position);
+
+  /**
+   * @brief Drift in parts per million, positive when the sender runs fast
+   *
+   * 0 until ten seconds of arrivals have been seen.
+   */
+  [[nodiscard]] double drift_ppm() const;
+
+  /**
+   * @brief Start over
+   */
+  void reset();
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace audio
+}  // namespace rtc
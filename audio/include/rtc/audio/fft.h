@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+ * @file fft.h
+ * @brief Real FFT for the audio DSP blocks
+ */
+
+#include <cstddef>
+#include <memory>
+#include <span>
+
+namespace rtc
+{
+namespace audio
+{
+
+/**
+ * @brief Real-input FFT of a power-of-two size
+ *
+ * A half-size complex FFT (Stockham radix-4, one radix-2 pass when needed,
+ * SIMD butterflies) plus a split step for the real input. Spectra are split
+ * into real and imaginary arrays of bins() values, DC to Nyquist.
+ *
+ * Not thread-safe: each instance owns its scratch buffers.
+ */
+class RealFft
+{
+ public:
+  /**
+   * @param size Transform length, a power of two of at least 32
+   */
+  explicit RealFft(size_t size);
+  ~RealFft();
+
+  // Disable copy
+  RealFft(const RealFft&) = delete;
+  RealFft& operator=(const RealFft&) = delete;
+
+  [[nodiscard]] size_t size() const;
+
+  /**
+   * @brief Number of spectrum bins, size() / 2 + 1
+   */
+  [[nodiscard]] size_t bins() const;
+
+  /**
+   * @brief Time domain to spectrum
+   * @param input size() samples
+   * @param re, im bins() values each
+   */
+  void forward(std::span<const float> input, std::span<float> re, std::span<float> im);
+
+  /**
+   * @brief Spectrum to time domain, scaled so inverse(forward(x)) == x
+   * @param re, im bins() values each
+   * @param output size() samples
+   */
+  void inverse(std::span<const float> re, std::span<const float> im, std::span<float> output);
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace audio
+}  // namespace rtc
@@ -13,6 +13,9 @@
 
 namespace rtc
 {
+
+class MetricHistogram;
+
 namespace audio
 {
 
@@ -37,6 +40,7 @@ struct JitterBufferStats
   std::chrono::milliseconds current_delay{0};  // Current playout delay
   float packet_loss_rate = 0.0f;               // Recent packet loss rate
   float jitter_ms = 0.0f;                      // Estimated jitter in ms
+  uint32_t jitter_rtp = 0;                     // RFC 3550 interarrival jitter, RTP units
   uint64_t packets_received = 0;
   uint64_t packets_lost = 0;
   uint64_t packets_late = 0;
@@ -51,9 +55,12 @@ struct JitterBufferConfig
   std::chrono::milliseconds min_delay{10};     // Minimum playout delay
   std::chrono::milliseconds max_delay{200};    // Maximum playout delay
   std::chrono::milliseconds target_delay{50};  // Target playout delay
-  size_t max_packets = 100;                    // Maximum packets to buffer
-  int sample_rate = 48000;                     // Sample rate for timestamp calc
+  size_t max_packets = 100;                    // Ring size, rounded up to a power of two
+  int sample_rate = 48000;                     // RTP clock rate
   bool enable_adaptive = true;                 // Enable adaptive delay
+  float delay_quantile = 0.95f;                // Share of packets on time at the target
+  float delay_forget_factor = 0.9993f;         // Delay histogram memory, per packet
+  uint32_t ssrc = 0;                           // Stream SSRC, tags flight recorder events
 };
 
 /**
@@ -64,6 +71,11 @@ struct JitterBufferConfig
  * - Adaptive playout delay
  * - Packet loss detection
  * - Statistics collection
+ *
+ * Packets sit in a fixed ring indexed by unwrapped sequence number, so
+ * insert, duplicate and loss detection are O(1). A packet is due at its RTP
+ * timestamp mapped to local time plus the target delay; the mapping follows
+ * the earliest arrivals and creeps after late ones to absorb clock drift.
  */
 class JitterBuffer
 {
@@ -88,11 +100,26 @@ class JitterBuffer
    */
   std::optional<JitterFrame> pop();
 
+  /**
+   * @brief Pop the oldest frame now, ignoring the target delay
+   *
+   * For playout that manages its own delay by time stretching.
+   */
+  std::optional<JitterFrame> pop_next();
+
   /**
    * @brief Peek at the next frame without removing
    */
   std::optional<JitterFrame> peek() const;
 
+  /**
+   * @brief Look ahead for a packet by sequence number, ready or not
+   *
+   * Lets playout rebuild a missing frame from the FEC data of the packet
+   * after it before that packet is due.
+   */
+  std::optional<JitterFrame> peek(uint16_t sequence) const;
+
   /**
    * @brief Check if buffer is ready for playout
    */
@@ -118,6 +145,12 @@ class JitterBuffer
    */
   void set_target_delay(std::chrono::milliseconds delay);
 
+  /**
+   * @brief Record each played-out frame's buffering delay in milliseconds
+   * @see MetricsExporter::jitter_buffer_delay_histogram
+   */
+  void set_delay_histogram(MetricHistogram histogram);
+
  private:
   struct Impl;
   std::unique_ptr<Impl> impl_;
@@ -5,14 +5,15 @@
  * @brief Opus audio codec wrapper for RTC engine
  *
  * Provides encoding/decoding using libopus with settings
- * optimized for real-time voice communication.
+ * optimized for real-time voice communication. Built without libopus
+ * (ENABLE_OPUS=OFF or not found), the codec is a stub that emits
+ * placeholder packets and decodes silence.
  */
 
 #include <cstdint>
 #include <memory>
 #include <optional>
 #include <span>
-#include <vector>
 
 namespace rtc
 {
@@ -31,6 +32,8 @@ struct OpusEncoderConfig
   bool use_vbr = true;         // Variable bitrate
   bool use_dtx = true;         // Discontinuous transmission
   int complexity = 10;         // Encoding complexity (0-10)
+  bool use_fec = true;         // In-band FEC (LBRR copy of the previous frame)
+  int packet_loss_percent = 10;  // Expected loss; FEC is only sent when above 0
 
   enum class Application
   {
@@ -51,27 +54,26 @@ struct OpusDecoderConfig
 };
 
 /**
- * @brief Opus encoder result
+ * @brief Opus encoder result (the packet is in the caller's buffer)
  */
 struct EncodeResult
 {
-  std::vector<uint8_t> data;    // Encoded Opus packet
-  int samples_encoded = 0;      // Number of samples encoded
-  bool voice_activity = false;  // Voice activity detected (DTX)
+  size_t bytes = 0;             // Packet length written to the output buffer
+  int samples_encoded = 0;      // Number of samples encoded (per channel)
+  bool voice_activity = false;  // False for DTX packets (1-2 bytes)
 
   [[nodiscard]] bool success() const
   {
-    return !data.empty();
+    return bytes > 0;
   }
 };
 
 /**
- * @brief Opus decoder result
+ * @brief Opus decoder result (the PCM is in the caller's buffer)
  */
 struct DecodeResult
 {
-  std::vector<int16_t> samples;  // Decoded PCM samples (interleaved if stereo)
-  int samples_decoded = 0;
+  int samples_decoded = 0;  // Per channel; interleaved if stereo
 
   [[nodiscard]] bool success() const
   {
@@ -87,6 +89,8 @@ struct DecodeResult
 class OpusEncoder
 {
  public:
+  static constexpr size_t MAX_PACKET_BYTES = 4000;  // Output size libopus recommends
+
   explicit OpusEncoder(OpusEncoderConfig config = {});
   ~OpusEncoder();
 
@@ -105,11 +109,13 @@ class OpusEncoder
   [[nodiscard]] bool initialize();
 
   /**
-   * @brief Encode PCM samples to Opus
-   * @param pcm_samples PCM samples (16-bit signed, interleaved if stereo)
-   * @return Encoded result
+   * @brief Encode one frame of PCM to Opus, without allocating
+   * @param pcm_samples frame_size() samples per channel (16-bit, interleaved if stereo)
+   * @param output Packet buffer (MAX_PACKET_BYTES is always enough)
+   * @return Encoded result; bytes is 0 on error
    */
-  [[nodiscard]] EncodeResult encode(std::span<const int16_t> pcm_samples);
+  [[nodiscard]] EncodeResult encode(std::span<const int16_t> pcm_samples,
+                                    std::span<uint8_t> output);
 
   /**
    * @brief Set target bitrate
@@ -128,6 +134,14 @@ class OpusEncoder
    */
   void set_dtx(bool enable);
 
+  /**
+   * @brief Set the expected packet loss (e.g. from RTCP receiver reports)
+   *
+   * Sizes the in-band FEC: more expected loss spends more of the bitrate
+   * on the redundant copy; 0 turns it off.
+   */
+  void set_packet_loss(int percent);
+
   /**
    * @brief Reset encoder state (call after packet loss)
    */
@@ -143,6 +157,11 @@ class OpusEncoder
    */
   [[nodiscard]] bool is_initialized() const;
 
+  /**
+   * @brief Check if built against libopus (false: stub codec)
+   */
+  [[nodiscard]] static bool has_libopus();
+
  private:
   struct Impl;
   std::unique_ptr<Impl> impl_;
@@ -156,6 +175,8 @@ class OpusEncoder
 class OpusDecoder
 {
  public:
+  static constexpr int MAX_FRAME_SIZE = 5760;  // 120 ms at 48 kHz, per channel
+
   explicit OpusDecoder(OpusDecoderConfig config = {});
   ~OpusDecoder();
 
@@ -174,19 +195,38 @@ class OpusDecoder
   [[nodiscard]] bool initialize();
 
   /**
-   * @brief Decode Opus packet to PCM
+   * @brief Decode an Opus packet into the caller's buffer, without allocating
    * @param opus_data Encoded Opus packet
-   * @param frame_size Expected frame size in samples
-   * @return Decoded result
+   * @param pcm Output; its size / channels bounds the frame size (interleaved if stereo)
+   * @return Decoded result; samples_decoded is 0 on error
    */
-  [[nodiscard]] DecodeResult decode(std::span<const uint8_t> opus_data, int frame_size);
+  [[nodiscard]] DecodeResult decode(std::span<const uint8_t> opus_data, std::span<int16_t> pcm);
 
   /**
    * @brief Generate packet loss concealment (PLC)
-   * @param frame_size Frame size in samples
-   * @return Concealed samples
+   * @param pcm Output sized for exactly one frame (interleaved if stereo)
+   * @return Concealed result
+   */
+  [[nodiscard]] DecodeResult decode_plc(std::span<int16_t> pcm);
+
+  /**
+   * @brief Rebuild the frame before next_packet from its in-band FEC data
+   *
+   * Falls back to PLC inside libopus when next_packet carries no FEC.
+   *
+   * @param next_packet The packet following the lost one
+   * @param pcm Output sized for exactly the lost frame (interleaved if stereo)
+   */
+  [[nodiscard]] DecodeResult decode_fec(std::span<const uint8_t> next_packet,
+                                        std::span<int16_t> pcm);
+
+  /**
+   * @brief Check if a packet carries FEC data for the frame before it
+   *
+   * Reads the LBRR flag of the first SILK frame; CELT-only packets never
+   * carry FEC.
    */
-  [[nodiscard]] DecodeResult decode_plc(int frame_size);
+  [[nodiscard]] static bool has_fec(std::span<const uint8_t> packet);
 
   /**
    * @brief Reset decoder state
@@ -0,0 +1,138 @@
+#pragma once
+
+/**
+ * @file resampler.h
+ * @brief Streaming polyphase sample-rate converter
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace rtc
+{
+namespace audio
+{
+
+/**
+ * @brief Resampler configuration
+ */
+struct ResamplerConfig
+{
+  int input_rate = 48000;   // Input sample rate in Hz
+  int output_rate = 16000;  // Output sample rate in Hz
+  int channels = 1;         // Interleaved channels
+};
+
+/**
+ * @brief Rational-ratio polyphase FIR resampler
+ *
+ * Converts by L/M, the output/input rate ratio in lowest terms, with a
+ * Kaiser-windowed sinc (80 dB stopband from the lower Nyquist frequency,
+ * passband to about 0.84 of it). Each of the L phases is a short FIR run
+ * as a SIMD dot product over contiguous history, so the cost is the taps
+ * per phase times the output rate, whatever L is. Equal rates pass through.
+ *
+ * Streaming: any number of frames can be pushed per call, filter state and
+ * phase carry over. Output lags the input by about 32 input frames (64
+ * scaled by M/L when downsampling).
+ *
+ * Not thread-safe.
+ */
+class Resampler
+{
+ public:
+  /**
+   * @throws std::invalid_argument for non-positive rates or channels, or a
+   *         reduced ratio with more than 1024 phases
+   */
+  explicit Resampler(ResamplerConfig config);
+  ~Resampler();
+
+  // Disable copy
+  Resampler(const Resampler&) = delete;
+  Resampler& operator=(const Resampler&) = delete;
+
+  [[nodiscard]] const ResamplerConfig& config() const;
+
+  /**
+   * @brief Upper bound on the frames one process() call yields for this input
+   */
+  [[nodiscard]] size_t max_output_frames(size_t input_frames) const;
+
+  /**
+   * @brief Resample interleaved samples
+   * @param input Whole frames of input
+   * @param output Room for max_output_frames() frames; with less, the
+   *        remainder stays buffered for the next call
+   * @return Frames written
+   */
+  size_t process(std::span<const float> input, std::span<float> output);
+  size_t process(std::span<const int16_t> input, std::span<int16_t> output);
+
+  /**
+   * @brief Clear history and phase
+   */
+  void reset();
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Resampler for small, changing corrections around 1:1
+ *
+ * Absorbs clock drift between two nominally equal rates, such as a sender's
+ * RTP clock and the local sound card. The ratio may change on every call;
+ * each output frame is a 32-tap windowed sinc (passband to 0.9 of Nyquist)
+ * taken at its fractional input position, the taps interpolated from a
+ * 256-phase table. Output lags the input by 16 frames.
+ *
+ * Pull-oriented: ask required_input() how much input the next output needs,
+ * then hand over exactly that. Not thread-safe.
+ */
+class DriftResampler
+{
+ public:
+  /**
+   * @param channels Interleaved channels
+   */
+  explicit DriftResampler(int channels);
+  ~DriftResampler();
+
+  // Disable copy
+  DriftResampler(const DriftResampler&) = delete;
+  DriftResampler& operator=(const DriftResampler&) = delete;
+
+  /**
+   * @brief Input frames consumed per output frame, clamped to 1 +- 1%
+   */
+  void set_ratio(double ratio);
+  [[nodiscard]] double ratio() const;
+
+  /**
+   * @brief Input frames the next process() call needs for output_frames
+   */
+  [[nodiscard]] size_t required_input(size_t output_frames) const;
+
+  /**
+   * @brief Resample interleaved samples
+   * @param input required_input() frames; output short of input is zeroed
+   * @param output Frames to produce
+   */
+  void process(std::span<const int16_t> input, std::span<int16_t> output);
+
+  /**
+   * @brief Clear history and position
+   */
+  void reset();
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace audio
+}  // namespace rtc
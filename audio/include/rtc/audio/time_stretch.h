@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @file time_stretch.h
+ * @brief WSOLA time stretching for jitter buffer delay control
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rtc
+{
+namespace audio
+{
+
+/**
+ * @brief Time stretcher configuration
+ */
+struct TimeStretchConfig
+{
+  int sample_rate = 48000;
+  int channels = 1;
+  float min_correlation = 0.9f;  // Periodicity needed to drop or repeat a pitch period
+  float silence_dbfs = -50.0f;   // Below this any segment can be stretched
+};
+
+/**
+ * @brief Shortens or lengthens decoded speech by whole pitch periods
+ *
+ * Finds the pitch period by normalized cross-correlation (coarse search at
+ * 8 kHz, refined at the full rate) and cross-fades one period out of or into
+ * the signal, so the playout delay can move without audible gaps. Segments
+ * that are not periodic enough are left alone; near-silent ones are stretched
+ * by the longest period.
+ *
+ * Buffers hold interleaved samples; all lengths are in samples per channel.
+ */
+class TimeStretcher
+{
+ public:
+  static constexpr int MIN_PITCH_MS = 2;   // 500 Hz
+  static constexpr int MAX_PITCH_MS = 15;  // 67 Hz
+
+  explicit TimeStretcher(TimeStretchConfig config = {});
+  ~TimeStretcher();
+
+  // Disable copy
+  TimeStretcher(const TimeStretcher&) = delete;
+  TimeStretcher& operator=(const TimeStretcher&) = delete;
+
+  /**
+   * @brief Samples per channel the buffer must hold before stretching
+   */
+  [[nodiscard]] size_t min_input() const;
+
+  /**
+   * @brief Remove one pitch period from the start of the buffer
+   * @param pcm Buffer to shorten in place
+   * @return Samples per channel removed, 0 if the signal was not periodic
+   */
+  size_t accelerate(std::vector<int16_t>& pcm);
+
+  /**
+   * @brief Repeat one pitch period at the start of the buffer
+   * @param pcm Buffer to lengthen in place
+   * @return Samples per channel inserted, 0 if the signal was not periodic
+   */
+  size_t preemptive_expand(std::vector<int16_t>& pcm);
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace audio
+}  // namespace rtc
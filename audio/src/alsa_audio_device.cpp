@@ -0,0 +1,391 @@
+/**
+ * @file alsa_audio_device.cpp
+ * @brief ALSA capture and playback backends with mmap access
+ *
+ * The PCM is opened for interleaved 16-bit mmap access with a few short
+ * periods (5 ms by default), and the I/O thread reads or renders straight
+ * into the device ring buffer: capture hands the mapped area to the sink,
+ * playback's render callback writes into it, so no intermediate copy or
+ * buffering adds latency. Playback latency is the whole ring, two periods.
+ * Over- and underruns are recovered in place and the stream restarted.
+ *
+ * Built only with HAVE_ALSA (libasound found by CMake); otherwise opening
+ * fails and callers fall back to another backend.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "audio_device.h"
+
+#ifdef HAVE_ALSA
+#include <alsa/asoundlib.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace rtc
+{
+namespace audio
+{
+
+#ifdef HAVE_ALSA
+
+namespace
+{
+
+constexpr int ALSA_PERIOD_MS = 5;
+constexpr unsigned CAPTURE_PERIODS = 4;   // Headroom only: data leaves after one period
+constexpr unsigned PLAYBACK_PERIODS = 2;  // The ring is the output latency
+constexpr int WAIT_TIMEOUT_MS = 100;
+constexpr int IO_THREAD_PRIORITY = 10;  // SCHED_FIFO, when the process may use it
+
+// Opens `name` for interleaved S16 mmap access; rate and period come back as granted
+snd_pcm_t* open_pcm(const std::string& name, snd_pcm_stream_t stream, int channels,
+                    unsigned& rate, snd_pcm_uframes_t& period, unsigned periods)
+{
+  snd_pcm_t* pcm = nullptr;
+  if (snd_pcm_open(&pcm, name.empty() ? "default" : name.c_str(), stream, 0) < 0)
+  {
+    return nullptr;
+  }
+
+  snd_pcm_hw_params_t* hw = nullptr;
+  snd_pcm_hw_params_alloca(&hw);
+  snd_pcm_uframes_t buffer = period * periods;
+  bool ok = snd_pcm_hw_params_any(pcm, hw) >= 0 &&
+            snd_pcm_hw_params_set_access(pcm, hw, SND_PCM_ACCESS_MMAP_INTERLEAVED) >= 0 &&
+            snd_pcm_hw_params_set_format(pcm, hw, SND_PCM_FORMAT_S16_LE) >= 0 &&
+            snd_pcm_hw_params_set_channels(pcm, hw, static_cast<unsigned>(channels)) >= 0 &&
+            snd_pcm_hw_params_set_rate_near(pcm, hw, &rate, nullptr) >= 0 &&
+            snd_pcm_hw_params_set_period_size_near(pcm, hw, &period, nullptr) >= 0 &&
+            snd_pcm_hw_params_set_buffer_size_near(pcm, hw, &buffer) >= 0 &&
+            snd_pcm_hw_params(pcm, hw) >= 0 &&
+            snd_pcm_hw_params_get_period_size(hw, &period, nullptr) >= 0 &&
+            snd_pcm_hw_params_get_buffer_size(hw, &buffer) >= 0;
+
+  // Wake per period; playback starts once the ring is full, capture when started
+  snd_pcm_sw_params_t* sw = nullptr;
+  snd_pcm_sw_params_alloca(&sw);
+  ok = ok && snd_pcm_sw_params_current(pcm, sw) >= 0 &&
+       snd_pcm_sw_params_set_avail_min(pcm, sw, period) >= 0 &&
+       snd_pcm_sw_params_set_start_threshold(
+           pcm, sw, stream == SND_PCM_STREAM_PLAYBACK ? buffer : 1) >= 0 &&
+       snd_pcm_sw_params(pcm, sw) >= 0;
+
+  if (!ok)
+  {
+    snd_pcm_close(pcm);
+    return nullptr;
+  }
+  return pcm;
+}
+
+// Interleaved areas share one base; each frame is `channels` samples
+int16_t* mapped_samples(const snd_pcm_channel_area_t* areas, snd_pcm_uframes_t offset,
+                        size_t channels)
+{
+  auto* base = static_cast<uint8_t*>(areas[0].addr) + areas[0].first / 8;
+  return reinterpret_cast<int16_t*>(base) + offset * channels;
+}
+
+void raise_priority(std::thread& thread)
+{
+  // Best effort: needs CAP_SYS_NICE or an rtprio limit, plain scheduling otherwise
+  sched_param param{};
+  param.sched_priority = IO_THREAD_PRIORITY;
+  pthread_setschedparam(thread.native_handle(), SCHED_FIFO, &param);
+}
+
+class AlsaCapture final : public CaptureBackend
+{
+ public:
+  AlsaCapture(snd_pcm_t* pcm, unsigned rate, int channels, snd_pcm_uframes_t period)
+      : pcm_(pcm), rate_(rate), channels_(static_cast<size_t>(channels)), period_(period)
+  {
+  }
+
+  ~AlsaCapture() override
+  {
+    stop();
+    snd_pcm_close(pcm_);
+  }
+
+  bool start(AudioCaptureCallback sink) override
+  {
+    stop();
+    sink_ = std::move(sink);
+    if (snd_pcm_start(pcm_) < 0)
+    {
+      return false;
+    }
+    running_.store(true);
+    thread_ = std::thread([this]() { run(); });
+    raise_priority(thread_);
+    return true;
+  }
+
+  void stop() override
+  {
+    running_.store(false);
+    if (thread_.joinable())
+    {
+      thread_.join();
+    }
+    snd_pcm_drop(pcm_);
+    snd_pcm_prepare(pcm_);
+  }
+
+  bool running() const override
+  {
+    return running_.load();
+  }
+
+  int sample_rate() const override
+  {
+    return static_cast<int>(rate_);
+  }
+
+ private:
+  // Overrun or suspend: start over; anything else ends capture
+  bool recover(long error)
+  {
+    return snd_pcm_recover(pcm_, static_cast<int>(error), 1) >= 0 && snd_pcm_start(pcm_) >= 0;
+  }
+
+  void run()
+  {
+    while (running_.load())
+    {
+      snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm_);
+      if (avail < 0)
+      {
+        if (!recover(avail)) break;
+        continue;
+      }
+      if (static_cast<snd_pcm_uframes_t>(avail) < period_)
+      {
+        int error = snd_pcm_wait(pcm_, WAIT_TIMEOUT_MS);
+        if (error < 0 && !recover(error)) break;
+        continue;
+      }
+
+      const snd_pcm_channel_area_t* areas = nullptr;
+      snd_pcm_uframes_t offset = 0;
+      snd_pcm_uframes_t frames = period_;  // Less at the end of the ring
+      int error = snd_pcm_mmap_begin(pcm_, &areas, &offset, &frames);
+      if (error < 0)
+      {
+        if (!recover(error)) break;
+        continue;
+      }
+
+      // The oldest frame waiting was captured `avail` frames ago
+      auto now_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch())
+                        .count();
+      sink_(std::span<const int16_t>(mapped_samples(areas, offset, channels_), frames * channels_),
+            now_us - static_cast<int64_t>(avail) * 1000000 / rate_);
+
+      snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcm_, offset, frames);
+      if (committed < 0 || static_cast<snd_pcm_uframes_t>(committed) != frames)
+      {
+        if (!recover(committed < 0 ? committed : -EPIPE)) break;
+      }
+    }
+    running_.store(false);
+  }
+
+  snd_pcm_t* pcm_;
+  unsigned rate_;
+  size_t channels_;
+  snd_pcm_uframes_t period_;
+
+  AudioCaptureCallback sink_;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+class AlsaPlayback final : public PlaybackBackend
+{
+ public:
+  AlsaPlayback(snd_pcm_t* pcm, int channels, snd_pcm_uframes_t period)
+      : pcm_(pcm), channels_(static_cast<size_t>(channels)), period_(period)
+  {
+  }
+
+  ~AlsaPlayback() override
+  {
+    stop();
+    snd_pcm_close(pcm_);
+  }
+
+  bool start(AudioRenderCallback render) override
+  {
+    stop();
+    if (render)
+    {
+      render_ = std::move(render);
+      pulling_.store(true);
+      thread_ = std::thread([this]() { run(); });
+      raise_priority(thread_);
+    }
+    return true;
+  }
+
+  void stop() override
+  {
+    pulling_.store(false);
+    if (thread_.joinable())
+    {
+      thread_.join();
+    }
+    snd_pcm_drop(pcm_);
+    snd_pcm_prepare(pcm_);
+  }
+
+  size_t write(std::span<const int16_t> samples) override
+  {
+    // The render thread owns the ring in pull mode
+    if (pulling_.load())
+    {
+      return 0;
+    }
+
+    // Blocks until the ring has room; playback starts once it is full
+    size_t frames = samples.size() / channels_;
+    size_t done = 0;
+    while (done < frames)
+    {
+      snd_pcm_sframes_t written =
+          snd_pcm_mmap_writei(pcm_, samples.data() + done * channels_, frames - done);
+      if (written < 0)
+      {
+        if (snd_pcm_recover(pcm_, static_cast<int>(written), 1) < 0) break;
+        continue;
+      }
+      done += static_cast<size_t>(written);
+    }
+    return done * channels_;
+  }
+
+  size_t available_space() const override
+  {
+    snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm_);
+    return avail > 0 ? static_cast<size_t>(avail) * channels_ : 0;
+  }
+
+ private:
+  void run()
+  {
+    while (pulling_.load())
+    {
+      snd_pcm_sframes_t avail = snd_pcm_avail_update(pcm_);
+      if (avail < 0)
+      {
+        // Underrun: refill the ring, which restarts the stream at the threshold
+        if (snd_pcm_recover(pcm_, static_cast<int>(avail), 1) < 0) break;
+        continue;
+      }
+      if (static_cast<snd_pcm_uframes_t>(avail) < period_)
+      {
+        // A ring that is not a whole number of periods never reaches the threshold
+        if (snd_pcm_state(pcm_) == SND_PCM_STATE_PREPARED)
+        {
+          snd_pcm_start(pcm_);
+        }
+        int error = snd_pcm_wait(pcm_, WAIT_TIMEOUT_MS);
+        if (error < 0 && snd_pcm_recover(pcm_, error, 1) < 0) break;
+        continue;
+      }
+
+      const snd_pcm_channel_area_t* areas = nullptr;
+      snd_pcm_uframes_t offset = 0;
+      snd_pcm_uframes_t frames = period_;  // Less at the end of the ring
+      int error = snd_pcm_mmap_begin(pcm_, &areas, &offset, &frames);
+      if (error < 0)
+      {
+        if (snd_pcm_recover(pcm_, error, 1) < 0) break;
+        continue;
+      }
+
+      render_(std::span<int16_t>(mapped_samples(areas, offset, channels_), frames * channels_));
+
+      snd_pcm_sframes_t committed = snd_pcm_mmap_commit(pcm_, offset, frames);
+      if (committed < 0 && snd_pcm_recover(pcm_, static_cast<int>(committed), 1) < 0) break;
+    }
+    pulling_.store(false);
+  }
+
+  snd_pcm_t* pcm_;
+  size_t channels_;
+  snd_pcm_uframes_t period_;
+
+  AudioRenderCallback render_;
+  std::atomic<bool> pulling_{false};
+  std::thread thread_;
+};
+
+snd_pcm_uframes_t period_frames(int configured, unsigned rate)
+{
+  return configured > 0 ? static_cast<snd_pcm_uframes_t>(configured)
+                        : static_cast<snd_pcm_uframes_t>(rate * ALSA_PERIOD_MS / 1000);
+}
+
+}  // namespace
+
+std::unique_ptr<CaptureBackend> open_alsa_capture(const AudioCaptureConfig& config)
+{
+  // The card may grant another rate; AudioCapture resamples from it
+  auto rate = static_cast<unsigned>(config.device_rate > 0 ? config.device_rate
+                                                           : config.sample_rate);
+  snd_pcm_uframes_t period = period_frames(config.period_frames, rate);
+  snd_pcm_t* pcm = open_pcm(config.device_name, SND_PCM_STREAM_CAPTURE, config.channels, rate,
+                            period, CAPTURE_PERIODS);
+  if (!pcm)
+  {
+    return nullptr;
+  }
+  return std::make_unique<AlsaCapture>(pcm, rate, config.channels, period);
+}
+
+std::unique_ptr<PlaybackBackend> open_alsa_playback(const AudioPlaybackConfig& config)
+{
+  auto rate = static_cast<unsigned>(config.sample_rate);
+  snd_pcm_uframes_t period = period_frames(config.period_frames, rate);
+  snd_pcm_t* pcm = open_pcm(config.device_name, SND_PCM_STREAM_PLAYBACK, config.channels, rate,
+                            period, PLAYBACK_PERIODS);
+  if (!pcm)
+  {
+    return nullptr;
+  }
+  if (rate != static_cast<unsigned>(config.sample_rate))
+  {
+    // No resampler on this side; "default" and plughw devices convert for us
+    snd_pcm_close(pcm);
+    return nullptr;
+  }
+  return std::make_unique<AlsaPlayback>(pcm, config.channels, period);
+}
+
+#else
+
+std::unique_ptr<CaptureBackend> open_alsa_capture(const AudioCaptureConfig& /*config*/)
+{
+  return nullptr;
+}
+
+std::unique_ptr<PlaybackBackend> open_alsa_playback(const AudioPlaybackConfig& /*config*/)
+{
+  return nullptr;
+}
+
+#endif
+
+}  // namespace audio
+}  // namespace rtc
@@ -0,0 +1,261 @@
+/**
+ * @file audio_buffer.cpp
+ * @brief Float planar audio block
+ *
+ * int16 is converted eight samples at a time with simd::load_int16 and
+ * store_int16. A mono plane is laid out like interleaved samples, so it
+ * converts directly; with more channels each group of eight goes through a
+ * small stack buffer on its way to or from the planes.
+ */
+
+#include "rtc/audio/audio_buffer.h"
+
+#include <algorithm>
+
+#include "simd.h"
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+constexpr float TO_FLOAT = 1.0f / 32768.0f;
+constexpr float TO_INT16 = 32768.0f;
+constexpr size_t CHUNK = 2 * simd::WIDTH;  // Samples per int16 conversion
+
+// Eight int16 to scaled floats; a short tail is zero-padded
+void widen(const int16_t* in, size_t count, float* out)
+{
+  alignas(16) int16_t padded[CHUNK] = {};
+  if (count < CHUNK)
+  {
+    std::copy_n(in, count, padded);
+    in = padded;
+  }
+  simd::f32x4 low;
+  simd::f32x4 high;
+  simd::load_int16(in, low, high);
+  simd::f32x4 scale = simd::set1(TO_FLOAT);
+  simd::store(out, simd::mul(low, scale));
+  simd::store(out + simd::WIDTH, simd::mul(high, scale));
+}
+
+// Eight scaled floats to rounded, saturated int16; only `count` are written
+void narrow(const float* in, size_t count, int16_t* out)
+{
+  simd::f32x4 scale = simd::set1(TO_INT16);
+  simd::f32x4 low = simd::mul(simd::load(in), scale);
+  simd::f32x4 high = simd::mul(simd::load(in + simd::WIDTH), scale);
+  if (count == CHUNK)
+  {
+    simd::store_int16(out, low, high);
+    return;
+  }
+  alignas(16) int16_t padded[CHUNK];
+  simd::store_int16(padded, low, high);
+  std::copy_n(padded, count, out);
+}
+
+}  // namespace
+
+void int16_to_float(std::span<const int16_t> in, std::span<float> out)
+{
+  size_t count = std::min(in.size(), out.size());
+  size_t i = 0;
+  for (; i + CHUNK <= count; i += CHUNK)
+  {
+    widen(&in[i], CHUNK, &out[i]);
+  }
+  if (i < count)
+  {
+    alignas(16) float tail[CHUNK];
+    widen(&in[i], count - i, tail);
+    std::copy_n(tail, count - i, &out[i]);
+  }
+}
+
+void float_to_int16(std::span<const float> in, std::span<int16_t> out)
+{
+  size_t count = std::min(in.size(), out.size());
+  size_t i = 0;
+  for (; i + CHUNK <= count; i += CHUNK)
+  {
+    narrow(&in[i], CHUNK, &out[i]);
+  }
+  if (i < count)
+  {
+    alignas(16) float tail[CHUNK] = {};
+    std::copy_n(&in[i], count - i, tail);
+    narrow(tail, count - i, &out[i]);
+  }
+}
+
+AudioBuffer::AudioBuffer(size_t channels, size_t max_frames)
+{
+  reset(channels, max_frames);
+}
+
+void AudioBuffer::reset(size_t channels, size_t max_frames)
+{
+  channels_ = channels;
+  frames_ = 0;
+  capacity_ = max_frames;
+  data_.assign(channels * max_frames, 0.0f);
+}
+
+void AudioBuffer::set_frames(size_t frames)
+{
+  if (frames > capacity_)
+  {
+    // Planes start at multiples of the capacity, so growing moves them
+    std::vector<float> grown(channels_ * frames, 0.0f);
+    for (size_t c = 0; c < channels_; ++c)
+    {
+      std::copy_n(data_.begin() + static_cast<std::ptrdiff_t>(c * capacity_), frames_,
+                  grown.begin() + static_cast<std::ptrdiff_t>(c * frames));
+    }
+    data_.swap(grown);
+    capacity_ = frames;
+  }
+  frames_ = frames;
+}
+
+void AudioBuffer::copy_from(std::span<const int16_t> interleaved)
+{
+  set_frames(channels_ == 0 ? 0 : interleaved.size() / channels_);
+  size_t count = frames_ * channels_;
+  if (channels_ == 1)
+  {
+    int16_to_float(interleaved.first(count), data_);
+    return;
+  }
+
+  alignas(16) float chunk[CHUNK];
+  size_t c = 0;
+  size_t f = 0;
+  for (size_t i = 0; i < count; i += CHUNK)
+  {
+    size_t n = std::min(CHUNK, count - i);
+    widen(&interleaved[i], n, chunk);
+    for (size_t j = 0; j < n; ++j)
+    {
+      data_[c * capacity_ + f] = chunk[j];
+      if (++c == channels_)
+      {
+        c = 0;
+        ++f;
+      }
+    }
+  }
+}
+
+void AudioBuffer::copy_from(std::span<const float> interleaved)
+{
+  set_frames(channels_ == 0 ? 0 : interleaved.size() / channels_);
+  for (size_t c = 0; c < channels_; ++c)
+  {
+    float* plane = data_.data() + c * capacity_;
+    for (size_t f = 0; f < frames_; ++f)
+    {
+      plane[f] = interleaved[f * channels_ + c];
+    }
+  }
+}
+
+void AudioBuffer::copy_to(std::span<int16_t> interleaved) const
+{
+  if (channels_ == 0)
+  {
+    return;
+  }
+  size_t count = std::min(frames_, interleaved.size() / channels_) * channels_;
+  if (channels_ == 1)
+  {
+    float_to_int16(std::span<const float>(data_).first(count), interleaved);
+    return;
+  }
+
+  alignas(16) float chunk[CHUNK] = {};
+  size_t c = 0;
+  size_t f = 0;
+  for (size_t i = 0; i < count; i += CHUNK)
+  {
+    size_t n = std::min(CHUNK, count - i);
+    for (size_t j = 0; j < n; ++j)
+    {
+      chunk[j] = data_[c * capacity_ + f];
+      if (++c == channels_)
+      {
+        c = 0;
+        ++f;
+      }
+    }
+    narrow(chunk, n, &interleaved[i]);
+  }
+}
+
+void AudioBuffer::copy_to(std::span<float> interleaved) const
+{
+  if (channels_ == 0)
+  {
+    return;
+  }
+  size_t frames = std::min(frames_, interleaved.size() / channels_);
+  for (size_t c = 0; c < channels_; ++c)
+  {
+    const float* plane = data_.data() + c * capacity_;
+    for (size_t f = 0; f < frames; ++f)
+    {
+      interleaved[f * channels_ + c] = plane[f];
+    }
+  }
+}
+
+void AudioBuffer::downmix(std::span<float> mono) const
+{
+  size_t frames = std::min(frames_, mono.size());
+  if (channels_ == 1)
+  {
+    std::copy_n(data_.begin(), frames, mono.begin());
+    return;
+  }
+
+  const float inverse = 1.0f / static_cast<float>(channels_);
+  simd::f32x4 scale = simd::set1(inverse);
+  size_t i = 0;
+  for (; i + simd::WIDTH <= frames; i += simd::WIDTH)
+  {
+    simd::f32x4 sum = simd::load(&data_[i]);
+    for (size_t c = 1; c < channels_; ++c)
+    {
+      sum = simd::add(sum, simd::load(&data_[c * capacity_ + i]));
+    }
+    simd::store(&mono[i], simd::mul(sum, scale));
+  }
+  for (; i < frames; ++i)
+  {
+    float sum = 0.0f;
+    for (size_t c = 0; c < channels_; ++c)
+    {
+      sum += data_[c * capacity_ + i];
+    }
+    mono[i] = sum * inverse;
+  }
+}
+
+void AudioBuffer::upmix(std::span<const float> mono)
+{
+  size_t ready = std::min(frames_, mono.size());
+  for (size_t c = 0; c < channels_; ++c)
+  {
+    float* plane = data_.data() + c * capacity_;
+    std::copy_n(mono.begin(), ready, plane);
+    std::fill(plane + ready, plane + frames_, 0.0f);
+  }
+}
+
+}  // namespace audio
+}  // namespace rtc
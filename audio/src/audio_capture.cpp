@@ -1,8 +1,9 @@
 /**
  * @file audio_capture.cpp
- * @brief Audio capture/playback stub implementation
+ * @brief Audio capture/playback front end over the device backends
  *
- * Note: Full implementation requires PortAudio.
+ * The ALSA and file backends live in audio_device.h; PortAudio is a stub.
+ * Note: Full PortAudio implementation requires PortAudio.
  * Install via:
  *   - Windows: vcpkg install portaudio
  *   - Linux: apt install libportaudio-dev
@@ -11,6 +12,12 @@
 
 #include "rtc/audio/audio_capture.h"
 
+#include <algorithm>
+#include <atomic>
+
+#include "audio_device.h"
+#include "rtc/audio/resampler.h"
+
 // Uncomment when PortAudio is available:
 // #include <portaudio.h>
 
@@ -24,12 +31,64 @@ struct AudioCapture::Impl
 {
   AudioCaptureConfig config;
   AudioCaptureCallback callback;
-  bool capturing = false;
+  std::atomic<bool> capturing{false};  // Read on the backend's thread
   int frame_size = 0;
+  std::unique_ptr<CaptureBackend> backend;  // ALSA or file; none for PortAudio
+
+  // Device-rate input is resampled into `pending` and handed out in whole frames
+  std::unique_ptr<Resampler> resampler;
+  std::vector<int16_t> resampled;
+  std::vector<int16_t> pending;
 
   // PaStream* stream = nullptr;  // PortAudio stream
 
   Impl() = default;
+
+  int device_rate() const
+  {
+    return config.device_rate > 0 ? config.device_rate : config.sample_rate;
+  }
+
+  /**
+   * @brief Hand device samples to the callback as sample_rate frames
+   * @param timestamp Capture time of the first sample, in microseconds
+   */
+  void deliver(std::span<const int16_t> samples, int64_t timestamp)
+  {
+    if (!capturing || !callback) return;
+
+    auto channels = static_cast<size_t>(config.channels);
+    auto frame_samples = static_cast<size_t>(frame_size) * channels;
+    if (!resampler && pending.empty() && samples.size() == frame_samples)
+    {
+      callback(samples, timestamp);
+      return;
+    }
+
+    // Timestamps step back from the newest sample by what is still queued
+    int64_t end_time = timestamp + static_cast<int64_t>(samples.size() / channels) * 1000000 /
+                                       device_rate();
+    if (resampler)
+    {
+      resampled.resize(resampler->max_output_frames(samples.size() / channels) * channels);
+      size_t frames = resampler->process(samples, resampled);
+      pending.insert(pending.end(), resampled.begin(),
+                     resampled.begin() + static_cast<std::ptrdiff_t>(frames * channels));
+    }
+    else
+    {
+      pending.insert(pending.end(), samples.begin(), samples.end());
+    }
+
+    size_t offset = 0;
+    for (; offset + frame_samples <= pending.size(); offset += frame_samples)
+    {
+      auto queued = static_cast<int64_t>((pending.size() - offset) / channels);
+      callback(std::span<const int16_t>(pending.data() + offset, frame_samples),
+               end_time - queued * 1000000 / config.sample_rate);
+    }
+    pending.erase(pending.begin(), pending.begin() + static_cast<std::ptrdiff_t>(offset));
+  }
 };
 
 AudioCapture::AudioCapture() : impl_(std::make_unique<Impl>()) {}
@@ -101,8 +160,33 @@ std::optional<AudioDevice> AudioCapture::get_default_input_device()
 
 bool AudioCapture::open(AudioCaptureConfig config)
 {
+  close();
   impl_->config = config;
   impl_->frame_size = config.sample_rate * config.frame_duration_ms / 1000;
+  impl_->pending.clear();
+  impl_->resampler.reset();
+
+  if (config.backend != AudioBackend::PORTAUDIO)
+  {
+    impl_->backend = config.backend == AudioBackend::FILE ? open_file_capture(config)
+                                                           : open_alsa_capture(config);
+    if (!impl_->backend)
+    {
+      return false;
+    }
+    // The WAV header or the hardware has the last word on the rate
+    impl_->config.device_rate = impl_->backend->sample_rate();
+  }
+
+  if (impl_->device_rate() != config.sample_rate)
+  {
+    impl_->resampler = std::make_unique<Resampler>(
+        ResamplerConfig{impl_->device_rate(), config.sample_rate, config.channels});
+  }
+  if (impl_->backend)
+  {
+    return true;
+  }
 
   /*
   PaStreamParameters params;
@@ -112,12 +196,13 @@ bool AudioCapture::open(AudioCaptureConfig config)
   params.suggestedLatency = Pa_GetDeviceInfo(params.device)->defaultLowInputLatency;
   params.hostApiSpecificStreamInfo = nullptr;
 
+  // Each block read from the stream goes through Impl::deliver()
   PaError err = Pa_OpenStream(
       &impl_->stream,
       &params,
       nullptr,  // No output
-      config.sample_rate,
-      impl_->frame_size,
+      impl_->device_rate(),
+      impl_->device_rate() * config.frame_duration_ms / 1000,
       paClipOff,
       nullptr,  // Blocking read
       nullptr);
@@ -133,6 +218,18 @@ bool AudioCapture::start(AudioCaptureCallback callback)
   impl_->callback = std::move(callback);
   impl_->capturing = true;
 
+  if (impl_->backend)
+  {
+    Impl* impl = impl_.get();
+    if (!impl->backend->start([impl](std::span<const int16_t> samples, int64_t timestamp)
+                              { impl->deliver(samples, timestamp); }))
+    {
+      impl_->capturing = false;
+      return false;
+    }
+    return true;
+  }
+
   // Pa_StartStream(impl_->stream);
   return true;
 }
@@ -140,19 +237,24 @@ bool AudioCapture::start(AudioCaptureCallback callback)
 void AudioCapture::stop()
 {
   impl_->capturing = false;
+  if (impl_->backend)
+  {
+    impl_->backend->stop();
+  }
   // Pa_StopStream(impl_->stream);
 }
 
 void AudioCapture::close()
 {
   stop();
+  impl_->backend.reset();
   // if (impl_->stream) Pa_CloseStream(impl_->stream);
   // impl_->stream = nullptr;
 }
 
 bool AudioCapture::is_capturing() const
 {
-  return impl_->capturing;
+  return impl_->capturing && (!impl_->backend || impl_->backend->running());
 }
 
 int AudioCapture::frame_size() const
@@ -163,13 +265,25 @@ int AudioCapture::frame_size() const
 // AudioPlayback implementation
 struct AudioPlayback::Impl
 {
-  int sample_rate = 48000;
-  int channels = 1;
+  AudioPlaybackConfig config;
   bool playing = false;
+  AudioRenderCallback render_callback;       // Set in pull mode
+  std::unique_ptr<PlaybackBackend> backend;  // ALSA or file; none for PortAudio
 
   // PaStream* stream = nullptr;
 
   Impl() = default;
+
+  /*
+  static int on_device(const void*, void* output, unsigned long frames,
+                       const PaStreamCallbackTimeInfo*, PaStreamCallbackFlags, void* user)
+  {
+    auto* impl = static_cast<Impl*>(user);
+    impl->render_callback(std::span<int16_t>(static_cast<int16_t*>(output),
+                                             frames * static_cast<size_t>(impl->config.channels)));
+    return paContinue;
+  }
+  */
 };
 
 AudioPlayback::AudioPlayback() : impl_(std::make_unique<Impl>()) {}
@@ -179,15 +293,33 @@ AudioPlayback::~AudioPlayback()
   close();
 }
 
-bool AudioPlayback::open(int /*device_id*/, int sample_rate, int channels)
+bool AudioPlayback::open(int device_id, int sample_rate, int channels)
+{
+  AudioPlaybackConfig config;
+  config.device_id = device_id;
+  config.sample_rate = sample_rate;
+  config.channels = channels;
+  return open(std::move(config));
+}
+
+bool AudioPlayback::open(AudioPlaybackConfig config)
 {
-  impl_->sample_rate = sample_rate;
-  impl_->channels = channels;
+  close();
+  impl_->config = std::move(config);
+  if (impl_->config.backend != AudioBackend::PORTAUDIO)
+  {
+    impl_->backend = impl_->config.backend == AudioBackend::FILE
+                         ? open_file_playback(impl_->config)
+                         : open_alsa_playback(impl_->config);
+    return impl_->backend != nullptr;
+  }
 
   /*
+  int device_id = impl_->config.device_id;
+  int sample_rate = impl_->config.sample_rate;
   PaStreamParameters params;
   params.device = device_id < 0 ? Pa_GetDefaultOutputDevice() : device_id;
-  params.channelCount = channels;
+  params.channelCount = impl_->config.channels;
   params.sampleFormat = paInt16;
   params.suggestedLatency = Pa_GetDeviceInfo(params.device)->defaultLowOutputLatency;
   params.hostApiSpecificStreamInfo = nullptr;
@@ -212,26 +344,77 @@ bool AudioPlayback::open(int /*device_id*/, int sample_rate, int channels)
 
 bool AudioPlayback::start()
 {
+  impl_->render_callback = nullptr;
+  if (impl_->backend && !impl_->backend->start(nullptr))
+  {
+    return false;
+  }
   impl_->playing = true;
   // Pa_StartStream(impl_->stream);
   return true;
 }
 
-size_t AudioPlayback::write(std::span<const int16_t> /*samples*/)
+bool AudioPlayback::start(AudioRenderCallback callback)
 {
-  // Pa_WriteStream(impl_->stream, samples.data(), samples.size() / impl_->channels);
+  impl_->render_callback = std::move(callback);
+  if (impl_->backend)
+  {
+    impl_->playing = impl_->backend->start(impl_->render_callback);
+    return impl_->playing;
+  }
+
+  /*
+  // Reopen the stream in callback mode; PortAudio picks the period size
+  if (impl_->stream) Pa_CloseStream(impl_->stream);
+  PaStreamParameters params;
+  params.device =
+      impl_->config.device_id < 0 ? Pa_GetDefaultOutputDevice() : impl_->config.device_id;
+  params.channelCount = impl_->config.channels;
+  params.sampleFormat = paInt16;
+  params.suggestedLatency = Pa_GetDeviceInfo(params.device)->defaultLowOutputLatency;
+  params.hostApiSpecificStreamInfo = nullptr;
+
+  PaError err = Pa_OpenStream(
+      &impl_->stream,
+      nullptr,  // No input
+      &params,
+      impl_->config.sample_rate,
+      impl_->config.period_frames > 0 ? impl_->config.period_frames
+                                      : paFramesPerBufferUnspecified,
+      paClipOff,
+      &Impl::on_device,
+      impl_.get());
+  if (err != paNoError || Pa_StartStream(impl_->stream) != paNoError) return false;
+  */
+
+  impl_->playing = true;
+  return true;  // Stub
+}
+
+size_t AudioPlayback::write(std::span<const int16_t> samples)
+{
+  if (impl_->backend)
+  {
+    return impl_->backend->write(samples);
+  }
+  // Pa_WriteStream(impl_->stream, samples.data(), samples.size() / impl_->config.channels);
   return 0;  // Stub
 }
 
 void AudioPlayback::stop()
 {
   impl_->playing = false;
+  if (impl_->backend)
+  {
+    impl_->backend->stop();
+  }
   // Pa_StopStream(impl_->stream);
 }
 
 void AudioPlayback::close()
 {
   stop();
+  impl_->backend.reset();
   // if (impl_->stream) Pa_CloseStream(impl_->stream);
   // impl_->stream = nullptr;
 }
@@ -243,6 +426,10 @@ bool AudioPlayback::is_playing() const
 
 size_t AudioPlayback::available_buffer_space() const
 {
+  if (impl_->backend)
+  {
+    return impl_->backend->available_space();
+  }
   return 4096;  // Stub
 }
 
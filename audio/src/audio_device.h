@@ -0,0 +1,73 @@
+#pragma once
+
+/**
+ * @file audio_device.h
+ * @brief Device backends behind AudioCapture and AudioPlayback
+ *
+ * Each backend owns its I/O thread: capture backends hand every device block
+ * to a sink, playback backends pull every period from a render callback (or
+ * take write() when started without one). AudioCapture resamples and chunks
+ * what the sink receives, so backends deliver whatever block size suits the
+ * device.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+#include "rtc/audio/audio_capture.h"
+
+namespace rtc
+{
+namespace audio
+{
+
+class CaptureBackend
+{
+ public:
+  virtual ~CaptureBackend() = default;
+
+  /**
+   * @brief Start the I/O thread
+   * @param sink Called on that thread with interleaved device-rate samples
+   *        and the capture time of the first, in microseconds
+   */
+  [[nodiscard]] virtual bool start(AudioCaptureCallback sink) = 0;
+  virtual void stop() = 0;
+
+  // False once the source has run out
+  [[nodiscard]] virtual bool running() const = 0;
+
+  // Device rate, which the file header or the hardware may have chosen
+  [[nodiscard]] virtual int sample_rate() const = 0;
+};
+
+class PlaybackBackend
+{
+ public:
+  virtual ~PlaybackBackend() = default;
+
+  /**
+   * @brief Start playback
+   * @param render Pulled on the I/O thread for every period; when empty,
+   *        the caller feeds the device with write()
+   */
+  [[nodiscard]] virtual bool start(AudioRenderCallback render) = 0;
+  virtual void stop() = 0;
+
+  // Push mode; returns samples accepted
+  virtual size_t write(std::span<const int16_t> samples) = 0;
+  [[nodiscard]] virtual size_t available_space() const = 0;
+};
+
+// Each returns nullptr when the file or device cannot be opened as configured
+std::unique_ptr<CaptureBackend> open_file_capture(const AudioCaptureConfig& config);
+std::unique_ptr<PlaybackBackend> open_file_playback(const AudioPlaybackConfig& config);
+
+// Always nullptr in builds without HAVE_ALSA
+std::unique_ptr<CaptureBackend> open_alsa_capture(const AudioCaptureConfig& config);
+std::unique_ptr<PlaybackBackend> open_alsa_playback(const AudioPlaybackConfig& config);
+
+}  // namespace audio
+}  // namespace rtc
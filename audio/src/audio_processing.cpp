@@ -1,153 +1,38 @@
 /**
  * @file audio_processing.cpp
- * @brief Audio processing pipeline stub implementation
+ * @brief Audio processing pipeline
  *
- * Note: Full implementation requires WebRTC audio processing module
- * or RNNoise for noise suppression.
+ * The echo canceller, noise suppressor, gain controller and voice activity
+ * detector live in echo_canceller.cpp, noise_suppressor.cpp,
+ * gain_controller.cpp and voice_detector.cpp.
  */
 
 #include "rtc/audio/audio_processing.h"
 
-namespace rtc
-{
-namespace audio
-{
-
-// EchoCanceller stub
-struct EchoCanceller::Impl
-{
-  AecConfig config;
-  bool initialized = false;
-  float erle = 0.0f;
-
-  Impl(AecConfig cfg) : config(std::move(cfg)) {}
-};
-
-EchoCanceller::EchoCanceller(AecConfig config) : impl_(std::make_unique<Impl>(std::move(config))) {}
-
-EchoCanceller::~EchoCanceller() = default;
-
-bool EchoCanceller::initialize()
-{
-  // TODO: Initialize WebRTC AEC3
-  impl_->initialized = true;
-  return true;
-}
-
-void EchoCanceller::analyze_render(std::span<const int16_t> /*playback_samples*/)
-{
-  // TODO: Buffer far-end signal for echo cancellation
-}
-
-void EchoCanceller::process_capture(std::span<int16_t> /*capture_samples*/)
-{
-  // TODO: Apply echo cancellation
-}
-
-float EchoCanceller::get_erle() const
-{
-  return impl_->erle;
-}
-
-void EchoCanceller::reset()
-{
-  impl_->erle = 0.0f;
-}
-
-// NoiseSuppressor stub
-struct NoiseSuppressor::Impl
-{
-  NsConfig config;
-  bool initialized = false;
-  float voice_probability = 0.0f;
-
-  Impl(NsConfig cfg) : config(std::move(cfg)) {}
-};
-
-NoiseSuppressor::NoiseSuppressor(NsConfig config) : impl_(std::make_unique<Impl>(std::move(config)))
-{
-}
-
-NoiseSuppressor::~NoiseSuppressor() = default;
-
-bool NoiseSuppressor::initialize()
-{
-  // TODO: Initialize RNNoise or WebRTC NS
-  impl_->initialized = true;
-  return true;
-}
-
-void NoiseSuppressor::process(std::span<int16_t> /*samples*/)
-{
-  // TODO: Apply noise suppression
-  impl_->voice_probability = 0.8f;  // Stub value
-}
-
-void NoiseSuppressor::set_level(NsConfig::Level level)
-{
-  impl_->config.level = level;
-}
-
-float NoiseSuppressor::get_voice_probability() const
-{
-  return impl_->voice_probability;
-}
-
-void NoiseSuppressor::reset()
-{
-  impl_->voice_probability = 0.0f;
-}
-
-// GainController stub
-struct GainController::Impl
-{
-  AgcConfig config;
-  bool initialized = false;
-  float current_gain = 0.0f;
-  bool speech_detected = false;
-
-  Impl(AgcConfig cfg) : config(std::move(cfg)) {}
-};
-
-GainController::GainController(AgcConfig config) : impl_(std::make_unique<Impl>(std::move(config)))
-{
-}
+#include <algorithm>
 
-GainController::~GainController() = default;
+#include "rtc/audio/resampler.h"
 
-bool GainController::initialize()
+namespace rtc
 {
-  // TODO: Initialize WebRTC AGC
-  impl_->initialized = true;
-  return true;
-}
-
-void GainController::process(std::span<int16_t> /*samples*/)
+namespace audio
 {
-  // TODO: Apply automatic gain control
-  impl_->speech_detected = true;  // Stub
-}
 
-void GainController::set_target_level(int level_dbfs)
+namespace
 {
-  impl_->config.target_level_dbfs = level_dbfs;
-}
 
-float GainController::get_current_gain() const
-{
-  return impl_->current_gain;
-}
+constexpr int MAX_FRAME_MS = 60;  // Longer frames grow the buffers once
 
-bool GainController::is_speech_detected() const
+// Grows only; the contents need not survive
+void fit(std::vector<float>& buffer, size_t size)
 {
-  return impl_->speech_detected;
+  if (buffer.size() < size)
+  {
+    buffer.resize(size);
+  }
 }
 
-void GainController::reset()
-{
-  impl_->current_gain = 0.0f;
-  impl_->speech_detected = false;
-}
+}  // namespace
 
 // AudioProcessor implementation
 struct AudioProcessor::Impl
@@ -156,16 +41,80 @@ struct AudioProcessor::Impl
   std::unique_ptr<EchoCanceller> aec;
   std::unique_ptr<NoiseSuppressor> ns;
   std::unique_ptr<GainController> agc;
+  std::unique_ptr<VoiceActivityDetector> vad;
   bool aec_enabled = true;
   bool ns_enabled = true;
   bool agc_enabled = true;
 
+  // Stage-rate float planes; render and capture may run on different threads
+  AudioBuffer render_frame;
+  AudioBuffer capture_frame;
+
+  // Stream <-> stage rate conversion, only when the rates differ, on interleaved
+  // floats. Processed capture queues at the stream rate so every call returns a
+  // full frame.
+  std::unique_ptr<Resampler> render_down;
+  std::unique_ptr<Resampler> capture_down;
+  std::unique_ptr<Resampler> capture_up;
+  std::vector<float> render_in, render_staged;
+  std::vector<float> capture_in, capture_staged;
+  std::vector<float> capture_out;
+
   Impl(Config cfg) : config(std::move(cfg))
   {
     aec_enabled = config.enable_aec;
     ns_enabled = config.enable_ns;
     agc_enabled = config.enable_agc;
   }
+
+  void setup_buffers()
+  {
+    int stage_rate = config.aec_config.sample_rate;
+    int stream_rate = config.stream_rate > 0 ? config.stream_rate : stage_rate;
+    int channels = config.aec_config.channels;
+    auto stage_frames = static_cast<size_t>(stage_rate * MAX_FRAME_MS / 1000);
+    render_frame.reset(static_cast<size_t>(channels), stage_frames);
+    capture_frame.reset(static_cast<size_t>(channels), stage_frames);
+    if (stream_rate == stage_rate)
+    {
+      return;
+    }
+    render_down = std::make_unique<Resampler>(ResamplerConfig{stream_rate, stage_rate, channels});
+    capture_down = std::make_unique<Resampler>(ResamplerConfig{stream_rate, stage_rate, channels});
+    capture_up = std::make_unique<Resampler>(ResamplerConfig{stage_rate, stream_rate, channels});
+
+    auto stream_frames = static_cast<size_t>(stream_rate * MAX_FRAME_MS / 1000);
+    auto samples = [&](size_t frames) { return frames * static_cast<size_t>(channels); };
+    render_in.resize(samples(stream_frames));
+    capture_in.resize(samples(stream_frames));
+    render_staged.resize(samples(render_down->max_output_frames(stream_frames)));
+    capture_staged.resize(samples(capture_down->max_output_frames(stream_frames)));
+    capture_out.reserve(samples(capture_up->max_output_frames(stage_frames) + stream_frames));
+  }
+
+  void run_stages(AudioBuffer& samples)
+  {
+    // Order: AEC -> NS -> VAD -> AGC
+    if (aec_enabled && aec)
+    {
+      aec->process_capture(samples);
+    }
+
+    if (ns_enabled && ns)
+    {
+      ns->process(samples);
+    }
+
+    if (vad)
+    {
+      vad->process(samples);
+    }
+
+    if (agc_enabled && agc)
+    {
+      agc->process(samples);
+    }
+  }
 };
 
 AudioProcessor::AudioProcessor(Config config) : impl_(std::make_unique<Impl>(std::move(config))) {}
@@ -174,6 +123,17 @@ AudioProcessor::~AudioProcessor() = default;
 
 bool AudioProcessor::initialize()
 {
+  // Every stage runs on the same frames, at aec_config's rate and channels
+  auto& config = impl_->config;
+  config.ns_config.sample_rate = config.aec_config.sample_rate;
+  config.ns_config.channels = config.aec_config.channels;
+  config.agc_config.sample_rate = config.aec_config.sample_rate;
+  config.agc_config.channels = config.aec_config.channels;
+  config.vad_config.sample_rate = config.aec_config.sample_rate;
+  config.vad_config.channels = config.aec_config.channels;
+
+  impl_->setup_buffers();
+
   if (impl_->config.enable_aec)
   {
     impl_->aec = std::make_unique<EchoCanceller>(impl_->config.aec_config);
@@ -201,34 +161,87 @@ bool AudioProcessor::initialize()
     }
   }
 
+  if (impl_->config.enable_vad)
+  {
+    impl_->vad = std::make_unique<VoiceActivityDetector>(impl_->config.vad_config);
+    if (!impl_->vad->initialize())
+    {
+      return false;
+    }
+  }
+
   return true;
 }
 
 void AudioProcessor::process_render_frame(std::span<const int16_t> playback_samples)
 {
-  if (impl_->aec_enabled && impl_->aec)
+  auto& d = *impl_;
+  if (!d.aec_enabled || !d.aec)
+  {
+    return;
+  }
+
+  if (!d.render_down)
   {
-    impl_->aec->analyze_render(playback_samples);
+    d.render_frame.copy_from(playback_samples);
+    d.aec->analyze_render(d.render_frame);
+    return;
   }
+
+  auto channels = static_cast<size_t>(d.config.aec_config.channels);
+  size_t input_frames = playback_samples.size() / channels;
+  fit(d.render_in, input_frames * channels);
+  fit(d.render_staged, d.render_down->max_output_frames(input_frames) * channels);
+  std::span<float> input(d.render_in.data(), input_frames * channels);
+  int16_to_float(playback_samples, input);
+  size_t frames = d.render_down->process(input, d.render_staged);
+  d.render_frame.copy_from(std::span<const float>(d.render_staged.data(), frames * channels));
+  d.aec->analyze_render(d.render_frame);
 }
 
 void AudioProcessor::process_capture_frame(std::span<int16_t> samples)
 {
-  // Order: AEC -> NS -> AGC
-  if (impl_->aec_enabled && impl_->aec)
-  {
-    impl_->aec->process_capture(samples);
-  }
+  process_capture_frame(samples, samples);
+}
 
-  if (impl_->ns_enabled && impl_->ns)
+void AudioProcessor::process_capture_frame(std::span<const int16_t> input,
+                                           std::span<int16_t> output)
+{
+  auto& d = *impl_;
+  if (!d.capture_down)
   {
-    impl_->ns->process(samples);
+    d.capture_frame.copy_from(input);
+    d.run_stages(d.capture_frame);
+    d.capture_frame.copy_to(output);
+    return;
   }
 
-  if (impl_->agc_enabled && impl_->agc)
-  {
-    impl_->agc->process(samples);
-  }
+  auto channels = static_cast<size_t>(d.config.aec_config.channels);
+  size_t input_frames = input.size() / channels;
+  fit(d.capture_in, input_frames * channels);
+  fit(d.capture_staged, d.capture_down->max_output_frames(input_frames) * channels);
+  std::span<float> converted(d.capture_in.data(), input_frames * channels);
+  int16_to_float(input, converted);
+  size_t frames = d.capture_down->process(converted, d.capture_staged);
+  std::span<float> staged(d.capture_staged.data(), frames * channels);
+  d.capture_frame.copy_from(std::span<const float>(staged));
+  d.run_stages(d.capture_frame);
+  d.capture_frame.copy_to(staged);
+
+  // Both converters round their output counts up, so the queue never runs short
+  size_t at = d.capture_out.size();
+  d.capture_out.resize(at + d.capture_up->max_output_frames(frames) * channels);
+  size_t returned = d.capture_up->process(std::span<const float>(staged),
+                                          std::span<float>(d.capture_out).subspan(at));
+  d.capture_out.resize(at + returned * channels);
+
+  size_t count = std::min(input.size(), output.size());
+  size_t ready = std::min(count, d.capture_out.size());
+  float_to_int16(std::span<const float>(d.capture_out.data(), ready), output);
+  std::fill(output.begin() + static_cast<std::ptrdiff_t>(ready),
+            output.begin() + static_cast<std::ptrdiff_t>(count), int16_t{0});
+  d.capture_out.erase(d.capture_out.begin(),
+                      d.capture_out.begin() + static_cast<std::ptrdiff_t>(ready));
 }
 
 void AudioProcessor::set_aec_enabled(bool enabled)
@@ -246,11 +259,21 @@ void AudioProcessor::set_agc_enabled(bool enabled)
   impl_->agc_enabled = enabled;
 }
 
+bool AudioProcessor::is_voice_detected() const
+{
+  return !impl_->vad || impl_->vad->is_voice_detected();
+}
+
 void AudioProcessor::reset()
 {
   if (impl_->aec) impl_->aec->reset();
   if (impl_->ns) impl_->ns->reset();
   if (impl_->agc) impl_->agc->reset();
+  if (impl_->vad) impl_->vad->reset();
+  if (impl_->render_down) impl_->render_down->reset();
+  if (impl_->capture_down) impl_->capture_down->reset();
+  if (impl_->capture_up) impl_->capture_up->reset();
+  impl_->capture_out.clear();
 }
 
 }  // namespace audio
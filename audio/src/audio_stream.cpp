@@ -5,14 +5,23 @@
 
 #include "rtc/audio/audio_stream.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cmath>
 #include <mutex>
-#include <thread>
+#include <utility>
 
 #include "rtc/audio/audio_capture.h"
 #include "rtc/audio/audio_processing.h"
+#include "rtc/audio/clock_drift.h"
 #include "rtc/audio/jitter_buffer.h"
 #include "rtc/audio/opus_codec.h"
+#include "rtc/audio/resampler.h"
+#include "rtc/audio/time_stretch.h"
+#include "rtc/health_monitor.h"
+#include "rtc/metrics_exporter.h"
+#include "rtc/task_scheduler.h"
 
 
 namespace rtc
@@ -30,13 +39,27 @@ class AudioStreamImpl : public AudioStream
                   .bitrate = config_.bitrate,
                   .frame_duration_ms = config_.frame_duration_ms}),
         decoder_({.sample_rate = config_.sample_rate, .channels = config_.channels}),
-        jitter_buffer_({.sample_rate = config_.sample_rate}),
+        jitter_buffer_({.sample_rate = config_.sample_rate, .ssrc = config_.remote_ssrc}),
+        stretcher_({.sample_rate = config_.sample_rate, .channels = config_.channels}),
         processor_({
             .enable_aec = config_.enable_aec,
             .enable_ns = config_.enable_ns,
             .enable_agc = config_.enable_agc,
-        })
+            .aec_config = {.channels = config_.channels},
+            .ns_config = {.channels = config_.channels},
+            .agc_config = {.channels = config_.channels},
+            .vad_config = {.channels = config_.channels},
+            .stream_rate = config_.sample_rate,
+        }),
+        drift_estimator_({.sample_rate = config_.sample_rate}),
+        drift_resampler_(config_.channels),
+        capture_buffer_(static_cast<size_t>(config_.sample_rate * config_.frame_duration_ms /
+                                            1000 * config_.channels)),
+        playout_buffer_(static_cast<size_t>(OpusDecoder::MAX_FRAME_SIZE * config_.channels))
   {
+    // A full packet on top of a stretch window; more only after long concealment bursts
+    sync_buffer_.reserve(playout_buffer_.size() * 3);
+    timer_buffer_.resize(frame_span().size());
   }
 
   ~AudioStreamImpl() override
@@ -56,23 +79,71 @@ class AudioStreamImpl : public AudioStream
       return false;
     }
 
-    if (!capture_.open({.sample_rate = config_.sample_rate,
-                        .channels = config_.channels,
-                        .frame_duration_ms = config_.frame_duration_ms}))
+    AudioCaptureConfig capture_config;
+    capture_config.sample_rate = config_.sample_rate;
+    capture_config.channels = config_.channels;
+    capture_config.frame_duration_ms = config_.frame_duration_ms;
+    capture_config.backend = config_.backend;
+    capture_config.file_path = config_.capture_file;
+    capture_config.realtime = config_.realtime;
+    if (!capture_.open(std::move(capture_config)))
     {
       return false;
     }
 
+    if (config_.device_playout)
+    {
+      AudioPlaybackConfig playback_config;
+      playback_config.backend = config_.backend;
+      playback_config.sample_rate = config_.sample_rate;
+      playback_config.channels = config_.channels;
+      playback_config.file_path = config_.playback_file;
+      if (!playback_.open(std::move(playback_config)))
+      {
+        return false;
+      }
+    }
+
     running_.store(true);
     sequence_ = 0;
     timestamp_ = 0;
+    playout_started_ = false;
+    filled_frames_ = 0;
+    stretch_due_ = 0;
+    sync_buffer_.clear();
+    drift_resampler_.reset();
+    {
+      std::lock_guard lock(mutex_);
+      drift_estimator_.reset();
+      clock_started_ = false;
+      played_frames_ = 0;
+    }
 
     // Start capture with callback
-    capture_.start([this](std::span<const int16_t> samples, int64_t /*ts*/)
-                   { on_capture_frame(samples); });
+    if (!capture_.start([this](std::span<const int16_t> samples, int64_t /*ts*/)
+                        { on_capture_frame(samples); }))
+    {
+      stop();
+      return false;
+    }
 
-    // Start playout thread
-    playout_thread_ = std::thread([this]() { playout_loop(); });
+    if (config_.device_playout)
+    {
+      // The sound card asks for each period; its clock is the playout clock
+      if (!playback_.start([this](std::span<int16_t> out) { on_device_render(out); }))
+      {
+        stop();
+        return false;
+      }
+    }
+    else
+    {
+      // Headless: drain the jitter buffer twice per frame on the shared pool
+      lag_probe_ = LoopLagProbe::create("audio_playout");
+      playout_task_ = TaskScheduler::shared().schedule_periodic(
+          std::chrono::milliseconds(std::max(1, config_.frame_duration_ms / 2)),
+          [this]() { playout(); });
+    }
 
     return true;
   }
@@ -81,11 +152,13 @@ class AudioStreamImpl : public AudioStream
   {
     running_.store(false);
     capture_.stop();
+    playback_.stop();
 
-    if (playout_thread_.joinable())
+    if (playout_task_)
     {
-      playout_thread_.join();
+      TaskScheduler::shared().cancel_periodic(std::exchange(playout_task_, 0));
     }
+    lag_probe_.reset();
   }
 
   void set_send_callback(AudioSendCallback callback) override
@@ -109,9 +182,20 @@ class AudioStreamImpl : public AudioStream
     frame.sequence_number = sequence;
     frame.arrival_time = std::chrono::steady_clock::now();
 
+    {
+      // Pair the sender's clock with ours for drift estimation
+      std::lock_guard lock(mutex_);
+      if (clock_started_)
+      {
+        std::chrono::duration<double> since = frame.arrival_time - played_at_;
+        drift_estimator_.on_packet(
+            timestamp, static_cast<double>(played_frames_) + since.count() * config_.sample_rate);
+      }
+      stats_.packets_received++;
+      stats_.bytes_received += opus_data.size();
+    }
+
     jitter_buffer_.push(std::move(frame));
-    stats_.packets_received++;
-    stats_.bytes_received += opus_data.size();
   }
 
   AudioStreamStats stats() const override
@@ -144,6 +228,17 @@ class AudioStreamImpl : public AudioStream
     return audio_level_.load();
   }
 
+  void set_encode_time_histogram(MetricHistogram histogram) override
+  {
+    std::lock_guard lock(mutex_);
+    encode_time_histogram_ = histogram;
+  }
+
+  void set_jitter_delay_histogram(MetricHistogram histogram) override
+  {
+    jitter_buffer_.set_delay_histogram(histogram);
+  }
+
  private:
   void on_capture_frame(std::span<const int16_t> samples)
   {
@@ -152,62 +247,282 @@ class AudioStreamImpl : public AudioStream
       return;
     }
 
-    // Copy samples for processing
-    std::vector<int16_t> processed(samples.begin(), samples.end());
-
-    // Apply audio processing
-    processor_.process_capture_frame(processed);
+    // Processing reads the device's samples and writes the buffer, which is sized
+    // for a frame up front
+    if (capture_buffer_.size() < samples.size())
+    {
+      capture_buffer_.resize(samples.size());
+    }
+    std::span<int16_t> processed(capture_buffer_.data(), samples.size());
+    processor_.process_capture_frame(samples, processed);
 
-    // Calculate audio level
+    // Level of what is encoded, and whether it is speech, for the audio level extension
     float level = calculate_audio_level(processed);
     audio_level_.store(level);
+    auto level_indication = RtpAudioLevel::from_dbov(level, processor_.is_voice_detected());
 
     // Encode
-    auto result = encoder_.encode(processed);
-    if (result.success())
+    auto encode_start = std::chrono::steady_clock::now();
+    auto result = encoder_.encode(processed, packet_buffer_);
+    std::chrono::duration<double, std::milli> encode_time =
+        std::chrono::steady_clock::now() - encode_start;
+
+    // DTX frames are not sent; the receiver sees a timestamp jump and plays comfort noise
+    if (result.success() && result.voice_activity)
     {
       std::lock_guard lock(mutex_);
+      encode_time_histogram_.observe(encode_time.count());
       if (send_callback_)
       {
-        send_callback_(result.data, timestamp_, sequence_);
+        send_callback_(std::span<const uint8_t>(packet_buffer_).first(result.bytes), timestamp_,
+                       sequence_, level_indication);
       }
 
       stats_.packets_sent++;
-      stats_.bytes_sent += result.data.size();
+      stats_.bytes_sent += result.bytes;
+      sequence_++;
     }
 
     timestamp_ += result.samples_encoded;
-    sequence_++;
   }
 
-  void playout_loop()
+  // Headless playout: the steady clock stands in for a sound card
+  void playout()
+  {
+    auto frame_duration = std::chrono::milliseconds(config_.frame_duration_ms);
+
+    // Buffer up to the target delay once, then play one frame per frame duration
+    auto now = std::chrono::steady_clock::now();
+    if (!playout_started_)
+    {
+      if (!jitter_buffer_.is_ready())
+      {
+        return;
+      }
+      next_playout_ = now;
+    }
+
+    // Frames are stamped with their deadline, not the late tick that renders them
+    while (running_.load() && now >= next_playout_)
+    {
+      lag_probe_->tick(next_playout_);
+      render(timer_buffer_, next_playout_);
+      next_playout_ += frame_duration;
+
+      // After a stall, resume from now rather than bursting the backlog out
+      if (now - next_playout_ > MAX_CONCEALED_FRAMES * frame_duration)
+      {
+        auto skipped = (now - next_playout_) / frame_duration;
+        next_playout_ += skipped * frame_duration;
+        std::lock_guard lock(mutex_);
+        played_frames_ += static_cast<uint64_t>(skipped) * frame_span().size() /
+                          static_cast<size_t>(config_.channels);
+      }
+    }
+  }
+
+  // Device playout, on the audio thread: silence until the jitter buffer fills
+  void on_device_render(std::span<int16_t> out)
+  {
+    if (!running_.load() || (!playout_started_ && !jitter_buffer_.is_ready()))
+    {
+      std::fill(out.begin(), out.end(), int16_t{0});
+      return;
+    }
+    render(out, std::chrono::steady_clock::now());
+  }
+
+  /**
+   * Fill `out` from the sync buffer of decoded samples.
+   *
+   * The audio buffered in the jitter buffer plus the sync buffer is held near
+   * the target delay by removing (accelerate) or repeating (preemptive expand)
+   * one pitch period, at most once per frame of output; an empty jitter buffer
+   * is bridged by FEC or PLC (expand). The steady difference between the
+   * sender's clock and the playout clock never reaches those thresholds: it
+   * is taken out by resampling at the estimated drift.
+   */
+  void render(std::span<int16_t> out, std::chrono::steady_clock::time_point at)
+  {
+    auto channels = static_cast<size_t>(config_.channels);
+    size_t frame = frame_span().size();
+    size_t buffered = sync_buffer_.size() + jitter_buffer_.size() * frame;
+    auto target = static_cast<size_t>(jitter_buffer_.stats().target_delay.count() *
+                                      config_.sample_rate / 1000 * config_.channels);
+    size_t stretch_input = stretcher_.min_input() * channels;
+
+    stretch_due_ += out.size();
+    if (stretch_due_ >= frame)
+    {
+      stretch_due_ = 0;
+      if (buffered > target + frame)
+      {
+        decode_until(frame + stretch_input);
+        size_t removed = stretcher_.accelerate(sync_buffer_);
+        std::lock_guard lock(mutex_);
+        stats_.accelerated_samples += removed;
+      }
+      else if (buffered + frame < target)
+      {
+        decode_until(stretch_input);
+        size_t inserted = stretcher_.preemptive_expand(sync_buffer_);
+        std::lock_guard lock(mutex_);
+        stats_.expanded_samples += inserted;
+      }
+    }
+
+    double drift_ppm = 0.0;
+    {
+      std::lock_guard lock(mutex_);
+      drift_ppm = drift_estimator_.drift_ppm();
+    }
+    drift_resampler_.set_ratio(1.0 + drift_ppm * 1e-6);
+
+    size_t needed = drift_resampler_.required_input(out.size() / channels) * channels;
+    decode_until(needed);
+    while (sync_buffer_.size() < needed)
+    {
+      fill_frame();
+    }
+    drift_resampler_.process(std::span<const int16_t>(sync_buffer_.data(), needed), out);
+    sync_buffer_.erase(sync_buffer_.begin(),
+                       sync_buffer_.begin() + static_cast<std::ptrdiff_t>(needed));
+
+    // Feed to AEC
+    processor_.process_render_frame(out);
+
+    {
+      std::lock_guard lock(mutex_);
+      if (playback_callback_)
+      {
+        playback_callback_(out);
+      }
+      stats_.playout_delay_ms = static_cast<float>(buffered) * 1000.0f /
+                                static_cast<float>(config_.sample_rate * config_.channels);
+      stats_.clock_drift_ppm = static_cast<float>(drift_ppm);
+      played_frames_ += out.size() / channels;
+      played_at_ = at;
+      clock_started_ = true;
+    }
+  }
+
+  // Decode packets into the sync buffer until it holds `samples` or the jitter buffer is empty
+  void decode_until(size_t samples)
+  {
+    while (sync_buffer_.size() < samples)
+    {
+      auto frame = jitter_buffer_.pop_next();
+      if (!frame)
+      {
+        break;
+      }
+      play_packet(*frame);
+    }
+  }
+
+  // One frame for a slot whose packet is missing (lost, late or DTX)
+  void fill_frame()
   {
-    int frame_size = config_.sample_rate * config_.frame_duration_ms / 1000;
+    // This slot belongs to expected_sequence_ + filled_frames_; the packet right
+    // after it carries the slot's frame as FEC data
+    auto next = jitter_buffer_.peek(
+        static_cast<uint16_t>(expected_sequence_ + filled_frames_ + 1));
+    if (next && OpusDecoder::has_fec(next->data))
+    {
+      auto result = decoder_.decode_fec(next->data, frame_span());
+      if (result.success())
+      {
+        append(result.samples_decoded);
+        // Every slot up to this one is accounted for; earlier fills were losses, not DTX
+        expected_sequence_ = static_cast<uint16_t>(next->sequence_number);
+        std::lock_guard lock(mutex_);
+        stats_.concealed_frames += std::exchange(filled_frames_, 0);
+        stats_.fec_recovered++;
+        return;
+      }
+    }
+
+    // PLC; after a DTX update libopus turns this into comfort noise
+    auto result = decoder_.decode_plc(frame_span());
+    if (!result.success())
+    {
+      // Keep the output clock running on silence
+      std::fill(frame_span().begin(), frame_span().end(), int16_t{0});
+      result.samples_decoded = config_.sample_rate * config_.frame_duration_ms / 1000;
+    }
+    append(result.samples_decoded);
+    filled_frames_++;
+  }
 
-    while (running_.load())
+  void play_packet(const JitterFrame& frame)
+  {
+    if (playout_started_)
     {
-      auto frame = jitter_buffer_.pop();
-      if (frame)
+      int16_t missing = static_cast<int16_t>(frame.sequence_number - expected_sequence_);
+      if (missing < 0)
       {
-        auto result = decoder_.decode(frame->data, frame_size);
+        return;  // Its slot was already filled
+      }
+
+      uint64_t comfort_noise = 0;
+      uint64_t concealed = filled_frames_;
+      if (missing == 0 && filled_frames_ > 0 &&
+          static_cast<int32_t>(frame.timestamp - last_packet_end_) > 0)
+      {
+        // No sequence gap but time moved on: the sender was in DTX
+        comfort_noise = std::exchange(concealed, 0);
+      }
+
+      // Lost packets whose slots were not filled while waiting
+      int unfilled = std::min(missing - static_cast<int>(filled_frames_), MAX_CONCEALED_FRAMES);
+      bool has_fec = OpusDecoder::has_fec(frame.data);
+      uint64_t recovered = 0;
+      for (int i = 0; i < unfilled; ++i)
+      {
+        // The frame just before this packet comes from its FEC data when present
+        bool use_fec = has_fec && i + 1 == unfilled;
+        auto result = use_fec ? decoder_.decode_fec(frame.data, frame_span())
+                              : decoder_.decode_plc(frame_span());
         if (result.success())
         {
-          // Feed to AEC
-          processor_.process_render_frame(result.samples);
-
-          std::lock_guard lock(mutex_);
-          if (playback_callback_)
-          {
-            playback_callback_(result.samples);
-          }
+          append(result.samples_decoded);
+          (use_fec ? recovered : concealed)++;
         }
       }
-      else
+
+      if (comfort_noise || concealed || recovered)
       {
-        // No packet ready, maybe do PLC or just wait
-        std::this_thread::sleep_for(std::chrono::milliseconds(config_.frame_duration_ms / 2));
+        std::lock_guard lock(mutex_);
+        stats_.comfort_noise_frames += comfort_noise;
+        stats_.concealed_frames += concealed;
+        stats_.fec_recovered += recovered;
       }
     }
+
+    auto result = decoder_.decode(frame.data, playout_buffer_);
+    if (result.success())
+    {
+      append(result.samples_decoded);
+    }
+
+    playout_started_ = true;
+    filled_frames_ = 0;
+    expected_sequence_ = static_cast<uint16_t>(frame.sequence_number + 1);
+    last_packet_end_ = frame.timestamp + static_cast<uint32_t>(std::max(0, result.samples_decoded));
+  }
+
+  std::span<int16_t> frame_span()
+  {
+    auto frame_samples = static_cast<size_t>(config_.sample_rate * config_.frame_duration_ms /
+                                             1000 * config_.channels);
+    return std::span<int16_t>(playout_buffer_).first(frame_samples);
+  }
+
+  void append(int samples_decoded)
+  {
+    auto count = static_cast<std::ptrdiff_t>(samples_decoded) * config_.channels;
+    sync_buffer_.insert(sync_buffer_.end(), playout_buffer_.begin(),
+                        playout_buffer_.begin() + count);
   }
 
   float calculate_audio_level(std::span<const int16_t> samples)
@@ -236,8 +551,12 @@ class AudioStreamImpl : public AudioStream
   OpusEncoder encoder_;
   OpusDecoder decoder_;
   JitterBuffer jitter_buffer_;
+  TimeStretcher stretcher_;
   AudioProcessor processor_;
   AudioCapture capture_;
+  AudioPlayback playback_;
+  ClockDriftEstimator drift_estimator_;  // Guarded by mutex_
+  DriftResampler drift_resampler_;
 
   std::atomic<bool> running_{false};
   std::atomic<bool> muted_{false};
@@ -247,17 +566,47 @@ class AudioStreamImpl : public AudioStream
   uint32_t timestamp_ = 0;
   uint16_t sequence_ = 0;
 
+  // Codec buffers, sized once so the per-frame path does not allocate
+  std::vector<int16_t> capture_buffer_;
+  std::vector<uint8_t> packet_buffer_ = std::vector<uint8_t>(OpusEncoder::MAX_PACKET_BYTES);
+  std::vector<int16_t> playout_buffer_;
+  std::vector<int16_t> timer_buffer_;  // Headless output frame
+  std::vector<int16_t> sync_buffer_;  // Decoded, not yet played
+
   mutable std::mutex mutex_;
   AudioSendCallback send_callback_;
   AudioPlaybackCallback playback_callback_;
   AudioStreamStats stats_;
-
-  std::thread playout_thread_;
+  MetricHistogram encode_time_histogram_;
+
+  PeriodicTaskId playout_task_ = 0;
+  std::shared_ptr<LoopLagProbe> lag_probe_;  // Frame deadlines vs. when they render
+
+  // Playout position (playout task only)
+  static constexpr int MAX_CONCEALED_FRAMES = 5;  // Longer gaps are skipped, not concealed
+  bool playout_started_ = false;
+  uint16_t expected_sequence_ = 0;
+  uint32_t last_packet_end_ = 0;  // Timestamp after the last decoded packet
+  uint64_t filled_frames_ = 0;    // PLC/CNG frames since the last packet
+  size_t stretch_due_ = 0;        // Output samples since the last stretch decision
+  std::chrono::steady_clock::time_point next_playout_;
+
+  // Playout clock for drift estimation (guarded by mutex_)
+  bool clock_started_ = false;
+  uint64_t played_frames_ = 0;
+  std::chrono::steady_clock::time_point played_at_;  // When the last render was due
 };
 
 std::unique_ptr<AudioStream> create_audio_stream(AudioStreamConfig config)
 {
-  return std::make_unique<AudioStreamImpl>(std::move(config));
+  MetricsExporter* metrics = config.metrics;
+  auto stream = std::make_unique<AudioStreamImpl>(std::move(config));
+  if (metrics)
+  {
+    stream->set_encode_time_histogram(metrics->encode_time_histogram("audio"));
+    stream->set_jitter_delay_histogram(metrics->jitter_buffer_delay_histogram());
+  }
+  return stream;
 }
 
 }  // namespace audio
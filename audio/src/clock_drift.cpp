@@ -0,0 +1,178 @@
+/**
+ * @file clock_drift.cpp
+ * @brief Exponentially weighted least-squares clock ratio
+ *
+ * Queueing only ever delays packets, so each second of arrivals contributes
+ * just its earliest packet (the smallest playout position for its RTP time):
+ * the line is fitted to the lower edge of the delay scatter, which moves far
+ * less than its mean. Weighted sums of x (playout position), y (unwrapped
+ * RTP time), x^2 and xy decay by exp(-dx / window) as playout advances.
+ * Both axes are kept relative to a recent origin so the sums stay well
+ * conditioned over long calls.
+ */
+
+#include "rtc/audio/clock_drift.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+constexpr double BUCKET_SECONDS = 1.0;
+constexpr double MIN_SPAN_SECONDS = 10.0;
+constexpr double RESET_ERROR_SECONDS = 1.0;
+constexpr double RECENTRE_SECONDS = 600.0;
+
+}  // namespace
+
+struct ClockDriftEstimator::Impl
+{
+  ClockDriftConfig config;
+
+  bool started = false;
+  uint32_t last_timestamp = 0;
+  int64_t rtp_time = 0;  // Unwrapped, relative to the origin
+  double origin_x = 0.0;
+  double last_x = 0.0;
+  double first_x = 0.0;
+
+  double sw = 0.0, sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+
+  // Earliest arrival of the current bucket
+  bool bucket_open = false;
+  double bucket_start_y = 0.0;
+  double bucket_x = 0.0;
+  double bucket_y = 0.0;
+
+  explicit Impl(ClockDriftConfig cfg) : config(cfg) {}
+
+  void reset()
+  {
+    started = false;
+    rtp_time = 0;
+    sw = sx = sy = sxx = sxy = 0.0;
+    bucket_open = false;
+  }
+
+  void add_point(double x, double y)
+  {
+    double window = config.window_seconds * config.sample_rate;
+    double decay = std::exp(-std::max(0.0, x - last_x) / window);
+    last_x = x;
+    sw = sw * decay + 1.0;
+    sx = sx * decay + x;
+    sy = sy * decay + y;
+    sxx = sxx * decay + x * x;
+    sxy = sxy * decay + x * y;
+  }
+
+  bool fitted(double& slope, double& intercept) const
+  {
+    double det = sw * sxx - sx * sx;
+    if (sw <= 0.0 || det <= 1e-9 * sw * sxx)
+    {
+      return false;
+    }
+    slope = (sw * sxy - sx * sy) / det;
+    intercept = (sy - slope * sx) / sw;
+    return true;
+  }
+
+  // Moves the origin to (dx, dy) from the current one
+  void shift(double dx, double dy)
+  {
+    sxy -= dx * sy + dy * sx - dx * dy * sw;
+    sxx -= 2.0 * dx * sx - dx * dx * sw;
+    sx -= dx * sw;
+    sy -= dy * sw;
+    origin_x += dx;
+    first_x -= dx;
+    last_x -= dx;
+    rtp_time -= static_cast<int64_t>(dy);
+  }
+};
+
+ClockDriftEstimator::ClockDriftEstimator(ClockDriftConfig config)
+    : impl_(std::make_unique<Impl>(config))
+{
+}
+
+ClockDriftEstimator::~ClockDriftEstimator() = default;
+
+void ClockDriftEstimator::on_packet(uint32_t rtp_timestamp, double playout_position)
+{
+  auto& d = *impl_;
+  double rate = d.config.sample_rate;
+  if (!d.started)
+  {
+    d.started = true;
+    d.last_timestamp = rtp_timestamp;
+    d.origin_x = playout_position;
+    d.first_x = 0.0;
+    d.last_x = 0.0;
+  }
+
+  d.rtp_time += static_cast<int32_t>(rtp_timestamp - d.last_timestamp);
+  d.last_timestamp = rtp_timestamp;
+  double x = playout_position - d.origin_x;
+  auto y = static_cast<double>(d.rtp_time);
+
+  // Far off the current line: the sender's timeline changed
+  double slope = 0.0, intercept = 0.0;
+  if (d.fitted(slope, intercept) &&
+      std::abs(y - (intercept + slope * x)) > RESET_ERROR_SECONDS * rate)
+  {
+    d.reset();
+    on_packet(rtp_timestamp, playout_position);
+    return;
+  }
+
+  if (!d.bucket_open)
+  {
+    d.bucket_open = true;
+    d.bucket_start_y = y;
+    d.bucket_x = x;
+    d.bucket_y = y;
+  }
+  else if (x - y < d.bucket_x - d.bucket_y)
+  {
+    d.bucket_x = x;
+    d.bucket_y = y;
+  }
+
+  if (y - d.bucket_start_y >= BUCKET_SECONDS * rate)
+  {
+    d.bucket_open = false;
+    d.add_point(d.bucket_x, d.bucket_y);
+    if (d.bucket_x > RECENTRE_SECONDS * rate)
+    {
+      d.shift(d.bucket_x, d.bucket_y);
+    }
+  }
+}
+
+double ClockDriftEstimator::drift_ppm() const
+{
+  const auto& d = *impl_;
+  double slope = 1.0, intercept = 0.0;
+  if (!d.started || d.last_x - d.first_x < MIN_SPAN_SECONDS * d.config.sample_rate ||
+      !d.fitted(slope, intercept))
+  {
+    return 0.0;
+  }
+  return std::clamp((slope - 1.0) * 1e6, -d.config.max_drift_ppm, d.config.max_drift_ppm);
+}
+
+void ClockDriftEstimator::reset()
+{
+  impl_->reset();
+}
+
+}  // namespace audio
+}  // namespace rtc
@@ -0,0 +1,726 @@
+/**
+ * @file echo_canceller.cpp
+ * @brief Partitioned-block frequency-domain NLMS echo canceller
+ *
+ * The echo path is modelled by an overlap-save adaptive filter split into
+ * 5 ms partitions covering filter_length_ms. The render signal is aligned
+ * to the capture by an envelope-correlation delay estimate, and whatever
+ * the linear filter leaves behind is attenuated per bin by a residual echo
+ * suppressor running on a sqrt-Hann STFT.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#include "rtc/audio/audio_processing.h"
+#include "rtc/audio/fft.h"
+#include "simd.h"
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+constexpr int BLOCK_MS = 5;
+constexpr int MAX_DELAY_MS = 500;
+constexpr int DELAY_WINDOW_BLOCKS = 200;  // Envelope history correlated per estimate
+constexpr int DELAY_UPDATE_BLOCKS = 20;
+constexpr float DELAY_MIN_CORRELATION = 0.6f;
+constexpr size_t DELAY_MARGIN_BLOCKS = 4;  // Filter taps kept ahead of the echo onset
+constexpr int REANCHOR_BLOCKS = 20;  // Render out of reach this long re-pairs the streams
+
+constexpr float STEP_SIZE = 0.5f;
+constexpr float DOUBLE_TALK_STEP_SIZE = 0.02f;
+constexpr float RENDER_ACTIVE_POWER = 1e-6f;  // -60 dBFS
+constexpr float REGULARIZATION = 1e-6f;
+constexpr float ERROR_REGULARIZATION = 4.0f;
+
+constexpr float SUPPRESSOR_OVERDRIVE = 2.0f;
+constexpr float SUPPRESSOR_MIN_GAIN = 0.05f;
+
+// y += x * w over complex bins
+void multiply_accumulate(const float* xr, const float* xi, const float* wr, const float* wi,
+                         float* yr, float* yi, size_t bins)
+{
+  size_t k = 0;
+  for (; k + simd::WIDTH <= bins; k += simd::WIDTH)
+  {
+    auto ar = simd::load(xr + k), ai = simd::load(xi + k);
+    auto br = simd::load(wr + k), bi = simd::load(wi + k);
+    simd::store(yr + k, simd::add(simd::load(yr + k),
+                                  simd::sub(simd::mul(ar, br), simd::mul(ai, bi))));
+    simd::store(yi + k, simd::add(simd::load(yi + k),
+                                  simd::add(simd::mul(ar, bi), simd::mul(ai, br))));
+  }
+  for (; k < bins; ++k)
+  {
+    yr[k] += xr[k] * wr[k] - xi[k] * wi[k];
+    yi[k] += xr[k] * wi[k] + xi[k] * wr[k];
+  }
+}
+
+// w += conj(x) * g over complex bins
+void adapt_partition(const float* xr, const float* xi, const float* gr, const float* gi,
+                     float* wr, float* wi, size_t bins)
+{
+  size_t k = 0;
+  for (; k + simd::WIDTH <= bins; k += simd::WIDTH)
+  {
+    auto ar = simd::load(xr + k), ai = simd::load(xi + k);
+    auto br = simd::load(gr + k), bi = simd::load(gi + k);
+    simd::store(wr + k, simd::add(simd::load(wr + k),
+                                  simd::add(simd::mul(ar, br), simd::mul(ai, bi))));
+    simd::store(wi + k, simd::add(simd::load(wi + k),
+                                  simd::sub(simd::mul(ar, bi), simd::mul(ai, br))));
+  }
+  for (; k < bins; ++k)
+  {
+    wr[k] += xr[k] * gr[k] + xi[k] * gi[k];
+    wi[k] += xr[k] * gi[k] - xi[k] * gr[k];
+  }
+}
+
+// p += |x|^2
+void accumulate_power(const float* xr, const float* xi, float* p, size_t bins)
+{
+  size_t k = 0;
+  for (; k + simd::WIDTH <= bins; k += simd::WIDTH)
+  {
+    auto ar = simd::load(xr + k), ai = simd::load(xi + k);
+    simd::store(p + k, simd::add(simd::load(p + k),
+                                 simd::add(simd::mul(ar, ar), simd::mul(ai, ai))));
+  }
+  for (; k < bins; ++k)
+  {
+    p[k] += xr[k] * xr[k] + xi[k] * xi[k];
+  }
+}
+
+// y += x
+void add_to(const float* x, float* y, size_t n)
+{
+  size_t i = 0;
+  for (; i + simd::WIDTH <= n; i += simd::WIDTH)
+  {
+    simd::store(y + i, simd::add(simd::load(y + i), simd::load(x + i)));
+  }
+  for (; i < n; ++i)
+  {
+    y[i] += x[i];
+  }
+}
+
+// y[k] = max(x[k - 1], x[k], x[k + 1])
+void neighbour_max(const float* x, float* y, size_t n)
+{
+  y[0] = std::max(x[0], x[1]);
+  size_t k = 1;
+  for (; k + simd::WIDTH < n; k += simd::WIDTH)
+  {
+    simd::store(y + k, simd::max(simd::max(simd::load(x + k - 1), simd::load(x + k)),
+                                 simd::load(x + k + 1)));
+  }
+  for (; k + 1 < n; ++k)
+  {
+    y[k] = std::max({x[k - 1], x[k], x[k + 1]});
+  }
+  y[n - 1] = std::max(x[n - 2], x[n - 1]);
+}
+
+float energy(const float* x, size_t n)
+{
+  float sum = 0.0f;
+  for (size_t i = 0; i < n; ++i)
+  {
+    sum += x[i] * x[i];
+  }
+  return sum / static_cast<float>(n);
+}
+
+float to_db(float power)
+{
+  return 10.0f * std::log10(power + 1e-10f);
+}
+
+}  // namespace
+
+struct EchoCanceller::Impl
+{
+  AecConfig config;
+  bool initialized = false;
+  float erle = 0.0f;
+  std::mutex mutex;
+
+  size_t block = 0;       // Samples per partition and per processing block
+  size_t fft_size = 0;    // At least two blocks
+  size_t bins = 0;
+  size_t partitions = 0;  // Covering filter_length_ms
+  size_t max_delay = 0;   // In blocks; 0 unless delay agnostic
+  size_t history = 0;     // Render spectra kept: max_delay + partitions + slack
+
+  std::unique_ptr<RealFft> fft;
+
+  // Render: newest fft_size samples, spectra and powers by render block
+  std::vector<float> render_window;
+  std::vector<float> render_pending;
+  std::vector<float> render_re, render_im, render_power;
+  std::vector<float> render_energy_db;  // Envelope for the delay estimate
+  int64_t render_blocks = 0;
+
+  // Capture block index minus the render block index played at the same time,
+  // fixed when render first arrives so every capture block pairs with its own
+  // render block rather than whatever was delivered last
+  int64_t render_offset = 0;
+  bool anchored = false;
+  int unaligned_blocks = 0;
+
+  // Adaptive filter, one spectrum per partition
+  std::vector<float> filter_re, filter_im;
+  size_t constrain_next = 0;
+
+  // int16 calls are converted through here
+  AudioBuffer scratch;
+
+  // Capture block scratch
+  std::vector<float> capture_pending;
+  std::vector<float> capture_out;
+  std::vector<float> time, spec_re, spec_im, gain_re, gain_im, power, norm;
+  std::vector<float> echo, error;
+
+  // Delay estimate
+  size_t delay_blocks = 0;
+  size_t delay_candidate = 0;
+  std::vector<float> capture_energy_db;
+  std::vector<int64_t> capture_render_index;  // Paired render block per capture block
+  int64_t capture_blocks = 0;
+
+  // Convergence and double talk
+  float capture_power = 0.0f;
+  float error_power = 0.0f;
+  float echo_power = 0.0f;
+
+  // Residual echo suppressor: sqrt-Hann STFT, hop of one block
+  std::vector<float> window;
+  std::vector<float> previous_error, previous_echo;
+  std::vector<float> overlap;
+  std::vector<float> suppressor_gain;
+  std::vector<float> error_re, error_im;
+
+  Impl(AecConfig cfg) : config(std::move(cfg)) {}
+
+  void setup()
+  {
+    block = static_cast<size_t>(config.sample_rate * BLOCK_MS / 1000);
+    fft_size = std::max<size_t>(32, std::bit_ceil(2 * block));
+    bins = fft_size / 2 + 1;
+    auto filter_samples = static_cast<size_t>(config.sample_rate) *
+                          static_cast<size_t>(config.filter_length_ms) / 1000;
+    partitions = std::max<size_t>(1, (filter_samples + block - 1) / block);
+    max_delay = config.enable_delay_agnostic ? MAX_DELAY_MS / BLOCK_MS : 0;
+    // Render and capture arrive a frame at a time, so either may run a frame or two ahead
+    auto frame = static_cast<size_t>(config.sample_rate * config.frame_duration_ms / 1000);
+    size_t frame_blocks = (frame + block - 1) / block;
+    history = max_delay + partitions + 2 * frame_blocks + 1;
+
+    fft = std::make_unique<RealFft>(fft_size);
+    scratch.reset(static_cast<size_t>(config.channels), frame);
+    render_window.assign(fft_size, 0.0f);
+    render_pending.clear();
+    render_pending.reserve(block * 8);
+    render_re.assign(history * bins, 0.0f);
+    render_im.assign(history * bins, 0.0f);
+    render_power.assign(history * bins, 0.0f);
+    render_energy_db.assign(max_delay + DELAY_WINDOW_BLOCKS + 1, -100.0f);
+    render_blocks = 0;
+    render_offset = 0;
+    anchored = false;
+    unaligned_blocks = 0;
+
+    filter_re.assign(partitions * bins, 0.0f);
+    filter_im.assign(partitions * bins, 0.0f);
+    constrain_next = 0;
+
+    capture_pending.clear();
+    capture_pending.reserve(block * 8);
+    time.assign(fft_size, 0.0f);
+    spec_re.assign(bins, 0.0f);
+    spec_im.assign(bins, 0.0f);
+    gain_re.assign(bins, 0.0f);
+    gain_im.assign(bins, 0.0f);
+    power.assign(bins, 0.0f);
+    norm.assign(bins, 0.0f);
+    echo.assign(block, 0.0f);
+    error.assign(block, 0.0f);
+
+    delay_blocks = 0;
+    delay_candidate = 0;
+    capture_energy_db.assign(DELAY_WINDOW_BLOCKS, -100.0f);
+    capture_render_index.assign(DELAY_WINDOW_BLOCKS, 0);
+    capture_blocks = 0;
+
+    capture_power = error_power = echo_power = 0.0f;
+    erle = 0.0f;
+
+    const double pi = std::acos(-1.0);
+    window.resize(2 * block);
+    for (size_t n = 0; n < window.size(); ++n)
+    {
+      window[n] = static_cast<float>(std::sin(pi * (static_cast<double>(n) + 0.5) /
+                                              static_cast<double>(window.size())));
+    }
+    previous_error.assign(block, 0.0f);
+    previous_echo.assign(block, 0.0f);
+    overlap.assign(block, 0.0f);
+    suppressor_gain.assign(bins, 1.0f);
+    error_re.assign(bins, 0.0f);
+    error_im.assign(bins, 0.0f);
+
+    // The suppressor's overlap-add delays output by one block; frames that are not a
+    // whole number of blocks need one more so every call finds its output ready
+    capture_out.assign(frame % block == 0 ? 0 : block, 0.0f);
+    capture_out.reserve(frame + 2 * block);
+  }
+
+  void analyze(const AudioBuffer& playback)
+  {
+    // Mono downmix
+    size_t at = render_pending.size();
+    render_pending.resize(at + playback.frames());
+    playback.downmix(std::span<float>(render_pending).subspan(at));
+
+    size_t consumed = 0;
+    for (; consumed + block <= render_pending.size(); consumed += block)
+    {
+      add_render_block(render_pending.data() + consumed);
+    }
+    render_pending.erase(render_pending.begin(),
+                         render_pending.begin() + static_cast<std::ptrdiff_t>(consumed));
+  }
+
+  void cancel(AudioBuffer& capture)
+  {
+    // Cancelled on the mono downmix, written back to every channel
+    size_t frames = capture.frames();
+    size_t at = capture_pending.size();
+    capture_pending.resize(at + frames);
+    capture.downmix(std::span<float>(capture_pending).subspan(at));
+
+    size_t consumed = 0;
+    for (; consumed + block <= capture_pending.size(); consumed += block)
+    {
+      size_t out = capture_out.size();
+      capture_out.resize(out + block);
+      process_block(capture_pending.data() + consumed, capture_out.data() + out);
+    }
+    capture_pending.erase(capture_pending.begin(),
+                          capture_pending.begin() + static_cast<std::ptrdiff_t>(consumed));
+
+    size_t ready = std::min(frames, capture_out.size());
+    capture.upmix(std::span<const float>(capture_out.data(), ready));
+    capture_out.erase(capture_out.begin(),
+                      capture_out.begin() + static_cast<std::ptrdiff_t>(ready));
+  }
+
+  size_t slot(int64_t render_block) const
+  {
+    return static_cast<size_t>(render_block % history) * bins;
+  }
+
+  void add_render_block(const float* samples)
+  {
+    std::copy(render_window.begin() + static_cast<std::ptrdiff_t>(block), render_window.end(),
+              render_window.begin());
+    std::copy(samples, samples + block, render_window.end() - static_cast<std::ptrdiff_t>(block));
+
+    if (!anchored)
+    {
+      render_offset = capture_blocks - render_blocks;
+      anchored = true;
+    }
+
+    size_t s = slot(render_blocks);
+    fft->forward(render_window, std::span<float>(render_re).subspan(s, bins),
+                 std::span<float>(render_im).subspan(s, bins));
+    std::fill_n(render_power.begin() + static_cast<std::ptrdiff_t>(s), bins, 0.0f);
+    accumulate_power(&render_re[s], &render_im[s], &render_power[s], bins);
+
+    render_energy_db[envelope_slot(render_blocks)] = to_db(energy(samples, block));
+    render_blocks++;
+  }
+
+  size_t envelope_slot(int64_t render_block) const
+  {
+    return static_cast<size_t>(render_block % static_cast<int64_t>(render_energy_db.size()));
+  }
+
+  /**
+   * Correlate capture and render log-energy envelopes over the last second
+   * and take the best lag, once it wins twice in a row.
+   */
+  void estimate_delay()
+  {
+    if (max_delay == 0 || !anchored || capture_blocks < DELAY_WINDOW_BLOCKS ||
+        capture_blocks % DELAY_UPDATE_BLOCKS != 0)
+    {
+      return;
+    }
+
+    size_t n = DELAY_WINDOW_BLOCKS;
+    float capture_mean = 0.0f;
+    for (float v : capture_energy_db)
+    {
+      capture_mean += v;
+    }
+    capture_mean /= static_cast<float>(n);
+
+    float best = DELAY_MIN_CORRELATION;
+    auto oldest = render_blocks - static_cast<int64_t>(render_energy_db.size());
+    size_t best_lag = SIZE_MAX;
+    for (size_t lag = 0; lag <= max_delay; ++lag)
+    {
+      float render_mean = 0.0f;
+      bool available = true;
+      for (size_t t = 0; t < n && available; ++t)
+      {
+        int64_t index = capture_render_index[t] - static_cast<int64_t>(lag);
+        available = index >= 0 && index >= oldest && index < render_blocks;
+        if (available)
+        {
+          render_mean += render_energy_db[envelope_slot(index)];
+        }
+      }
+      if (!available)
+      {
+        continue;
+      }
+      render_mean /= static_cast<float>(n);
+
+      float cross = 0.0f, capture_var = 0.0f, render_var = 0.0f;
+      for (size_t t = 0; t < n; ++t)
+      {
+        float c = capture_energy_db[t] - capture_mean;
+        float r = render_energy_db[envelope_slot(capture_render_index[t] -
+                                                 static_cast<int64_t>(lag))] -
+                  render_mean;
+        cross += c * r;
+        capture_var += c * c;
+        render_var += r * r;
+      }
+      if (render_var < 1.0f * static_cast<float>(n))
+      {
+        return;  // Far end too steady (silent) to locate the echo
+      }
+      float corr = cross / std::sqrt(capture_var * render_var + 1e-9f);
+      if (corr > best)
+      {
+        best = corr;
+        best_lag = lag;
+      }
+    }
+
+    if (best_lag == SIZE_MAX)
+    {
+      return;
+    }
+    if (best_lag != delay_candidate)
+    {
+      delay_candidate = best_lag;
+      return;
+    }
+
+    // Leave the filter alone while the echo onset sits in its first half; otherwise
+    // re-centre with a few blocks of margin and start over
+    size_t target = best_lag > DELAY_MARGIN_BLOCKS ? best_lag - DELAY_MARGIN_BLOCKS : 0;
+    bool inside = best_lag >= delay_blocks && best_lag <= delay_blocks + partitions / 2 &&
+                  (best_lag > delay_blocks || delay_blocks == 0);
+    if (inside || target == delay_blocks)
+    {
+      return;
+    }
+    delay_blocks = target;
+    std::fill(filter_re.begin(), filter_re.end(), 0.0f);
+    std::fill(filter_im.begin(), filter_im.end(), 0.0f);
+  }
+
+  /**
+   * Render block that lines up with the current capture block after the
+   * delay estimate, and how many partitions have render spectra behind it.
+   * Re-pairs the streams if render stays out of reach, e.g. after a stall.
+   */
+  size_t align(int64_t& aligned)
+  {
+    if (!anchored)
+    {
+      return 0;
+    }
+    auto oldest = std::max<int64_t>(0, render_blocks - static_cast<int64_t>(history));
+    aligned = capture_blocks - render_offset - static_cast<int64_t>(delay_blocks);
+    if (aligned < oldest || aligned >= render_blocks)
+    {
+      if (++unaligned_blocks < REANCHOR_BLOCKS)
+      {
+        return 0;
+      }
+      render_offset = capture_blocks - (render_blocks - 1);
+      delay_blocks = 0;
+      std::fill(filter_re.begin(), filter_re.end(), 0.0f);
+      std::fill(filter_im.begin(), filter_im.end(), 0.0f);
+      aligned = render_blocks - 1;
+    }
+    unaligned_blocks = 0;
+    return static_cast<size_t>(std::min<int64_t>(static_cast<int64_t>(partitions),
+                                                 aligned - oldest + 1));
+  }
+
+  void process_block(const float* capture, float* output)
+  {
+    capture_energy_db[static_cast<size_t>(capture_blocks % DELAY_WINDOW_BLOCKS)] =
+        to_db(energy(capture, block));
+    capture_render_index[static_cast<size_t>(capture_blocks % DELAY_WINDOW_BLOCKS)] =
+        capture_blocks - render_offset;
+    estimate_delay();
+
+    int64_t aligned = 0;
+    size_t available = align(aligned);
+    capture_blocks++;
+
+    // Echo estimate: sum of partition filters over delayed render spectra
+    std::fill(spec_re.begin(), spec_re.end(), 0.0f);
+    std::fill(spec_im.begin(), spec_im.end(), 0.0f);
+    std::fill(power.begin(), power.end(), 0.0f);
+    for (size_t j = 0; j < available; ++j)
+    {
+      size_t s = slot(aligned - static_cast<int64_t>(j));
+      multiply_accumulate(&render_re[s], &render_im[s], &filter_re[j * bins],
+                          &filter_im[j * bins], spec_re.data(), spec_im.data(), bins);
+      add_to(&render_power[s], power.data(), bins);
+    }
+    fft->inverse(spec_re, spec_im, time);
+    std::copy(time.end() - static_cast<std::ptrdiff_t>(block), time.end(), echo.begin());
+
+    for (size_t i = 0; i < block; ++i)
+    {
+      error[i] = capture[i] - echo[i];
+    }
+
+    float capture_e = energy(capture, block);
+    float error_e = energy(error.data(), block);
+    float echo_e = energy(echo.data(), block);
+    float render_e = 0.0f;
+    for (size_t k = 0; k < bins && available > 0; ++k)
+    {
+      render_e += render_power[slot(aligned) + k];
+    }
+    render_e /= static_cast<float>(fft_size * fft_size / 2);
+    bool render_active = render_e > RENDER_ACTIVE_POWER;
+
+    // Near-end speech makes the capture far louder than the modelled echo
+    bool converged = erle > 6.0f;
+    bool double_talk = converged && capture_e > 8.0f * echo_e;
+
+    if (render_active)
+    {
+      const float alpha = 0.05f;
+      capture_power += alpha * (capture_e - capture_power);
+      error_power += alpha * (error_e - error_power);
+      echo_power += alpha * (echo_e - echo_power);
+      if (!double_talk)
+      {
+        erle = std::max(0.0f, to_db(capture_power) - to_db(error_power));
+      }
+    }
+
+    if (render_active && available > 0)
+    {
+      // Error spectrum, last block of an otherwise empty window
+      std::fill(time.begin(), time.end() - static_cast<std::ptrdiff_t>(block), 0.0f);
+      std::copy(error.begin(), error.end(), time.end() - static_cast<std::ptrdiff_t>(block));
+      fft->forward(time, spec_re, spec_im);
+      // Per-bin NLMS over the render power of all partitions. A harmonic's leakage
+      // puts its error into the weak bins beside it, so each bin is normalized by the
+      // strongest of its neighbours or the gradient constraint spreads a huge step back
+      neighbour_max(power.data(), norm.data(), bins);
+      float mu = double_talk ? DOUBLE_TALK_STEP_SIZE : STEP_SIZE;
+      float delta = REGULARIZATION * static_cast<float>(partitions * fft_size);
+      for (size_t k = 0; k < bins; ++k)
+      {
+        // A bin whose error the render cannot explain (near-end speech, an echo out
+        // of reach) takes proportionally smaller steps instead of wandering off
+        float error_bin = spec_re[k] * spec_re[k] + spec_im[k] * spec_im[k];
+        float scale = mu / (norm[k] + delta + ERROR_REGULARIZATION * error_bin);
+        gain_re[k] = spec_re[k] * scale;
+        gain_im[k] = spec_im[k] * scale;
+      }
+
+      for (size_t j = 0; j < available; ++j)
+      {
+        size_t s = slot(aligned - static_cast<int64_t>(j));
+        adapt_partition(&render_re[s], &render_im[s], gain_re.data(), gain_im.data(),
+                        &filter_re[j * bins], &filter_im[j * bins], bins);
+      }
+
+      // Keep one partition a true block-long filter per block, in rotation
+      size_t j = constrain_next;
+      constrain_next = (constrain_next + 1) % partitions;
+      std::span<float> wr(&filter_re[j * bins], bins);
+      std::span<float> wi(&filter_im[j * bins], bins);
+      fft->inverse(wr, wi, time);
+      std::fill(time.begin() + static_cast<std::ptrdiff_t>(block), time.end(), 0.0f);
+      fft->forward(time, wr, wi);
+    }
+
+    suppress_residual(render_active && converged, output);
+  }
+
+  /**
+   * Attenuate bins where the scaled echo estimate explains the error; the
+   * STFT overlap-add completes one block behind the input.
+   */
+  void suppress_residual(bool active, float* output)
+  {
+    auto frame = [&](const std::vector<float>& previous, const std::vector<float>& current,
+                     std::vector<float>& re, std::vector<float>& im)
+    {
+      for (size_t n = 0; n < block; ++n)
+      {
+        time[n] = previous[n] * window[n];
+        time[block + n] = current[n] * window[block + n];
+      }
+      std::fill(time.begin() + static_cast<std::ptrdiff_t>(2 * block), time.end(), 0.0f);
+      fft->forward(time, re, im);
+    };
+
+    frame(previous_error, error, error_re, error_im);
+    if (active)
+    {
+      frame(previous_echo, echo, spec_re, spec_im);
+      float leak = std::clamp(std::pow(10.0f, -erle / 10.0f), 0.005f, 1.0f) *
+                   SUPPRESSOR_OVERDRIVE;
+      for (size_t k = 0; k < bins; ++k)
+      {
+        float residual = leak * (spec_re[k] * spec_re[k] + spec_im[k] * spec_im[k]);
+        float power = error_re[k] * error_re[k] + error_im[k] * error_im[k];
+        float gain = std::max(SUPPRESSOR_MIN_GAIN, 1.0f - residual / (power + 1e-9f));
+        // Clamp down at once, recover over a few blocks
+        suppressor_gain[k] =
+            gain < suppressor_gain[k] ? gain : suppressor_gain[k] + 0.3f * (gain - suppressor_gain[k]);
+      }
+    }
+    else
+    {
+      for (auto& g : suppressor_gain)
+      {
+        g += 0.3f * (1.0f - g);
+      }
+    }
+
+    for (size_t k = 0; k < bins; ++k)
+    {
+      error_re[k] *= suppressor_gain[k];
+      error_im[k] *= suppressor_gain[k];
+    }
+    fft->inverse(error_re, error_im, time);
+    for (size_t n = 0; n < block; ++n)
+    {
+      output[n] = overlap[n] + time[n] * window[n];
+      overlap[n] = time[block + n] * window[block + n];
+    }
+
+    previous_error.swap(error);
+    previous_echo.swap(echo);
+  }
+};
+
+EchoCanceller::EchoCanceller(AecConfig config) : impl_(std::make_unique<Impl>(std::move(config))) {}
+
+EchoCanceller::~EchoCanceller() = default;
+
+bool EchoCanceller::initialize()
+{
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->config.sample_rate < 8000 || impl_->config.channels < 1)
+  {
+    return false;
+  }
+  impl_->setup();
+  impl_->initialized = true;
+  return true;
+}
+
+void EchoCanceller::analyze_render(std::span<const int16_t> playback_samples)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return;
+  }
+  d.scratch.copy_from(playback_samples);
+  d.analyze(d.scratch);
+}
+
+void EchoCanceller::analyze_render(const AudioBuffer& playback)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return;
+  }
+  d.analyze(playback);
+}
+
+void EchoCanceller::process_capture(std::span<int16_t> capture_samples)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return;
+  }
+  d.scratch.copy_from(capture_samples);
+  d.cancel(d.scratch);
+  d.scratch.copy_to(capture_samples);
+}
+
+void EchoCanceller::process_capture(AudioBuffer& capture)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return;
+  }
+  d.cancel(capture);
+}
+
+float EchoCanceller::get_erle() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->erle;
+}
+
+int EchoCanceller::get_delay_ms() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return static_cast<int>(impl_->delay_blocks) * BLOCK_MS;
+}
+
+void EchoCanceller::reset()
+{
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->initialized)
+  {
+    impl_->setup();
+  }
+  impl_->erle = 0.0f;
+}
+
+}  // namespace audio
+}  // namespace rtc
@@ -0,0 +1,335 @@
+/**
+ * @file fft.cpp
+ * @brief Stockham radix-4/2 FFT with SIMD butterflies
+ */
+
+#include "rtc/audio/fft.h"
+
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "simd.h"
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+// One radix-4 pass: length-n sub-transforms at stride s
+struct Stage
+{
+  size_t length;
+  size_t stride;
+  std::vector<float> w1r, w1i, w2r, w2i, w3r, w3i;  // Twiddles for p in [0, length / 4)
+};
+
+// Complex multiply (ar + i ai)(br + i bi), four lanes
+inline void cmul(simd::f32x4& re, simd::f32x4& im, simd::f32x4 wr, simd::f32x4 wi)
+{
+  simd::f32x4 r = simd::sub(simd::mul(re, wr), simd::mul(im, wi));
+  im = simd::mul_add(re, wi, simd::mul(im, wr));
+  re = r;
+}
+
+struct Butterfly
+{
+  simd::f32x4 r0, i0, r1, i1, r2, i2, r3, i3;
+};
+
+// DFT-4 of a0..a3 with outputs 1..3 twiddled
+inline Butterfly radix4(const Butterfly& a, simd::f32x4 w1r, simd::f32x4 w1i, simd::f32x4 w2r,
+                        simd::f32x4 w2i, simd::f32x4 w3r, simd::f32x4 w3i)
+{
+  simd::f32x4 t0r = simd::add(a.r0, a.r2), t0i = simd::add(a.i0, a.i2);
+  simd::f32x4 t1r = simd::sub(a.r0, a.r2), t1i = simd::sub(a.i0, a.i2);
+  simd::f32x4 t2r = simd::add(a.r1, a.r3), t2i = simd::add(a.i1, a.i3);
+  // -i (a1 - a3)
+  simd::f32x4 t3r = simd::sub(a.i1, a.i3), t3i = simd::sub(a.r3, a.r1);
+
+  Butterfly y;
+  y.r0 = simd::add(t0r, t2r);
+  y.i0 = simd::add(t0i, t2i);
+  y.r1 = simd::add(t1r, t3r);
+  y.i1 = simd::add(t1i, t3i);
+  y.r2 = simd::sub(t0r, t2r);
+  y.i2 = simd::sub(t0i, t2i);
+  y.r3 = simd::sub(t1r, t3r);
+  y.i3 = simd::sub(t1i, t3i);
+  cmul(y.r1, y.i1, w1r, w1i);
+  cmul(y.r2, y.i2, w2r, w2i);
+  cmul(y.r3, y.i3, w3r, w3i);
+  return y;
+}
+
+void run_stage(const Stage& stage, const float* xr, const float* xi, float* yr, float* yi)
+{
+  size_t m = stage.length / 4;
+  size_t s = stage.stride;
+
+  if (s >= simd::WIDTH)
+  {
+    // Four sub-transforms at once, one twiddle per pass over q
+    for (size_t p = 0; p < m; ++p)
+    {
+      auto w1r = simd::set1(stage.w1r[p]), w1i = simd::set1(stage.w1i[p]);
+      auto w2r = simd::set1(stage.w2r[p]), w2i = simd::set1(stage.w2i[p]);
+      auto w3r = simd::set1(stage.w3r[p]), w3i = simd::set1(stage.w3i[p]);
+      for (size_t q = 0; q < s; q += simd::WIDTH)
+      {
+        size_t in = q + s * p;
+        size_t out = q + s * 4 * p;
+        Butterfly a{simd::load(xr + in),         simd::load(xi + in),
+                    simd::load(xr + in + s * m), simd::load(xi + in + s * m),
+                    simd::load(xr + in + 2 * s * m), simd::load(xi + in + 2 * s * m),
+                    simd::load(xr + in + 3 * s * m), simd::load(xi + in + 3 * s * m)};
+        Butterfly y = radix4(a, w1r, w1i, w2r, w2i, w3r, w3i);
+        simd::store(yr + out, y.r0);
+        simd::store(yi + out, y.i0);
+        simd::store(yr + out + s, y.r1);
+        simd::store(yi + out + s, y.i1);
+        simd::store(yr + out + 2 * s, y.r2);
+        simd::store(yi + out + 2 * s, y.i2);
+        simd::store(yr + out + 3 * s, y.r3);
+        simd::store(yi + out + 3 * s, y.i3);
+      }
+    }
+    return;
+  }
+
+  if (s == 1 && m % simd::WIDTH == 0)
+  {
+    // First pass: four values of p at once, outputs interleaved by a transpose
+    for (size_t p = 0; p < m; p += simd::WIDTH)
+    {
+      Butterfly a{simd::load(xr + p),         simd::load(xi + p),
+                  simd::load(xr + p + m),     simd::load(xi + p + m),
+                  simd::load(xr + p + 2 * m), simd::load(xi + p + 2 * m),
+                  simd::load(xr + p + 3 * m), simd::load(xi + p + 3 * m)};
+      Butterfly y = radix4(a, simd::load(&stage.w1r[p]), simd::load(&stage.w1i[p]),
+                           simd::load(&stage.w2r[p]), simd::load(&stage.w2i[p]),
+                           simd::load(&stage.w3r[p]), simd::load(&stage.w3i[p]));
+      simd::transpose(y.r0, y.r1, y.r2, y.r3);
+      simd::transpose(y.i0, y.i1, y.i2, y.i3);
+      simd::store(yr + 4 * p, y.r0);
+      simd::store(yr + 4 * p + 4, y.r1);
+      simd::store(yr + 4 * p + 8, y.r2);
+      simd::store(yr + 4 * p + 12, y.r3);
+      simd::store(yi + 4 * p, y.i0);
+      simd::store(yi + 4 * p + 4, y.i1);
+      simd::store(yi + 4 * p + 8, y.i2);
+      simd::store(yi + 4 * p + 12, y.i3);
+    }
+    return;
+  }
+
+  // Small transforms
+  for (size_t p = 0; p < m; ++p)
+  {
+    for (size_t q = 0; q < s; ++q)
+    {
+      size_t in = q + s * p;
+      size_t out = q + s * 4 * p;
+      float t0r = xr[in] + xr[in + 2 * s * m], t0i = xi[in] + xi[in + 2 * s * m];
+      float t1r = xr[in] - xr[in + 2 * s * m], t1i = xi[in] - xi[in + 2 * s * m];
+      float t2r = xr[in + s * m] + xr[in + 3 * s * m], t2i = xi[in + s * m] + xi[in + 3 * s * m];
+      float t3r = xi[in + s * m] - xi[in + 3 * s * m], t3i = xr[in + 3 * s * m] - xr[in + s * m];
+
+      float u1r = t1r + t3r, u1i = t1i + t3i;
+      float u2r = t0r - t2r, u2i = t0i - t2i;
+      float u3r = t1r - t3r, u3i = t1i - t3i;
+      yr[out] = t0r + t2r;
+      yi[out] = t0i + t2i;
+      yr[out + s] = u1r * stage.w1r[p] - u1i * stage.w1i[p];
+      yi[out + s] = u1r * stage.w1i[p] + u1i * stage.w1r[p];
+      yr[out + 2 * s] = u2r * stage.w2r[p] - u2i * stage.w2i[p];
+      yi[out + 2 * s] = u2r * stage.w2i[p] + u2i * stage.w2r[p];
+      yr[out + 3 * s] = u3r * stage.w3r[p] - u3i * stage.w3i[p];
+      yi[out + 3 * s] = u3r * stage.w3i[p] + u3i * stage.w3r[p];
+    }
+  }
+}
+
+// Last pass when log4 of the size is fractional: length-2 transforms at stride s
+void run_radix2(size_t s, const float* xr, const float* xi, float* yr, float* yi)
+{
+  size_t q = 0;
+  for (; q + simd::WIDTH <= s; q += simd::WIDTH)
+  {
+    auto ar = simd::load(xr + q), ai = simd::load(xi + q);
+    auto br = simd::load(xr + q + s), bi = simd::load(xi + q + s);
+    simd::store(yr + q, simd::add(ar, br));
+    simd::store(yi + q, simd::add(ai, bi));
+    simd::store(yr + q + s, simd::sub(ar, br));
+    simd::store(yi + q + s, simd::sub(ai, bi));
+  }
+  for (; q < s; ++q)
+  {
+    float ar = xr[q], ai = xi[q];
+    yr[q] = ar + xr[q + s];
+    yi[q] = ai + xi[q + s];
+    yr[q + s] = ar - xr[q + s];
+    yi[q + s] = ai - xi[q + s];
+  }
+}
+
+}  // namespace
+
+struct RealFft::Impl
+{
+  size_t size;
+  size_t half;  // Complex transform length
+  std::vector<Stage> stages;
+  bool final_radix2 = false;
+
+  // Split-step twiddles, e^(-2 pi i k / size)
+  std::vector<float> split_cos;
+  std::vector<float> split_sin;
+
+  // Ping-pong buffers
+  std::vector<float> ar, ai, br, bi;
+
+  Impl(size_t n) : size(n), half(n / 2)
+  {
+    if (n < 32 || !std::has_single_bit(n))
+    {
+      throw std::invalid_argument("RealFft size must be a power of two >= 32");
+    }
+
+    const double pi = std::acos(-1.0);
+    size_t length = half;
+    size_t stride = 1;
+    while (length >= 4)
+    {
+      Stage stage{length, stride, {}, {}, {}, {}, {}, {}};
+      for (size_t p = 0; p < length / 4; ++p)
+      {
+        for (int k = 1; k <= 3; ++k)
+        {
+          double angle = -2.0 * pi * static_cast<double>(k * p) / static_cast<double>(length);
+          auto& wr = k == 1 ? stage.w1r : k == 2 ? stage.w2r : stage.w3r;
+          auto& wi = k == 1 ? stage.w1i : k == 2 ? stage.w2i : stage.w3i;
+          wr.push_back(static_cast<float>(std::cos(angle)));
+          wi.push_back(static_cast<float>(std::sin(angle)));
+        }
+      }
+      stages.push_back(std::move(stage));
+      length /= 4;
+      stride *= 4;
+    }
+    final_radix2 = length == 2;
+
+    for (size_t k = 0; k <= half; ++k)
+    {
+      double angle = -2.0 * pi * static_cast<double>(k) / static_cast<double>(size);
+      split_cos.push_back(static_cast<float>(std::cos(angle)));
+      split_sin.push_back(static_cast<float>(std::sin(angle)));
+    }
+
+    ar.resize(half);
+    ai.resize(half);
+    br.resize(half);
+    bi.resize(half);
+  }
+
+  // Forward complex FFT of (ar, ai); returns the buffers holding the result
+  std::pair<float*, float*> complex_fft()
+  {
+    float* xr = ar.data();
+    float* xi = ai.data();
+    float* yr = br.data();
+    float* yi = bi.data();
+    for (const auto& stage : stages)
+    {
+      run_stage(stage, xr, xi, yr, yi);
+      std::swap(xr, yr);
+      std::swap(xi, yi);
+    }
+    if (final_radix2)
+    {
+      run_radix2(half / 2, xr, xi, yr, yi);
+      std::swap(xr, yr);
+      std::swap(xi, yi);
+    }
+    return {xr, xi};
+  }
+};
+
+RealFft::RealFft(size_t size) : impl_(std::make_unique<Impl>(size)) {}
+
+RealFft::~RealFft() = default;
+
+size_t RealFft::size() const
+{
+  return impl_->size;
+}
+
+size_t RealFft::bins() const
+{
+  return impl_->half + 1;
+}
+
+void RealFft::forward(std::span<const float> input, std::span<float> re, std::span<float> im)
+{
+  auto& d = *impl_;
+  size_t half = d.half;
+
+  // Even samples as real part, odd as imaginary
+  for (size_t n = 0; n < half; ++n)
+  {
+    d.ar[n] = input[2 * n];
+    d.ai[n] = input[2 * n + 1];
+  }
+  auto [zr, zi] = d.complex_fft();
+
+  // X[k] = (Z[k] + conj Z[M-k]) / 2 - i W^k (Z[k] - conj Z[M-k]) / 2
+  re[0] = zr[0] + zi[0];
+  im[0] = 0.0f;
+  re[half] = zr[0] - zi[0];
+  im[half] = 0.0f;
+  for (size_t k = 1; k < half; ++k)
+  {
+    float er = 0.5f * (zr[k] + zr[half - k]);
+    float ei = 0.5f * (zi[k] - zi[half - k]);
+    float or_ = 0.5f * (zi[k] + zi[half - k]);
+    float oi = -0.5f * (zr[k] - zr[half - k]);
+    re[k] = er + or_ * d.split_cos[k] - oi * d.split_sin[k];
+    im[k] = ei + or_ * d.split_sin[k] + oi * d.split_cos[k];
+  }
+}
+
+void RealFft::inverse(std::span<const float> re, std::span<const float> im, std::span<float> output)
+{
+  auto& d = *impl_;
+  size_t half = d.half;
+
+  // Z[k] = E[k] + i O[k], conjugated so the forward transform runs it backwards
+  for (size_t k = 0; k < half; ++k)
+  {
+    float er = 0.5f * (re[k] + re[half - k]);
+    float ei = 0.5f * (im[k] - im[half - k]);
+    float dr = 0.5f * (re[k] - re[half - k]);
+    float di = 0.5f * (im[k] + im[half - k]);
+    // O = D W^-k
+    float or_ = dr * d.split_cos[k] + di * d.split_sin[k];
+    float oi = di * d.split_cos[k] - dr * d.split_sin[k];
+    d.ar[k] = er - oi;
+    d.ai[k] = -(ei + or_);
+  }
+  auto [zr, zi] = d.complex_fft();
+
+  float scale = 1.0f / static_cast<float>(half);
+  for (size_t n = 0; n < half; ++n)
+  {
+    output[2 * n] = zr[n] * scale;
+    output[2 * n + 1] = -zi[n] * scale;
+  }
+}
+
+}  // namespace audio
+}  // namespace rtc
@@ -0,0 +1,438 @@
+/**
+ * @file file_audio_device.cpp
+ * @brief WAV and raw PCM file capture and playback backends
+ *
+ * Capture reads one frame duration per block; playback writes one period at
+ * a time. Real-time mode sleeps to steady-clock deadlines derived from the
+ * sample count, so pacing does not drift with scheduling; otherwise blocks
+ * go back to back as fast as the consumer (or renderer) keeps up. Samples
+ * are 16-bit little-endian, the host order on every target we build for;
+ * WAV headers are parsed and written byte by byte.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "audio_device.h"
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+constexpr size_t WAV_HEADER_BYTES = 44;
+constexpr int FILE_PERIOD_MS = 10;
+
+uint16_t read_le16(const uint8_t* p)
+{
+  return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t read_le32(const uint8_t* p)
+{
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+         (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void write_le16(uint8_t* p, uint16_t value)
+{
+  p[0] = static_cast<uint8_t>(value);
+  p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void write_le32(uint8_t* p, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i)
+  {
+    p[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+struct WavFormat
+{
+  int sample_rate = 0;
+  int channels = 0;
+  long data_begin = 0;
+  long data_end = -1;  // -1: to the end of the file
+};
+
+// Finds the format and data chunks of a 16-bit PCM WAV file; leaves the
+// file positioned at the first sample
+bool read_wav_header(std::FILE* file, WavFormat& format)
+{
+  uint8_t riff[12];
+  if (std::fread(riff, 1, sizeof(riff), file) != sizeof(riff) ||
+      std::memcmp(riff, "RIFF", 4) != 0 || std::memcmp(riff + 8, "WAVE", 4) != 0)
+  {
+    return false;
+  }
+
+  bool have_format = false;
+  uint8_t chunk[8];
+  while (std::fread(chunk, 1, sizeof(chunk), file) == sizeof(chunk))
+  {
+    uint32_t size = read_le32(chunk + 4);
+    long skip = static_cast<long>(size) + static_cast<long>(size & 1);  // Chunks are word aligned
+    if (std::memcmp(chunk, "fmt ", 4) == 0)
+    {
+      uint8_t fmt[16];
+      if (size < sizeof(fmt) || std::fread(fmt, 1, sizeof(fmt), file) != sizeof(fmt))
+      {
+        return false;
+      }
+      // PCM or WAVE_FORMAT_EXTENSIBLE, 16 bits per sample
+      uint16_t tag = read_le16(fmt);
+      if ((tag != 1 && tag != 0xFFFE) || read_le16(fmt + 14) != 16)
+      {
+        return false;
+      }
+      format.channels = read_le16(fmt + 2);
+      format.sample_rate = static_cast<int>(read_le32(fmt + 4));
+      have_format = true;
+      skip -= static_cast<long>(sizeof(fmt));
+    }
+    else if (std::memcmp(chunk, "data", 4) == 0)
+    {
+      format.data_begin = std::ftell(file);
+      // Streaming writers leave the size at 0 or ~0 until they finish
+      format.data_end =
+          size == 0 || size == 0xFFFFFFFF ? -1 : format.data_begin + static_cast<long>(size);
+      return have_format;
+    }
+    if (std::fseek(file, skip, SEEK_CUR) != 0)
+    {
+      return false;
+    }
+  }
+  return false;
+}
+
+void write_wav_header(std::FILE* file, int sample_rate, int channels, uint64_t data_bytes)
+{
+  auto size = static_cast<uint32_t>(
+      std::min<uint64_t>(data_bytes, std::numeric_limits<uint32_t>::max() - WAV_HEADER_BYTES));
+  auto block_align = static_cast<uint16_t>(channels * 2);
+
+  uint8_t header[WAV_HEADER_BYTES];
+  std::memcpy(header, "RIFF", 4);
+  write_le32(header + 4, static_cast<uint32_t>(WAV_HEADER_BYTES - 8) + size);
+  std::memcpy(header + 8, "WAVEfmt ", 8);
+  write_le32(header + 16, 16);
+  write_le16(header + 20, 1);  // PCM
+  write_le16(header + 22, static_cast<uint16_t>(channels));
+  write_le32(header + 24, static_cast<uint32_t>(sample_rate));
+  write_le32(header + 28, static_cast<uint32_t>(sample_rate) * block_align);
+  write_le16(header + 32, block_align);
+  write_le16(header + 34, 16);
+  std::memcpy(header + 36, "data", 4);
+  write_le32(header + 40, size);
+
+  std::fseek(file, 0, SEEK_SET);
+  std::fwrite(header, 1, sizeof(header), file);
+  std::fseek(file, 0, SEEK_END);
+}
+
+std::chrono::steady_clock::time_point deadline(std::chrono::steady_clock::time_point start,
+                                               uint64_t frames, int sample_rate)
+{
+  return start + std::chrono::microseconds(static_cast<int64_t>(
+                     frames * 1000000 / static_cast<uint64_t>(sample_rate)));
+}
+
+class FileCapture final : public CaptureBackend
+{
+ public:
+  FileCapture(std::FILE* file, const WavFormat& format, const AudioCaptureConfig& config)
+      : file_(file),
+        format_(format),
+        channels_(static_cast<size_t>(format.channels)),
+        block_frames_(static_cast<size_t>(
+            std::max(1, format.sample_rate * config.frame_duration_ms / 1000))),
+        realtime_(config.realtime),
+        loop_(config.loop),
+        position_(format.data_begin)
+  {
+  }
+
+  ~FileCapture() override
+  {
+    stop();
+    std::fclose(file_);
+  }
+
+  bool start(AudioCaptureCallback sink) override
+  {
+    stop();
+    sink_ = std::move(sink);
+    running_.store(true);
+    thread_ = std::thread([this]() { run(); });
+    return true;
+  }
+
+  void stop() override
+  {
+    running_.store(false);
+    if (thread_.joinable())
+    {
+      thread_.join();
+    }
+  }
+
+  bool running() const override
+  {
+    return running_.load();
+  }
+
+  int sample_rate() const override
+  {
+    return format_.sample_rate;
+  }
+
+ private:
+  // Whole frames up to the end of the data chunk
+  size_t read_some(int16_t* out, size_t frames)
+  {
+    size_t frame_bytes = channels_ * sizeof(int16_t);
+    if (format_.data_end >= 0)
+    {
+      frames = std::min(frames, static_cast<size_t>(format_.data_end - position_) / frame_bytes);
+    }
+    size_t got = frames > 0 ? std::fread(out, frame_bytes, frames, file_) : 0;
+    position_ += static_cast<long>(got * frame_bytes);
+    return got;
+  }
+
+  // Fills the block, rewinding when looping; fewer frames only at the end
+  size_t read(std::vector<int16_t>& block)
+  {
+    size_t frames = block.size() / channels_;
+    size_t filled = 0;
+    bool rewound = false;
+    while (filled < frames)
+    {
+      size_t got = read_some(block.data() + filled * channels_, frames - filled);
+      filled += got;
+      if (got > 0)
+      {
+        rewound = false;
+        continue;
+      }
+      // A loop over an empty data chunk would never end
+      if (!loop_ || std::exchange(rewound, true))
+      {
+        break;
+      }
+      std::fseek(file_, format_.data_begin, SEEK_SET);
+      position_ = format_.data_begin;
+    }
+    return filled;
+  }
+
+  void run()
+  {
+    std::vector<int16_t> block(block_frames_ * channels_);
+    auto start = std::chrono::steady_clock::now();
+    auto origin_us =
+        std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()).count();
+    uint64_t delivered = 0;
+
+    while (running_.load())
+    {
+      size_t frames = read(block);
+      if (frames == 0)
+      {
+        break;
+      }
+      if (realtime_)
+      {
+        // A block is ready once its last sample would have been captured
+        std::this_thread::sleep_until(deadline(start, delivered + frames, format_.sample_rate));
+      }
+      sink_(std::span<const int16_t>(block.data(), frames * channels_),
+            origin_us + static_cast<int64_t>(delivered * 1000000 /
+                                             static_cast<uint64_t>(format_.sample_rate)));
+      delivered += frames;
+    }
+    running_.store(false);
+  }
+
+  std::FILE* file_;
+  WavFormat format_;
+  size_t channels_;
+  size_t block_frames_;
+  bool realtime_;
+  bool loop_;
+  long position_;
+
+  AudioCaptureCallback sink_;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+class FilePlayback final : public PlaybackBackend
+{
+ public:
+  FilePlayback(std::FILE* file, bool wav, const AudioPlaybackConfig& config)
+      : file_(file),
+        wav_(wav),
+        sample_rate_(config.sample_rate),
+        channels_(config.channels),
+        period_frames_(static_cast<size_t>(config.period_frames > 0
+                                               ? config.period_frames
+                                               : config.sample_rate * FILE_PERIOD_MS / 1000)),
+        realtime_(config.realtime)
+  {
+    if (wav_)
+    {
+      write_wav_header(file_, sample_rate_, channels_, 0);
+    }
+  }
+
+  ~FilePlayback() override
+  {
+    stop();
+    std::fclose(file_);
+  }
+
+  bool start(AudioRenderCallback render) override
+  {
+    stop();
+    if (render)
+    {
+      render_ = std::move(render);
+      running_.store(true);
+      thread_ = std::thread([this]() { run(); });
+    }
+    return true;
+  }
+
+  void stop() override
+  {
+    running_.store(false);
+    if (thread_.joinable())
+    {
+      thread_.join();
+    }
+    // Leave a valid file behind at every stop
+    if (wav_)
+    {
+      write_wav_header(file_, sample_rate_, channels_, data_bytes_);
+    }
+    std::fflush(file_);
+  }
+
+  size_t write(std::span<const int16_t> samples) override
+  {
+    // The render thread owns the file in pull mode
+    return running_.load() ? 0 : append(samples);
+  }
+
+  size_t available_space() const override
+  {
+    return std::numeric_limits<size_t>::max();  // Files never fill up
+  }
+
+ private:
+  size_t append(std::span<const int16_t> samples)
+  {
+    size_t written = std::fwrite(samples.data(), sizeof(int16_t), samples.size(), file_);
+    data_bytes_ += written * sizeof(int16_t);
+    return written;
+  }
+
+  void run()
+  {
+    std::vector<int16_t> period(period_frames_ * static_cast<size_t>(channels_));
+    auto start = std::chrono::steady_clock::now();
+    uint64_t rendered = 0;
+
+    while (running_.load())
+    {
+      if (realtime_)
+      {
+        // The device asks for a period as the previous one starts playing
+        std::this_thread::sleep_until(deadline(start, rendered, sample_rate_));
+      }
+      render_(period);
+      append(period);
+      rendered += period_frames_;
+    }
+  }
+
+  std::FILE* file_;
+  bool wav_;
+  int sample_rate_;
+  int channels_;
+  size_t period_frames_;
+  bool realtime_;
+  uint64_t data_bytes_ = 0;
+
+  AudioRenderCallback render_;
+  std::atomic<bool> running_{false};
+  std::thread thread_;
+};
+
+}  // namespace
+
+std::unique_ptr<CaptureBackend> open_file_capture(const AudioCaptureConfig& config)
+{
+  std::FILE* file = std::fopen(config.file_path.c_str(), "rb");
+  if (!file)
+  {
+    return nullptr;
+  }
+
+  // WAV when the header says so, raw PCM in the configured format otherwise
+  WavFormat format;
+  char magic[4] = {};
+  bool is_wav = std::fread(magic, 1, sizeof(magic), file) == sizeof(magic) &&
+                std::memcmp(magic, "RIFF", 4) == 0;
+  std::rewind(file);
+  if (is_wav && !read_wav_header(file, format))
+  {
+    std::fclose(file);
+    return nullptr;
+  }
+  if (!is_wav)
+  {
+    format.sample_rate = config.device_rate > 0 ? config.device_rate : config.sample_rate;
+    format.channels = config.channels;
+  }
+
+  if (format.sample_rate <= 0 || format.channels != config.channels)
+  {
+    std::fclose(file);
+    return nullptr;
+  }
+  return std::make_unique<FileCapture>(file, format, config);
+}
+
+std::unique_ptr<PlaybackBackend> open_file_playback(const AudioPlaybackConfig& config)
+{
+  if (config.sample_rate <= 0 || config.channels <= 0)
+  {
+    return nullptr;
+  }
+  std::FILE* file = std::fopen(config.file_path.c_str(), "wb");
+  if (!file)
+  {
+    return nullptr;
+  }
+  const std::string& path = config.file_path;
+  bool wav = path.ends_with(".wav") || path.ends_with(".WAV");
+  return std::make_unique<FilePlayback>(file, wav, config);
+}
+
+}  // namespace audio
+}  // namespace rtc
@@ -0,0 +1,419 @@
+/**
+ * @file gain_controller.cpp
+ * @brief Speech-gated digital AGC with a look-ahead peak limiter
+ *
+ * Audio is handled in float, 1 ms sub-blocks at a time. Every 10 ms an
+ * energy VAD decides whether the block is speech; only speech moves the
+ * peak level estimate, and the gain needed to bring that level to the
+ * target (capped at compression_gain_db) is approached with a fast attack
+ * and a slow, rate-limited release. The limiter sees 5 ms ahead, so it can
+ * ramp its gain down before a peak arrives instead of clipping it.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <vector>
+
+#include "rtc/audio/audio_processing.h"
+#include "simd.h"
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+constexpr int SUB_BLOCKS_PER_ANALYSIS = 10;  // 10 ms analysis blocks of 1 ms sub-blocks
+
+// Energy VAD over a tracked noise floor
+constexpr float VAD_MARGIN_DB = 10.0f;
+constexpr float VAD_MIN_LEVEL_DBFS = -60.0f;
+constexpr int VAD_HANGOVER_BLOCKS = 20;
+constexpr float NOISE_FLOOR_RISE_DB = 0.02f;  // Per analysis block: 2 dB/s
+
+// Speech peak level: rises fast, decays over about a second
+constexpr float LEVEL_ATTACK = 0.5f;
+constexpr float LEVEL_DECAY = 0.01f;
+
+// Gain smoothing per sub-block
+constexpr float GAIN_ATTACK = 0.05f;            // ~20 ms time constant
+constexpr float GAIN_RELEASE_DB_PER_MS = 0.006f;  // 6 dB/s
+
+constexpr int LIMITER_LOOKAHEAD_MS = 5;
+constexpr float LIMITER_CEILING = 0.891f;  // -1 dBFS
+constexpr float LIMITER_RELEASE = 0.983f;  // Per sub-block: ~60 ms time constant
+
+float to_db(float value)
+{
+  return 20.0f * std::log10(value + 1e-9f);
+}
+
+float from_db(float db)
+{
+  return std::pow(10.0f, db / 20.0f);
+}
+
+// Largest magnitude in x
+float peak(const float* x, size_t n)
+{
+  auto sign = simd::set1(-0.0f);
+  auto best = simd::set1(0.0f);
+  size_t i = 0;
+  for (; i + simd::WIDTH <= n; i += simd::WIDTH)
+  {
+    auto v = simd::load(x + i);
+    best = simd::max(best, simd::max(v, simd::sub(sign, v)));
+  }
+  float result = 0.0f;
+  float lanes[simd::WIDTH];
+  simd::store(lanes, best);
+  for (float lane : lanes)
+  {
+    result = std::max(result, lane);
+  }
+  for (; i < n; ++i)
+  {
+    result = std::max(result, std::abs(x[i]));
+  }
+  return result;
+}
+
+float sum_squares(const float* x, size_t n)
+{
+  auto acc = simd::set1(0.0f);
+  size_t i = 0;
+  for (; i + simd::WIDTH <= n; i += simd::WIDTH)
+  {
+    auto v = simd::load(x + i);
+    acc = simd::mul_add(v, v, acc);
+  }
+  float result = simd::sum(acc);
+  for (; i < n; ++i)
+  {
+    result += x[i] * x[i];
+  }
+  return result;
+}
+
+// x *= a gain ramping linearly from start to end over the frames, each frame
+// holding `channels` interleaved samples
+void apply_ramp(float* x, size_t frames, size_t channels, float start, float end,
+                std::vector<float>& ramp)
+{
+  float step = (end - start) / static_cast<float>(frames);
+  for (size_t i = 0; i < frames; ++i)
+  {
+    float g = start + step * static_cast<float>(i + 1);
+    for (size_t c = 0; c < channels; ++c)
+    {
+      ramp[i * channels + c] = g;
+    }
+  }
+
+  size_t n = frames * channels;
+  size_t i = 0;
+  for (; i + simd::WIDTH <= n; i += simd::WIDTH)
+  {
+    simd::store(x + i, simd::mul(simd::load(x + i), simd::load(ramp.data() + i)));
+  }
+  for (; i < n; ++i)
+  {
+    x[i] *= ramp[i];
+  }
+}
+
+}  // namespace
+
+struct GainController::Impl
+{
+  AgcConfig config;
+  bool initialized = false;
+  float current_gain = 0.0f;  // dB
+  bool speech_detected = false;
+  std::mutex mutex;
+
+  size_t channels = 1;
+  size_t sub_frames = 0;  // Frames per 1 ms sub-block
+  size_t sub_samples = 0;
+
+  std::vector<float> input_pending;  // Interleaved, like the sub-blocks
+  std::vector<float> output;
+  bool output_primed = false;
+  std::vector<float> ramp;
+  AudioBuffer scratch;  // Planes for int16 callers
+
+  // Analysis over SUB_BLOCKS_PER_ANALYSIS sub-blocks
+  int analysis_blocks = 0;
+  float analysis_energy = 0.0f;
+  float analysis_peak = 0.0f;
+  float noise_floor_db = -70.0f;
+  int hangover = 0;
+  float level_db = -30.0f;
+  bool level_valid = false;
+  float target_gain_db = 0.0f;
+  float applied_gain = 1.0f;  // Linear gain at the end of the last sub-block
+
+  // Limiter: ring of lookahead + 1 sub-blocks and their peaks after the AGC gain
+  size_t lookahead = 0;
+  std::vector<float> delay_line;
+  std::vector<float> delay_peaks;
+  size_t newest = 0;
+  float limiter_gain = 1.0f;
+
+  Impl(AgcConfig cfg) : config(std::move(cfg)) {}
+
+  void setup()
+  {
+    channels = static_cast<size_t>(config.channels);
+    sub_frames = static_cast<size_t>(std::max(1, config.sample_rate / 1000));
+    sub_samples = sub_frames * channels;
+
+    input_pending.clear();
+    input_pending.reserve(sub_samples * 64);
+    output.clear();
+    output.reserve(sub_samples * 64);
+    output_primed = false;
+    ramp.assign(sub_samples, 1.0f);
+    scratch.reset(channels, 20 * sub_frames);
+
+    analysis_blocks = 0;
+    analysis_energy = analysis_peak = 0.0f;
+    noise_floor_db = -70.0f;
+    hangover = 0;
+    level_db = -30.0f;
+    level_valid = false;
+    speech_detected = false;
+    current_gain = config.mode == AgcConfig::Mode::FIXED_DIGITAL
+                       ? static_cast<float>(config.compression_gain_db)
+                       : 0.0f;
+    target_gain_db = current_gain;
+    applied_gain = from_db(current_gain);
+
+    lookahead = config.limiter_enabled ? static_cast<size_t>(LIMITER_LOOKAHEAD_MS) : 0;
+    delay_line.assign((lookahead + 1) * sub_samples, 0.0f);
+    delay_peaks.assign(lookahead + 1, 0.0f);
+    newest = 0;
+    limiter_gain = 1.0f;
+  }
+
+  void apply(AudioBuffer& samples)
+  {
+    size_t frames = samples.frames();
+    size_t count = frames * channels;
+    size_t at = input_pending.size();
+    input_pending.resize(at + count);
+    samples.copy_to(std::span<float>(input_pending).subspan(at));
+
+    // Frames that are not a whole number of sub-blocks need one more queued so
+    // every call finds its output ready
+    if (!output_primed)
+    {
+      if (count % sub_samples != 0)
+      {
+        output.assign(sub_samples, 0.0f);
+      }
+      output_primed = true;
+    }
+
+    size_t consumed = 0;
+    for (; consumed + sub_samples <= input_pending.size(); consumed += sub_samples)
+    {
+      size_t out = output.size();
+      output.resize(out + sub_samples);
+      process_sub_block(input_pending.data() + consumed, output.data() + out);
+    }
+    input_pending.erase(input_pending.begin(),
+                        input_pending.begin() + static_cast<std::ptrdiff_t>(consumed));
+
+    size_t ready = std::min(frames, output.size() / channels);
+    for (size_t c = 0; c < channels; ++c)
+    {
+      auto plane = samples.channel(c);
+      for (size_t i = 0; i < ready; ++i)
+      {
+        plane[i] = output[i * channels + c];
+      }
+      std::fill(plane.begin() + static_cast<std::ptrdiff_t>(ready), plane.end(), 0.0f);
+    }
+    output.erase(output.begin(), output.begin() + static_cast<std::ptrdiff_t>(ready * channels));
+  }
+
+  /**
+   * Energy VAD and speech peak level over one analysis block; returns the
+   * gain in dB that brings the speech level to the target.
+   */
+  float analyze()
+  {
+    float energy_db =
+        10.0f * std::log10(analysis_energy / static_cast<float>(sub_samples *
+                                                                SUB_BLOCKS_PER_ANALYSIS) +
+                           1e-10f);
+    if (energy_db < noise_floor_db)
+    {
+      noise_floor_db += 0.2f * (energy_db - noise_floor_db);
+    }
+    else
+    {
+      noise_floor_db += NOISE_FLOOR_RISE_DB;
+    }
+
+    bool active = energy_db > noise_floor_db + VAD_MARGIN_DB && energy_db > VAD_MIN_LEVEL_DBFS;
+    hangover = active ? VAD_HANGOVER_BLOCKS : std::max(0, hangover - 1);
+    speech_detected = hangover > 0;
+
+    if (active)
+    {
+      float peak_db = to_db(analysis_peak);
+      if (!level_valid)
+      {
+        level_db = peak_db;
+        level_valid = true;
+      }
+      level_db += (peak_db > level_db ? LEVEL_ATTACK : LEVEL_DECAY) * (peak_db - level_db);
+    }
+
+    if (!level_valid)
+    {
+      return 0.0f;
+    }
+    return std::clamp(static_cast<float>(config.target_level_dbfs) - level_db, 0.0f,
+                      static_cast<float>(config.compression_gain_db));
+  }
+
+  void process_sub_block(const float* input, float* out)
+  {
+    // AGC analysis runs on the input, before any gain
+    analysis_energy += sum_squares(input, sub_samples);
+    analysis_peak = std::max(analysis_peak, peak(input, sub_samples));
+    if (++analysis_blocks == SUB_BLOCKS_PER_ANALYSIS)
+    {
+      float desired = analyze();
+      if (config.mode != AgcConfig::Mode::FIXED_DIGITAL)
+      {
+        target_gain_db = desired;
+      }
+      analysis_blocks = 0;
+      analysis_energy = analysis_peak = 0.0f;
+    }
+
+    if (config.mode != AgcConfig::Mode::FIXED_DIGITAL)
+    {
+      if (target_gain_db < current_gain)
+      {
+        current_gain += GAIN_ATTACK * (target_gain_db - current_gain);
+      }
+      else
+      {
+        current_gain = std::min(target_gain_db, current_gain + GAIN_RELEASE_DB_PER_MS);
+      }
+    }
+
+    newest = (newest + 1) % (lookahead + 1);
+    float* block = &delay_line[newest * sub_samples];
+    std::copy(input, input + sub_samples, block);
+    float gain = from_db(current_gain);
+    apply_ramp(block, sub_frames, channels, applied_gain, gain, ramp);
+    applied_gain = gain;
+    delay_peaks[newest] = peak(block, sub_samples);
+
+    // The oldest sub-block leaves now, with the gain its lookahead window allows
+    size_t oldest = (newest + 1) % (lookahead + 1);
+    float* leaving = &delay_line[oldest * sub_samples];
+    if (config.limiter_enabled)
+    {
+      auto required = [&](size_t d)
+      {
+        float p = delay_peaks[(oldest + d) % (lookahead + 1)];
+        return p > LIMITER_CEILING ? LIMITER_CEILING / p : 1.0f;
+      };
+
+      // Release towards unity, but steep enough to be at each coming sub-block's
+      // required gain by the time it starts, and never above this one's
+      float start = std::min(limiter_gain, required(0));
+      float end = 1.0f + (limiter_gain - 1.0f) * LIMITER_RELEASE;
+      for (size_t d = 1; d <= lookahead; ++d)
+      {
+        end = std::min(end, limiter_gain + (required(d) - limiter_gain) / static_cast<float>(d));
+      }
+      end = std::min(end, required(0));
+      apply_ramp(leaving, sub_frames, channels, start, end, ramp);
+      limiter_gain = end;
+    }
+    std::copy(leaving, leaving + sub_samples, out);
+  }
+};
+
+GainController::GainController(AgcConfig config) : impl_(std::make_unique<Impl>(std::move(config)))
+{
+}
+
+GainController::~GainController() = default;
+
+bool GainController::initialize()
+{
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->config.sample_rate < 8000 || impl_->config.channels < 1)
+  {
+    return false;
+  }
+  impl_->setup();
+  impl_->initialized = true;
+  return true;
+}
+
+void GainController::process(std::span<int16_t> samples)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return;
+  }
+  d.scratch.copy_from(samples);
+  d.apply(d.scratch);
+  d.scratch.copy_to(samples);
+}
+
+void GainController::process(AudioBuffer& samples)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return;
+  }
+  d.apply(samples);
+}
+
+void GainController::set_target_level(int level_dbfs)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->config.target_level_dbfs = level_dbfs;
+}
+
+float GainController::get_current_gain() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->current_gain;
+}
+
+bool GainController::is_speech_detected() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->speech_detected;
+}
+
+void GainController::reset()
+{
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->initialized)
+  {
+    impl_->setup();
+  }
+}
+
+}  // namespace audio
+}  // namespace rtc
@@ -6,68 +6,315 @@
 #include "rtc/audio/jitter_buffer.h"
 
 #include <algorithm>
+#include <bit>
+#include <cmath>
 #include <deque>
 #include <mutex>
 
+#include "rtc/flight_recorder.h"
+#include "rtc/metrics_exporter.h"
+
 namespace rtc
 {
 namespace audio
 {
 
+namespace
+{
+
+// Share of a late packet's extra delay the playout clock absorbs (sender clock drift)
+constexpr double DRIFT_GAIN = 1.0 / 512.0;
+
+// Relative delay histogram resolution
+constexpr int BUCKET_MS = 5;
+
+// Delay peaks: a packet this much later than the target, at most this far apart
+constexpr double PEAK_THRESHOLD_MS = 40.0;
+constexpr auto MAX_PEAK_PERIOD = std::chrono::seconds(10);
+constexpr size_t MAX_PEAKS = 8;
+
+struct DelayPeak
+{
+  std::chrono::steady_clock::time_point time;
+  double delay_ms;
+};
+
+}  // namespace
+
 struct JitterBuffer::Impl
 {
+  struct Slot
+  {
+    JitterFrame frame;
+    int64_t sequence = -1;  // Unwrapped; -1 when empty
+    int64_t timestamp = 0;  // Unwrapped RTP timestamp
+  };
+
   JitterBufferConfig config;
-  std::deque<JitterFrame> buffer;
+  std::vector<Slot> slots;  // Ring indexed by unwrapped sequence number
+  size_t mask;
+  size_t count = 0;
   mutable std::mutex mutex;
 
-  // State
-  uint16_t expected_sequence = 0;
+  // Sequence and timestamp tracking
   bool sequence_initialized = false;
-  std::chrono::steady_clock::time_point playout_start;
+  int64_t head = 0;  // Next unwrapped sequence number to play
+  int64_t highest_sequence = 0;
+  int64_t highest_timestamp = 0;
+
+  // Playout clock: RTP timestamps mapped to local time
+  std::chrono::steady_clock::time_point epoch;
+  int64_t epoch_timestamp = 0;
+  double clock_offset_ms = 0.0;  // Local arrival minus media time of an on-time packet
   bool playout_started = false;
 
+  // RFC 3550 interarrival jitter
+  double jitter = 0.0;  // RTP units
+  int64_t last_transit = 0;
+
+  // Target delay: forgetting histogram of relative delay, plus periodic peaks
+  std::vector<double> delay_histogram_buckets;
+  uint64_t delay_samples = 0;
+  std::deque<DelayPeak> peaks;
+
   // Stats
   JitterBufferStats stats;
-  float jitter_estimate = 0.0f;
-  int64_t last_arrival_delta = 0;
+  MetricHistogram delay_histogram;
 
-  Impl(JitterBufferConfig cfg) : config(std::move(cfg))
+  Impl(JitterBufferConfig cfg)
+      : config(std::move(cfg)),
+        slots(std::bit_ceil(std::max<size_t>(config.max_packets, 1))),
+        mask(slots.size() - 1),
+        delay_histogram_buckets(static_cast<size_t>(config.max_delay.count() / BUCKET_MS + 1))
   {
     stats.target_delay = config.target_delay;
+    reset_histogram();
   }
 
-  void update_jitter(std::chrono::steady_clock::time_point arrival_time, uint32_t /*timestamp*/)
+  // Start with all the mass at the configured target delay
+  void reset_histogram()
   {
-    // Simplified jitter estimation
-    auto now = arrival_time;
-    if (playout_started)
-    {
-      auto delta =
-          std::chrono::duration_cast<std::chrono::milliseconds>(now - playout_start).count();
-      auto diff = std::abs(delta - last_arrival_delta);
-      jitter_estimate += (diff - jitter_estimate) / 16.0f;
-      last_arrival_delta = delta;
-    }
-    else
+    std::fill(delay_histogram_buckets.begin(), delay_histogram_buckets.end(), 0.0);
+    auto bucket = std::clamp<int64_t>(config.target_delay.count() / BUCKET_MS - 1, 0,
+                                      static_cast<int64_t>(delay_histogram_buckets.size() - 1));
+    delay_histogram_buckets[static_cast<size_t>(bucket)] = 1.0;
+    delay_samples = 0;
+    peaks.clear();
+  }
+
+  Slot& slot(int64_t sequence)
+  {
+    return slots[static_cast<size_t>(sequence) & mask];
+  }
+
+  int64_t unwrap_sequence(uint16_t sequence) const
+  {
+    return highest_sequence +
+           static_cast<int16_t>(sequence - static_cast<uint16_t>(highest_sequence));
+  }
+
+  int64_t unwrap_timestamp(uint32_t timestamp) const
+  {
+    return highest_timestamp +
+           static_cast<int32_t>(timestamp - static_cast<uint32_t>(highest_timestamp));
+  }
+
+  double media_ms(int64_t timestamp) const
+  {
+    return static_cast<double>(timestamp - epoch_timestamp) * 1000.0 / config.sample_rate;
+  }
+
+  double local_ms(std::chrono::steady_clock::time_point time) const
+  {
+    return std::chrono::duration<double, std::milli>(time - epoch).count();
+  }
+
+  void update_clock(std::chrono::steady_clock::time_point arrival_time, int64_t timestamp)
+  {
+    if (!playout_started)
     {
-      playout_start = now;
+      epoch = arrival_time;
+      epoch_timestamp = timestamp;
+      clock_offset_ms = 0.0;
+      last_transit = 0;
       playout_started = true;
+      return;
     }
-    stats.jitter_ms = jitter_estimate;
+
+    // An early packet moves the clock at once; lateness only slowly, as it is mostly jitter
+    double lateness = local_ms(arrival_time) - media_ms(timestamp) - clock_offset_ms;
+    clock_offset_ms += lateness < 0.0 ? lateness : lateness * DRIFT_GAIN;
+    adapt_delay(std::max(0.0, lateness), arrival_time);
+
+    // J += (|D| - J) / 16 with D the change in transit time, in RTP units
+    auto transit = static_cast<int64_t>(local_ms(arrival_time) * config.sample_rate / 1000.0) -
+                   (timestamp - epoch_timestamp);
+    double d = std::abs(static_cast<double>(transit - last_transit));
+    last_transit = transit;
+    jitter += (d - jitter) / 16.0;
+
+    stats.jitter_rtp = static_cast<uint32_t>(jitter);
+    stats.jitter_ms = static_cast<float>(jitter * 1000.0 / config.sample_rate);
   }
 
-  void adapt_delay()
+  std::chrono::steady_clock::time_point playout_time(int64_t timestamp) const
+  {
+    auto at = std::chrono::duration<double, std::milli>(media_ms(timestamp) + clock_offset_ms);
+    return epoch + std::chrono::duration_cast<std::chrono::steady_clock::duration>(at) +
+           stats.target_delay;
+  }
+
+  /**
+   * Target the configured quantile of relative delay (how much later than the
+   * earliest packets this one arrived). The histogram forgets old packets
+   * geometrically; periodic peaks, such as Wi-Fi scans or bursty cellular
+   * scheduling, hold the target at the peak height while they recur.
+   */
+  void adapt_delay(double relative_delay_ms, std::chrono::steady_clock::time_point now)
   {
     if (!config.enable_adaptive)
     {
       return;
     }
 
-    // Adjust target delay based on jitter
-    auto new_delay = std::chrono::milliseconds(static_cast<int>(jitter_estimate * 2 + 10));
+    auto bucket = std::min(static_cast<size_t>(relative_delay_ms / BUCKET_MS),
+                           delay_histogram_buckets.size() - 1);
+    // A running average until there is a full memory's worth of packets
+    delay_samples++;
+    double forget = std::min(static_cast<double>(config.delay_forget_factor),
+                             1.0 - 1.0 / static_cast<double>(delay_samples + 1));
+    for (auto& probability : delay_histogram_buckets)
+    {
+      probability *= forget;
+    }
+    delay_histogram_buckets[bucket] += 1.0 - forget;
+
+    // The buckets always sum to one
+    double cumulative = 0.0;
+    size_t quantile_bucket = delay_histogram_buckets.size() - 1;
+    for (size_t i = 0; i < delay_histogram_buckets.size(); ++i)
+    {
+      cumulative += delay_histogram_buckets[i];
+      if (cumulative >= config.delay_quantile)
+      {
+        quantile_bucket = i;
+        break;
+      }
+    }
+    double target_ms = static_cast<double>((quantile_bucket + 1) * BUCKET_MS);
+
+    // Peak detection
+    while (!peaks.empty() && now - peaks.front().time > MAX_PEAK_PERIOD)
+    {
+      peaks.pop_front();
+    }
+    if (relative_delay_ms > std::max(2.0 * target_ms, target_ms + PEAK_THRESHOLD_MS))
+    {
+      if (peaks.size() == MAX_PEAKS)
+      {
+        peaks.pop_front();
+      }
+      peaks.push_back({now, relative_delay_ms});
+    }
+    if (peaks.size() >= 2)
+    {
+      // Still periodic while the last peak is no older than twice the longest gap between peaks
+      std::chrono::steady_clock::duration longest_gap{0};
+      double highest = 0.0;
+      for (size_t i = 0; i < peaks.size(); ++i)
+      {
+        highest = std::max(highest, peaks[i].delay_ms);
+        if (i > 0)
+        {
+          longest_gap = std::max(longest_gap, peaks[i].time - peaks[i - 1].time);
+        }
+      }
+      if (now - peaks.back().time <= 2 * longest_gap)
+      {
+        target_ms = std::max(target_ms, highest);
+      }
+    }
+
+    auto new_delay = std::chrono::milliseconds(static_cast<int>(std::ceil(target_ms)));
+    stats.target_delay = std::clamp(new_delay, config.min_delay, config.max_delay);
+  }
+
+  // First occupied slot at or after head; count must be non-zero
+  Slot& front()
+  {
+    int64_t sequence = head;
+    while (slot(sequence).sequence != sequence)
+    {
+      sequence++;
+    }
+    return slot(sequence);
+  }
+
+  void count_lost(int64_t lost)
+  {
+    if (lost <= 0)
+    {
+      return;
+    }
+    stats.packets_lost += static_cast<uint64_t>(lost);
+    FlightRecorder::record(FlightEventType::PACKET_DROP, FlightSource::JITTER_BUFFER, config.ssrc,
+                           static_cast<uint64_t>(FlightDropReason::LOST),
+                           static_cast<uint64_t>(lost));
+  }
+
+  // Slide the window so `sequence` fits, dropping the oldest packets
+  void make_room(int64_t sequence)
+  {
+    auto capacity = static_cast<int64_t>(slots.size());
+    int64_t overflow = sequence - (head + capacity) + 1;
+    if (overflow <= 0)
+    {
+      return;
+    }
 
-    new_delay = std::clamp(new_delay, config.min_delay, config.max_delay);
-    stats.target_delay = new_delay;
+    FlightRecorder::record(FlightEventType::QUEUE_OVERFLOW, FlightSource::JITTER_BUFFER,
+                           config.ssrc, count, config.max_packets);
+    int64_t lost = std::max<int64_t>(0, overflow - capacity);
+    for (int64_t i = 0; i < std::min(overflow, capacity); ++i)
+    {
+      Slot& s = slot(head + i);
+      if (s.sequence == head + i)
+      {
+        s.sequence = -1;
+        count--;
+        stats.packets_late++;
+      }
+      else
+      {
+        lost++;
+      }
+    }
+    count_lost(lost);
+    head += overflow;
+  }
+
+  JitterFrame pop_front(std::chrono::steady_clock::time_point now)
+  {
+    Slot& s = front();
+    count_lost(s.sequence - head);
+    head = s.sequence + 1;
+    s.sequence = -1;
+    count--;
+    auto frame = std::move(s.frame);
+
+    std::chrono::duration<double, std::milli> buffered = now - frame.arrival_time;
+    delay_histogram.observe(buffered.count());
+    stats.current_delay = std::chrono::duration_cast<std::chrono::milliseconds>(buffered);
+    stats.current_size = count;
+
+    // Update packet loss rate
+    if (stats.packets_received > 0)
+    {
+      stats.packet_loss_rate = static_cast<float>(stats.packets_lost) /
+                               static_cast<float>(stats.packets_received + stats.packets_lost);
+    }
+
+    return frame;
   }
 };
 
@@ -82,48 +329,53 @@ bool JitterBuffer::push(JitterFrame frame)
 {
   std::lock_guard lock(impl_->mutex);
 
-  // Check max size
-  if (impl_->buffer.size() >= impl_->config.max_packets)
-  {
-    // Drop oldest packet
-    impl_->buffer.pop_front();
-    impl_->stats.packets_late++;
-  }
-
   // Initialize sequence tracking
   if (!impl_->sequence_initialized)
   {
-    impl_->expected_sequence = frame.sequence_number;
+    impl_->head = frame.sequence_number;
+    impl_->highest_sequence = frame.sequence_number;
+    impl_->highest_timestamp = frame.timestamp;
     impl_->sequence_initialized = true;
   }
 
+  int64_t sequence = impl_->unwrap_sequence(frame.sequence_number);
+  int64_t timestamp = impl_->unwrap_timestamp(frame.timestamp);
+
+  // Already played out or skipped as lost
+  if (sequence < impl_->head)
+  {
+    impl_->stats.packets_late++;
+    return false;
+  }
+
   // Check for duplicates
-  for (const auto& f : impl_->buffer)
+  if (impl_->slot(sequence).sequence == sequence)
   {
-    if (f.sequence_number == frame.sequence_number)
-    {
-      impl_->stats.packets_duplicated++;
-      return false;
-    }
+    impl_->stats.packets_duplicated++;
+    FlightRecorder::record(FlightEventType::PACKET_DROP, FlightSource::JITTER_BUFFER,
+                           impl_->config.ssrc,
+                           static_cast<uint64_t>(FlightDropReason::DUPLICATE),
+                           frame.sequence_number);
+    return false;
   }
 
-  // Update jitter estimate
-  impl_->update_jitter(frame.arrival_time, frame.timestamp);
-  impl_->adapt_delay();
+  impl_->make_room(sequence);
+  if (sequence > impl_->highest_sequence)
+  {
+    impl_->highest_sequence = sequence;
+    impl_->highest_timestamp = timestamp;
+  }
 
-  // Insert in order
-  auto it = std::find_if(impl_->buffer.begin(), impl_->buffer.end(),
-                         [&](const JitterFrame& f)
-                         {
-                           // Handle sequence number wrap-around
-                           int16_t diff =
-                               static_cast<int16_t>(frame.sequence_number - f.sequence_number);
-                           return diff < 0;
-                         });
+  // Update jitter and target delay
+  impl_->update_clock(frame.arrival_time, timestamp);
 
-  impl_->buffer.insert(it, std::move(frame));
+  auto& slot = impl_->slot(sequence);
+  slot.frame = std::move(frame);
+  slot.sequence = sequence;
+  slot.timestamp = timestamp;
+  impl_->count++;
   impl_->stats.packets_received++;
-  impl_->stats.current_size = impl_->buffer.size();
+  impl_->stats.current_size = impl_->count;
 
   return true;
 }
@@ -132,86 +384,79 @@ std::optional<JitterFrame> JitterBuffer::pop()
 {
   std::lock_guard lock(impl_->mutex);
 
-  if (impl_->buffer.empty())
+  if (impl_->count == 0)
   {
     return std::nullopt;
   }
 
   // Check if we should wait more (buffering delay)
-  if (!impl_->playout_started)
+  auto now = std::chrono::steady_clock::now();
+  if (now < impl_->playout_time(impl_->front().timestamp))
   {
     return std::nullopt;
   }
 
-  auto now = std::chrono::steady_clock::now();
-  auto front_age = std::chrono::duration_cast<std::chrono::milliseconds>(
-      now - impl_->buffer.front().arrival_time);
+  return impl_->pop_front(now);
+}
+
+std::optional<JitterFrame> JitterBuffer::pop_next()
+{
+  std::lock_guard lock(impl_->mutex);
 
-  if (front_age < impl_->stats.target_delay)
+  if (impl_->count == 0)
   {
     return std::nullopt;
   }
 
-  // Get next frame
-  auto frame = std::move(impl_->buffer.front());
-  impl_->buffer.pop_front();
-
-  // Check for packet loss
-  if (frame.sequence_number != impl_->expected_sequence)
-  {
-    int16_t diff = static_cast<int16_t>(frame.sequence_number - impl_->expected_sequence);
-    if (diff > 0)
-    {
-      impl_->stats.packets_lost += diff;
-    }
-  }
+  return impl_->pop_front(std::chrono::steady_clock::now());
+}
 
-  impl_->expected_sequence = frame.sequence_number + 1;
-  impl_->stats.current_size = impl_->buffer.size();
+std::optional<JitterFrame> JitterBuffer::peek() const
+{
+  std::lock_guard lock(impl_->mutex);
 
-  // Update packet loss rate
-  if (impl_->stats.packets_received > 0)
+  if (impl_->count == 0)
   {
-    impl_->stats.packet_loss_rate =
-        static_cast<float>(impl_->stats.packets_lost) /
-        static_cast<float>(impl_->stats.packets_received + impl_->stats.packets_lost);
+    return std::nullopt;
   }
 
-  return frame;
+  return impl_->front().frame;
 }
 
-std::optional<JitterFrame> JitterBuffer::peek() const
+std::optional<JitterFrame> JitterBuffer::peek(uint16_t sequence) const
 {
   std::lock_guard lock(impl_->mutex);
 
-  if (impl_->buffer.empty())
+  if (impl_->count == 0)
   {
     return std::nullopt;
   }
 
-  return impl_->buffer.front();
+  int64_t unwrapped = impl_->unwrap_sequence(sequence);
+  const auto& slot = impl_->slot(unwrapped);
+  if (slot.sequence != unwrapped)
+  {
+    return std::nullopt;
+  }
+  return slot.frame;
 }
 
 bool JitterBuffer::is_ready() const
 {
   std::lock_guard lock(impl_->mutex);
 
-  if (impl_->buffer.empty())
+  if (impl_->count == 0)
   {
     return false;
   }
 
-  auto now = std::chrono::steady_clock::now();
-  auto front_age = std::chrono::duration_cast<std::chrono::milliseconds>(
-      now - impl_->buffer.front().arrival_time);
-
-  return front_age >= impl_->stats.target_delay;
+  return std::chrono::steady_clock::now() >= impl_->playout_time(impl_->front().timestamp);
 }
 
 size_t JitterBuffer::size() const
 {
   std::lock_guard lock(impl_->mutex);
-  return impl_->buffer.size();
+  return impl_->count;
 }
 
 JitterBufferStats JitterBuffer::stats() const
@@ -223,9 +468,15 @@ JitterBufferStats JitterBuffer::stats() const
 void JitterBuffer::reset()
 {
   std::lock_guard lock(impl_->mutex);
-  impl_->buffer.clear();
+  for (auto& slot : impl_->slots)
+  {
+    slot.sequence = -1;
+  }
+  impl_->count = 0;
   impl_->sequence_initialized = false;
   impl_->playout_started = false;
+  impl_->jitter = 0.0;
+  impl_->reset_histogram();
   impl_->stats = {};
   impl_->stats.target_delay = impl_->config.target_delay;
 }
@@ -236,5 +487,11 @@ void JitterBuffer::set_target_delay(std::chrono::milliseconds delay)
   impl_->stats.target_delay = std::clamp(delay, impl_->config.min_delay, impl_->config.max_delay);
 }
 
+void JitterBuffer::set_delay_histogram(MetricHistogram histogram)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->delay_histogram = histogram;
+}
+
 }  // namespace audio
 }  // namespace rtc
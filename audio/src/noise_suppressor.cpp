@@ -0,0 +1,429 @@
+/**
+ * @file noise_suppressor.cpp
+ * @brief STFT noise suppressor with minimum-statistics noise tracking
+ *
+ * Every 10 ms hop the last 20 ms are analysed through a sqrt-Hann window.
+ * The noise spectrum is the bias-corrected minimum of the smoothed power
+ * over about 1.5 s, tracked in sub-windows so it follows rising noise
+ * within that time. Gains are Wiener gains on a decision-directed a priori
+ * SNR, floored by the suppression level, and the frame is resynthesized by
+ * overlap-add one hop behind the input.
+ */
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+#include "rtc/audio/audio_processing.h"
+#include "rtc/audio/fft.h"
+#include "simd.h"
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+constexpr int HOP_MS = 10;
+
+constexpr float POWER_SMOOTHING = 0.9f;  // Periodogram smoothing before the minimum search
+constexpr size_t MIN_SUBWINDOWS = 8;
+constexpr size_t MIN_SUBWINDOW_HOPS = 19;  // 8 x 19 hops: a 1.5 s minimum search window
+constexpr float MIN_BIAS = 1.7f;           // Mean over minimum of the smoothed periodogram
+
+constexpr float DECISION_DIRECTED = 0.98f;
+
+// Speech presence from the mean log likelihood ratio over 100 Hz - 4 kHz
+constexpr float SPEECH_LOW_HZ = 100.0f;
+constexpr float SPEECH_HIGH_HZ = 4000.0f;
+constexpr float LIKELIHOOD_THRESHOLD = 0.5f;
+constexpr float LIKELIHOOD_SLOPE = 4.0f;
+constexpr float VOICE_SMOOTHING = 0.7f;
+
+struct LevelSettings
+{
+  float floor;           // Minimum gain
+  float overestimation;  // Noise scale before the SNR estimate
+};
+
+LevelSettings settings_for(NsConfig::Level level)
+{
+  switch (level)
+  {
+    case NsConfig::Level::LOW:
+      return {0.5f, 1.0f};  // -6 dB
+    case NsConfig::Level::MODERATE:
+      return {0.25f, 1.0f};  // -12 dB
+    case NsConfig::Level::HIGH:
+      return {0.125f, 1.25f};  // -18 dB
+    case NsConfig::Level::VERY_HIGH:
+      return {0.063f, 1.5f};  // -24 dB
+  }
+  return {0.25f, 1.0f};
+}
+
+// p = |x|^2
+void power_spectrum(const float* re, const float* im, float* p, size_t n)
+{
+  size_t k = 0;
+  for (; k + simd::WIDTH <= n; k += simd::WIDTH)
+  {
+    auto r = simd::load(re + k), i = simd::load(im + k);
+    simd::store(p + k, simd::add(simd::mul(r, r), simd::mul(i, i)));
+  }
+  for (; k < n; ++k)
+  {
+    p[k] = re[k] * re[k] + im[k] * im[k];
+  }
+}
+
+// s = a * s + (1 - a) * p
+void smooth(const float* p, float* s, float a, size_t n)
+{
+  auto va = simd::set1(a), vb = simd::set1(1.0f - a);
+  size_t k = 0;
+  for (; k + simd::WIDTH <= n; k += simd::WIDTH)
+  {
+    simd::store(s + k, simd::mul_add(va, simd::load(s + k), simd::mul(vb, simd::load(p + k))));
+  }
+  for (; k < n; ++k)
+  {
+    s[k] = a * s[k] + (1.0f - a) * p[k];
+  }
+}
+
+// y = min(y, x)
+void minimum(const float* x, float* y, size_t n)
+{
+  size_t k = 0;
+  for (; k + simd::WIDTH <= n; k += simd::WIDTH)
+  {
+    simd::store(y + k, simd::min(simd::load(y + k), simd::load(x + k)));
+  }
+  for (; k < n; ++k)
+  {
+    y[k] = std::min(y[k], x[k]);
+  }
+}
+
+// re, im *= g
+void apply_gain(const float* g, float* re, float* im, size_t n)
+{
+  size_t k = 0;
+  for (; k + simd::WIDTH <= n; k += simd::WIDTH)
+  {
+    auto gain = simd::load(g + k);
+    simd::store(re + k, simd::mul(simd::load(re + k), gain));
+    simd::store(im + k, simd::mul(simd::load(im + k), gain));
+  }
+  for (; k < n; ++k)
+  {
+    re[k] *= g[k];
+    im[k] *= g[k];
+  }
+}
+
+}  // namespace
+
+struct NoiseSuppressor::Impl
+{
+  NsConfig config;
+  bool initialized = false;
+  float voice_probability = 0.0f;
+  std::mutex mutex;
+
+  size_t hop = 0;
+  size_t bins = 0;
+  size_t speech_low = 0, speech_high = 0;  // Bin range of the speech presence feature
+  std::unique_ptr<RealFft> fft;
+
+  std::vector<float> input_pending;
+  std::vector<float> output;  // Synthesized samples not yet returned
+  bool output_primed = false;
+  AudioBuffer scratch;        // For the int16 overload
+
+  std::vector<float> window;
+  std::vector<float> previous;  // Last hop of input, first half of the analysis window
+  std::vector<float> overlap;
+  std::vector<float> time, re, im;
+
+  std::vector<float> power, smoothed;
+  std::vector<float> subwindow_min, window_min, noise;
+  std::vector<float> subwindow_mins;  // MIN_SUBWINDOWS rows of bins
+  size_t subwindow_hops = 0;
+  size_t subwindow_index = 0;
+  size_t hops = 0;
+
+  std::vector<float> clean;  // Previous hop's clean speech power, for the a priori SNR
+  std::vector<float> prior;  // A priori SNR
+  std::vector<float> gain;
+
+  Impl(NsConfig cfg) : config(std::move(cfg)) {}
+
+  void setup()
+  {
+    hop = static_cast<size_t>(config.sample_rate * HOP_MS / 1000);
+    size_t fft_size = std::max<size_t>(32, std::bit_ceil(2 * hop));
+    bins = fft_size / 2 + 1;
+    float bin_hz = static_cast<float>(config.sample_rate) / static_cast<float>(fft_size);
+    speech_low = std::max<size_t>(1, static_cast<size_t>(SPEECH_LOW_HZ / bin_hz));
+    speech_high = std::clamp(static_cast<size_t>(SPEECH_HIGH_HZ / bin_hz), speech_low + 1, bins);
+
+    fft = std::make_unique<RealFft>(fft_size);
+    input_pending.clear();
+    input_pending.reserve(hop * 8);
+    output.clear();
+    output.reserve(hop * 8);
+    output_primed = false;
+    scratch.reset(static_cast<size_t>(config.channels), 2 * hop);
+
+    const double pi = std::acos(-1.0);
+    window.resize(2 * hop);
+    for (size_t n = 0; n < window.size(); ++n)
+    {
+      window[n] = static_cast<float>(std::sin(pi * (static_cast<double>(n) + 0.5) /
+                                              static_cast<double>(window.size())));
+    }
+    previous.assign(hop, 0.0f);
+    overlap.assign(hop, 0.0f);
+    time.assign(fft_size, 0.0f);
+    re.assign(bins, 0.0f);
+    im.assign(bins, 0.0f);
+
+    const float inf = std::numeric_limits<float>::max();
+    power.assign(bins, 0.0f);
+    smoothed.assign(bins, 0.0f);
+    subwindow_min.assign(bins, inf);
+    window_min.assign(bins, inf);
+    noise.assign(bins, 0.0f);
+    subwindow_mins.assign(MIN_SUBWINDOWS * bins, inf);
+    subwindow_hops = 0;
+    subwindow_index = 0;
+    hops = 0;
+
+    clean.assign(bins, 0.0f);
+    prior.assign(bins, 0.0f);
+    gain.assign(bins, 1.0f);
+    voice_probability = 0.0f;
+  }
+
+  /**
+   * Minimum statistics: the minimum of the smoothed power over the last
+   * MIN_SUBWINDOWS sub-windows and the current one, scaled by MIN_BIAS.
+   */
+  void track_noise()
+  {
+    if (hops == 0)
+    {
+      std::copy(power.begin(), power.end(), smoothed.begin());
+    }
+    else
+    {
+      smooth(power.data(), smoothed.data(), POWER_SMOOTHING, bins);
+    }
+    // The first window is half silence from before the stream started
+    if (hops++ > 0)
+    {
+      minimum(smoothed.data(), subwindow_min.data(), bins);
+    }
+
+    if (++subwindow_hops == MIN_SUBWINDOW_HOPS)
+    {
+      std::copy(subwindow_min.begin(), subwindow_min.end(),
+                subwindow_mins.begin() + static_cast<std::ptrdiff_t>(subwindow_index * bins));
+      subwindow_index = (subwindow_index + 1) % MIN_SUBWINDOWS;
+      std::fill(window_min.begin(), window_min.end(), std::numeric_limits<float>::max());
+      for (size_t u = 0; u < MIN_SUBWINDOWS; ++u)
+      {
+        minimum(&subwindow_mins[u * bins], window_min.data(), bins);
+      }
+      std::fill(subwindow_min.begin(), subwindow_min.end(), std::numeric_limits<float>::max());
+      subwindow_hops = 0;
+    }
+
+    for (size_t k = 0; k < bins; ++k)
+    {
+      noise[k] = MIN_BIAS * std::min(window_min[k], subwindow_min[k]);
+    }
+  }
+
+  /**
+   * Decision-directed Wiener gains; returns the mean log likelihood ratio of
+   * speech over the speech band.
+   */
+  float compute_gains()
+  {
+    auto level = settings_for(config.level);
+    auto beta = simd::set1(DECISION_DIRECTED);
+    auto one_minus_beta = simd::set1(1.0f - DECISION_DIRECTED);
+    auto one = simd::set1(1.0f);
+    auto zero = simd::set1(0.0f);
+    auto floor = simd::set1(level.floor);
+    auto epsilon = simd::set1(1e-12f);
+    auto overestimation = simd::set1(level.overestimation);
+
+    size_t k = 0;
+    for (; k + simd::WIDTH <= bins; k += simd::WIDTH)
+    {
+      auto p = simd::load(&power[k]);
+      auto n = simd::add(simd::mul(overestimation, simd::load(&noise[k])), epsilon);
+      auto posterior = simd::div(p, n);
+      auto instantaneous = simd::max(simd::sub(posterior, one), zero);
+      auto xi = simd::mul_add(beta, simd::div(simd::load(&clean[k]), n),
+                              simd::mul(one_minus_beta, instantaneous));
+      auto g = simd::max(simd::div(xi, simd::add(one, xi)), floor);
+      simd::store(&prior[k], xi);
+      simd::store(&gain[k], g);
+      simd::store(&clean[k], simd::mul(simd::mul(g, g), p));
+    }
+    for (; k < bins; ++k)
+    {
+      float n = level.overestimation * noise[k] + 1e-12f;
+      float posterior = power[k] / n;
+      prior[k] = DECISION_DIRECTED * clean[k] / n +
+                 (1.0f - DECISION_DIRECTED) * std::max(posterior - 1.0f, 0.0f);
+      gain[k] = std::max(prior[k] / (1.0f + prior[k]), level.floor);
+      clean[k] = gain[k] * gain[k] * power[k];
+    }
+
+    float llr = 0.0f;
+    for (size_t b = speech_low; b < speech_high; ++b)
+    {
+      float posterior = power[b] / (noise[b] + 1e-12f);
+      llr += posterior * prior[b] / (1.0f + prior[b]) - std::log1p(prior[b]);
+    }
+    return llr / static_cast<float>(speech_high - speech_low);
+  }
+
+  void suppress(AudioBuffer& samples)
+  {
+    // Suppressed on the mono downmix, written back to every channel
+    size_t frames = samples.frames();
+    size_t at = input_pending.size();
+    input_pending.resize(at + frames);
+    samples.downmix(std::span<float>(input_pending).subspan(at));
+
+    // Synthesis runs one hop behind; frames that are not a whole number of hops
+    // need one more hop queued so every call finds its output ready
+    if (!output_primed)
+    {
+      if (frames % hop != 0)
+      {
+        output.assign(hop, 0.0f);
+      }
+      output_primed = true;
+    }
+
+    size_t consumed = 0;
+    for (; consumed + hop <= input_pending.size(); consumed += hop)
+    {
+      size_t out = output.size();
+      output.resize(out + hop);
+      process_hop(input_pending.data() + consumed, output.data() + out);
+    }
+    input_pending.erase(input_pending.begin(),
+                        input_pending.begin() + static_cast<std::ptrdiff_t>(consumed));
+
+    size_t ready = std::min(frames, output.size());
+    samples.upmix(std::span<const float>(output.data(), ready));
+    output.erase(output.begin(), output.begin() + static_cast<std::ptrdiff_t>(ready));
+  }
+
+  void process_hop(const float* input, float* out)
+  {
+    for (size_t n = 0; n < hop; ++n)
+    {
+      time[n] = previous[n] * window[n];
+      time[hop + n] = input[n] * window[hop + n];
+    }
+    std::fill(time.begin() + static_cast<std::ptrdiff_t>(2 * hop), time.end(), 0.0f);
+    std::copy(input, input + hop, previous.begin());
+    fft->forward(time, re, im);
+
+    power_spectrum(re.data(), im.data(), power.data(), bins);
+    track_noise();
+    float llr = compute_gains();
+    float probability = 1.0f / (1.0f + std::exp(-LIKELIHOOD_SLOPE * (llr - LIKELIHOOD_THRESHOLD)));
+    voice_probability = VOICE_SMOOTHING * voice_probability + (1.0f - VOICE_SMOOTHING) * probability;
+
+    apply_gain(gain.data(), re.data(), im.data(), bins);
+    fft->inverse(re, im, time);
+    for (size_t n = 0; n < hop; ++n)
+    {
+      out[n] = overlap[n] + time[n] * window[n];
+      overlap[n] = time[hop + n] * window[hop + n];
+    }
+  }
+};
+
+NoiseSuppressor::NoiseSuppressor(NsConfig config) : impl_(std::make_unique<Impl>(std::move(config)))
+{
+}
+
+NoiseSuppressor::~NoiseSuppressor() = default;
+
+bool NoiseSuppressor::initialize()
+{
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->config.sample_rate < 8000 || impl_->config.channels < 1)
+  {
+    return false;
+  }
+  impl_->setup();
+  impl_->initialized = true;
+  return true;
+}
+
+void NoiseSuppressor::process(std::span<int16_t> samples)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return;
+  }
+  d.scratch.copy_from(samples);
+  d.suppress(d.scratch);
+  d.scratch.copy_to(samples);
+}
+
+void NoiseSuppressor::process(AudioBuffer& samples)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return;
+  }
+  d.suppress(samples);
+}
+
+void NoiseSuppressor::set_level(NsConfig::Level level)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->config.level = level;
+}
+
+float NoiseSuppressor::get_voice_probability() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->voice_probability;
+}
+
+void NoiseSuppressor::reset()
+{
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->initialized)
+  {
+    impl_->setup();
+  }
+  impl_->voice_probability = 0.0f;
+}
+
+}  // namespace audio
+}  // namespace rtc
@@ -2,28 +2,43 @@
  * @file opus_codec.cpp
  * @brief Opus codec implementation
  *
- * Note: This is a stub implementation. Full implementation requires
- * linking against libopus. Install via:
+ * Uses libopus when built with HAVE_OPUS (CMake option ENABLE_OPUS).
+ * Install via:
  *   - Windows: vcpkg install opus
  *   - Linux: apt install libopus-dev
  *   - macOS: brew install opus
+ * Without it the codec is a stub: placeholder packets and silence.
  */
 
 #include "rtc/audio/opus_codec.h"
 
-// Uncomment when libopus is available:
-// #include <opus/opus.h>
+#include <algorithm>
+
+#ifdef HAVE_OPUS
+#include <opus/opus.h>
+#endif
 
 namespace rtc
 {
 namespace audio
 {
 
+namespace
+{
+
+#ifndef HAVE_OPUS
+constexpr size_t STUB_PACKET_BYTES = 32;
+#endif
+
+}  // namespace
+
 // OpusEncoder implementation
 struct OpusEncoder::Impl
 {
   OpusEncoderConfig config;
-  // ::OpusEncoder* encoder = nullptr;  // libopus encoder
+#ifdef HAVE_OPUS
+  ::OpusEncoder* encoder = nullptr;
+#endif
   bool initialized = false;
   int frame_size = 0;
 
@@ -34,7 +49,9 @@ struct OpusEncoder::Impl
 
   ~Impl()
   {
-    // if (encoder) opus_encoder_destroy(encoder);
+#ifdef HAVE_OPUS
+    if (encoder) opus_encoder_destroy(encoder);
+#endif
   }
 };
 
@@ -50,74 +67,74 @@ OpusEncoder& OpusEncoder::operator=(OpusEncoder&&) noexcept = default;
 
 bool OpusEncoder::initialize()
 {
-  /*
-  int error;
+#ifdef HAVE_OPUS
+  if (impl_->encoder) return true;
+
   int application = OPUS_APPLICATION_VOIP;
-  switch (impl_->config.application) {
-      case OpusEncoderConfig::Application::VOIP:
-          application = OPUS_APPLICATION_VOIP;
-          break;
-      case OpusEncoderConfig::Application::AUDIO:
-          application = OPUS_APPLICATION_AUDIO;
-          break;
-      case OpusEncoderConfig::Application::LOW_DELAY:
-          application = OPUS_APPLICATION_RESTRICTED_LOWDELAY;
-          break;
+  switch (impl_->config.application)
+  {
+    case OpusEncoderConfig::Application::VOIP:
+      application = OPUS_APPLICATION_VOIP;
+      break;
+    case OpusEncoderConfig::Application::AUDIO:
+      application = OPUS_APPLICATION_AUDIO;
+      break;
+    case OpusEncoderConfig::Application::LOW_DELAY:
+      application = OPUS_APPLICATION_RESTRICTED_LOWDELAY;
+      break;
   }
 
-  impl_->encoder = opus_encoder_create(
-      impl_->config.sample_rate,
-      impl_->config.channels,
-      application,
-      &error);
-
-  if (error != OPUS_OK || !impl_->encoder) {
-      return false;
+  int error = OPUS_OK;
+  impl_->encoder =
+      opus_encoder_create(impl_->config.sample_rate, impl_->config.channels, application, &error);
+  if (error != OPUS_OK || !impl_->encoder)
+  {
+    impl_->encoder = nullptr;
+    return false;
   }
 
   opus_encoder_ctl(impl_->encoder, OPUS_SET_BITRATE(impl_->config.bitrate));
   opus_encoder_ctl(impl_->encoder, OPUS_SET_VBR(impl_->config.use_vbr ? 1 : 0));
   opus_encoder_ctl(impl_->encoder, OPUS_SET_DTX(impl_->config.use_dtx ? 1 : 0));
   opus_encoder_ctl(impl_->encoder, OPUS_SET_COMPLEXITY(impl_->config.complexity));
-  */
+  opus_encoder_ctl(impl_->encoder, OPUS_SET_INBAND_FEC(impl_->config.use_fec ? 1 : 0));
+  opus_encoder_ctl(impl_->encoder, OPUS_SET_PACKET_LOSS_PERC(impl_->config.packet_loss_percent));
+#endif
 
   impl_->initialized = true;
   return true;
 }
 
-EncodeResult OpusEncoder::encode(std::span<const int16_t> pcm_samples)
+EncodeResult OpusEncoder::encode(std::span<const int16_t> pcm_samples, std::span<uint8_t> output)
 {
   EncodeResult result;
 
-  if (!impl_->initialized)
+  if (!impl_->initialized ||
+      pcm_samples.size() < static_cast<size_t>(impl_->frame_size * impl_->config.channels))
   {
     return result;
   }
 
-  /*
-  // Allocate output buffer (max Opus frame is 1275 bytes per channel per frame)
-  result.data.resize(4000);
-
-  int encoded_bytes = opus_encode(
-      impl_->encoder,
-      pcm_samples.data(),
-      impl_->frame_size,
-      result.data.data(),
-      result.data.size());
-
-  if (encoded_bytes < 0) {
-      result.data.clear();
-      return result;
+#ifdef HAVE_OPUS
+  int encoded_bytes =
+      opus_encode(impl_->encoder, pcm_samples.data(), impl_->frame_size, output.data(),
+                  static_cast<opus_int32>(std::min(output.size(), MAX_PACKET_BYTES)));
+  if (encoded_bytes < 0)
+  {
+    return result;
   }
 
-  result.data.resize(encoded_bytes);
+  result.bytes = static_cast<size_t>(encoded_bytes);
+  result.samples_encoded = impl_->frame_size;
+  // With DTX, silence is sent as 1-2 byte packets
+  result.voice_activity = encoded_bytes > 2;
+#else
+  // Stub: placeholder packet
+  result.bytes = std::min(output.size(), STUB_PACKET_BYTES);
+  std::fill_n(output.begin(), result.bytes, uint8_t{0});
   result.samples_encoded = impl_->frame_size;
-  */
-
-  // Stub: Return fake encoded data
-  result.data.resize(32);  // Fake minimal packet
-  result.samples_encoded = static_cast<int>(pcm_samples.size());
   result.voice_activity = true;
+#endif
 
   return result;
 }
@@ -125,24 +142,43 @@ EncodeResult OpusEncoder::encode(std::span<const int16_t> pcm_samples)
 void OpusEncoder::set_bitrate(int bitrate_bps)
 {
   impl_->config.bitrate = bitrate_bps;
-  // if (impl_->encoder) opus_encoder_ctl(impl_->encoder, OPUS_SET_BITRATE(bitrate_bps));
+#ifdef HAVE_OPUS
+  if (impl_->encoder) opus_encoder_ctl(impl_->encoder, OPUS_SET_BITRATE(bitrate_bps));
+#endif
 }
 
 void OpusEncoder::set_complexity(int complexity)
 {
   impl_->config.complexity = complexity;
-  // if (impl_->encoder) opus_encoder_ctl(impl_->encoder, OPUS_SET_COMPLEXITY(complexity));
+#ifdef HAVE_OPUS
+  if (impl_->encoder) opus_encoder_ctl(impl_->encoder, OPUS_SET_COMPLEXITY(complexity));
+#endif
 }
 
 void OpusEncoder::set_dtx(bool enable)
 {
   impl_->config.use_dtx = enable;
-  // if (impl_->encoder) opus_encoder_ctl(impl_->encoder, OPUS_SET_DTX(enable ? 1 : 0));
+#ifdef HAVE_OPUS
+  if (impl_->encoder) opus_encoder_ctl(impl_->encoder, OPUS_SET_DTX(enable ? 1 : 0));
+#endif
+}
+
+void OpusEncoder::set_packet_loss(int percent)
+{
+  impl_->config.packet_loss_percent = std::clamp(percent, 0, 100);
+#ifdef HAVE_OPUS
+  if (impl_->encoder)
+  {
+    opus_encoder_ctl(impl_->encoder, OPUS_SET_PACKET_LOSS_PERC(impl_->config.packet_loss_percent));
+  }
+#endif
 }
 
 void OpusEncoder::reset()
 {
-  // if (impl_->encoder) opus_encoder_ctl(impl_->encoder, OPUS_RESET_STATE);
+#ifdef HAVE_OPUS
+  if (impl_->encoder) opus_encoder_ctl(impl_->encoder, OPUS_RESET_STATE);
+#endif
 }
 
 int OpusEncoder::frame_size() const
@@ -155,18 +191,38 @@ bool OpusEncoder::is_initialized() const
   return impl_->initialized;
 }
 
+bool OpusEncoder::has_libopus()
+{
+#ifdef HAVE_OPUS
+  return true;
+#else
+  return false;
+#endif
+}
+
 // OpusDecoder implementation
 struct OpusDecoder::Impl
 {
   OpusDecoderConfig config;
-  // ::OpusDecoder* decoder = nullptr;  // libopus decoder
+#ifdef HAVE_OPUS
+  ::OpusDecoder* decoder = nullptr;
+#endif
   bool initialized = false;
 
   Impl(OpusDecoderConfig cfg) : config(std::move(cfg)) {}
 
   ~Impl()
   {
-    // if (decoder) opus_decoder_destroy(decoder);
+#ifdef HAVE_OPUS
+    if (decoder) opus_decoder_destroy(decoder);
+#endif
+  }
+
+  // Whole frames that fit in pcm
+  int capacity(std::span<int16_t> pcm) const
+  {
+    auto frames = pcm.size() / static_cast<size_t>(std::max(1, config.channels));
+    return static_cast<int>(std::min(frames, static_cast<size_t>(MAX_FRAME_SIZE)));
   }
 };
 
@@ -182,95 +238,176 @@ OpusDecoder& OpusDecoder::operator=(OpusDecoder&&) noexcept = default;
 
 bool OpusDecoder::initialize()
 {
-  /*
-  int error;
-  impl_->decoder = opus_decoder_create(
-      impl_->config.sample_rate,
-      impl_->config.channels,
-      &error);
-
-  if (error != OPUS_OK || !impl_->decoder) {
-      return false;
+#ifdef HAVE_OPUS
+  if (impl_->decoder) return true;
+
+  int error = OPUS_OK;
+  impl_->decoder = opus_decoder_create(impl_->config.sample_rate, impl_->config.channels, &error);
+  if (error != OPUS_OK || !impl_->decoder)
+  {
+    impl_->decoder = nullptr;
+    return false;
   }
-  */
+#endif
 
   impl_->initialized = true;
   return true;
 }
 
-DecodeResult OpusDecoder::decode(std::span<const uint8_t> opus_data, int frame_size)
+DecodeResult OpusDecoder::decode(std::span<const uint8_t> opus_data, std::span<int16_t> pcm)
 {
   DecodeResult result;
 
-  if (!impl_->initialized)
+  int frame_size = impl_->capacity(pcm);
+  if (!impl_->initialized || frame_size == 0)
   {
     return result;
   }
 
-  /*
-  result.samples.resize(frame_size * impl_->config.channels);
-
-  int decoded_samples = opus_decode(
-      impl_->decoder,
-      opus_data.data(),
-      opus_data.size(),
-      result.samples.data(),
-      frame_size,
-      0);  // No FEC
-
-  if (decoded_samples < 0) {
-      result.samples.clear();
-      return result;
+#ifdef HAVE_OPUS
+  int decoded_samples =
+      opus_decode(impl_->decoder, opus_data.data(), static_cast<opus_int32>(opus_data.size()),
+                  pcm.data(), frame_size, 0);
+  if (decoded_samples < 0)
+  {
+    return result;
   }
 
   result.samples_decoded = decoded_samples;
-  */
-
-  // Stub: Return silence
-  result.samples.resize(frame_size * impl_->config.channels, 0);
+#else
+  // Stub: a 20 ms frame of silence
+  (void)opus_data;
+  frame_size = std::min(frame_size, impl_->config.sample_rate / 50);
+  std::fill_n(pcm.begin(), static_cast<size_t>(frame_size * impl_->config.channels), int16_t{0});
   result.samples_decoded = frame_size;
+#endif
 
   return result;
 }
 
-DecodeResult OpusDecoder::decode_plc(int frame_size)
+DecodeResult OpusDecoder::decode_plc(std::span<int16_t> pcm)
 {
   DecodeResult result;
 
-  if (!impl_->initialized)
+  int frame_size = impl_->capacity(pcm);
+  if (!impl_->initialized || frame_size == 0)
+  {
+    return result;
+  }
+
+#ifdef HAVE_OPUS
+  // A null packet asks libopus to conceal exactly frame_size samples
+  int decoded_samples = opus_decode(impl_->decoder, nullptr, 0, pcm.data(), frame_size, 0);
+  if (decoded_samples < 0)
   {
     return result;
   }
 
-  /*
-  result.samples.resize(frame_size * impl_->config.channels);
+  result.samples_decoded = decoded_samples;
+#else
+  // Stub: silence
+  std::fill_n(pcm.begin(), static_cast<size_t>(frame_size * impl_->config.channels), int16_t{0});
+  result.samples_decoded = frame_size;
+#endif
+
+  return result;
+}
 
-  int decoded_samples = opus_decode(
-      impl_->decoder,
-      nullptr,  // NULL for PLC
-      0,
-      result.samples.data(),
-      frame_size,
-      0);
+DecodeResult OpusDecoder::decode_fec(std::span<const uint8_t> next_packet,
+                                     std::span<int16_t> pcm)
+{
+  DecodeResult result;
 
-  if (decoded_samples < 0) {
-      result.samples.clear();
-      return result;
+  int frame_size = impl_->capacity(pcm);
+  if (!impl_->initialized || frame_size == 0)
+  {
+    return result;
   }
 
-  result.samples_decoded = decoded_samples;
-  */
+#ifdef HAVE_OPUS
+  // decode_fec=1 takes the LBRR copy of the previous frame out of next_packet
+  int decoded_samples =
+      opus_decode(impl_->decoder, next_packet.data(), static_cast<opus_int32>(next_packet.size()),
+                  pcm.data(), frame_size, 1);
+  if (decoded_samples < 0)
+  {
+    return result;
+  }
 
-  // Stub: Return silence
-  result.samples.resize(frame_size * impl_->config.channels, 0);
+  result.samples_decoded = decoded_samples;
+#else
+  // Stub: silence
+  (void)next_packet;
+  std::fill_n(pcm.begin(), static_cast<size_t>(frame_size * impl_->config.channels), int16_t{0});
   result.samples_decoded = frame_size;
+#endif
 
   return result;
 }
 
+bool OpusDecoder::has_fec(std::span<const uint8_t> packet)
+{
+  // RFC 6716 section 3.1: TOC byte, then framing depending on the code
+  if (packet.size() < 2) return false;
+
+  uint8_t toc = packet[0];
+  int config = toc >> 3;
+  if (config >= 16) return false;  // CELT only
+
+  // SILK frames are 20 ms at most; longer packets hold two or three
+  static constexpr int SILK_MS[] = {10, 20, 40, 60};
+  int frame_ms = config < 12 ? SILK_MS[config & 3] : ((config & 1) ? 20 : 10);
+  int silk_frames = frame_ms > 20 ? frame_ms / 20 : 1;
+  bool stereo = (toc & 0x04) != 0;
+
+  size_t offset = 1;
+  switch (toc & 0x03)
+  {
+    case 0:  // One frame
+    case 1:  // Two frames of equal size
+      break;
+    case 2:  // Two frames, the first one's length follows
+      offset = packet[1] >= 252 ? 3 : 2;
+      break;
+    default:  // Frame count byte, optional padding and lengths
+    {
+      uint8_t count_byte = packet[1];
+      int count = count_byte & 0x3F;
+      offset = 2;
+      if (count_byte & 0x40)
+      {
+        // Padding length: 255 means 254 more bytes and another length byte
+        while (offset < packet.size() && packet[offset++] == 255)
+        {
+        }
+      }
+      if (count_byte & 0x80)
+      {
+        for (int i = 0; i + 1 < count && offset < packet.size(); ++i)
+        {
+          offset += packet[offset] >= 252 ? 2 : 1;
+        }
+      }
+      break;
+    }
+  }
+  if (offset >= packet.size()) return false;
+
+  // The VAD flags come first, then the LBRR flag, per channel
+  uint8_t first = packet[offset];
+  bool lbrr = ((first >> (7 - silk_frames)) & 1) != 0;
+  if (stereo)
+  {
+    lbrr = lbrr || ((first >> (6 - 2 * silk_frames)) & 1) != 0;
+  }
+  return lbrr;
+}
+
 void OpusDecoder::reset()
 {
-  // if (impl_->decoder) opus_decoder_ctl(impl_->decoder, OPUS_RESET_STATE);
+#ifdef HAVE_OPUS
+  if (impl_->decoder) opus_decoder_ctl(impl_->decoder, OPUS_RESET_STATE);
+#endif
 }
 
 bool OpusDecoder::is_initialized() const
@@ -0,0 +1,435 @@
+/**
+ * @file resampler.cpp
+ * @brief Polyphase FIR resampler with SIMD dot products
+ *
+ * Output frame k sits at input position k M / L. Its integer part picks the
+ * newest input frame the filter covers and its remainder picks the phase:
+ * phase p of the prototype h (designed at L times the input rate) is
+ * h[p], h[p + L], h[p + 2L], ... Each phase is stored reversed so it lines
+ * up with the oldest-to-newest history it multiplies.
+ *
+ * DriftResampler instead walks a floating-point input position, so its
+ * ratio can move by parts per million between calls.
+ */
+
+#include "rtc/audio/resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "simd.h"
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+constexpr int MAX_PHASES = 1024;
+constexpr size_t TAPS_PER_PHASE = 64;  // At the lower rate; scaled by M / L when decimating
+constexpr double STOPBAND_DB = 80.0;
+
+constexpr size_t DRIFT_TAPS = 32;
+constexpr size_t DRIFT_PHASES = 256;
+constexpr double DRIFT_CUTOFF = 0.45;  // Cycles per sample
+constexpr double DRIFT_BETA = 8.0;
+constexpr double DRIFT_MAX_CORRECTION = 0.01;
+
+// Zeroth-order modified Bessel function of the first kind
+double bessel_i0(double x)
+{
+  double term = 1.0;
+  double sum = 1.0;
+  for (int k = 1; term > sum * 1e-12; ++k)
+  {
+    double half = x / (2.0 * k);
+    term *= half * half;
+    sum += term;
+  }
+  return sum;
+}
+
+// Kaiser window at r in [-1, 1]
+double kaiser(double r, double beta)
+{
+  return bessel_i0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / bessel_i0(beta);
+}
+
+double sinc(double x)
+{
+  const double pi = std::acos(-1.0);
+  return std::abs(x) < 1e-12 ? 1.0 : std::sin(pi * x) / (pi * x);
+}
+
+float dot(const float* taps, const float* samples, size_t count)
+{
+  size_t vector_end = count - count % (2 * simd::WIDTH);
+  size_t i = 0;
+  simd::f32x4 acc0 = simd::set1(0.0f);
+  simd::f32x4 acc1 = simd::set1(0.0f);
+  for (; i < vector_end; i += 2 * simd::WIDTH)
+  {
+    acc0 = simd::mul_add(simd::load(taps + i), simd::load(samples + i), acc0);
+    acc1 = simd::mul_add(simd::load(taps + i + simd::WIDTH),
+                         simd::load(samples + i + simd::WIDTH), acc1);
+  }
+  float sum = simd::sum(simd::add(acc0, acc1));
+  for (; i < count; ++i)
+  {
+    sum += taps[i] * samples[i];
+  }
+  return sum;
+}
+
+}  // namespace
+
+struct Resampler::Impl
+{
+  ResamplerConfig config;
+  size_t up = 1;    // L
+  size_t down = 1;  // M
+  size_t taps = 1;  // Per phase
+  std::vector<float> coefficients;  // up * taps, phase-major, each phase reversed
+
+  // Planar history per channel; `next` is the newest frame the next output
+  // needs, always at least taps - 1 so the window fits behind it
+  std::vector<std::vector<float>> history;
+  size_t next = 0;
+  size_t phase = 0;
+
+  // int16 conversion buffers, grown once to the largest call
+  std::vector<float> input_scratch;
+  std::vector<float> output_scratch;
+
+  explicit Impl(ResamplerConfig cfg) : config(cfg)
+  {
+    if (config.input_rate <= 0 || config.output_rate <= 0 || config.channels <= 0)
+    {
+      throw std::invalid_argument("Resampler: rates and channels must be positive");
+    }
+    int common = std::gcd(config.input_rate, config.output_rate);
+    if (config.output_rate / common > MAX_PHASES)
+    {
+      throw std::invalid_argument("Resampler: rate ratio needs too many phases");
+    }
+    up = static_cast<size_t>(config.output_rate / common);
+    down = static_cast<size_t>(config.input_rate / common);
+
+    if (up == 1 && down == 1)
+    {
+      coefficients.assign(1, 1.0f);
+    }
+    else
+    {
+      design();
+    }
+    history.resize(static_cast<size_t>(config.channels));
+    reset();
+  }
+
+  // Kaiser-windowed sinc whose transition band ends at the lower Nyquist frequency
+  void design()
+  {
+    taps = TAPS_PER_PHASE;
+    if (down > up)
+    {
+      taps = (TAPS_PER_PHASE * down + up - 1) / up;
+      taps = (taps + 2 * simd::WIDTH - 1) / (2 * simd::WIDTH) * (2 * simd::WIDTH);
+    }
+    size_t length = up * taps;
+
+    // Frequencies in cycles per sample at the prototype rate, L times the input rate
+    double nyquist = 0.5 / static_cast<double>(std::max(up, down));
+    double transition = (STOPBAND_DB - 7.95) / (14.36 * static_cast<double>(length));
+    double cutoff = nyquist - transition / 2.0;
+    double beta = 0.1102 * (STOPBAND_DB - 8.7);
+
+    double centre = static_cast<double>(length - 1) / 2.0;
+    std::vector<double> prototype(length);
+    for (size_t n = 0; n < length; ++n)
+    {
+      double t = static_cast<double>(n) - centre;
+      prototype[n] = sinc(2.0 * cutoff * t) * kaiser(t / centre, beta);
+    }
+
+    // Unit DC gain per phase keeps the passband flat across phases
+    coefficients.resize(length);
+    for (size_t p = 0; p < up; ++p)
+    {
+      double sum = 0.0;
+      for (size_t j = 0; j < taps; ++j)
+      {
+        sum += prototype[p + j * up];
+      }
+      for (size_t j = 0; j < taps; ++j)
+      {
+        coefficients[p * taps + (taps - 1 - j)] = static_cast<float>(prototype[p + j * up] / sum);
+      }
+    }
+  }
+
+  void reset()
+  {
+    for (auto& channel : history)
+    {
+      channel.assign(taps - 1, 0.0f);
+    }
+    next = taps - 1;
+    phase = 0;
+  }
+
+  size_t pending_frames() const
+  {
+    return history[0].size() > next ? history[0].size() - next : 0;
+  }
+
+  size_t process(std::span<const float> input, std::span<float> output)
+  {
+    auto channels = static_cast<size_t>(config.channels);
+    size_t frames = input.size() / channels;
+    for (size_t c = 0; c < channels; ++c)
+    {
+      auto& channel = history[c];
+      size_t at = channel.size();
+      channel.resize(at + frames);
+      for (size_t i = 0; i < frames; ++i)
+      {
+        channel[at + i] = input[i * channels + c];
+      }
+    }
+
+    size_t capacity = output.size() / channels;
+    size_t buffered = history[0].size();
+    size_t produced = 0;
+    for (; next < buffered && produced < capacity; ++produced)
+    {
+      const float* phase_taps = coefficients.data() + phase * taps;
+      size_t oldest = next + 1 - taps;
+      for (size_t c = 0; c < channels; ++c)
+      {
+        output[produced * channels + c] = dot(phase_taps, history[c].data() + oldest, taps);
+      }
+      phase += down;
+      next += phase / up;
+      phase %= up;
+    }
+
+    // Keep only the window the next output reaches back over
+    size_t drop = std::min(next + 1 - taps, buffered);
+    for (auto& channel : history)
+    {
+      channel.erase(channel.begin(), channel.begin() + static_cast<std::ptrdiff_t>(drop));
+    }
+    next -= drop;
+    return produced;
+  }
+};
+
+Resampler::Resampler(ResamplerConfig config) : impl_(std::make_unique<Impl>(config)) {}
+
+Resampler::~Resampler() = default;
+
+const ResamplerConfig& Resampler::config() const
+{
+  return impl_->config;
+}
+
+size_t Resampler::max_output_frames(size_t input_frames) const
+{
+  size_t span = impl_->pending_frames() + input_frames;
+  return (span * impl_->up + impl_->down - 1) / impl_->down + 1;
+}
+
+size_t Resampler::process(std::span<const float> input, std::span<float> output)
+{
+  return impl_->process(input, output);
+}
+
+size_t Resampler::process(std::span<const int16_t> input, std::span<int16_t> output)
+{
+  auto& d = *impl_;
+  if (d.input_scratch.size() < input.size())
+  {
+    d.input_scratch.resize(input.size());
+  }
+  if (d.output_scratch.size() < output.size())
+  {
+    d.output_scratch.resize(output.size());
+  }
+
+  for (size_t i = 0; i < input.size(); ++i)
+  {
+    d.input_scratch[i] = static_cast<float>(input[i]);
+  }
+  size_t produced = d.process(std::span<const float>(d.input_scratch.data(), input.size()),
+                              std::span<float>(d.output_scratch.data(), output.size()));
+
+  size_t count = produced * static_cast<size_t>(d.config.channels);
+  for (size_t i = 0; i < count; ++i)
+  {
+    output[i] = static_cast<int16_t>(std::clamp(std::lround(d.output_scratch[i]), -32768L, 32767L));
+  }
+  return produced;
+}
+
+void Resampler::reset()
+{
+  impl_->reset();
+}
+
+struct DriftResampler::Impl
+{
+  static constexpr size_t HALF = DRIFT_TAPS / 2;
+
+  size_t channels = 1;
+  double ratio = 1.0;
+
+  // Row j holds the taps for fractional position j / DRIFT_PHASES, one
+  // extra row closes the interpolation at 1
+  std::vector<float> table;
+
+  // Planar history per channel; output frame k sits at position + k * ratio
+  std::vector<std::vector<float>> history;
+  double position = 0.0;
+  std::vector<float> taps = std::vector<float>(DRIFT_TAPS);
+
+  explicit Impl(int channel_count) : channels(static_cast<size_t>(std::max(1, channel_count)))
+  {
+    table.resize((DRIFT_PHASES + 1) * DRIFT_TAPS);
+    for (size_t j = 0; j <= DRIFT_PHASES; ++j)
+    {
+      double fraction = static_cast<double>(j) / DRIFT_PHASES;
+      double sum = 0.0;
+      float* row = table.data() + j * DRIFT_TAPS;
+      for (size_t k = 0; k < DRIFT_TAPS; ++k)
+      {
+        double t = static_cast<double>(k) - static_cast<double>(HALF - 1) - fraction;
+        double value = sinc(2.0 * DRIFT_CUTOFF * t) * kaiser(t / HALF, DRIFT_BETA);
+        row[k] = static_cast<float>(value);
+        sum += value;
+      }
+      for (size_t k = 0; k < DRIFT_TAPS; ++k)
+      {
+        row[k] = static_cast<float>(row[k] / sum);
+      }
+    }
+    history.resize(channels);
+    reset();
+  }
+
+  void reset()
+  {
+    // The first output is centred on the first input frame
+    for (auto& channel : history)
+    {
+      channel.assign(HALF - 1, 0.0f);
+    }
+    position = static_cast<double>(HALF - 1);
+  }
+
+  size_t required_input(size_t output_frames) const
+  {
+    if (output_frames == 0)
+    {
+      return 0;
+    }
+    double last = position + static_cast<double>(output_frames - 1) * ratio;
+    auto needed = static_cast<size_t>(last) + HALF + 1;
+    return needed > history[0].size() ? needed - history[0].size() : 0;
+  }
+
+  // Taps for a fraction in [0, 1), blended between the two nearest rows
+  void interpolate_taps(double fraction)
+  {
+    double scaled = fraction * DRIFT_PHASES;
+    auto row = std::min(static_cast<size_t>(scaled), DRIFT_PHASES - 1);
+    auto blend = simd::set1(static_cast<float>(scaled - static_cast<double>(row)));
+    const float* low = table.data() + row * DRIFT_TAPS;
+    const float* high = low + DRIFT_TAPS;
+    for (size_t k = 0; k < DRIFT_TAPS; k += simd::WIDTH)
+    {
+      auto a = simd::load(low + k);
+      simd::store(taps.data() + k, simd::mul_add(blend, simd::sub(simd::load(high + k), a), a));
+    }
+  }
+};
+
+DriftResampler::DriftResampler(int channels) : impl_(std::make_unique<Impl>(channels)) {}
+
+DriftResampler::~DriftResampler() = default;
+
+void DriftResampler::set_ratio(double ratio)
+{
+  impl_->ratio = std::clamp(ratio, 1.0 - DRIFT_MAX_CORRECTION, 1.0 + DRIFT_MAX_CORRECTION);
+}
+
+double DriftResampler::ratio() const
+{
+  return impl_->ratio;
+}
+
+size_t DriftResampler::required_input(size_t output_frames) const
+{
+  return impl_->required_input(output_frames);
+}
+
+void DriftResampler::process(std::span<const int16_t> input, std::span<int16_t> output)
+{
+  auto& d = *impl_;
+  size_t frames = input.size() / d.channels;
+  for (size_t c = 0; c < d.channels; ++c)
+  {
+    auto& channel = d.history[c];
+    size_t at = channel.size();
+    channel.resize(at + frames);
+    for (size_t i = 0; i < frames; ++i)
+    {
+      channel[at + i] = static_cast<float>(input[i * d.channels + c]);
+    }
+  }
+
+  size_t buffered = d.history[0].size();
+  size_t output_frames = output.size() / d.channels;
+  for (size_t k = 0; k < output_frames; ++k)
+  {
+    double at = d.position + static_cast<double>(k) * d.ratio;
+    auto centre = static_cast<size_t>(at);
+    if (centre + Impl::HALF >= buffered)
+    {
+      std::fill(output.begin() + static_cast<std::ptrdiff_t>(k * d.channels), output.end(),
+                int16_t{0});
+      break;
+    }
+
+    d.interpolate_taps(at - static_cast<double>(centre));
+    size_t oldest = centre + 1 - Impl::HALF;
+    for (size_t c = 0; c < d.channels; ++c)
+    {
+      float value = dot(d.taps.data(), d.history[c].data() + oldest, DRIFT_TAPS);
+      output[k * d.channels + c] =
+          static_cast<int16_t>(std::clamp(std::lround(value), -32768L, 32767L));
+    }
+  }
+
+  // Keep the window the next output reaches back over
+  d.position += static_cast<double>(output_frames) * d.ratio;
+  size_t drop = std::min(static_cast<size_t>(d.position) + 1 - Impl::HALF, buffered);
+  for (auto& channel : d.history)
+  {
+    channel.erase(channel.begin(), channel.begin() + static_cast<std::ptrdiff_t>(drop));
+  }
+  d.position -= static_cast<double>(drop);
+}
+
+void DriftResampler::reset()
+{
+  impl_->reset();
+}
+
+}  // namespace audio
+}  // namespace rtc
@@ -0,0 +1,290 @@
+#pragma once
+
+/**
+ * @file simd.h
+ * @brief Four-lane float vectors over SSE2, NEON or plain arrays
+ *
+ * SSE2 and NEON are baseline on x86-64 and AArch64, so no extra compiler
+ * flags are needed; other targets get the scalar fallback.
+ */
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RTC_SIMD_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define RTC_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace rtc
+{
+namespace audio
+{
+namespace simd
+{
+
+constexpr size_t WIDTH = 4;
+
+// load_int16() widens eight int16 samples into two vectors; store_int16()
+// rounds two vectors to nearest and saturates them back into eight
+
+#if defined(RTC_SIMD_SSE2)
+
+using f32x4 = __m128;
+
+inline f32x4 load(const float* p)
+{
+  return _mm_loadu_ps(p);
+}
+inline void store(float* p, f32x4 v)
+{
+  _mm_storeu_ps(p, v);
+}
+inline f32x4 set1(float x)
+{
+  return _mm_set1_ps(x);
+}
+inline f32x4 add(f32x4 a, f32x4 b)
+{
+  return _mm_add_ps(a, b);
+}
+inline f32x4 sub(f32x4 a, f32x4 b)
+{
+  return _mm_sub_ps(a, b);
+}
+inline f32x4 mul(f32x4 a, f32x4 b)
+{
+  return _mm_mul_ps(a, b);
+}
+inline f32x4 div(f32x4 a, f32x4 b)
+{
+  return _mm_div_ps(a, b);
+}
+inline f32x4 min(f32x4 a, f32x4 b)
+{
+  return _mm_min_ps(a, b);
+}
+inline f32x4 max(f32x4 a, f32x4 b)
+{
+  return _mm_max_ps(a, b);
+}
+inline float sum(f32x4 v)
+{
+  __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+  __m128 sums = _mm_add_ps(v, shuffled);
+  shuffled = _mm_movehl_ps(shuffled, sums);
+  return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+inline void transpose(f32x4& a, f32x4& b, f32x4& c, f32x4& d)
+{
+  _MM_TRANSPOSE4_PS(a, b, c, d);
+}
+inline void load_int16(const int16_t* p, f32x4& low, f32x4& high)
+{
+  __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  low = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+  high = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+}
+inline void store_int16(int16_t* p, f32x4 low, f32x4 high)
+{
+  // Out-of-range lanes convert to INT_MIN whatever their sign, so clamp first
+  const __m128 floor = _mm_set1_ps(-32768.0f);
+  const __m128 ceiling = _mm_set1_ps(32767.0f);
+  __m128i a = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(low, floor), ceiling));
+  __m128i b = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(high, floor), ceiling));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(a, b));
+}
+
+#elif defined(RTC_SIMD_NEON)
+
+using f32x4 = float32x4_t;
+
+inline f32x4 load(const float* p)
+{
+  return vld1q_f32(p);
+}
+inline void store(float* p, f32x4 v)
+{
+  vst1q_f32(p, v);
+}
+inline f32x4 set1(float x)
+{
+  return vdupq_n_f32(x);
+}
+inline f32x4 add(f32x4 a, f32x4 b)
+{
+  return vaddq_f32(a, b);
+}
+inline f32x4 sub(f32x4 a, f32x4 b)
+{
+  return vsubq_f32(a, b);
+}
+inline f32x4 mul(f32x4 a, f32x4 b)
+{
+  return vmulq_f32(a, b);
+}
+inline f32x4 div(f32x4 a, f32x4 b)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+  return vdivq_f32(a, b);
+#else
+  // ARMv7 has no vector divide: reciprocal estimate and two Newton steps
+  float32x4_t reciprocal = vrecpeq_f32(b);
+  reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+  reciprocal = vmulq_f32(vrecpsq_f32(b, reciprocal), reciprocal);
+  return vmulq_f32(a, reciprocal);
+#endif
+}
+inline f32x4 min(f32x4 a, f32x4 b)
+{
+  return vminq_f32(a, b);
+}
+inline f32x4 max(f32x4 a, f32x4 b)
+{
+  return vmaxq_f32(a, b);
+}
+inline float sum(f32x4 v)
+{
+  float32x2_t pair = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+  return vget_lane_f32(vpadd_f32(pair, pair), 0);
+}
+inline void transpose(f32x4& a, f32x4& b, f32x4& c, f32x4& d)
+{
+  float32x4x2_t ac = vzipq_f32(a, c);
+  float32x4x2_t bd = vzipq_f32(b, d);
+  float32x4x2_t low = vzipq_f32(ac.val[0], bd.val[0]);
+  float32x4x2_t high = vzipq_f32(ac.val[1], bd.val[1]);
+  a = low.val[0];
+  b = low.val[1];
+  c = high.val[0];
+  d = high.val[1];
+}
+inline void load_int16(const int16_t* p, f32x4& low, f32x4& high)
+{
+  int16x8_t v = vld1q_s16(p);
+  low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(v)));
+  high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(v)));
+}
+inline int32x4_t round_int32(f32x4 v)
+{
+#if defined(__aarch64__) || defined(_M_ARM64)
+  return vcvtnq_s32_f32(v);
+#else
+  // ARMv7 only truncates: add half away from zero first
+  float32x4_t half = vbslq_f32(vcltq_f32(v, vdupq_n_f32(0.0f)), vdupq_n_f32(-0.5f),
+                               vdupq_n_f32(0.5f));
+  return vcvtq_s32_f32(vaddq_f32(v, half));
+#endif
+}
+inline void store_int16(int16_t* p, f32x4 low, f32x4 high)
+{
+  // Both conversions and the narrowing saturate
+  vst1q_s16(p, vcombine_s16(vqmovn_s32(round_int32(low)), vqmovn_s32(round_int32(high))));
+}
+
+#else
+
+struct f32x4
+{
+  float v[4];
+};
+
+inline f32x4 load(const float* p)
+{
+  return {{p[0], p[1], p[2], p[3]}};
+}
+inline void store(float* p, f32x4 v)
+{
+  for (size_t i = 0; i < 4; ++i)
+  {
+    p[i] = v.v[i];
+  }
+}
+inline f32x4 set1(float x)
+{
+  return {{x, x, x, x}};
+}
+inline f32x4 add(f32x4 a, f32x4 b)
+{
+  return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+}
+inline f32x4 sub(f32x4 a, f32x4 b)
+{
+  return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+}
+inline f32x4 mul(f32x4 a, f32x4 b)
+{
+  return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+}
+inline f32x4 div(f32x4 a, f32x4 b)
+{
+  return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}};
+}
+inline f32x4 min(f32x4 a, f32x4 b)
+{
+  f32x4 r;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+  }
+  return r;
+}
+inline f32x4 max(f32x4 a, f32x4 b)
+{
+  f32x4 r;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+  }
+  return r;
+}
+inline float sum(f32x4 v)
+{
+  return (v.v[0] + v.v[1]) + (v.v[2] + v.v[3]);
+}
+inline void transpose(f32x4& a, f32x4& b, f32x4& c, f32x4& d)
+{
+  f32x4 rows[4] = {a, b, c, d};
+  for (size_t i = 0; i < 4; ++i)
+  {
+    a.v[i] = rows[i].v[0];
+    b.v[i] = rows[i].v[1];
+    c.v[i] = rows[i].v[2];
+    d.v[i] = rows[i].v[3];
+  }
+}
+inline void load_int16(const int16_t* p, f32x4& low, f32x4& high)
+{
+  for (size_t i = 0; i < 4; ++i)
+  {
+    low.v[i] = p[i];
+    high.v[i] = p[i + 4];
+  }
+}
+inline void store_int16(int16_t* p, f32x4 low, f32x4 high)
+{
+  for (size_t i = 0; i < 4; ++i)
+  {
+    p[i] = static_cast<int16_t>(std::lrint(std::fmin(std::fmax(low.v[i], -32768.0f), 32767.0f)));
+    p[i + 4] =
+        static_cast<int16_t>(std::lrint(std::fmin(std::fmax(high.v[i], -32768.0f), 32767.0f)));
+  }
+}
+
+#endif
+
+/**
+ * @brief a * b + c
+ */
+inline f32x4 mul_add(f32x4 a, f32x4 b, f32x4 c)
+{
+  return add(mul(a, b), c);
+}
+
+}  // namespace simd
+}  // namespace audio
+}  // namespace rtc
@@ -0,0 +1,193 @@
+/**
+ * @file time_stretch.cpp
+ * @brief WSOLA accelerate and preemptive expand
+ */
+
+#include "rtc/audio/time_stretch.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+constexpr int SEARCH_RATE = 8000;  // Coarse pitch search rate
+
+float normalized_correlation(const float* a, const float* b, size_t length)
+{
+  double cross = 0.0;
+  double energy_a = 0.0;
+  double energy_b = 0.0;
+  for (size_t i = 0; i < length; ++i)
+  {
+    cross += static_cast<double>(a[i]) * b[i];
+    energy_a += static_cast<double>(a[i]) * a[i];
+    energy_b += static_cast<double>(b[i]) * b[i];
+  }
+  double norm = std::sqrt(energy_a * energy_b);
+  return norm > 0.0 ? static_cast<float>(cross / norm) : 0.0f;
+}
+
+}  // namespace
+
+struct TimeStretcher::Impl
+{
+  TimeStretchConfig config;
+  size_t min_lag;
+  size_t max_lag;
+  size_t decimation;
+
+  // Scratch, sized once
+  std::vector<float> mono;
+  std::vector<float> decimated;
+
+  Impl(TimeStretchConfig cfg)
+      : config(cfg),
+        min_lag(static_cast<size_t>(config.sample_rate * MIN_PITCH_MS / 1000)),
+        max_lag(static_cast<size_t>(config.sample_rate * MAX_PITCH_MS / 1000)),
+        decimation(static_cast<size_t>(std::max(1, config.sample_rate / SEARCH_RATE))),
+        mono(2 * max_lag),
+        decimated(2 * max_lag / decimation)
+  {
+  }
+
+  /**
+   * @brief Pitch period at the start of the buffer
+   * @return Lag in samples per channel, 0 if not periodic enough
+   */
+  size_t find_period(const std::vector<int16_t>& pcm)
+  {
+    auto channels = static_cast<size_t>(config.channels);
+    if (pcm.size() < 2 * max_lag * channels)
+    {
+      return 0;
+    }
+
+    double energy = 0.0;
+    for (size_t i = 0; i < mono.size(); ++i)
+    {
+      float sum = 0.0f;
+      for (size_t c = 0; c < channels; ++c)
+      {
+        sum += pcm[i * channels + c];
+      }
+      mono[i] = sum / static_cast<float>(channels);
+      energy += static_cast<double>(mono[i]) * mono[i];
+    }
+
+    double rms = std::sqrt(energy / static_cast<double>(mono.size()));
+    if (rms < 32768.0 * std::pow(10.0, config.silence_dbfs / 20.0))
+    {
+      return max_lag;  // Nothing audible to distort
+    }
+
+    // Coarse search on a box-filtered 8 kHz copy
+    for (size_t j = 0; j < decimated.size(); ++j)
+    {
+      float sum = 0.0f;
+      for (size_t k = 0; k < decimation; ++k)
+      {
+        sum += mono[j * decimation + k];
+      }
+      decimated[j] = sum;
+    }
+
+    size_t window = max_lag / decimation;
+    size_t coarse_lag = 0;
+    float coarse_best = -1.0f;
+    for (size_t lag = std::max<size_t>(1, min_lag / decimation); lag <= window; ++lag)
+    {
+      float corr = normalized_correlation(decimated.data(), decimated.data() + lag, window);
+      if (corr > coarse_best)
+      {
+        coarse_best = corr;
+        coarse_lag = lag;
+      }
+    }
+
+    // Refine around the coarse peak at the full rate
+    size_t low = std::max(min_lag, (coarse_lag - 1) * decimation);
+    size_t high = std::min(max_lag, coarse_lag * decimation + decimation);
+    size_t best_lag = 0;
+    float best = -1.0f;
+    for (size_t lag = low; lag <= high; ++lag)
+    {
+      float corr = normalized_correlation(mono.data(), mono.data() + lag, max_lag);
+      if (corr > best)
+      {
+        best = corr;
+        best_lag = lag;
+      }
+    }
+
+    return best >= config.min_correlation ? best_lag : 0;
+  }
+};
+
+TimeStretcher::TimeStretcher(TimeStretchConfig config)
+    : impl_(std::make_unique<Impl>(std::move(config)))
+{
+}
+
+TimeStretcher::~TimeStretcher() = default;
+
+size_t TimeStretcher::min_input() const
+{
+  return 2 * impl_->max_lag;
+}
+
+size_t TimeStretcher::accelerate(std::vector<int16_t>& pcm)
+{
+  size_t lag = impl_->find_period(pcm);
+  if (lag == 0)
+  {
+    return 0;
+  }
+
+  // Fade the first period into the second, then drop the second
+  auto channels = static_cast<size_t>(impl_->config.channels);
+  for (size_t i = 0; i < lag; ++i)
+  {
+    float w = (static_cast<float>(i) + 0.5f) / static_cast<float>(lag);
+    for (size_t c = 0; c < channels; ++c)
+    {
+      float mixed = pcm[i * channels + c] * (1.0f - w) + pcm[(lag + i) * channels + c] * w;
+      pcm[i * channels + c] = static_cast<int16_t>(std::lround(mixed));
+    }
+  }
+
+  auto first = pcm.begin() + static_cast<std::ptrdiff_t>(lag * channels);
+  pcm.erase(first, first + static_cast<std::ptrdiff_t>(lag * channels));
+  return lag;
+}
+
+size_t TimeStretcher::preemptive_expand(std::vector<int16_t>& pcm)
+{
+  size_t lag = impl_->find_period(pcm);
+  if (lag == 0)
+  {
+    return 0;
+  }
+
+  // Open a period-long gap after the first period and fade the second back into the first
+  auto channels = static_cast<size_t>(impl_->config.channels);
+  pcm.insert(pcm.begin() + static_cast<std::ptrdiff_t>(lag * channels), lag * channels, 0);
+  for (size_t i = 0; i < lag; ++i)
+  {
+    float w = (static_cast<float>(i) + 0.5f) / static_cast<float>(lag);
+    for (size_t c = 0; c < channels; ++c)
+    {
+      float mixed = pcm[(2 * lag + i) * channels + c] * (1.0f - w) + pcm[i * channels + c] * w;
+      pcm[(lag + i) * channels + c] = static_cast<int16_t>(std::lround(mixed));
+    }
+  }
+  return lag;
+}
+
+}  // namespace audio
+}  // namespace rtc
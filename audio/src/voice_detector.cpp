@@ -0,0 +1,234 @@
+/**
+ * @file voice_detector.cpp
+ * @brief Speech-band energy VAD with onset confirmation and hangover
+ *
+ * The mono downmix runs through a 200 Hz high-pass and a 3.4 kHz low-pass
+ * biquad, so hum, rumble and hiss weigh little. Each 10 ms block's filtered
+ * energy is compared with a noise floor that follows quiet blocks down at
+ * once and creeps up otherwise, so steady noise is absorbed within seconds
+ * while speech, which keeps dipping between syllables, is not.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include "rtc/audio/audio_processing.h"
+
+namespace rtc
+{
+namespace audio
+{
+
+namespace
+{
+
+constexpr int BLOCK_MS = 10;
+constexpr double HIGH_PASS_HZ = 200.0;
+constexpr double LOW_PASS_HZ = 3400.0;
+
+constexpr float MARGIN_DB = 9.0f;         // Above the noise floor
+constexpr float MIN_LEVEL_DBFS = -55.0f;  // Speech-band energy, full-scale sine = -3 dB
+constexpr float FLOOR_FALL = 0.3f;        // Share of the way down per quiet block
+constexpr float FLOOR_RISE_DB = 0.03f;    // Per block: 3 dB/s
+constexpr int ONSET_BLOCKS = 2;
+
+// Direct form I biquad
+struct Biquad
+{
+  float b0 = 1.0f, b1 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+  float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+
+  // RBJ cookbook Butterworth (Q = 1/sqrt 2) sections
+  static Biquad make(double cutoff_hz, double sample_rate, bool high_pass)
+  {
+    const double pi = std::acos(-1.0);
+    double w = 2.0 * pi * cutoff_hz / sample_rate;
+    double alpha = std::sin(w) / std::sqrt(2.0);
+    double cos_w = std::cos(w);
+    double a0 = 1.0 + alpha;
+    double edge = high_pass ? (1.0 + cos_w) / 2.0 : (1.0 - cos_w) / 2.0;
+
+    Biquad f;
+    f.b0 = static_cast<float>(edge / a0);
+    f.b1 = static_cast<float>((high_pass ? -2.0 : 2.0) * edge / a0);
+    f.b2 = f.b0;
+    f.a1 = static_cast<float>(-2.0 * cos_w / a0);
+    f.a2 = static_cast<float>((1.0 - alpha) / a0);
+    return f;
+  }
+
+  float process(float x)
+  {
+    float y = b0 * x + b1 * x1 + b2 * x2 - a1 * y1 - a2 * y2;
+    x2 = x1;
+    x1 = x;
+    y2 = y1;
+    y1 = y;
+    return y;
+  }
+};
+
+}  // namespace
+
+struct VoiceActivityDetector::Impl
+{
+  VadConfig config;
+  mutable std::mutex mutex;
+  bool initialized = false;
+
+  size_t block_size = 0;
+  int hangover_blocks = 0;
+  Biquad high_pass;
+  Biquad low_pass;
+
+  double block_energy = 0.0;
+  size_t block_filled = 0;
+  float noise_floor_db = 0.0f;
+  bool floor_started = false;
+  int onset = 0;
+  int hangover = 0;
+  bool voice = false;
+  AudioBuffer scratch;  // int16 frames, deinterleaved
+
+  explicit Impl(VadConfig cfg) : config(cfg) {}
+
+  void setup()
+  {
+    block_size = static_cast<size_t>(config.sample_rate / 1000 * BLOCK_MS);
+    hangover_blocks = std::max(0, config.hangover_ms) / BLOCK_MS;
+    double rate = config.sample_rate;
+    high_pass = Biquad::make(HIGH_PASS_HZ, rate, true);
+    low_pass = Biquad::make(std::min(LOW_PASS_HZ, 0.45 * rate), rate, false);
+    scratch.reset(static_cast<size_t>(config.channels), 2 * block_size);
+
+    block_energy = 0.0;
+    block_filled = 0;
+    noise_floor_db = 0.0f;
+    floor_started = false;
+    onset = 0;
+    hangover = 0;
+    voice = false;
+  }
+
+  bool detect(const AudioBuffer& samples)
+  {
+    // A frame is speech if any block ending in it is (or its hangover covers it)
+    size_t channels = samples.channels();
+    float inverse = 1.0f / static_cast<float>(channels);
+    bool speech = hangover > 0;
+    for (size_t i = 0; i < samples.frames(); ++i)
+    {
+      float sum = 0.0f;
+      for (size_t c = 0; c < channels; ++c)
+      {
+        sum += samples.channel(c)[i];
+      }
+      float y = low_pass.process(high_pass.process(sum * inverse));
+      block_energy += static_cast<double>(y) * y;
+
+      if (++block_filled == block_size)
+      {
+        end_block();
+        speech = speech || hangover > 0;
+      }
+    }
+    voice = speech;
+    return speech;
+  }
+
+  void end_block()
+  {
+    auto mean = static_cast<float>(block_energy / static_cast<double>(block_size));
+    float energy_db = 10.0f * std::log10(mean + 1e-12f);
+    block_energy = 0.0;
+    block_filled = 0;
+
+    // The first block seeds the floor; a speech start drops it at the first pause
+    if (!floor_started)
+    {
+      noise_floor_db = energy_db;
+      floor_started = true;
+    }
+    else if (energy_db < noise_floor_db)
+    {
+      noise_floor_db += FLOOR_FALL * (energy_db - noise_floor_db);
+    }
+    else
+    {
+      noise_floor_db += FLOOR_RISE_DB;
+    }
+
+    bool loud = energy_db > noise_floor_db + MARGIN_DB && energy_db > MIN_LEVEL_DBFS;
+    onset = loud ? onset + 1 : 0;
+    if (onset >= ONSET_BLOCKS)
+    {
+      hangover = hangover_blocks + 1;
+    }
+    else if (hangover > 0)
+    {
+      --hangover;
+    }
+  }
+};
+
+VoiceActivityDetector::VoiceActivityDetector(VadConfig config)
+    : impl_(std::make_unique<Impl>(config))
+{
+}
+
+VoiceActivityDetector::~VoiceActivityDetector() = default;
+
+bool VoiceActivityDetector::initialize()
+{
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->config.sample_rate < 8000 || impl_->config.sample_rate % 1000 != 0 ||
+      impl_->config.channels < 1)
+  {
+    return false;
+  }
+  impl_->setup();
+  impl_->initialized = true;
+  return true;
+}
+
+bool VoiceActivityDetector::process(std::span<const int16_t> samples)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return false;
+  }
+  d.scratch.copy_from(samples);
+  return d.detect(d.scratch);
+}
+
+bool VoiceActivityDetector::process(const AudioBuffer& samples)
+{
+  auto& d = *impl_;
+  std::lock_guard lock(d.mutex);
+  if (!d.initialized)
+  {
+    return false;
+  }
+  return d.detect(samples);
+}
+
+bool VoiceActivityDetector::is_voice_detected() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->voice;
+}
+
+void VoiceActivityDetector::reset()
+{
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->initialized)
+  {
+    impl_->setup();
+  }
+}
+
+}  // namespace audio
+}  // namespace rtc
@@ -52,7 +52,8 @@ struct RecoveryConfig
   float backoff_multiplier = 2.0f;
   int max_attempts = 10;
   bool enable_ice_restart = true;
-  std::chrono::seconds connection_timeout{10};
+  std::chrono::seconds connection_timeout{10};  // Also bounds an ICE restart
+  float full_bitrate_ratio = 0.95f;  // Share of the pre-outage bitrate that counts as recovered
 };
 
 /**
@@ -65,6 +66,7 @@ enum class RecoveryEvent
   RECONNECTED,
   FAILED,
   ICE_RESTART,
+  PATH_SWITCHED,  // Failed over to a standby pair without reconnecting
 };
 
 /**
@@ -81,8 +83,12 @@ struct RecoveryStats
   size_t reconnect_success = 0;
   size_t reconnect_failed = 0;
   size_t ice_restarts = 0;
+  size_t path_switches = 0;  // Hitless failovers to a standby pair
   std::chrono::milliseconds total_downtime{0};
   std::chrono::milliseconds average_recovery_time{0};
+  std::chrono::milliseconds last_recovery_time{0};
+  std::chrono::milliseconds average_bitrate_recovery_time{0};  // Reconnect to full bitrate
+  std::chrono::milliseconds last_path_switch_outage{0};  // Silence on the old pair
 };
 
 /**
@@ -90,7 +96,12 @@ struct RecoveryStats
  *
  * Handles:
  * - Automatic reconnection with backoff
- * - ICE restart for network changes
+ * - Failover between pre-validated candidate pairs (IceAgent standbys),
+ *   which never enters RECONNECTING
+ * - ICE restart for network changes, keeping media state (jitter
+ *   buffers, bitrate estimates, forwarding state) and swapping only the
+ *   transport pair; falls back to full reconnection after
+ *   connection_timeout
  * - Network quality monitoring
  * - Failover to backup servers
  */
@@ -106,6 +117,10 @@ class ConnectionRecovery
 
   /**
    * @brief Set recovery callback
+   *
+   * Events are delivered in order from the shared TaskScheduler, never on
+   * the timer wheel thread or with internal locks held. The destructor
+   * drops undelivered events and waits for a callback that is running.
    */
   void set_callback(RecoveryCallback callback);
 
@@ -116,9 +131,43 @@ class ConnectionRecovery
 
   /**
    * @brief Report network change (e.g., WiFi <-> Mobile)
+   *
+   * Starts an ICE restart when connectivity is available. To restart only
+   * the sessions a change affects, use NetworkMonitor::watch() instead.
    */
   void on_network_change(bool has_connectivity);
 
+  /**
+   * @brief Start an ICE restart
+   *
+   * Emits ICE_RESTART; the handler calls IceAgent::restart() and
+   * re-signals credentials while media objects stay as they are. Completes
+   * with on_reconnected(); after connection_timeout it falls back to
+   * start_recovery().
+   *
+   * @return False if disabled or a restart is already running
+   */
+  bool start_ice_restart(const std::string& reason = "");
+
+  /**
+   * @brief Report a failover to a standby pair (see IceAgent::set_recovery)
+   *
+   * Emits PATH_SWITCHED and leaves the state CONNECTED. If the path had
+   * already been reported down, or a restart or reconnection is running,
+   * this completes it like on_reconnected() since a working pair exists.
+   *
+   * @param outage How long the old pair was silent before the switch
+   */
+  void on_path_switched(std::chrono::milliseconds outage, const std::string& reason = "");
+
+  /**
+   * @brief Report the current send bitrate
+   *
+   * Used to measure how long after a recovery the bitrate climbs back to
+   * full_bitrate_ratio of its value before the outage.
+   */
+  void on_bitrate(uint64_t bitrate_bps);
+
   /**
    * @brief Start recovery process
    * @return True if recovery started
@@ -127,11 +176,15 @@ class ConnectionRecovery
 
   /**
    * @brief Cancel ongoing recovery
+   *
+   * Waits for a timer callback that is running and keeps it from arming
+   * another, so the object may be destroyed afterwards. start_recovery()
+   * or start_ice_restart() lifts the cancel.
    */
   void cancel_recovery();
 
   /**
-   * @brief Report successful reconnection
+   * @brief Report successful reconnection (new pair selected)
    */
   void on_reconnected();
 
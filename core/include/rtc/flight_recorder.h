@@ -0,0 +1,206 @@
+#pragma once
+
+/**
+ * @file flight_recorder.h
+ * @brief Always-on binary recorder for hot-path media events
+ *
+ * Keeps the last few thousand events of every thread (drops, layer
+ * switches, PLI/NACK, queue overflows, state changes) so the seconds
+ * before a freeze can be reconstructed after the fact. Dumps are decoded
+ * with tools/flight_decode.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rtc
+{
+
+/**
+ * @brief Event kinds; arg0/arg1 meaning is listed per kind
+ */
+enum class FlightEventType : uint8_t
+{
+  PACKET_DROP,     // arg0 = FlightDropReason, arg1 = sequence number or count
+  LAYER_SWITCH,    // arg0 = old layer, arg1 = new layer
+  PLI,             // Keyframe requested
+  NACK,            // arg0 = first sequence number, arg1 = count
+  QUEUE_OVERFLOW,  // arg0 = queue depth, arg1 = limit
+  STATE_CHANGE,    // arg0 = old state, arg1 = new state (source specific)
+  TRIGGER,         // Anomaly trigger; arg0 = hash of the reason
+};
+
+/**
+ * @brief Component that recorded an event
+ */
+enum class FlightSource : uint8_t
+{
+  APP,
+  FORWARDER,
+  PACER,
+  JITTER_BUFFER,
+  VIDEO_RECEIVER,
+  OVERLOAD,
+};
+
+/**
+ * @brief Why a packet was dropped
+ */
+enum class FlightDropReason : uint8_t
+{
+  UNKNOWN_SSRC,
+  QUEUE_FULL,
+  DUPLICATE,
+  LOST,  // Gap detected at playout; arg1 = packets missing
+};
+
+const char* flight_event_name(FlightEventType type);
+const char* flight_source_name(FlightSource source);
+const char* flight_drop_reason_name(FlightDropReason reason);
+
+/**
+ * @brief One event, as stored in rings and dump files (32 bytes)
+ */
+struct FlightRecord
+{
+  int64_t time_ns = 0;  // steady_clock (rings hold raw ticks until dumped)
+  FlightEventType type = FlightEventType::TRIGGER;
+  FlightSource source = FlightSource::APP;
+  uint16_t thread = 0;  // Ring index, stable while the thread lives
+  uint32_t ssrc = 0;
+  uint64_t arg0 = 0;
+  uint64_t arg1 = 0;
+};
+static_assert(sizeof(FlightRecord) == 32);
+
+/**
+ * @brief Dump file header (64 bytes, host byte order), followed by
+ *        record_count FlightRecords sorted by time
+ */
+struct FlightDumpHeader
+{
+  char magic[8] = {'R', 'T', 'C', 'F', 'L', 'I', 'T', 'E'};
+  uint32_t version = 1;
+  uint32_t record_size = sizeof(FlightRecord);
+  uint64_t record_count = 0;
+  int64_t steady_ns = 0;  // steady_clock when dumped
+  int64_t wall_ns = 0;    // system_clock (Unix epoch) at the same instant
+  char reason[24] = {};
+};
+static_assert(sizeof(FlightDumpHeader) == 64);
+
+/**
+ * @brief Flight recorder configuration
+ */
+struct FlightRecorderConfig
+{
+  std::string dump_directory = ".";  // Where trigger()/signal dumps go
+  std::chrono::seconds min_trigger_interval{30};  // Rate limit for trigger()
+};
+
+/**
+ * @brief Flight recorder statistics
+ */
+struct FlightRecorderStats
+{
+  uint64_t dumps_written = 0;
+  uint64_t triggers_suppressed = 0;  // Within min_trigger_interval
+  std::string last_dump_path;
+};
+
+/**
+ * @brief Process-wide flight recorder
+ *
+ * record() writes into the calling thread's single-writer ring: a
+ * thread-local lookup, a TSC read and a handful of relaxed stores,
+ * with no locks or allocation. Older events are overwritten.
+ *
+ * Usage:
+ * @code
+ * FlightRecorder::record(FlightEventType::PLI, FlightSource::VIDEO_RECEIVER, ssrc);
+ * // On a customer-visible anomaly
+ * FlightRecorder::shared().trigger("freeze");
+ * @endcode
+ */
+class FlightRecorder
+{
+ public:
+  static constexpr size_t RING_CAPACITY = 8192;  // Events kept per thread
+
+  /**
+   * @brief The process-wide recorder
+   */
+  static FlightRecorder& shared();
+
+  /**
+   * @brief Record an event on the calling thread
+   */
+  static void record(FlightEventType type, FlightSource source, uint32_t ssrc = 0,
+                     uint64_t arg0 = 0, uint64_t arg1 = 0);
+
+  // Disable copy
+  FlightRecorder(const FlightRecorder&) = delete;
+  FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+  void configure(FlightRecorderConfig config);
+
+  /**
+   * @brief Write every ring to a dump file
+   * @return False if the file cannot be written
+   */
+  bool dump(const std::string& path, std::string_view reason = "manual");
+
+  /**
+   * @brief Record a TRIGGER event and dump to dump_directory in the background
+   *
+   * Suppressed if the previous trigger was less than min_trigger_interval ago.
+   *
+   * @return False if suppressed
+   */
+  bool trigger(std::string_view reason);
+
+  /**
+   * @brief Dump to dump_directory whenever signum is received (POSIX)
+   *
+   * The handler only sets a flag; the dump runs on TaskScheduler::shared().
+   *
+   * @return False if a handler is already installed
+   */
+  bool install_signal_handler(int signum);
+
+  /**
+   * @brief Get statistics
+   */
+  [[nodiscard]] FlightRecorderStats stats() const;
+
+ private:
+  FlightRecorder();
+  ~FlightRecorder();
+
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/**
+ * @brief Read a dump file written by FlightRecorder::dump
+ * @return False if the file is missing, truncated or not a dump
+ */
+bool read_flight_dump(const std::string& path, FlightDumpHeader& header,
+                      std::vector<FlightRecord>& records);
+
+/**
+ * @brief Render records as a timeline, one event per line
+ *
+ * Times are relative to the dump, so the last seconds before a freeze
+ * read as negative offsets.
+ *
+ * @param ssrc Only events for this SSRC (0 = all)
+ */
+std::string format_flight_timeline(const FlightDumpHeader& header,
+                                   const std::vector<FlightRecord>& records, uint32_t ssrc = 0);
+
+}  // namespace rtc
@@ -7,6 +7,8 @@
  * Monitors server and connection health with automatic recovery.
  */
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <functional>
@@ -17,6 +19,8 @@
 namespace rtc
 {
 
+class MetricsExporter;
+
 /**
  * @brief Health status levels
  */
@@ -41,6 +45,18 @@ struct ComponentHealth
   float load_percent = 0.0f;
 };
 
+/**
+ * @brief Per-thread CPU and scheduling health
+ */
+struct ThreadHealth
+{
+  std::string name;  // Loop probe name, else the kernel thread name
+  int tid = 0;
+  float cpu_percent = 0.0f;        // Of one core over the last interval
+  float run_delay_percent = 0.0f;  // Runnable but waiting for a CPU
+  std::chrono::microseconds loop_lag{0};  // Worst wakeup lag (probed loops only)
+};
+
 /**
  * @brief System health summary
  */
@@ -48,6 +64,7 @@ struct SystemHealth
 {
   HealthStatus overall_status = HealthStatus::HEALTHY;
   std::vector<ComponentHealth> components;
+  std::vector<ThreadHealth> threads;  // Busiest first
   float cpu_usage_percent = 0.0f;
   float memory_usage_percent = 0.0f;
   size_t active_connections = 0;
@@ -75,14 +92,103 @@ struct HealthMonitorConfig
   float cpu_critical_threshold = 95.0f;
   float memory_warning_threshold = 80.0f;
   float memory_critical_threshold = 95.0f;
+  float thread_cpu_warning_threshold = 85.0f;  // One thread close to a full core
+  float thread_cpu_critical_threshold = 98.0f;
+  std::chrono::milliseconds loop_lag_warning{20};
+  std::chrono::milliseconds loop_lag_critical{100};
   bool enable_auto_recovery = true;
 };
 
+/**
+ * @brief Wakeup-lag probe for one event loop thread
+ *
+ * The loop reports each wakeup together with the time it was due; the
+ * difference is how long the thread waited for a CPU (or was blocked by
+ * the previous iteration). Probes are process-wide so media threads need
+ * no reference to a HealthMonitor; every monitor reports all live probes.
+ * The worst lag is kept per 100 ms window for the last 6.4 s and each
+ * monitor reads the windows since its own previous check, so monitors do
+ * not consume each other's readings.
+ *
+ * Usage:
+ * @code
+ * auto probe = LoopLagProbe::create("audio_playout");
+ * while (running) {
+ *   auto deadline = std::chrono::steady_clock::now() + 10ms;
+ *   std::this_thread::sleep_until(deadline);
+ *   probe->tick(deadline);
+ * }
+ * @endcode
+ */
+class LoopLagProbe
+{
+ public:
+  /**
+   * @brief Register a probe; it is unregistered when the last handle is released
+   */
+  static std::shared_ptr<LoopLagProbe> create(std::string name);
+
+  ~LoopLagProbe() = default;
+
+  // Disable copy
+  LoopLagProbe(const LoopLagProbe&) = delete;
+  LoopLagProbe& operator=(const LoopLagProbe&) = delete;
+
+  /**
+   * @brief Report a wakeup that was due at deadline (lock-free)
+   *
+   * Must be called from the loop thread, which is what ties the lag to
+   * that thread's CPU accounting. A periodic pool task may tick from any
+   * worker; the probe follows the latest one. Ticks of one probe must not
+   * run concurrently.
+   */
+  void tick(std::chrono::steady_clock::time_point deadline);
+
+  [[nodiscard]] const std::string& name() const { return name_; }
+
+  /**
+   * @brief Process-unique number telling apart probes of the same name
+   */
+  [[nodiscard]] uint64_t instance() const { return instance_; }
+
+  /**
+   * @brief Kernel thread ID of the last tick (0 until the first)
+   */
+  [[nodiscard]] int thread_id() const { return tid_.load(std::memory_order_relaxed); }
+
+ private:
+  friend class HealthMonitor;
+  LoopLagProbe(std::string name, uint64_t instance)
+      : name_(std::move(name)), instance_(instance)
+  {
+  }
+
+  static constexpr size_t LAG_WINDOWS = 64;
+  static constexpr std::chrono::milliseconds LAG_WINDOW{100};
+
+  // Worst lag in the windows from `window` up to the current one, which
+  // becomes the new `window`; each reader keeps its own cursor
+  std::chrono::microseconds max_lag_since(int64_t& window) const;
+
+  struct LagWindow
+  {
+    std::atomic<int64_t> index{-1};  // Window number held, -1 while rewritten
+    std::atomic<int64_t> max_lag_us{0};
+  };
+
+  std::string name_;
+  uint64_t instance_;
+  std::atomic<int> tid_{0};
+  std::array<LagWindow, LAG_WINDOWS> windows_;
+};
+
 /**
  * @brief Health monitoring system
  *
  * Monitors:
  * - CPU and memory usage
+ * - Per-thread CPU and run-queue delay (Linux /proc/self/task)
+ * - Event loop wakeup lag (see LoopLagProbe)
  * - Network connectivity
  * - Component latencies
  * - Connection states
@@ -99,6 +205,9 @@ class HealthMonitor
 
   /**
    * @brief Start monitoring
+   *
+   * Checks once on the calling thread, then every check_interval on the
+   * shared TaskScheduler.
    */
   void start();
 
@@ -119,9 +228,18 @@ class HealthMonitor
 
   /**
    * @brief Set callback for health changes
+   *
+   * Runs on the checking thread without the monitor's lock held.
    */
   void set_health_callback(HealthChangeCallback callback);
 
+  /**
+   * @brief Publish CPU, per-thread and loop lag gauges on each check
+   *
+   * The exporter must outlive the monitor or be reset with nullptr.
+   */
+  void set_metrics_exporter(MetricsExporter* exporter);
+
   /**
    * @brief Get current system health
    */
@@ -20,6 +20,8 @@ namespace rtc
 {
 
 struct SocketAddress;
+struct NetworkChange;
+class ConnectionRecovery;
 class UdpSocket;
 class StunClient;
 class TurnClient;
@@ -83,11 +85,17 @@ struct IceCandidatePair
     FAILED,
   };
   State state = State::FROZEN;
+  bool nominated = false;  // USE-CANDIDATE seen (controlled) or sent (controlling)
 
   // Stats
-  std::chrono::milliseconds rtt{0};
+  std::chrono::milliseconds rtt{0};  // Smoothed over checks
   size_t bytes_sent = 0;
   size_t bytes_received = 0;
+
+  // Liveness, kept up after selection for failover
+  std::chrono::steady_clock::time_point last_check_sent;
+  std::chrono::steady_clock::time_point last_activity;  // Last response or packet from remote
+  std::string route_source;  // Local address the pair sends from (set on selection)
 };
 
 /**
@@ -134,6 +142,16 @@ struct IceCredentials
   [[nodiscard]] static IceCredentials generate();
 };
 
+/**
+ * @brief What a network change means for an agent
+ */
+enum class IceNetworkAction
+{
+  NONE,      // Selected path unaffected
+  SWITCHED,  // Moved to a standby pair (on_failover was called)
+  RESTART,   // New candidates needed: start an ICE restart
+};
+
 /**
  * @brief ICE agent callbacks
  */
@@ -143,6 +161,7 @@ struct IceAgentCallbacks
   std::function<void(IceGatheringState)> on_gathering_state_change;
   std::function<void(IceConnectionState)> on_connection_state_change;
   std::function<void(const IceCandidatePair&)> on_selected_pair;
+  std::function<void(const IceCandidatePair& from, const IceCandidatePair& to)> on_failover;
   std::function<void(std::span<const uint8_t>, const SocketAddress&)> on_data;
 };
 
@@ -174,8 +193,17 @@ class IceAgent
     std::chrono::milliseconds keepalive_interval{15000};
     std::chrono::seconds nomination_timeout{10};
 
+    // Failover to pre-validated standby pairs
+    size_t standby_pairs = 2;                                // Kept warm besides the selected one
+    std::chrono::milliseconds standby_check_interval{2500};  // Checks per standby pair
+    std::chrono::milliseconds consent_check_interval{500};   // Checks on the selected pair
+    int failover_lost_checks = 2;                            // Unanswered checks before switching
+    std::chrono::milliseconds failover_silence{1000};        // Or this long without a packet
+    std::chrono::milliseconds disconnect_timeout{5000};  // Silent with no standby: DISCONNECTED
+
     // Candidate type preferences
     bool gather_host_candidates = true;
+    std::vector<std::string> host_addresses;  // One socket each; empty = non-loopback IPv4
     bool gather_srflx_candidates = true;
     bool gather_relay_candidates = true;
   };
@@ -188,6 +216,15 @@ class IceAgent
    */
   void set_callbacks(IceAgentCallbacks callbacks);
 
+  /**
+   * @brief Report failovers and completed restarts to a recovery manager
+   *
+   * Failovers go to ConnectionRecovery::on_path_switched(), a restart that
+   * nominates a new pair to on_reconnected(). Independent of the callbacks;
+   * nullptr detaches. NetworkMonitor::watch() attaches its recovery.
+   */
+  void set_recovery(ConnectionRecovery* recovery);
+
   /**
    * @brief Get local credentials
    */
@@ -233,6 +270,38 @@ class IceAgent
    */
   [[nodiscard]] std::optional<IceCandidatePair> selected_pair() const;
 
+  /**
+   * @brief Restart ICE (RFC 8445 Section 9) without tearing down media
+   *
+   * Generates new local credentials and drops remote candidates and
+   * pairs, then gathers again on the host addresses present now: sockets
+   * are bound on new addresses and closed on removed ones (unless
+   * Config::host_addresses pins them). The selected pair keeps
+   * carrying media until checks with the new credentials nominate a
+   * replacement, which is reported through on_selected_pair; the
+   * connection state only leaves CONNECTED if there was no selected pair.
+   * Signal local_credentials() and the new candidates to the peer, then
+   * feed its new credentials and candidates as for the initial exchange.
+   */
+  void restart();
+
+  /**
+   * @brief Check if a restart is waiting for a new pair to be nominated
+   */
+  [[nodiscard]] bool is_restarting() const;
+
+  /**
+   * @brief React to a local address or link change (see NetworkMonitor)
+   *
+   * If the change takes away the address the selected pair sends from,
+   * fails over at once to a standby pair that is still routable;
+   * otherwise asks for a restart. An address or link coming up asks for a
+   * restart while DISCONNECTED or FAILED; a new address also asks for one
+   * while connected without a live standby pair, so the session gathers
+   * a candidate on it before the selected path fails.
+   */
+  IceNetworkAction on_network_change(const NetworkChange& change);
+
   /**
    * @brief Send data over selected pair
    * @param data Data to send
@@ -244,12 +313,32 @@ class IceAgent
    * @brief Process incoming packet
    * @param data Raw packet data
    * @param source Source address
+   * @param local Address it arrived on, the base of a local candidate
    * @return True if packet was handled (STUN/data)
    */
+  bool process_packet(std::span<const uint8_t> data, const SocketAddress& source,
+                      const SocketAddress& local);
+
+  /**
+   * @brief Process a packet that arrived on the first host candidate's socket
+   */
   bool process_packet(std::span<const uint8_t> data, const SocketAddress& source);
 
   /**
    * @brief Periodic processing (call from event loop)
+   *
+   * Reads pending packets from the agent's sockets, then paces
+   * connectivity checks and their retransmissions. Each pair sends from
+   * the socket of its local candidate; RTT is sampled only from checks
+   * answered without a retransmission (Karn's algorithm).
+   *
+   * Once connected, keeps checking the selected pair and up to
+   * standby_pairs other succeeded pairs. When the selected pair loses
+   * failover_lost_checks checks in a row or goes failover_silence
+   * without a packet, switches to the freshest standby with the lowest
+   * RTT (nominating it if controlling) and reports on_failover; the
+   * connection state stays CONNECTED. Only without a usable standby does
+   * it report DISCONNECTED, after disconnect_timeout.
    */
   void process();
 
@@ -267,6 +356,12 @@ class IceAgent
     size_t connectivity_checks_sent = 0;
     size_t connectivity_checks_received = 0;
     std::chrono::milliseconds time_to_connected{0};
+    size_t ice_restarts = 0;           // Restarts completed with a new pair
+    size_t stale_checks_rejected = 0;  // Checks using old credentials
+    size_t unauthenticated_rejected = 0;  // Bad or missing MESSAGE-INTEGRITY/FINGERPRINT
+    std::chrono::milliseconds last_restart_duration{0};
+    size_t failovers = 0;  // Switches to a standby pair
+    std::chrono::milliseconds last_failover_outage{0};  // Last packet on the old pair to switch
   };
   [[nodiscard]] Stats stats() const;
 
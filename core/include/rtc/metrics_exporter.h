@@ -5,11 +5,13 @@
  * @brief Prometheus metrics exporter for monitoring
  */
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace rtc
 {
@@ -35,16 +37,108 @@ using Labels = std::unordered_map<std::string, std::string>;
  */
 struct MetricsConfig
 {
+  std::string bind_address = "0.0.0.0";
   uint16_t port = 9090;
   std::string path = "/metrics";
   std::string namespace_prefix = "rtc";
   bool enable_default_metrics = true;  // CPU, memory, etc.
 };
 
+struct CounterShards;
+
+/**
+ * @brief Handle to a registered counter series
+ *
+ * inc() is a relaxed add on the calling thread's cache-line-padded shard;
+ * shards are only summed when metrics are scraped. A default-constructed
+ * handle is invalid and ignores increments.
+ */
+class MetricCounter
+{
+ public:
+  MetricCounter() = default;
+
+  void inc(double value = 1.0) const;
+
+  [[nodiscard]] bool valid() const { return shards_ != nullptr; }
+
+ private:
+  friend class MetricsExporter;
+  MetricCounter(CounterShards* shards, uint32_t index) : shards_(shards), index_(index) {}
+
+  CounterShards* shards_ = nullptr;
+  uint32_t index_ = 0;
+};
+
+/**
+ * @brief Handle to a registered gauge series
+ *
+ * Gauges hold a single atomic value (set() cannot be sharded).
+ */
+class MetricGauge
+{
+ public:
+  MetricGauge() = default;
+
+  void set(double value) const;
+  void inc(double value = 1.0) const;
+  void dec(double value = 1.0) const { inc(-value); }
+
+  [[nodiscard]] bool valid() const { return value_ != nullptr; }
+
+ private:
+  friend class MetricsExporter;
+  explicit MetricGauge(std::atomic<double>* value) : value_(value) {}
+
+  std::atomic<double>* value_ = nullptr;
+};
+
+struct HistogramCells;
+
+/**
+ * @brief Handle to a registered histogram or summary series
+ *
+ * Log-linear (HDR-style) buckets: 16 linear sub-buckets per power of two,
+ * so any recorded value is reproduced within 6.25% relative error (up to
+ * 2^32 times the resolution; larger values are clamped).
+ * observe() is a relaxed increment on the calling thread's shard.
+ */
+class MetricHistogram
+{
+ public:
+  MetricHistogram() = default;
+
+  void observe(double value) const;
+
+  /**
+   * @brief Estimate a quantile across all shards (scrape-time cost)
+   * @param q Quantile in [0, 1]
+   * @return NaN if nothing has been observed
+   */
+  [[nodiscard]] double quantile(double q) const;
+
+  [[nodiscard]] bool valid() const { return cells_ != nullptr; }
+
+ private:
+  friend class MetricsExporter;
+  explicit MetricHistogram(HistogramCells* cells) : cells_(cells) {}
+
+  HistogramCells* cells_ = nullptr;
+};
+
 /**
  * @brief Prometheus-compatible metrics exporter
  *
  * Exports metrics in Prometheus format for monitoring.
+ *
+ * Hot paths should register once and keep the handle:
+ * @code
+ * auto sent = exporter.register_counter("packets_sent_total", {{"type", "video"}});
+ * sent.inc();  // per packet, lock-free
+ * @endcode
+ *
+ * The name-based operations below look the series up under a mutex on
+ * every call and are meant for infrequent updates.
  */
 class MetricsExporter
 {
@@ -57,7 +151,12 @@ class MetricsExporter
   MetricsExporter& operator=(const MetricsExporter&) = delete;
 
   /**
-   * @brief Start HTTP metrics server
+   * @brief Start HTTP metrics server on config.port
+   *
+   * Scrapes are rendered on the server thread from published series and
+   * never block threads recording through handles.
+   *
+   * @return False if already started or the port cannot be bound
    */
   bool start();
 
@@ -66,6 +165,49 @@ class MetricsExporter
    */
   void stop();
 
+  /**
+   * @brief Register (or look up) a counter series
+   * @return Invalid handle if the name is registered with another type
+   *         or the counter table is full
+   */
+  MetricCounter register_counter(const std::string& name, const Labels& labels = {});
+
+  /**
+   * @brief Register (or look up) a gauge series
+   * @return Invalid handle if the name is registered with another type
+   */
+  MetricGauge register_gauge(const std::string& name, const Labels& labels = {});
+
+  /**
+   * @brief Drop a gauge series from scrapes, e.g. one labelled with an ID
+   *        that is gone
+   *
+   * Its slot is reused by the next new gauge series, so handles to it
+   * must not be used afterwards.
+   */
+  void unregister_gauge(const std::string& name, const Labels& labels = {});
+
+  /**
+   * @brief Register (or look up) a histogram series
+   *
+   * Exported as _bucket (power-of-two boundaries), _sum and _count.
+   *
+   * @param resolution Smallest distinguishable value, in the metric's unit
+   * @return Invalid handle if the name is registered with another type
+   */
+  MetricHistogram register_histogram(const std::string& name, const Labels& labels = {},
+                                     double resolution = 0.001);
+
+  /**
+   * @brief Register (or look up) a summary series
+   *
+   * Same storage as a histogram, exported as quantile estimates plus _sum
+   * and _count. Quantiles and resolution are fixed by the first registration.
+   */
+  MetricHistogram register_summary(const std::string& name, const Labels& labels = {},
+                                   std::vector<double> quantiles = {0.5, 0.9, 0.99},
+                                   double resolution = 0.001);
+
   // Counter operations
   void counter_inc(const std::string& name, const Labels& labels = {}, double value = 1.0);
 
@@ -88,6 +230,14 @@ class MetricsExporter
   void set_active_rooms(size_t count);
   void set_active_participants(size_t count);
 
+  // Pre-defined media pipeline histograms (milliseconds); pass the handles
+  // to the components that record them
+  MetricHistogram forwarding_latency_histogram();
+  MetricHistogram jitter_buffer_delay_histogram();
+  MetricHistogram encode_time_histogram(const std::string& media_type);
+  MetricHistogram pacer_delay_histogram();
+  MetricHistogram pipeline_stage_histogram(const std::string& stage);  // @see PacketTracer
+
   /**
    * @brief Get metrics in Prometheus format
    */
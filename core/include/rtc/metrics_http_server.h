@@ -0,0 +1,77 @@
+#pragma once
+
+/**
+ * @file metrics_http_server.h
+ * @brief Minimal non-blocking HTTP/1.1 server for Prometheus scrapes
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace rtc
+{
+
+/**
+ * @brief Metrics HTTP server configuration
+ */
+struct MetricsHttpServerConfig
+{
+  std::string bind_address = "0.0.0.0";
+  uint16_t port = 9090;  // 0 = pick an ephemeral port
+  std::string path = "/metrics";
+  size_t max_connections = 16;
+  std::chrono::milliseconds idle_timeout{5000};
+};
+
+/**
+ * @brief Renders the response body (appends to an empty, reused buffer)
+ */
+using MetricsRenderCallback = std::function<void(std::string& body)>;
+
+/**
+ * @brief Single-threaded poll()-based HTTP server
+ *
+ * Serves GET/HEAD on the configured path and closes each connection after
+ * the response. Rendering runs on the server thread, so a large scrape
+ * never executes on a media thread.
+ */
+class MetricsHttpServer
+{
+ public:
+  explicit MetricsHttpServer(MetricsHttpServerConfig config = {});
+  ~MetricsHttpServer();
+
+  // Disable copy
+  MetricsHttpServer(const MetricsHttpServer&) = delete;
+  MetricsHttpServer& operator=(const MetricsHttpServer&) = delete;
+
+  /**
+   * @brief Bind, listen and start the server thread
+   * @return False if already running or the port cannot be bound
+   */
+  bool start(MetricsRenderCallback render);
+
+  /**
+   * @brief Stop the server thread and close all connections
+   */
+  void stop();
+
+  /**
+   * @brief Check if running
+   */
+  [[nodiscard]] bool is_running() const;
+
+  /**
+   * @brief Port actually bound (useful when configured with port 0)
+   */
+  [[nodiscard]] uint16_t port() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace rtc
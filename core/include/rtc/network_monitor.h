@@ -0,0 +1,160 @@
+#pragma once
+
+/**
+ * @file network_monitor.h
+ * @brief Real-time detection of local address and link changes
+ *
+ * Listens to rtnetlink (Linux) so a roaming event (Wi-Fi to LTE, cable
+ * unplugged) reaches the affected ICE sessions as it happens instead of
+ * after consent or reconnect timeouts.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace rtc
+{
+
+struct SocketAddress;
+class IceAgent;
+class ConnectionRecovery;
+
+/**
+ * @brief Kind of network change
+ */
+enum class NetworkChangeType
+{
+  ADDRESS_ADDED,
+  ADDRESS_REMOVED,
+  LINK_UP,
+  LINK_DOWN,
+};
+
+/**
+ * @brief One network change
+ */
+struct NetworkChange
+{
+  NetworkChangeType type = NetworkChangeType::ADDRESS_ADDED;
+  int interface_index = 0;
+  std::string interface_name;
+  std::vector<std::string> addresses;  // The address, or all addresses of the link
+};
+
+/**
+ * @brief Network change callback
+ */
+using NetworkChangeCallback = std::function<void(const NetworkChange&)>;
+
+/**
+ * @brief Network monitor statistics
+ */
+struct NetworkMonitorStats
+{
+  uint64_t messages = 0;  // Netlink messages parsed
+  uint64_t changes = 0;   // Changes dispatched
+  uint64_t resyncs = 0;   // Full address dumps after a receive overflow
+  uint64_t sessions_restarted = 0;  // ICE restarts started by watch()
+};
+
+/**
+ * @brief rtnetlink listener for address and link changes
+ *
+ * Not a thread of its own: add native_handle() to the event loop that
+ * runs the ICE agents and call process() when it is readable (or on each
+ * loop iteration; it never blocks). Callbacks run inside process(), on
+ * that thread. On platforms without rtnetlink, start() returns false.
+ *
+ * Usage:
+ * @code
+ * NetworkMonitor monitor;
+ * monitor.start();
+ * monitor.watch(agent, recovery);  // Per session
+ * // Event loop
+ * monitor.process();
+ * agent.process();
+ * @endcode
+ */
+class NetworkMonitor
+{
+ public:
+  NetworkMonitor();
+  ~NetworkMonitor();
+
+  // Disable copy
+  NetworkMonitor(const NetworkMonitor&) = delete;
+  NetworkMonitor& operator=(const NetworkMonitor&) = delete;
+
+  /**
+   * @brief Open the netlink socket and load the current addresses
+   * @return False if unsupported or the socket cannot be opened
+   */
+  bool start();
+
+  /**
+   * @brief Close the netlink socket
+   */
+  void stop();
+
+  /**
+   * @brief Descriptor to poll for readability (-1 when stopped)
+   */
+  [[nodiscard]] intptr_t native_handle() const;
+
+  /**
+   * @brief Read pending netlink messages and dispatch changes
+   * @return Number of changes dispatched
+   */
+  size_t process();
+
+  /**
+   * @brief Receive every change
+   * @return Subscription ID for unsubscribe()
+   */
+  uint64_t subscribe(NetworkChangeCallback callback);
+
+  /**
+   * @brief Route changes to one ICE session
+   *
+   * Each change goes to IceAgent::on_network_change(), which switches to
+   * a standby pair itself when one survives (reported through its
+   * on_failover callback and, via IceAgent::set_recovery(), to
+   * ConnectionRecovery::on_path_switched()). Sessions that need new
+   * candidates get ConnectionRecovery::start_ice_restart(). Unaffected
+   * sessions are left alone. Both objects must outlive the subscription.
+   *
+   * @return Subscription ID for unsubscribe()
+   */
+  uint64_t watch(IceAgent& agent, ConnectionRecovery& recovery);
+
+  void unsubscribe(uint64_t id);
+
+  /**
+   * @brief Local addresses currently known, across all interfaces
+   */
+  [[nodiscard]] std::vector<std::string> addresses() const;
+
+  /**
+   * @brief Local address the kernel would send from to reach remote
+   *
+   * Connects a throwaway UDP socket; nothing is sent.
+   *
+   * @return nullopt if there is no route
+   */
+  [[nodiscard]] static std::optional<std::string> route_source(const SocketAddress& remote);
+
+  /**
+   * @brief Get statistics
+   */
+  [[nodiscard]] NetworkMonitorStats stats() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace rtc
@@ -0,0 +1,157 @@
+#pragma once
+
+/**
+ * @file packet_tracer.h
+ * @brief Sampled per-packet latency tracing through the media pipeline
+ *
+ * A sampled subset of RTP packets is stamped at each stage boundary into
+ * per-thread rings. A collector matches the stamps of each packet and
+ * turns them into per-stage latency histograms and Chrome trace events
+ * (load the JSON in chrome://tracing or Perfetto).
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+
+namespace rtc
+{
+
+class MetricHistogram;
+
+/**
+ * @brief Pipeline stage boundaries, in packet order
+ */
+enum class TraceStage : uint8_t
+{
+  RECEIVE,        // Read from the socket
+  FORWARD,        // Entered RtpForwarder::on_rtp_packet
+  PACER_ENQUEUE,  // Queued in RtpPacer
+  PACER_DEQUEUE,  // Released by RtpPacer
+  SEND,           // Written to the socket
+};
+
+constexpr size_t kTraceStageCount = 5;
+
+/**
+ * @brief Stage name as used in metric labels and trace events
+ */
+const char* trace_stage_name(TraceStage stage);
+
+/**
+ * @brief Packet tracer configuration
+ */
+struct PacketTracerConfig
+{
+  uint32_t sample_rate = 1024;      // Trace 1 in N packets (rounded up to a power of two)
+  size_t max_trace_spans = 65536;   // Most recent spans kept for Chrome trace export
+  std::chrono::milliseconds collect_interval{100};  // 0 = only collect() on demand
+};
+
+/**
+ * @brief Packet tracer statistics
+ */
+struct PacketTracerStats
+{
+  uint64_t events_collected = 0;
+  uint64_t events_dropped = 0;  // Overwritten in a ring before collection
+  uint64_t spans_matched = 0;
+};
+
+/**
+ * @brief Process-wide sampled packet tracer
+ *
+ * Packets are identified by RTP sequence number and timestamp, which
+ * survive SSRC rewriting, and sampled by a hash of that key, so every
+ * stage makes the same decision without carrying state along with the
+ * packet. Non-RTP datagrams (STUN, RTCP) are ignored.
+ *
+ * The latency recorded for a stage is the time since the packet's most
+ * recent earlier stage, so skipped stages (e.g. no pacer) fold into the
+ * next one.
+ */
+class PacketTracer
+{
+ public:
+  static constexpr size_t RING_CAPACITY = 4096;  // Events per thread between collections
+
+  /**
+   * @brief The process-wide tracer
+   */
+  static PacketTracer& shared();
+
+  /**
+   * @brief Stamp a stage boundary for an RTP packet
+   *
+   * When tracing is disabled this is one relaxed load and a branch.
+   */
+  static void trace(TraceStage stage, std::span<const uint8_t> rtp)
+  {
+    if (enabled_.load(std::memory_order_relaxed)) [[unlikely]]
+    {
+      shared().record(stage, rtp);
+    }
+  }
+
+  // Disable copy
+  PacketTracer(const PacketTracer&) = delete;
+  PacketTracer& operator=(const PacketTracer&) = delete;
+
+  /**
+   * @brief Start sampling and periodic collection on TaskScheduler::shared()
+   * @return False if already enabled
+   */
+  bool enable(PacketTracerConfig config = {});
+
+  /**
+   * @brief Stop sampling and collect what is left in the rings
+   */
+  void disable();
+
+  /**
+   * @brief Check if sampling is enabled
+   */
+  [[nodiscard]] bool is_enabled() const;
+
+  /**
+   * @brief Record latencies ending at a stage in milliseconds
+   * @see MetricsExporter::pipeline_stage_histogram
+   */
+  void set_stage_histogram(TraceStage stage, MetricHistogram histogram);
+
+  /**
+   * @brief Drain all thread rings now
+   */
+  void collect();
+
+  /**
+   * @brief Export collected spans in Chrome trace event format
+   */
+  [[nodiscard]] std::string chrome_trace_json() const;
+
+  /**
+   * @brief Discard collected spans and pending matches
+   */
+  void clear();
+
+  /**
+   * @brief Get statistics
+   */
+  [[nodiscard]] PacketTracerStats stats() const;
+
+ private:
+  PacketTracer();
+  ~PacketTracer();
+
+  void record(TraceStage stage, std::span<const uint8_t> rtp);
+
+  static inline std::atomic<bool> enabled_{false};
+
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace rtc
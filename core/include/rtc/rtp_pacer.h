@@ -19,6 +19,7 @@ namespace rtc
 {
 
 struct SocketAddress;
+class MetricHistogram;
 
 /**
  * @brief Queued packet for pacing
@@ -73,6 +74,12 @@ class RtpPacer
    */
   void set_send_callback(PacerSendCallback callback);
 
+  /**
+   * @brief Record each packet's queueing delay in milliseconds
+   * @see MetricsExporter::pacer_delay_histogram
+   */
+  void set_delay_histogram(MetricHistogram histogram);
+
   /**
    * @brief Queue a packet for paced sending
    * @param data Packet data
@@ -58,10 +58,72 @@ struct RtpHeader
  */
 struct RtpExtension
 {
+  static constexpr uint16_t ONE_BYTE_PROFILE = 0xBEDE;  // RFC 8285 one-byte elements
+
   uint16_t profile = 0;
   std::vector<uint8_t> data;
+
+  /**
+   * @brief Data of one-byte element `id`, empty if absent or another profile
+   */
+  [[nodiscard]] std::span<const uint8_t> find_element(uint8_t id) const;
+
+  /**
+   * @brief Add or replace one-byte element `id`
+   *
+   * An empty extension becomes a one-byte one; other profiles are left as is.
+   *
+   * @param id Element ID, 1-14
+   * @param element 1-16 bytes
+   * @return False if the element cannot be written
+   */
+  bool set_element(uint8_t id, std::span<const uint8_t> element);
+};
+
+/**
+ * @brief RFC 6464 client-to-mixer audio level
+ *
+ * One byte in a one-byte header extension element: the voice activity flag
+ * and the packet's audio level in -dBov, 0 (full scale) to 127 (silence).
+ * A server can rank speakers and drop silence from it without decoding.
+ */
+struct RtpAudioLevel
+{
+  uint8_t level = 127;  // -dBov
+  bool voice_activity = false;
+
+  /**
+   * @param dbov Level in dBov (<= 0), clamped to the 7-bit range
+   */
+  [[nodiscard]] static RtpAudioLevel from_dbov(float dbov, bool voice_activity);
+
+  [[nodiscard]] uint8_t encode() const
+  {
+    return static_cast<uint8_t>((voice_activity ? 0x80 : 0) | (level & 0x7F));
+  }
+  [[nodiscard]] static RtpAudioLevel decode(uint8_t byte)
+  {
+    return {static_cast<uint8_t>(byte & 0x7F), (byte & 0x80) != 0};
+  }
 };
 
+/**
+ * @brief Read one-byte element `id` straight from a serialized packet
+ *
+ * For forwarding paths that keep packets as bytes.
+ *
+ * @return Element data, empty if absent or the packet is malformed
+ */
+[[nodiscard]] std::span<const uint8_t> find_rtp_extension_element(std::span<const uint8_t> packet,
+                                                                  uint8_t id);
+
+/**
+ * @brief Payload of a serialized packet, without CSRCs, extension or padding
+ *
+ * @return Empty if the packet is malformed
+ */
+[[nodiscard]] std::span<const uint8_t> rtp_payload_view(std::span<const uint8_t> packet);
+
 /**
  * @brief Complete RTP packet
  */
@@ -177,6 +239,7 @@ class RtpPacketBuilder
   RtpPacketBuilder& set_marker(bool m);
   RtpPacketBuilder& set_payload(std::span<const uint8_t> data);
   RtpPacketBuilder& add_extension(uint16_t profile, std::span<const uint8_t> data);
+  RtpPacketBuilder& add_audio_level(uint8_t id, RtpAudioLevel level);
 
   [[nodiscard]] RtpPacket build() const;
 
@@ -14,6 +14,7 @@
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace rtc
@@ -94,25 +95,46 @@ class StunMessage
   [[nodiscard]] std::vector<uint8_t> serialize() const;
 
   /**
-   * @brief Add message integrity (HMAC-SHA1)
+   * @brief Add message integrity (HMAC-SHA1, short-term credentials)
+   *
+   * Covers the attributes added so far: add it after them and before the
+   * fingerprint.
    */
   void add_message_integrity(std::string_view password);
 
   /**
    * @brief Verify message integrity
+   * @return False if MESSAGE-INTEGRITY is absent or does not match
    */
   [[nodiscard]] bool verify_message_integrity(std::string_view password) const;
 
   /**
-   * @brief Add fingerprint (CRC32)
+   * @brief Add fingerprint (CRC32); must be the last attribute
    */
   void add_fingerprint();
 
+  /**
+   * @brief Verify fingerprint
+   * @return False if FINGERPRINT is absent or does not match
+   */
+  [[nodiscard]] bool verify_fingerprint() const;
+
   /**
    * @brief Get XOR-MAPPED-ADDRESS if present
    */
   [[nodiscard]] std::optional<SocketAddress> get_xor_mapped_address() const;
 
+  /**
+   * @brief Add XOR-MAPPED-ADDRESS (IPv4)
+   */
+  void add_xor_mapped_address(const SocketAddress& address);
+
+  /**
+   * @brief Find the first attribute of a type
+   * @return Attribute or nullptr if absent
+   */
+  [[nodiscard]] const StunAttribute* find_attribute(StunAttributeType type) const;
+
   // Accessors
   [[nodiscard]] StunMessageType type() const
   {
@@ -130,10 +152,12 @@ class StunMessage
   void set_type(StunMessageType type)
   {
     type_ = type;
+    raw_.clear();
   }
   void set_transaction_id(const StunTransactionId& id)
   {
     transaction_id_ = id;
+    raw_.clear();
   }
   void add_attribute(StunAttribute attr);
 
@@ -141,6 +165,7 @@ class StunMessage
   StunMessageType type_ = StunMessageType::BINDING_REQUEST;
   StunTransactionId transaction_id_{};
   std::vector<StunAttribute> attributes_;
+  std::vector<uint8_t> raw_;  // Bytes as parsed, padding included; empty once modified
 };
 
 /**
@@ -0,0 +1,174 @@
+#pragma once
+
+/**
+ * @file task_scheduler.h
+ * @brief Work-stealing task scheduler for server-side media processing
+ *
+ * One pool per node replaces per-object processing threads. Mixers,
+ * compositors and periodic room jobs all share the same workers.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string_view>
+
+namespace rtc
+{
+
+/**
+ * @brief Unit of work executed by the scheduler
+ */
+using Task = std::function<void()>;
+
+/**
+ * @brief Body of a parallel_for, invoked with a half-open index range
+ */
+using RangeTask = std::function<void(size_t begin, size_t end)>;
+
+/**
+ * @brief Handle for a periodic task (0 = invalid)
+ */
+using PeriodicTaskId = uint64_t;
+
+/**
+ * @brief Task scheduler configuration
+ */
+struct TaskSchedulerConfig
+{
+  size_t num_workers = 0;     // 0 = std::thread::hardware_concurrency()
+  bool pin_workers = false;   // Pin worker i to CPU i (Linux only)
+  int idle_spin_rounds = 64;  // Steal attempts before a worker sleeps
+};
+
+/**
+ * @brief Task scheduler statistics
+ */
+struct TaskSchedulerStats
+{
+  uint64_t tasks_submitted = 0;
+  uint64_t tasks_executed = 0;
+  uint64_t tasks_stolen = 0;
+  uint64_t tasks_pending = 0;  // Submitted, not yet started
+  uint64_t periodic_runs = 0;
+  uint64_t periodic_skipped = 0;  // Previous run still in flight
+};
+
+/**
+ * @brief Work-stealing thread pool
+ *
+ * Each worker owns a deque: it pushes and pops at the back (LIFO, cache
+ * warm) while idle workers steal from the front of other deques (FIFO).
+ *
+ * Features:
+ * - Affinity hints keep a room's jobs on the same worker
+ * - parallel_for with caller participation (safe to nest)
+ * - Periodic tasks that never overlap with themselves
+ *
+ * Usage:
+ * @code
+ * auto& pool = TaskScheduler::shared();
+ * auto id = pool.schedule_periodic(std::chrono::milliseconds(20),
+ *                                  [&]() { mixer.process(); },
+ *                                  pool.affinity_hint(room_id));
+ * // ...
+ * pool.cancel_periodic(id);
+ * @endcode
+ */
+class TaskScheduler
+{
+ public:
+  static constexpr size_t NO_AFFINITY = static_cast<size_t>(-1);
+
+  explicit TaskScheduler(TaskSchedulerConfig config = {});
+  ~TaskScheduler();
+
+  // Disable copy
+  TaskScheduler(const TaskScheduler&) = delete;
+  TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+  /**
+   * @brief Node-wide shared scheduler (started on first use)
+   */
+  static TaskScheduler& shared();
+
+  /**
+   * @brief Start worker threads
+   * @return False if already running
+   */
+  bool start();
+
+  /**
+   * @brief Stop periodic tasks, drain queued work and join workers
+   */
+  void stop();
+
+  /**
+   * @brief Check if running
+   */
+  [[nodiscard]] bool is_running() const;
+
+  /**
+   * @brief Queue a task
+   * @param task Work to run
+   * @param affinity Preferred worker (see affinity_hint), NO_AFFINITY to
+   *        keep it on the calling worker or spread round-robin
+   */
+  void submit(Task task, size_t affinity = NO_AFFINITY);
+
+  /**
+   * @brief Run body over [begin, end) split into chunks of grain indices
+   *
+   * Blocks until every chunk has completed. The calling thread executes
+   * chunks too, so calling this from inside a task cannot deadlock.
+   *
+   * @param grain Indices per chunk (0 = pick automatically)
+   */
+  void parallel_for(size_t begin, size_t end, size_t grain, const RangeTask& body);
+
+  /**
+   * @brief Run a task every interval on the pool
+   *
+   * A run is skipped if the previous one has not finished yet.
+   *
+   * @return Handle for cancel_periodic
+   */
+  PeriodicTaskId schedule_periodic(std::chrono::microseconds interval, Task task,
+                                   size_t affinity = NO_AFFINITY);
+
+  /**
+   * @brief Cancel a periodic task
+   *
+   * Waits for an in-flight run to finish unless called from that run.
+   */
+  void cancel_periodic(PeriodicTaskId id);
+
+  /**
+   * @brief Number of worker threads
+   */
+  [[nodiscard]] size_t worker_count() const;
+
+  /**
+   * @brief Map a key (e.g. room ID) to a stable worker index
+   */
+  [[nodiscard]] size_t affinity_hint(std::string_view key) const;
+
+  /**
+   * @brief Index of the calling worker, or NO_AFFINITY if the caller is
+   *        not one of this scheduler's workers
+   */
+  [[nodiscard]] size_t current_worker() const;
+
+  /**
+   * @brief Get statistics
+   */
+  [[nodiscard]] TaskSchedulerStats stats() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace rtc
@@ -0,0 +1,155 @@
+#pragma once
+
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timer wheel shared by all per-session timers
+ *
+ * Replaces per-object threads that sleep through backoff delays and
+ * polling intervals. Thousands of sessions share one wheel, driven by a
+ * dedicated thread or by an event loop.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+
+namespace rtc
+{
+
+/**
+ * @brief Timer callback
+ *
+ * Runs on the thread driving the wheel and delays every other timer
+ * while it runs; hand longer work to TaskScheduler.
+ */
+using TimerCallback = std::function<void()>;
+
+/**
+ * @brief Handle for a scheduled timer (0 = invalid)
+ */
+using TimerId = uint64_t;
+
+/**
+ * @brief Timer wheel configuration
+ */
+struct TimerWheelConfig
+{
+  std::chrono::microseconds resolution{1000};  // Tick length; timers fire on tick boundaries
+};
+
+/**
+ * @brief Timer wheel statistics
+ */
+struct TimerWheelStats
+{
+  size_t active_timers = 0;
+  uint64_t timers_fired = 0;
+  uint64_t timers_cancelled = 0;
+  uint64_t cascaded = 0;  // Timers moved down a level
+};
+
+/**
+ * @brief Four-level hierarchical timer wheel (256 slots per level)
+ *
+ * schedule() and cancel() are O(1): timers are intrusive list nodes in
+ * a slot chosen from their expiry tick, and move down one level at most
+ * three times before firing. Delays beyond 2^32 ticks are clamped.
+ *
+ * Drive it in one of two ways:
+ * - start() runs it on a dedicated thread (TimerWheel::shared() does this)
+ * - an event loop calls advance() after each poll, using next_timeout()
+ *   as the poll timeout (see SocketEventLoop::set_timer_wheel)
+ *
+ * Usage:
+ * @code
+ * auto& wheel = TimerWheel::shared();
+ * TimerId id = wheel.schedule(std::chrono::milliseconds(200), [&]() { retry(); });
+ * // ...
+ * wheel.cancel(id);
+ * @endcode
+ */
+class TimerWheel
+{
+ public:
+  explicit TimerWheel(TimerWheelConfig config = {});
+  ~TimerWheel();
+
+  // Disable copy
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  /**
+   * @brief Node-wide wheel running on its own thread (started on first use)
+   */
+  static TimerWheel& shared();
+
+  /**
+   * @brief Run the wheel on a dedicated thread
+   * @return False if already started
+   */
+  bool start();
+
+  /**
+   * @brief Stop the dedicated thread (pending timers are kept)
+   */
+  void stop();
+
+  /**
+   * @brief Run a callback once after delay
+   */
+  TimerId schedule(std::chrono::microseconds delay, TimerCallback callback);
+
+  /**
+   * @brief Run a callback every interval, first after first_delay
+   *
+   * If the wheel falls more than one interval behind, the missed runs
+   * are skipped rather than fired back to back.
+   */
+  TimerId schedule_periodic(std::chrono::microseconds first_delay,
+                            std::chrono::microseconds interval, TimerCallback callback);
+
+  TimerId schedule_periodic(std::chrono::microseconds interval, TimerCallback callback)
+  {
+    return schedule_periodic(interval, interval, std::move(callback));
+  }
+
+  /**
+   * @brief Cancel a timer
+   *
+   * If the callback is running on another thread, waits for it to finish
+   * (unless called from the callback itself), so captured state can be
+   * destroyed once this returns.
+   *
+   * @return True if the timer was pending or running
+   */
+  bool cancel(TimerId id);
+
+  /**
+   * @brief Fire every timer due at or before now
+   *
+   * Only one thread may drive the wheel at a time.
+   *
+   * @return Number of callbacks run
+   */
+  size_t advance(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+  /**
+   * @brief Time until the next tick that needs processing
+   * @return nullopt if no timers are pending
+   */
+  [[nodiscard]] std::optional<std::chrono::microseconds> next_timeout() const;
+
+  /**
+   * @brief Get statistics
+   */
+  [[nodiscard]] TimerWheelStats stats() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace rtc
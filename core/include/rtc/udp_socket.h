@@ -8,6 +8,7 @@
  * Windows (IOCP) and Linux (epoll) platforms.
  */
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -20,6 +21,8 @@
 namespace rtc
 {
 
+class TimerWheel;
+
 /**
  * @brief Network address (IP + port)
  */
@@ -47,6 +50,7 @@ struct RecvResult
     std::vector<uint8_t> data;
     SocketAddress remote_address;
     std::error_code error;
+    std::chrono::steady_clock::time_point received_at;  // When the datagram was read
 
     [[nodiscard]] bool success() const { return !error; }
 };
@@ -147,6 +151,10 @@ public:
 
     /**
      * @brief Start asynchronous receive
+     *
+     * The callback runs on the thread polling a SocketEventLoop the
+     * socket has been added to.
+     *
      * @param callback Callback invoked when data is received
      */
     virtual void async_recv(RecvCallback callback) = 0;
@@ -211,6 +219,10 @@ public:
 
     /**
      * @brief Register a socket with the event loop
+     *
+     * poll() then drains it into its async_recv callback. Remove it before
+     * it is destroyed. Linux (epoll) only for now.
+     *
      * @param socket Socket to register
      * @return Error code (empty if successful)
      */
@@ -230,11 +242,23 @@ public:
 
     /**
      * @brief Run one iteration of the event loop
-     * @param timeout_ms Timeout in milliseconds
-     * @return Number of events processed
+     * @param timeout_ms Timeout in milliseconds (shortened to the next
+     *        timer when a wheel is attached)
+     * @return Number of events processed, including timers fired
      */
     virtual size_t poll(int timeout_ms = 0) = 0;
 
+    /**
+     * @brief Drive a timer wheel from this loop
+     *
+     * Each poll() waits no longer than the wheel's next timeout and then
+     * advances it, so timers run on the I/O thread without a thread of
+     * their own. The wheel must not also be started or attached elsewhere.
+     *
+     * @param wheel Wheel to drive (nullptr to detach)
+     */
+    virtual void set_timer_wheel(TimerWheel* wheel) = 0;
+
     /**
      * @brief Stop the event loop
      */
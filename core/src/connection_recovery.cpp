@@ -7,27 +7,93 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
 #include <thread>
+#include <utility>
+
+#include "rtc/task_scheduler.h"
+#include "rtc/timer_wheel.h"
 
 namespace rtc
 {
 
+namespace
+{
+
+// Events waiting for the callback. Shared with the pool task delivering
+// them, so a delivery still queued never touches a destroyed recovery.
+struct EventQueue
+{
+  std::mutex mutex;
+  std::condition_variable idle;
+  RecoveryCallback callback;
+  std::deque<std::pair<RecoveryEvent, std::string>> events;
+  bool draining = false;    // A delivery task is queued or running
+  bool delivering = false;  // The callback is running on delivery_thread
+  std::thread::id delivery_thread;
+  bool closed = false;
+};
+
+void deliver_events(const std::shared_ptr<EventQueue>& queue)
+{
+  std::unique_lock lock(queue->mutex);
+  while (!queue->closed && !queue->events.empty())
+  {
+    auto [event, reason] = std::move(queue->events.front());
+    queue->events.pop_front();
+    RecoveryCallback callback = queue->callback;
+    queue->delivering = true;
+    queue->delivery_thread = std::this_thread::get_id();
+    lock.unlock();
+
+    if (callback)
+    {
+      callback(event, reason);
+    }
+
+    lock.lock();
+    queue->delivering = false;
+    queue->idle.notify_all();
+  }
+  queue->draining = false;
+}
+
+}  // namespace
+
 struct ConnectionRecovery::Impl
 {
   RecoveryConfig config;
   mutable std::mutex mutex;
 
-  RecoveryCallback callback;
+  std::shared_ptr<EventQueue> events = std::make_shared<EventQueue>();
   ConnectionState state = ConnectionState::NEW;
   RecoveryStats stats;
 
   std::atomic<bool> recovering{false};
-  std::thread recovery_thread;
+  TimerId attempt_timer = 0;  // Backoff delay of the current attempt
+
+  // Set by cancel_recovery() (guarded by mutex): timer callbacks stop
+  // re-arming. Their IDs stay set while they run, so the cancel waits.
+  bool shutdown = false;
   int current_attempt = 0;
   std::chrono::milliseconds current_delay{0};
   std::chrono::steady_clock::time_point disconnect_time;
 
+  // ICE restart in progress (guarded by mutex)
+  bool ice_restarting = false;
+  TimerId ice_restart_timer = 0;  // Falls back to start_recovery()
+
+  // Time back to full bitrate (guarded by mutex)
+  uint64_t last_bitrate = 0;
+  uint64_t bitrate_before = 0;  // At the start of the outage
+  bool awaiting_full_bitrate = false;
+  std::chrono::steady_clock::time_point reconnect_time;
+  std::chrono::milliseconds total_bitrate_recovery{0};
+  size_t bitrate_recoveries = 0;
+
   Impl(RecoveryConfig cfg) : config(std::move(cfg))
   {
     current_delay = config.initial_delay;
@@ -55,59 +121,105 @@ struct ConnectionRecovery::Impl
     }
   }
 
+  // Mutex held
+  void mark_down(std::chrono::steady_clock::time_point now)
+  {
+    disconnect_time = now;
+    bitrate_before = last_bitrate;
+    awaiting_full_bitrate = false;
+  }
+
+  // Mutex held
+  void record_success(std::chrono::steady_clock::time_point now)
+  {
+    stats.reconnect_success++;
+    auto downtime = std::chrono::duration_cast<std::chrono::milliseconds>(now - disconnect_time);
+    stats.total_downtime += downtime;
+    stats.last_recovery_time = downtime;
+    stats.average_recovery_time =
+        std::chrono::milliseconds(stats.total_downtime.count() / stats.reconnect_success);
+
+    reconnect_time = now;
+    awaiting_full_bitrate = bitrate_before > 0;
+  }
+
+  // Safe with the mutex held: delivery happens on the pool
   void emit_event(RecoveryEvent event, const std::string& reason = "")
   {
-    if (callback)
+    std::lock_guard lock(events->mutex);
+    if (events->closed) return;
+
+    events->events.emplace_back(event, reason);
+    if (!events->draining)
     {
-      callback(event, reason);
+      events->draining = true;
+      TaskScheduler::shared().submit([queue = events]() { deliver_events(queue); });
     }
   }
 
-  void recovery_loop()
+  // Drop undelivered events; wait for a running callback unless it is ours
+  void close_events()
   {
-    while (recovering.load() && current_attempt < config.max_attempts)
-    {
-      current_delay = calculate_delay();
+    std::unique_lock lock(events->mutex);
+    events->closed = true;
+    events->events.clear();
+    events->idle.wait(lock,
+                      [this]()
+                      {
+                        return !events->delivering ||
+                               events->delivery_thread == std::this_thread::get_id();
+                      });
+  }
 
-      {
-        std::lock_guard lock(mutex);
-        state = ConnectionState::RECONNECTING;
-      }
+  void begin_attempt()
+  {
+    current_delay = calculate_delay();
 
-      emit_event(RecoveryEvent::RECONNECTING, "Attempt " + std::to_string(current_attempt + 1));
+    {
+      std::lock_guard lock(mutex);
+      state = ConnectionState::RECONNECTING;
+    }
 
-      // Wait for delay
-      std::this_thread::sleep_for(current_delay);
+    emit_event(RecoveryEvent::RECONNECTING, "Attempt " + std::to_string(current_attempt + 1));
 
-      if (!recovering.load()) break;
+    // Wait for the delay on the shared wheel rather than a thread of our own
+    std::lock_guard lock(mutex);
+    if (recovering.load() && !shutdown)
+    {
+      attempt_timer = TimerWheel::shared().schedule(current_delay, [this]() { finish_attempt(); });
+    }
+  }
 
-      // Check if reconnected (would be set externally)
-      {
-        std::lock_guard lock(mutex);
-        if (state == ConnectionState::CONNECTED)
-        {
-          // Successful reconnection
-          stats.reconnect_success++;
-          auto now = std::chrono::steady_clock::now();
-          auto downtime =
-              std::chrono::duration_cast<std::chrono::milliseconds>(now - disconnect_time);
-          stats.total_downtime += downtime;
-
-          if (stats.reconnect_success > 0)
-          {
-            stats.average_recovery_time =
-                std::chrono::milliseconds(stats.total_downtime.count() / stats.reconnect_success);
-          }
+  void finish_attempt()
+  {
+    if (!recovering.load()) return;
 
-          emit_event(RecoveryEvent::RECONNECTED);
-          recovering.store(false);
-          return;
-        }
+    // Check if reconnected (would be set externally)
+    {
+      std::lock_guard lock(mutex);
+      if (shutdown) return;
+      if (state == ConnectionState::CONNECTED)
+      {
+        // Successful reconnection
+        record_success(std::chrono::steady_clock::now());
+        emit_event(RecoveryEvent::RECONNECTED);
+        recovering.store(false);
+        return;
       }
+    }
 
-      current_attempt++;
+    current_attempt++;
+    if (current_attempt < config.max_attempts)
+    {
+      begin_attempt();
+      return;
     }
 
+    fail();
+  }
+
+  void fail()
+  {
     // Failed all attempts
     {
       std::lock_guard lock(mutex);
@@ -118,6 +230,32 @@ struct ConnectionRecovery::Impl
     emit_event(RecoveryEvent::FAILED, "Max attempts reached");
     recovering.store(false);
   }
+
+  // start_recovery() without lifting a cancel, for timer callbacks
+  bool start_recovery()
+  {
+    if (config.strategy == ReconnectStrategy::NONE)
+    {
+      return false;
+    }
+
+    if (recovering.load())
+    {
+      return false;  // Already recovering
+    }
+
+    current_attempt = 0;
+    recovering.store(true);
+
+    if (config.max_attempts <= 0)
+    {
+      fail();
+      return true;
+    }
+
+    begin_attempt();
+    return true;
+  }
 };
 
 ConnectionRecovery::ConnectionRecovery(RecoveryConfig config)
@@ -128,12 +266,13 @@ ConnectionRecovery::ConnectionRecovery(RecoveryConfig config)
 ConnectionRecovery::~ConnectionRecovery()
 {
   cancel_recovery();
+  impl_->close_events();
 }
 
 void ConnectionRecovery::set_callback(RecoveryCallback callback)
 {
-  std::lock_guard lock(impl_->mutex);
-  impl_->callback = std::move(callback);
+  std::lock_guard lock(impl_->events->mutex);
+  impl_->events->callback = std::move(callback);
 }
 
 void ConnectionRecovery::on_state_change(ConnectionState new_state)
@@ -143,7 +282,7 @@ void ConnectionRecovery::on_state_change(ConnectionState new_state)
   if (impl_->state == ConnectionState::CONNECTED && new_state == ConnectionState::DISCONNECTED)
   {
     impl_->stats.disconnect_count++;
-    impl_->disconnect_time = std::chrono::steady_clock::now();
+    impl_->mark_down(std::chrono::steady_clock::now());
     impl_->emit_event(RecoveryEvent::DISCONNECTED);
 
     // Start auto recovery if enabled
@@ -158,47 +297,152 @@ void ConnectionRecovery::on_state_change(ConnectionState new_state)
 
 void ConnectionRecovery::on_network_change(bool has_connectivity)
 {
-  if (has_connectivity && impl_->config.enable_ice_restart)
+  if (has_connectivity)
+  {
+    start_ice_restart("Network changed");
+  }
+}
+
+bool ConnectionRecovery::start_ice_restart(const std::string& reason)
+{
+  if (!impl_->config.enable_ice_restart)
+  {
+    return false;
+  }
+
   {
     std::lock_guard lock(impl_->mutex);
+    if (impl_->ice_restarting)
+    {
+      return false;
+    }
+    impl_->shutdown = false;
+
+    // A restart may begin before the old path is reported down
+    auto now = std::chrono::steady_clock::now();
+    if (impl_->state == ConnectionState::CONNECTED)
+    {
+      impl_->mark_down(now);
+    }
+
+    impl_->ice_restarting = true;
+    impl_->state = ConnectionState::RECONNECTING;
     impl_->stats.ice_restarts++;
-    impl_->emit_event(RecoveryEvent::ICE_RESTART, "Network changed");
+
+    impl_->ice_restart_timer = TimerWheel::shared().schedule(
+        impl_->config.connection_timeout,
+        [this]()
+        {
+          {
+            std::lock_guard lock(impl_->mutex);
+            if (impl_->shutdown || !impl_->ice_restarting) return;
+            impl_->ice_restarting = false;
+          }
+
+          // The restart never selected a pair: reconnect from scratch
+          impl_->start_recovery();
+        });
   }
+
+  impl_->emit_event(RecoveryEvent::ICE_RESTART, reason);
+  return true;
 }
 
-bool ConnectionRecovery::start_recovery()
+void ConnectionRecovery::on_path_switched(std::chrono::milliseconds outage,
+                                          const std::string& reason)
 {
-  if (impl_->config.strategy == ReconnectStrategy::NONE)
+  bool was_down = false;
   {
-    return false;
+    std::lock_guard lock(impl_->mutex);
+    impl_->stats.path_switches++;
+    impl_->stats.last_path_switch_outage = outage;
+    was_down = impl_->state != ConnectionState::CONNECTED;
   }
 
-  if (impl_->recovering.load())
+  if (was_down)
   {
-    return false;  // Already recovering
+    on_reconnected();
   }
+  impl_->emit_event(RecoveryEvent::PATH_SWITCHED, reason);
+}
 
-  impl_->current_attempt = 0;
-  impl_->recovering.store(true);
+void ConnectionRecovery::on_bitrate(uint64_t bitrate_bps)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->last_bitrate = bitrate_bps;
 
-  impl_->recovery_thread = std::thread([this]() { impl_->recovery_loop(); });
+  if (!impl_->awaiting_full_bitrate || impl_->state != ConnectionState::CONNECTED)
+  {
+    return;
+  }
 
-  return true;
+  if (static_cast<double>(bitrate_bps) >=
+      static_cast<double>(impl_->bitrate_before) * impl_->config.full_bitrate_ratio)
+  {
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - impl_->reconnect_time);
+    impl_->total_bitrate_recovery += elapsed;
+    impl_->bitrate_recoveries++;
+    impl_->stats.average_bitrate_recovery_time = std::chrono::milliseconds(
+        impl_->total_bitrate_recovery.count() / static_cast<int64_t>(impl_->bitrate_recoveries));
+    impl_->awaiting_full_bitrate = false;
+  }
+}
+
+bool ConnectionRecovery::start_recovery()
+{
+  {
+    std::lock_guard lock(impl_->mutex);
+    impl_->shutdown = false;
+  }
+  return impl_->start_recovery();
 }
 
 void ConnectionRecovery::cancel_recovery()
 {
-  impl_->recovering.store(false);
-  if (impl_->recovery_thread.joinable())
+  TimerId attempt_timer;
+  TimerId restart_timer;
   {
-    impl_->recovery_thread.join();
+    std::lock_guard lock(impl_->mutex);
+    impl_->shutdown = true;
+    impl_->recovering.store(false);
+    impl_->ice_restarting = false;
+    attempt_timer = std::exchange(impl_->attempt_timer, 0);
+    restart_timer = std::exchange(impl_->ice_restart_timer, 0);
   }
+
+  // Waits for an attempt that is being evaluated right now
+  TimerWheel::shared().cancel(attempt_timer);
+  TimerWheel::shared().cancel(restart_timer);
 }
 
 void ConnectionRecovery::on_reconnected()
 {
-  std::lock_guard lock(impl_->mutex);
-  impl_->state = ConnectionState::CONNECTED;
+  TimerId attempt_timer = 0;
+  TimerId restart_timer = 0;
+  bool recovered = false;
+  {
+    std::lock_guard lock(impl_->mutex);
+    impl_->state = ConnectionState::CONNECTED;
+
+    // Count the recovery now rather than when the backoff delay expires
+    if (impl_->recovering.load() || impl_->ice_restarting)
+    {
+      impl_->record_success(std::chrono::steady_clock::now());
+      impl_->recovering.store(false);
+      impl_->ice_restarting = false;
+      attempt_timer = std::exchange(impl_->attempt_timer, 0);
+      restart_timer = std::exchange(impl_->ice_restart_timer, 0);
+      recovered = true;
+    }
+  }
+
+  if (recovered)
+  {
+    TimerWheel::shared().cancel(attempt_timer);
+    TimerWheel::shared().cancel(restart_timer);
+    impl_->emit_event(RecoveryEvent::RECONNECTED);
+  }
 }
 
 ConnectionState ConnectionRecovery::state() const
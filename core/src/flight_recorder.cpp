@@ -0,0 +1,527 @@
+/**
+ * @file flight_recorder.cpp
+ * @brief Flight recorder implementation
+ */
+
+#include "rtc/flight_recorder.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <ctime>
+#include <functional>
+#include <mutex>
+
+#include "rtc/task_scheduler.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define RTC_FLIGHT_TSC 1
+#elif defined(_M_X64)
+#include <intrin.h>
+#define RTC_FLIGHT_TSC 1
+#endif
+
+namespace rtc
+{
+
+namespace
+{
+
+constexpr size_t kMaxRings = 65535;  // FlightRecord::thread is 16 bits
+
+/**
+ * @brief Single-writer event ring owned by one thread at a time
+ *
+ * Same protocol as the packet tracer rings: the owner bumps claimed
+ * before overwriting a slot and committed after, so a concurrent dump
+ * can discard slots that were overwritten while it copied them.
+ */
+struct FlightRing
+{
+  struct Slot
+  {
+    std::atomic<int64_t> ticks{0};  // See read_ticks()
+    std::atomic<uint64_t> header{0};  // type | source << 8 | thread << 16 | ssrc << 32
+    std::atomic<uint64_t> arg0{0};
+    std::atomic<uint64_t> arg1{0};
+  };
+
+  std::array<Slot, FlightRecorder::RING_CAPACITY> slots;
+  std::atomic<uint64_t> claimed{0};
+  std::atomic<uint64_t> committed{0};
+  std::atomic<bool> in_use{true};
+  uint16_t id = 0;
+};
+
+/**
+ * @brief Returns the thread's ring to the pool when the thread exits
+ */
+struct RingLease
+{
+  FlightRing* ring = nullptr;
+
+  ~RingLease()
+  {
+    if (ring) ring->in_use.store(false, std::memory_order_release);
+  }
+};
+
+// Fast path reads only the trivially destructible pointer; the lease is
+// touched once per thread
+thread_local FlightRing* tls_ring = nullptr;
+thread_local bool tls_exhausted = false;
+thread_local RingLease tls_lease;
+
+std::atomic<bool> g_signal_dump{false};
+
+extern "C" void flight_signal_handler(int /*signum*/)
+{
+  g_signal_dump.store(true, std::memory_order_relaxed);  // Lock-free, async-signal-safe
+}
+
+int64_t steady_now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+/**
+ * @brief Event timestamp: the TSC where available (a few cycles rather
+ *        than a clock_gettime), otherwise steady_clock nanoseconds
+ */
+inline int64_t read_ticks()
+{
+#ifdef RTC_FLIGHT_TSC
+  return static_cast<int64_t>(__rdtsc());
+#else
+  return steady_now_ns();
+#endif
+}
+
+std::string dump_file_name(const std::string& directory, std::string_view reason)
+{
+  auto wall_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                     std::chrono::system_clock::now().time_since_epoch())
+                     .count();
+
+  std::string name = directory + "/flight-" + std::to_string(wall_ms) + "-";
+  for (char c : reason.substr(0, 23))
+  {
+    bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                c == '-' || c == '_';
+    name += safe ? c : '_';
+  }
+  return name + ".bin";
+}
+
+}  // namespace
+
+const char* flight_event_name(FlightEventType type)
+{
+  switch (type)
+  {
+    case FlightEventType::PACKET_DROP:
+      return "packet_drop";
+    case FlightEventType::LAYER_SWITCH:
+      return "layer_switch";
+    case FlightEventType::PLI:
+      return "pli";
+    case FlightEventType::NACK:
+      return "nack";
+    case FlightEventType::QUEUE_OVERFLOW:
+      return "queue_overflow";
+    case FlightEventType::STATE_CHANGE:
+      return "state_change";
+    case FlightEventType::TRIGGER:
+      return "trigger";
+  }
+  return "unknown";
+}
+
+const char* flight_source_name(FlightSource source)
+{
+  switch (source)
+  {
+    case FlightSource::APP:
+      return "app";
+    case FlightSource::FORWARDER:
+      return "forwarder";
+    case FlightSource::PACER:
+      return "pacer";
+    case FlightSource::JITTER_BUFFER:
+      return "jitter_buffer";
+    case FlightSource::VIDEO_RECEIVER:
+      return "video_receiver";
+    case FlightSource::OVERLOAD:
+      return "overload";
+  }
+  return "unknown";
+}
+
+const char* flight_drop_reason_name(FlightDropReason reason)
+{
+  switch (reason)
+  {
+    case FlightDropReason::UNKNOWN_SSRC:
+      return "unknown_ssrc";
+    case FlightDropReason::QUEUE_FULL:
+      return "queue_full";
+    case FlightDropReason::DUPLICATE:
+      return "duplicate";
+    case FlightDropReason::LOST:
+      return "lost";
+  }
+  return "unknown";
+}
+
+struct FlightRecorder::Impl
+{
+  std::mutex rings_mutex;
+  std::vector<std::unique_ptr<FlightRing>> rings;
+
+  mutable std::mutex mutex;
+  FlightRecorderConfig config;
+  FlightRecorderStats stats;
+  int64_t last_trigger_ns = 0;
+  PeriodicTaskId signal_job = 0;
+
+  // Reference point for converting ticks to steady_clock nanoseconds
+  int64_t base_ticks = 0;
+  int64_t base_ns = 0;
+
+  Impl()
+  {
+    base_ns = steady_now_ns();
+    base_ticks = read_ticks();
+  }
+
+  /**
+   * @brief Nanoseconds per tick, measured from construction until now
+   */
+  double tick_period() const
+  {
+#ifdef RTC_FLIGHT_TSC
+    int64_t ticks = read_ticks() - base_ticks;
+    int64_t ns = steady_now_ns() - base_ns;
+    return ticks > 0 && ns > 0 ? static_cast<double>(ns) / static_cast<double>(ticks) : 1.0;
+#else
+    return 1.0;
+#endif
+  }
+
+  FlightRing* acquire_ring()
+  {
+    std::lock_guard lock(rings_mutex);
+    for (auto& ring : rings)
+    {
+      bool free = !ring->in_use.load(std::memory_order_acquire);
+      if (free && !ring->in_use.exchange(true, std::memory_order_acq_rel))
+      {
+        return ring.get();
+      }
+    }
+
+    if (rings.size() >= kMaxRings)
+    {
+      return nullptr;
+    }
+
+    rings.push_back(std::make_unique<FlightRing>());
+    rings.back()->id = static_cast<uint16_t>(rings.size() - 1);
+    return rings.back().get();
+  }
+
+  void snapshot(const FlightRing& ring, double period, std::vector<FlightRecord>& out)
+  {
+    uint64_t end = ring.committed.load(std::memory_order_acquire);
+    uint64_t begin = end > RING_CAPACITY ? end - RING_CAPACITY : 0;
+
+    size_t first = out.size();
+    for (uint64_t i = begin; i < end; ++i)
+    {
+      const auto& slot = ring.slots[i % RING_CAPACITY];
+      uint64_t header = slot.header.load(std::memory_order_relaxed);
+
+      FlightRecord record;
+      int64_t ticks = slot.ticks.load(std::memory_order_relaxed) - base_ticks;
+      record.time_ns = base_ns + static_cast<int64_t>(static_cast<double>(ticks) * period);
+      record.type = static_cast<FlightEventType>(header & 0xFF);
+      record.source = static_cast<FlightSource>((header >> 8) & 0xFF);
+      record.thread = static_cast<uint16_t>(header >> 16);
+      record.ssrc = static_cast<uint32_t>(header >> 32);
+      record.arg0 = slot.arg0.load(std::memory_order_relaxed);
+      record.arg1 = slot.arg1.load(std::memory_order_relaxed);
+      out.push_back(record);
+    }
+
+    // Discard slots the owner started overwriting while they were copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t claimed = ring.claimed.load(std::memory_order_relaxed);
+    uint64_t valid_from = claimed > RING_CAPACITY ? claimed - RING_CAPACITY : 0;
+    if (valid_from > begin)
+    {
+      size_t torn = static_cast<size_t>(std::min(valid_from, end) - begin);
+      out.erase(out.begin() + first, out.begin() + first + torn);
+    }
+  }
+};
+
+FlightRecorder::FlightRecorder() : impl_(std::make_unique<Impl>()) {}
+
+FlightRecorder::~FlightRecorder() = default;
+
+FlightRecorder& FlightRecorder::shared()
+{
+  // Never destroyed: threads may still be recording during static destruction
+  static FlightRecorder* instance = new FlightRecorder();
+  return *instance;
+}
+
+void FlightRecorder::record(FlightEventType type, FlightSource source, uint32_t ssrc,
+                            uint64_t arg0, uint64_t arg1)
+{
+  FlightRing* ring = tls_ring;
+  if (!ring) [[unlikely]]
+  {
+    if (tls_exhausted) return;
+    ring = shared().impl_->acquire_ring();
+    if (!ring)
+    {
+      tls_exhausted = true;
+      return;
+    }
+    tls_ring = tls_lease.ring = ring;
+  }
+
+  uint64_t index = ring->committed.load(std::memory_order_relaxed);
+  ring->claimed.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  auto& slot = ring->slots[index % RING_CAPACITY];
+  slot.ticks.store(read_ticks(), std::memory_order_relaxed);
+  slot.header.store(static_cast<uint64_t>(type) | (static_cast<uint64_t>(source) << 8) |
+                        (static_cast<uint64_t>(ring->id) << 16) |
+                        (static_cast<uint64_t>(ssrc) << 32),
+                    std::memory_order_relaxed);
+  slot.arg0.store(arg0, std::memory_order_relaxed);
+  slot.arg1.store(arg1, std::memory_order_relaxed);
+  ring->committed.store(index + 1, std::memory_order_release);
+}
+
+void FlightRecorder::configure(FlightRecorderConfig config)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->config = std::move(config);
+}
+
+bool FlightRecorder::dump(const std::string& path, std::string_view reason)
+{
+  std::vector<FlightRecord> records;
+  {
+    std::lock_guard lock(impl_->rings_mutex);
+    double period = impl_->tick_period();
+    records.reserve(impl_->rings.size() * RING_CAPACITY);
+    for (const auto& ring : impl_->rings)
+    {
+      impl_->snapshot(*ring, period, records);
+    }
+  }
+
+  std::sort(records.begin(), records.end(), [](const FlightRecord& a, const FlightRecord& b)
+            { return a.time_ns < b.time_ns; });
+
+  FlightDumpHeader header;
+  header.record_count = records.size();
+  header.steady_ns = steady_now_ns();
+  header.wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                       .count();
+  reason.copy(header.reason, sizeof(header.reason) - 1);
+
+  std::FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file)
+  {
+    return false;
+  }
+
+  bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+  if (ok && !records.empty())
+  {
+    ok = std::fwrite(records.data(), sizeof(FlightRecord), records.size(), file) ==
+         records.size();
+  }
+  ok = std::fclose(file) == 0 && ok;
+
+  if (ok)
+  {
+    std::lock_guard lock(impl_->mutex);
+    impl_->stats.dumps_written++;
+    impl_->stats.last_dump_path = path;
+  }
+  return ok;
+}
+
+bool FlightRecorder::trigger(std::string_view reason)
+{
+  std::string path;
+  {
+    std::lock_guard lock(impl_->mutex);
+
+    int64_t now = steady_now_ns();
+    auto min_interval =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(impl_->config.min_trigger_interval);
+    if (impl_->last_trigger_ns != 0 && now - impl_->last_trigger_ns < min_interval.count())
+    {
+      impl_->stats.triggers_suppressed++;
+      return false;
+    }
+    impl_->last_trigger_ns = now;
+    path = dump_file_name(impl_->config.dump_directory, reason);
+  }
+
+  record(FlightEventType::TRIGGER, FlightSource::APP, 0, std::hash<std::string_view>{}(reason));
+
+  TaskScheduler::shared().submit([this, path, reason = std::string(reason)]()
+                                 { dump(path, reason); });
+  return true;
+}
+
+bool FlightRecorder::install_signal_handler(int signum)
+{
+  {
+    std::lock_guard lock(impl_->mutex);
+    if (impl_->signal_job != 0)
+    {
+      return false;
+    }
+
+    impl_->signal_job = TaskScheduler::shared().schedule_periodic(
+        std::chrono::milliseconds(200),
+        [this]()
+        {
+          if (!g_signal_dump.exchange(false, std::memory_order_relaxed))
+          {
+            return;
+          }
+
+          std::string directory;
+          {
+            std::lock_guard lock(impl_->mutex);
+            directory = impl_->config.dump_directory;
+          }
+          dump(dump_file_name(directory, "signal"), "signal");
+        });
+  }
+
+  std::signal(signum, flight_signal_handler);
+  return true;
+}
+
+FlightRecorderStats FlightRecorder::stats() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->stats;
+}
+
+bool read_flight_dump(const std::string& path, FlightDumpHeader& header,
+                      std::vector<FlightRecord>& records)
+{
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (!file)
+  {
+    return false;
+  }
+
+  const FlightDumpHeader expected;
+  bool ok = std::fread(&header, sizeof(header), 1, file) == 1 &&
+            std::equal(std::begin(header.magic), std::end(header.magic),
+                       std::begin(expected.magic)) &&
+            header.version == expected.version && header.record_size == sizeof(FlightRecord);
+
+  // Bound the count by what the file holds before allocating for it
+  if (ok)
+  {
+    long start = std::ftell(file);
+    ok = start >= 0 && std::fseek(file, 0, SEEK_END) == 0;
+    long end = ok ? std::ftell(file) : -1;
+    ok = ok && end >= start && std::fseek(file, start, SEEK_SET) == 0 &&
+         header.record_count <= static_cast<uint64_t>(end - start) / sizeof(FlightRecord);
+  }
+
+  if (ok)
+  {
+    header.reason[sizeof(header.reason) - 1] = '\0';
+    records.resize(static_cast<size_t>(header.record_count));
+    ok = std::fread(records.data(), sizeof(FlightRecord), records.size(), file) ==
+         records.size();
+  }
+
+  std::fclose(file);
+  return ok;
+}
+
+std::string format_flight_timeline(const FlightDumpHeader& header,
+                                   const std::vector<FlightRecord>& records, uint32_t ssrc)
+{
+  std::string out;
+  char buf[256];
+
+  std::time_t wall = static_cast<std::time_t>(header.wall_ns / 1'000'000'000);
+  std::tm utc{};
+#ifdef _WIN32
+  gmtime_s(&utc, &wall);
+#else
+  gmtime_r(&wall, &utc);
+#endif
+  char when[32];
+  std::strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &utc);
+  std::snprintf(buf, sizeof(buf), "# dump %s UTC, reason \"%s\", %llu events\n", when,
+                header.reason, static_cast<unsigned long long>(header.record_count));
+  out += buf;
+
+  for (const auto& record : records)
+  {
+    if (ssrc != 0 && record.ssrc != ssrc) continue;
+
+    double offset = static_cast<double>(record.time_ns - header.steady_ns) / 1e9;
+    int len = std::snprintf(buf, sizeof(buf), "%+12.6fs  t%-4u %-15s %-15s ssrc=%08x ", offset,
+                            static_cast<unsigned>(record.thread),
+                            flight_source_name(record.source), flight_event_name(record.type),
+                            static_cast<unsigned>(record.ssrc));
+    out.append(buf, static_cast<size_t>(len));
+
+    auto arg0 = static_cast<unsigned long long>(record.arg0);
+    auto arg1 = static_cast<unsigned long long>(record.arg1);
+    switch (record.type)
+    {
+      case FlightEventType::PACKET_DROP:
+        len = std::snprintf(buf, sizeof(buf), "reason=%s arg=%llu",
+                            flight_drop_reason_name(static_cast<FlightDropReason>(record.arg0)),
+                            arg1);
+        break;
+      case FlightEventType::LAYER_SWITCH:
+      case FlightEventType::STATE_CHANGE:
+        len = std::snprintf(buf, sizeof(buf), "%llu -> %llu", arg0, arg1);
+        break;
+      case FlightEventType::NACK:
+        len = std::snprintf(buf, sizeof(buf), "seq=%llu count=%llu", arg0, arg1);
+        break;
+      case FlightEventType::QUEUE_OVERFLOW:
+        len = std::snprintf(buf, sizeof(buf), "depth=%llu limit=%llu", arg0, arg1);
+        break;
+      case FlightEventType::PLI:
+      case FlightEventType::TRIGGER:
+        len = 0;
+        break;
+    }
+    out.append(buf, static_cast<size_t>(len));
+    out += '\n';
+  }
+  return out;
+}
+
+}  // namespace rtc
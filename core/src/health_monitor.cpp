@@ -5,63 +5,244 @@
 
 #include "rtc/health_monitor.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
+#include <cstring>
 #include <mutex>
-#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "rtc/metrics_exporter.h"
+#include "rtc/task_scheduler.h"
 
 #ifdef __linux__
-#include <fstream>
-#include <sstream>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #endif
 
 namespace rtc
 {
 
+namespace
+{
+
+std::mutex g_probes_mutex;
+std::vector<std::weak_ptr<LoopLagProbe>> g_probes;
+uint64_t g_next_probe_instance = 1;  // Guarded by g_probes_mutex
+
+int64_t lag_window_index(std::chrono::steady_clock::time_point time,
+                         std::chrono::milliseconds window)
+{
+  return std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()) / window;
+}
+
+int current_thread_id()
+{
+#ifdef __linux__
+  thread_local int tid = static_cast<int>(::syscall(SYS_gettid));
+  return tid;
+#else
+  return 0;
+#endif
+}
+
+#ifdef __linux__
+/**
+ * @brief Read a small /proc file from offset 0 into buf (NUL-terminated)
+ */
+bool read_proc(int fd, char* buf, size_t size)
+{
+  if (fd < 0) return false;
+  ssize_t len = ::pread(fd, buf, size - 1, 0);
+  if (len <= 0) return false;
+  buf[len] = '\0';
+  return true;
+}
+
+int open_proc(const char* path)
+{
+  return ::open(path, O_RDONLY | O_CLOEXEC);
+}
+#endif
+
+}  // namespace
+
+std::shared_ptr<LoopLagProbe> LoopLagProbe::create(std::string name)
+{
+  std::lock_guard lock(g_probes_mutex);
+  std::shared_ptr<LoopLagProbe> probe(
+      new LoopLagProbe(std::move(name), g_next_probe_instance++));
+
+  std::erase_if(g_probes, [](const auto& weak) { return weak.expired(); });
+  g_probes.push_back(probe);
+  return probe;
+}
+
+void LoopLagProbe::tick(std::chrono::steady_clock::time_point deadline)
+{
+  int tid = current_thread_id();
+  if (tid_.load(std::memory_order_relaxed) != tid)
+  {
+    tid_.store(tid, std::memory_order_relaxed);
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  auto late = std::chrono::duration_cast<std::chrono::microseconds>(now - deadline);
+  int64_t lag = std::max<int64_t>(late.count(), 0);
+
+  // Single writer: readers skip a window while its index is -1
+  int64_t index = lag_window_index(now, LAG_WINDOW);
+  auto& window = windows_[static_cast<size_t>(index) % LAG_WINDOWS];
+  if (window.index.load(std::memory_order_relaxed) != index)
+  {
+    window.index.store(-1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    window.max_lag_us.store(lag, std::memory_order_relaxed);
+    window.index.store(index, std::memory_order_release);
+  }
+  else if (lag > window.max_lag_us.load(std::memory_order_relaxed))
+  {
+    window.max_lag_us.store(lag, std::memory_order_relaxed);
+  }
+}
+
+std::chrono::microseconds LoopLagProbe::max_lag_since(int64_t& window) const
+{
+  int64_t current = lag_window_index(std::chrono::steady_clock::now(), LAG_WINDOW);
+  int64_t first = std::max(window, current - static_cast<int64_t>(LAG_WINDOWS) + 1);
+
+  int64_t max_lag = 0;
+  for (int64_t index = first; index <= current; ++index)
+  {
+    const auto& slot = windows_[static_cast<size_t>(index) % LAG_WINDOWS];
+    if (slot.index.load(std::memory_order_acquire) != index) continue;
+    int64_t lag = slot.max_lag_us.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.index.load(std::memory_order_relaxed) == index)
+    {
+      max_lag = std::max(max_lag, lag);
+    }
+  }
+
+  // The current window is read again next time, in case it is still filling
+  window = current;
+  return std::chrono::microseconds(max_lag);
+}
+
 struct HealthMonitor::Impl
 {
+  // Kernel accounting for one thread of this process, read with pread on
+  // descriptors kept open for the thread's lifetime
+  struct ThreadSample
+  {
+    int stat_fd = -1;
+    int schedstat_fd = -1;
+    std::string comm;
+    uint64_t cpu_ticks = 0;
+    uint64_t run_delay_ns = 0;
+    bool primed = false;
+    bool seen = false;
+    MetricGauge cpu_gauge;
+    MetricGauge run_delay_gauge;
+    Labels gauge_labels;  // As registered, to unregister when the thread exits
+  };
+
+  struct LagGauge
+  {
+    Labels labels;
+    MetricGauge gauge;
+  };
+
   HealthMonitorConfig config;
-  mutable std::mutex mutex;
+  mutable std::mutex mutex;  // Results and registrations; never held while sampling
 
   std::unordered_map<std::string, HealthCheckCallback> components;
   std::unordered_map<std::string, ComponentHealth> component_health;
   HealthChangeCallback health_callback;
 
   std::atomic<bool> running{false};
-  std::thread monitor_thread;
+  PeriodicTaskId check_task = 0;  // Periodic run_checks() on the shared pool
   std::chrono::steady_clock::time_point start_time;
   SystemHealth current_health;
 
+  // Everything below is guarded by sample_mutex, which serializes the
+  // /proc scan and metric publishing of concurrent run_checks()
+  std::mutex sample_mutex;
+
+  // System-wide CPU (previous /proc/stat sample)
+  uint64_t prev_idle = 0;
+  uint64_t prev_total = 0;
+  int proc_stat_fd = -1;
+  int meminfo_fd = -1;
+
+  // Per-thread accounting, keyed by kernel thread ID
+  std::unordered_map<int, ThreadSample> thread_samples;
+  std::chrono::steady_clock::time_point prev_thread_sample;
+  std::unordered_set<std::string> builtin_components;
+
+  MetricsExporter* metrics = nullptr;
+  MetricGauge cpu_gauge;
+  MetricGauge memory_gauge;
+  std::unordered_map<uint64_t, LagGauge> lag_gauges;  // By probe instance
+  std::unordered_map<uint64_t, int64_t> lag_cursors;  // Next lag window to read, by instance
+
   Impl(HealthMonitorConfig cfg) : config(std::move(cfg))
   {
     start_time = std::chrono::steady_clock::now();
+#ifdef __linux__
+    proc_stat_fd = open_proc("/proc/stat");
+    meminfo_fd = open_proc("/proc/meminfo");
+#endif
   }
 
-  float get_cpu_usage()
+  ~Impl()
   {
 #ifdef __linux__
-    static long prev_idle = 0, prev_total = 0;
+    for (auto& [_, sample] : thread_samples)
+    {
+      close_sample(sample);
+    }
+    if (proc_stat_fd >= 0) ::close(proc_stat_fd);
+    if (meminfo_fd >= 0) ::close(meminfo_fd);
+#endif
+  }
 
-    std::ifstream stat("/proc/stat");
-    std::string cpu_line;
-    std::getline(stat, cpu_line);
+  float get_cpu_usage()
+  {
+#ifdef __linux__
+    char buf[512];
+    if (!read_proc(proc_stat_fd, buf, sizeof(buf)) || std::strncmp(buf, "cpu ", 4) != 0)
+    {
+      return 0.0f;
+    }
 
-    std::istringstream iss(cpu_line);
-    std::string cpu;
-    long user, nice, system, idle, iowait, irq, softirq;
-    iss >> cpu >> user >> nice >> system >> idle >> iowait >> irq >> softirq;
+    // user nice system idle iowait irq softirq steal
+    uint64_t fields[8] = {};
+    char* cursor = buf + 4;
+    for (auto& field : fields)
+    {
+      field = std::strtoull(cursor, &cursor, 10);
+    }
 
-    long total = user + nice + system + idle + iowait + irq + softirq;
-    long idle_time = idle + iowait;
+    uint64_t total = 0;
+    for (auto field : fields)
+    {
+      total += field;
+    }
+    uint64_t idle_time = fields[3] + fields[4];
 
-    long diff_total = total - prev_total;
-    long diff_idle = idle_time - prev_idle;
+    uint64_t diff_total = total - prev_total;
+    uint64_t diff_idle = idle_time - prev_idle;
 
     prev_total = total;
     prev_idle = idle_time;
 
     if (diff_total == 0) return 0.0f;
-    return 100.0f * (1.0f - static_cast<float>(diff_idle) / diff_total);
+    return 100.0f * (1.0f - static_cast<float>(diff_idle) / static_cast<float>(diff_total));
 #else
     return 0.0f;  // Windows implementation would use GetSystemTimes
 #endif
@@ -70,113 +251,466 @@ struct HealthMonitor::Impl
   float get_memory_usage()
   {
 #ifdef __linux__
-    std::ifstream meminfo("/proc/meminfo");
-    std::string line;
-    long mem_total = 0, mem_available = 0;
-
-    while (std::getline(meminfo, line))
+    char buf[4096];
+    if (!read_proc(meminfo_fd, buf, sizeof(buf)))
     {
-      if (line.find("MemTotal:") == 0)
-      {
-        std::istringstream iss(line.substr(9));
-        iss >> mem_total;
-      }
-      else if (line.find("MemAvailable:") == 0)
-      {
-        std::istringstream iss(line.substr(13));
-        iss >> mem_available;
-      }
+      return 0.0f;
     }
 
+    auto field = [&buf](const char* key) -> uint64_t
+    {
+      const char* line = std::strstr(buf, key);
+      return line ? std::strtoull(line + std::strlen(key), nullptr, 10) : 0;
+    };
+    uint64_t mem_total = field("MemTotal:");
+    uint64_t mem_available = field("MemAvailable:");
+
     if (mem_total == 0) return 0.0f;
-    return 100.0f * (1.0f - static_cast<float>(mem_available) / mem_total);
+    return 100.0f *
+           (1.0f - static_cast<float>(mem_available) / static_cast<float>(mem_total));
 #else
     return 0.0f;
 #endif
   }
 
-  HealthStatus determine_overall_status()
+#ifdef __linux__
+  static void close_sample(ThreadSample& sample)
   {
-    if (current_health.cpu_usage_percent >= config.cpu_critical_threshold ||
-        current_health.memory_usage_percent >= config.memory_critical_threshold)
+    if (sample.stat_fd >= 0) ::close(sample.stat_fd);
+    if (sample.schedstat_fd >= 0) ::close(sample.schedstat_fd);
+    sample.stat_fd = sample.schedstat_fd = -1;
+  }
+
+  /**
+   * @brief Read utime+stime and thread name from /proc/self/task/<tid>/stat
+   */
+  static bool read_thread_stat(ThreadSample& sample, uint64_t& cpu_ticks)
+  {
+    char buf[1024];
+    if (!read_proc(sample.stat_fd, buf, sizeof(buf)))
     {
-      return HealthStatus::CRITICAL;
+      return false;
     }
 
-    bool has_unhealthy = false;
-    bool has_degraded = false;
+    // comm may contain spaces and parentheses; it ends at the last ')'
+    char* open = std::strchr(buf, '(');
+    char* close = std::strrchr(buf, ')');
+    if (!open || !close || close < open)
+    {
+      return false;
+    }
+    sample.comm.assign(open + 1, close);
 
-    for (const auto& [_, health] : component_health)
+    // Fields after comm start at state (3); utime and stime are 14 and 15
+    char* cursor = close + 2;
+    for (int field = 3; field < 14 && *cursor; ++field)
     {
-      if (health.status == HealthStatus::CRITICAL)
+      cursor = std::strchr(cursor, ' ');
+      if (!cursor) return false;
+      ++cursor;
+    }
+    uint64_t utime = std::strtoull(cursor, &cursor, 10);
+    uint64_t stime = std::strtoull(cursor, &cursor, 10);
+    cpu_ticks = utime + stime;
+    return true;
+  }
+#endif
+
+  /**
+   * @brief Sample every thread of the process and match loop probes
+   */
+  std::vector<ThreadHealth> sample_threads(std::chrono::steady_clock::time_point now,
+                                           std::vector<std::shared_ptr<LoopLagProbe>>& probes)
+  {
+    std::vector<ThreadHealth> threads;
+#ifdef __linux__
+    double elapsed = std::chrono::duration<double>(now - prev_thread_sample).count();
+    bool have_interval = prev_thread_sample.time_since_epoch().count() != 0 && elapsed > 0.0;
+    prev_thread_sample = now;
+    static const double ticks_per_second = static_cast<double>(::sysconf(_SC_CLK_TCK));
+
+    for (auto& [_, sample] : thread_samples)
+    {
+      sample.seen = false;
+    }
+
+    if (DIR* dir = ::opendir("/proc/self/task"))
+    {
+      while (dirent* entry = ::readdir(dir))
       {
-        return HealthStatus::CRITICAL;
+        int tid = std::atoi(entry->d_name);
+        if (tid <= 0) continue;
+
+        auto [it, inserted] = thread_samples.try_emplace(tid);
+        ThreadSample& sample = it->second;
+        if (inserted)
+        {
+          std::string base = "/proc/self/task/" + std::to_string(tid);
+          sample.stat_fd = open_proc((base + "/stat").c_str());
+          sample.schedstat_fd = open_proc((base + "/schedstat").c_str());
+        }
+
+        uint64_t cpu_ticks = 0;
+        if (!read_thread_stat(sample, cpu_ticks))
+        {
+          continue;  // Exited since the listing; dropped below
+        }
+        sample.seen = true;
+
+        // schedstat: on-CPU ns, run-queue wait ns, timeslices
+        uint64_t run_delay_ns = sample.run_delay_ns;
+        char buf[128];
+        if (read_proc(sample.schedstat_fd, buf, sizeof(buf)))
+        {
+          char* cursor = buf;
+          std::strtoull(cursor, &cursor, 10);
+          run_delay_ns = std::strtoull(cursor, &cursor, 10);
+        }
+
+        if (sample.primed && have_interval)
+        {
+          ThreadHealth thread;
+          thread.tid = tid;
+          thread.name = sample.comm;
+          thread.cpu_percent = static_cast<float>(
+              100.0 * static_cast<double>(cpu_ticks - sample.cpu_ticks) / ticks_per_second /
+              elapsed);
+          thread.run_delay_percent = static_cast<float>(
+              100.0 * static_cast<double>(run_delay_ns - sample.run_delay_ns) / 1e9 / elapsed);
+          threads.push_back(std::move(thread));
+        }
+
+        sample.cpu_ticks = cpu_ticks;
+        sample.run_delay_ns = run_delay_ns;
+        sample.primed = true;
       }
-      if (health.status == HealthStatus::UNHEALTHY)
+      ::closedir(dir);
+    }
+
+    for (auto it = thread_samples.begin(); it != thread_samples.end();)
+    {
+      if (!it->second.seen)
       {
-        has_unhealthy = true;
+        close_sample(it->second);
+        if (metrics && it->second.cpu_gauge.valid())
+        {
+          metrics->unregister_gauge("thread_cpu_percent", it->second.gauge_labels);
+          metrics->unregister_gauge("thread_run_delay_percent", it->second.gauge_labels);
+        }
+        it = thread_samples.erase(it);
       }
-      else if (health.status == HealthStatus::DEGRADED)
+      else
       {
-        has_degraded = true;
+        ++it;
       }
     }
+#else
+    (void)now;
+#endif
 
-    if (has_unhealthy) return HealthStatus::UNHEALTHY;
-    if (has_degraded) return HealthStatus::DEGRADED;
+    for (auto& probe : probes)
+    {
+      if (probe->thread_id() == 0) continue;  // Not ticked yet
 
-    if (current_health.cpu_usage_percent >= config.cpu_warning_threshold ||
-        current_health.memory_usage_percent >= config.memory_warning_threshold)
+      auto lag = probe->max_lag_since(lag_cursors[probe->instance()]);
+      auto it = std::find_if(threads.begin(), threads.end(), [&probe](const ThreadHealth& t)
+                             { return t.tid == probe->thread_id(); });
+      if (it == threads.end())
+      {
+        ThreadHealth thread;
+        thread.tid = probe->thread_id();
+        threads.push_back(std::move(thread));
+        it = threads.end() - 1;
+      }
+      it->name = probe->name();
+      it->loop_lag = std::max(it->loop_lag, lag);
+    }
+    std::erase_if(lag_cursors,
+                  [&probes](const auto& entry)
+                  {
+                    return std::none_of(probes.begin(), probes.end(), [&](const auto& probe)
+                                        { return probe->instance() == entry.first; });
+                  });
+
+    std::sort(threads.begin(), threads.end(), [](const ThreadHealth& a, const ThreadHealth& b)
+              { return a.cpu_percent > b.cpu_percent; });
+    return threads;
+  }
+
+  HealthStatus thread_status(const ThreadHealth& thread) const
+  {
+    if (thread.cpu_percent >= config.thread_cpu_critical_threshold ||
+        thread.loop_lag >= config.loop_lag_critical)
+    {
+      return HealthStatus::CRITICAL;
+    }
+    if (thread.cpu_percent >= config.thread_cpu_warning_threshold ||
+        thread.loop_lag >= config.loop_lag_warning)
     {
       return HealthStatus::DEGRADED;
     }
-
     return HealthStatus::HEALTHY;
   }
 
-  void check_loop()
+  /**
+   * @brief Report the busiest thread and every probed loop as components
+   */
+  void update_thread_components(const std::vector<ThreadHealth>& threads,
+                                const std::vector<std::shared_ptr<LoopLagProbe>>& probes,
+                                std::chrono::steady_clock::time_point now)
   {
-    while (running.load())
+    for (const auto& name : builtin_components)
+    {
+      component_health.erase(name);
+    }
+    builtin_components.clear();
+
+    auto add = [&](ComponentHealth health)
+    {
+      health.last_check = now;
+      builtin_components.insert(health.name);
+      component_health[health.name] = std::move(health);
+    };
+
+    if (!threads.empty())
     {
+      const ThreadHealth& hottest = threads.front();
+      ComponentHealth health;
+      health.name = "threads";
+      health.load_percent = hottest.cpu_percent;
+      health.status = HealthStatus::HEALTHY;
+      if (hottest.cpu_percent >= config.thread_cpu_critical_threshold)
+      {
+        health.status = HealthStatus::CRITICAL;
+      }
+      else if (hottest.cpu_percent >= config.thread_cpu_warning_threshold)
       {
-        std::lock_guard lock(mutex);
+        health.status = HealthStatus::DEGRADED;
+      }
+      health.message = "busiest " + hottest.name + " (" + std::to_string(hottest.tid) + ")";
+      add(std::move(health));
+    }
 
-        current_health.cpu_usage_percent = get_cpu_usage();
-        current_health.memory_usage_percent = get_memory_usage();
+    for (const auto& probe : probes)
+    {
+      auto it = std::find_if(threads.begin(), threads.end(), [&probe](const ThreadHealth& t)
+                             { return t.tid == probe->thread_id(); });
+      if (it == threads.end()) continue;
+
+      ComponentHealth health;
+      health.name = "loop:" + probe->name();
+      health.status = thread_status(*it);
+      health.latency = std::chrono::duration_cast<std::chrono::milliseconds>(it->loop_lag);
+      health.load_percent = it->cpu_percent;
+      health.message = "run delay " + std::to_string(static_cast<int>(it->run_delay_percent)) + "%";
+      add(std::move(health));
+    }
+  }
 
-        auto now = std::chrono::steady_clock::now();
-        current_health.uptime = std::chrono::duration_cast<std::chrono::seconds>(now - start_time);
+  void publish_metrics(float cpu_percent, float memory_percent,
+                       const std::vector<ThreadHealth>& threads)
+  {
+    if (!metrics) return;
 
-        // Check all components
-        for (const auto& [name, check] : components)
+    if (!cpu_gauge.valid())
+    {
+      cpu_gauge = metrics->register_gauge("cpu_usage_percent");
+      memory_gauge = metrics->register_gauge("memory_usage_percent");
+    }
+    cpu_gauge.set(cpu_percent);
+    memory_gauge.set(memory_percent);
+
+    for (const auto& thread : threads)
+    {
+      auto sample = thread_samples.find(thread.tid);
+      if (sample != thread_samples.end())
+      {
+        if (!sample->second.cpu_gauge.valid())
         {
-          auto health = check();
-          health.name = name;
-          health.last_check = now;
-          component_health[name] = health;
+          Labels labels{{"thread", thread.name}, {"tid", std::to_string(thread.tid)}};
+          sample->second.cpu_gauge = metrics->register_gauge("thread_cpu_percent", labels);
+          sample->second.run_delay_gauge =
+              metrics->register_gauge("thread_run_delay_percent", labels);
+          sample->second.gauge_labels = std::move(labels);
         }
+        sample->second.cpu_gauge.set(thread.cpu_percent);
+        sample->second.run_delay_gauge.set(thread.run_delay_percent);
+      }
+    }
+  }
+
+  void publish_loop_lag(const std::vector<ThreadHealth>& threads,
+                        const std::vector<std::shared_ptr<LoopLagProbe>>& probes)
+  {
+    if (!metrics) return;
+
+    // Same-named loops (one per stream, say) are told apart by instance
+    for (const auto& probe : probes)
+    {
+      auto [it, inserted] = lag_gauges.try_emplace(probe->instance());
+      if (inserted)
+      {
+        it->second.labels = {{"loop", probe->name()},
+                             {"instance", std::to_string(probe->instance())}};
+        it->second.gauge = metrics->register_gauge("event_loop_lag_ms", it->second.labels);
+      }
 
-        // Build component list
-        current_health.components.clear();
-        for (const auto& [_, health] : component_health)
+      auto thread = std::find_if(threads.begin(), threads.end(), [&probe](const ThreadHealth& t)
+                                 { return t.tid == probe->thread_id(); });
+      if (thread != threads.end())
+      {
+        it->second.gauge.set(
+            std::chrono::duration<double, std::milli>(thread->loop_lag).count());
+      }
+    }
+
+    // Drop the series of released probes
+    std::erase_if(lag_gauges,
+                  [&](const auto& entry)
+                  {
+                    bool live = std::any_of(probes.begin(), probes.end(), [&](const auto& probe)
+                                            { return probe->instance() == entry.first; });
+                    if (!live)
+                    {
+                      metrics->unregister_gauge("event_loop_lag_ms", entry.second.labels);
+                    }
+                    return !live;
+                  });
+  }
+
+  /**
+   * @brief Sample, check components and publish
+   *
+   * The monitor mutex is only taken to read registrations and store
+   * results: getters never wait for the /proc scan, and component checks
+   * and the health callback may call back into the monitor.
+   */
+  void run_checks()
+  {
+    auto now = std::chrono::steady_clock::now();
+
+    std::vector<std::shared_ptr<LoopLagProbe>> probes;
+    {
+      std::lock_guard lock(g_probes_mutex);
+      for (const auto& weak : g_probes)
+      {
+        if (auto probe = weak.lock())
         {
-          current_health.components.push_back(health);
+          probes.push_back(std::move(probe));
         }
+      }
+    }
+
+    float cpu_percent = 0.0f;
+    float memory_percent = 0.0f;
+    std::vector<ThreadHealth> threads;
+    {
+      std::lock_guard lock(sample_mutex);
+      cpu_percent = get_cpu_usage();
+      memory_percent = get_memory_usage();
+      threads = sample_threads(now, probes);
+      publish_metrics(cpu_percent, memory_percent, threads);
+      publish_loop_lag(threads, probes);
+    }
 
-        // Determine overall status
-        auto prev_status = current_health.overall_status;
-        current_health.overall_status = determine_overall_status();
+    // Check all components
+    std::vector<std::pair<std::string, HealthCheckCallback>> checks;
+    {
+      std::lock_guard lock(mutex);
+      checks.assign(components.begin(), components.end());
+    }
+    std::vector<ComponentHealth> results;
+    results.reserve(checks.size());
+    for (const auto& [name, check] : checks)
+    {
+      auto health = check();
+      health.name = name;
+      health.last_check = now;
+      results.push_back(std::move(health));
+    }
 
-        // Notify on change
-        if (current_health.overall_status != prev_status && health_callback)
+    HealthChangeCallback callback;
+    SystemHealth changed;
+    {
+      std::lock_guard lock(mutex);
+      current_health.cpu_usage_percent = cpu_percent;
+      current_health.memory_usage_percent = memory_percent;
+      current_health.uptime =
+          std::chrono::duration_cast<std::chrono::seconds>(now - start_time);
+      current_health.threads = threads;
+      update_thread_components(threads, probes, now);
+
+      for (auto& health : results)
+      {
+        if (components.count(health.name))  // Not unregistered meanwhile
         {
-          health_callback(current_health);
+          component_health[health.name] = std::move(health);
         }
       }
 
-      std::this_thread::sleep_for(config.check_interval);
+      // Build component list
+      current_health.components.clear();
+      for (const auto& [_, health] : component_health)
+      {
+        current_health.components.push_back(health);
+      }
+
+      // Determine overall status
+      auto prev_status = current_health.overall_status;
+      current_health.overall_status = determine_overall_status();
+
+      if (current_health.overall_status != prev_status && health_callback)
+      {
+        callback = health_callback;
+        changed = current_health;
+      }
+    }
+
+    // Notify on change
+    if (callback)
+    {
+      callback(changed);
     }
   }
+
+  HealthStatus determine_overall_status()
+  {
+    if (current_health.cpu_usage_percent >= config.cpu_critical_threshold ||
+        current_health.memory_usage_percent >= config.memory_critical_threshold)
+    {
+      return HealthStatus::CRITICAL;
+    }
+
+    bool has_unhealthy = false;
+    bool has_degraded = false;
+
+    for (const auto& [_, health] : component_health)
+    {
+      if (health.status == HealthStatus::CRITICAL)
+      {
+        return HealthStatus::CRITICAL;
+      }
+      if (health.status == HealthStatus::UNHEALTHY)
+      {
+        has_unhealthy = true;
+      }
+      else if (health.status == HealthStatus::DEGRADED)
+      {
+        has_degraded = true;
+      }
+    }
+
+    if (has_unhealthy) return HealthStatus::UNHEALTHY;
+    if (has_degraded) return HealthStatus::DEGRADED;
+
+    if (current_health.cpu_usage_percent >= config.cpu_warning_threshold ||
+        current_health.memory_usage_percent >= config.memory_warning_threshold)
+    {
+      return HealthStatus::DEGRADED;
+    }
+
+    return HealthStatus::HEALTHY;
+  }
 };
 
 HealthMonitor::HealthMonitor(HealthMonitorConfig config)
@@ -191,21 +725,20 @@ HealthMonitor::~HealthMonitor()
 
 void HealthMonitor::start()
 {
-  if (impl_->running.load()) return;
+  if (impl_->running.exchange(true)) return;
 
-  impl_->running.store(true);
-  impl_->monitor_thread = std::thread([this]() { impl_->check_loop(); });
+  // First check right away, then every check_interval. The wheel only
+  // dispatches the periodic runs: the scan and callbacks run on the pool.
+  impl_->run_checks();
+  impl_->check_task = TaskScheduler::shared().schedule_periodic(
+      impl_->config.check_interval, [this]() { impl_->run_checks(); });
 }
 
 void HealthMonitor::stop()
 {
-  if (!impl_->running.load()) return;
+  if (!impl_->running.exchange(false)) return;
 
-  impl_->running.store(false);
-  if (impl_->monitor_thread.joinable())
-  {
-    impl_->monitor_thread.join();
-  }
+  TaskScheduler::shared().cancel_periodic(std::exchange(impl_->check_task, 0));
 }
 
 void HealthMonitor::register_component(const std::string& name, HealthCheckCallback check)
@@ -244,21 +777,26 @@ ComponentHealth HealthMonitor::get_component_health(const std::string& name) con
   return {};
 }
 
-void HealthMonitor::check_now()
+void HealthMonitor::set_metrics_exporter(MetricsExporter* exporter)
 {
-  // Trigger immediate check
-  std::lock_guard lock(impl_->mutex);
-
-  auto now = std::chrono::steady_clock::now();
-  for (const auto& [name, check] : impl_->components)
+  std::lock_guard lock(impl_->sample_mutex);
+  impl_->metrics = exporter;
+  impl_->cpu_gauge = {};
+  impl_->memory_gauge = {};
+  impl_->lag_gauges.clear();
+  for (auto& [_, sample] : impl_->thread_samples)
   {
-    auto health = check();
-    health.name = name;
-    health.last_check = now;
-    impl_->component_health[name] = health;
+    sample.cpu_gauge = {};
+    sample.run_delay_gauge = {};
   }
 }
 
+void HealthMonitor::check_now()
+{
+  // Trigger immediate check
+  impl_->run_checks();
+}
+
 bool HealthMonitor::is_healthy() const
 {
   std::lock_guard lock(impl_->mutex);
@@ -1,13 +1,23 @@
 /**
  * @file ice_agent.cpp
- * @brief ICE agent implementation (stub)
+ * @brief ICE agent implementation
  */
 
 #include "rtc/ice_agent.h"
 
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#endif
+
+#include <algorithm>
 #include <random>
 #include <sstream>
 
+#include "rtc/connection_recovery.h"
+#include "rtc/network_monitor.h"
 #include "rtc/stun_client.h"
 #include "rtc/turn_client.h"
 #include "rtc/udp_socket.h"
@@ -102,9 +112,74 @@ IceCredentials IceCredentials::generate()
   return creds;
 }
 
+namespace
+{
+
+constexpr std::chrono::milliseconds CHECK_RTO{500};  // Retransmit an unanswered check
+constexpr int MAX_CHECK_ATTEMPTS = 7;               // Then the pair fails
+constexpr std::chrono::milliseconds MIN_LOSS_TIMEOUT{100};  // Selected pair check counted lost
+
+// Addresses to gather host candidates on; the wildcard if none is found
+std::vector<std::string> host_addresses(const std::vector<std::string>& configured)
+{
+  std::vector<std::string> result = configured;
+#ifndef _WIN32
+  ifaddrs* interfaces = nullptr;
+  if (result.empty() && ::getifaddrs(&interfaces) == 0)
+  {
+    for (ifaddrs* it = interfaces; it; it = it->ifa_next)
+    {
+      if (!it->ifa_addr || it->ifa_addr->sa_family != AF_INET || !(it->ifa_flags & IFF_UP) ||
+          (it->ifa_flags & IFF_LOOPBACK))
+      {
+        continue;
+      }
+      char ip[INET_ADDRSTRLEN];
+      const auto* v4 = reinterpret_cast<const sockaddr_in*>(it->ifa_addr);
+      if (::inet_ntop(AF_INET, &v4->sin_addr, ip, sizeof(ip)) &&
+          std::find(result.begin(), result.end(), ip) == result.end())
+      {
+        result.emplace_back(ip);
+      }
+    }
+    ::freeifaddrs(interfaces);
+  }
+#endif
+  if (result.empty())
+  {
+    result.emplace_back("0.0.0.0");
+  }
+  return result;
+}
+
+// Address a candidate's packets are sent from and received on
+const SocketAddress& base_address(const IceCandidate& candidate)
+{
+  return candidate.type == IceCandidateType::HOST ? candidate.address : candidate.related_address;
+}
+
+bool same_path(const IceCandidatePair& a, const IceCandidatePair& b)
+{
+  return a.local.address == b.local.address && a.remote.address == b.remote.address;
+}
+
+}  // namespace
+
 // IceAgent implementation
 struct IceAgent::Impl
 {
+  struct PendingCheck
+  {
+    StunTransactionId transaction;
+    SocketAddress local;  // Base the check was sent from
+    SocketAddress remote;  // Pairs may be added while a check is out
+    std::chrono::steady_clock::time_point first_sent;
+    std::chrono::steady_clock::time_point last_sent;
+    int attempts = 1;
+    bool nominate = false;      // Carries USE-CANDIDATE
+    bool counted_lost = false;  // Against the selected pair
+  };
+
   Config config;
   IceAgentCallbacks callbacks;
   IceCredentials local_credentials;
@@ -115,17 +190,540 @@ struct IceAgent::Impl
   std::optional<IceCandidatePair> selected_pair;
   IceConnectionState connection_state = IceConnectionState::NEW;
   IceGatheringState gathering_state = IceGatheringState::NEW;
-  std::shared_ptr<UdpSocket> socket;
+  std::vector<std::pair<SocketAddress, std::unique_ptr<UdpSocket>>> sockets;  // Per host base
   std::unique_ptr<StunClient> stun_client;
+  ConnectionRecovery* recovery = nullptr;
   Stats stats;
 
+  // Connectivity checks
+  uint64_t tiebreaker = 0;
+  std::vector<PendingCheck> pending_checks;
+  std::chrono::steady_clock::time_point last_check_time;
+  std::chrono::steady_clock::time_point checking_started;
+  bool has_connected = false;
+
+  // Failover: unanswered checks on the selected pair since its last response
+  int active_checks_lost = 0;
+
+  // Restart in progress: selected_pair keeps carrying media meanwhile
+  bool restarting = false;
+  std::chrono::steady_clock::time_point restart_started;
+
+  std::vector<uint8_t> recv_buffer = std::vector<uint8_t>(1500);  // MTU size
+
   Impl(Config cfg) : config(std::move(cfg))
   {
     local_credentials = IceCredentials::generate();
-    socket = UdpSocket::create();
-    if (socket)
+    tiebreaker = std::mt19937_64(std::random_device{}())();
+    refresh_sockets();
+  }
+
+  // One socket per current host address, in interface order: sockets of
+  // addresses still present are kept, new ones bound, the rest closed
+  void refresh_sockets()
+  {
+    std::vector<std::pair<SocketAddress, std::unique_ptr<UdpSocket>>> current;
+    for (const auto& ip : host_addresses(config.host_addresses))
+    {
+      auto kept = std::find_if(sockets.begin(), sockets.end(),
+                               [&ip](const auto& entry) { return entry.first.ip == ip; });
+      if (kept != sockets.end())
+      {
+        current.push_back(std::move(*kept));
+        continue;
+      }
+
+      auto socket = UdpSocket::create();
+      if (!socket || socket->bind(ip, 0)) continue;
+      (void)socket->set_non_blocking(true);  // Drained from process()
+      current.emplace_back(socket->local_address(), std::move(socket));
+    }
+
+    for (auto& [address, socket] : sockets)
     {
-      socket->bind("0.0.0.0", 0);
+      if (socket) socket->close();
+    }
+    sockets = std::move(current);
+  }
+
+  // Whether any of the addresses would get a host candidate that is not offered yet
+  bool offers_new_host(const std::vector<std::string>& addresses) const
+  {
+    auto hosts = host_addresses(config.host_addresses);
+    return std::any_of(
+        addresses.begin(), addresses.end(),
+        [&](const std::string& ip)
+        {
+          bool bound = std::any_of(sockets.begin(), sockets.end(),
+                                   [&ip](const auto& entry) { return entry.first.ip == ip; });
+          return !bound && std::find(hosts.begin(), hosts.end(), ip) != hosts.end();
+        });
+  }
+
+  UdpSocket* socket_for(const SocketAddress& base)
+  {
+    for (auto& [address, socket] : sockets)
+    {
+      if (address == base) return socket.get();
+    }
+    return nullptr;
+  }
+
+  void set_connection_state(IceConnectionState state)
+  {
+    if (connection_state == state) return;
+    connection_state = state;
+    if (callbacks.on_connection_state_change)
+    {
+      callbacks.on_connection_state_change(state);
+    }
+  }
+
+  bool checks_enabled() const
+  {
+    return !remote_credentials.username_fragment.empty() &&
+           (connection_state == IceConnectionState::CHECKING || restarting);
+  }
+
+  IceCandidatePair* find_pair(const SocketAddress& local, const SocketAddress& remote)
+  {
+    for (auto& pair : candidate_pairs)
+    {
+      if (pair.remote.address == remote && base_address(pair.local) == local) return &pair;
+    }
+    return nullptr;
+  }
+
+  IceCandidatePair* find_pair(const IceCandidatePair& path)
+  {
+    return find_pair(base_address(path.local), path.remote.address);
+  }
+
+  // Local address a pair's packets leave from
+  std::optional<std::string> source_of(const IceCandidatePair& pair) const
+  {
+    const auto& base = base_address(pair.local);
+    if (base.ip.empty() || base.ip == "0.0.0.0")
+    {
+      return NetworkMonitor::route_source(pair.remote.address);  // Kernel's choice
+    }
+    return base.ip;
+  }
+
+  // While nothing is selected, the first pair to succeed is used
+  bool aggressive_nomination(const IceCandidatePair& pair) const
+  {
+    return config.role == IceRole::CONTROLLING ? !selected_pair || restarting : pair.nominated;
+  }
+
+  void send_check(IceCandidatePair& pair, bool nominate,
+                  const StunTransactionId* retransmit = nullptr)
+  {
+    const auto& local = base_address(pair.local);
+    UdpSocket* socket = socket_for(local);
+    if (!socket) return;
+
+    StunMessage request(StunMessageType::BINDING_REQUEST);
+    if (retransmit)
+    {
+      request.set_transaction_id(*retransmit);
+    }
+
+    std::string username =
+        remote_credentials.username_fragment + ":" + local_credentials.username_fragment;
+    request.add_attribute({StunAttributeType::USERNAME, {username.begin(), username.end()}});
+
+    uint32_t priority = IceCandidate::calculate_priority(IceCandidateType::PEER_REFLEXIVE, 65535,
+                                                         pair.local.component);
+    request.add_attribute(
+        {StunAttributeType::PRIORITY,
+         {static_cast<uint8_t>(priority >> 24), static_cast<uint8_t>(priority >> 16),
+          static_cast<uint8_t>(priority >> 8), static_cast<uint8_t>(priority)}});
+
+    std::vector<uint8_t> tie(8);
+    for (int i = 0; i < 8; ++i)
+    {
+      tie[i] = static_cast<uint8_t>(tiebreaker >> (56 - 8 * i));
+    }
+    if (config.role == IceRole::CONTROLLING)
+    {
+      request.add_attribute({StunAttributeType::ICE_CONTROLLING, std::move(tie)});
+      if (nominate)
+      {
+        request.add_attribute({StunAttributeType::USE_CANDIDATE, {}});
+        pair.nominated = true;
+      }
+    }
+    else
+    {
+      request.add_attribute({StunAttributeType::ICE_CONTROLLED, std::move(tie)});
+    }
+
+    request.add_message_integrity(remote_credentials.password);
+    request.add_fingerprint();
+
+    auto bytes = request.serialize();
+    auto [error, sent] = socket->send_to(bytes, pair.remote.address);
+    if (!error)
+    {
+      stats.connectivity_checks_sent++;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (!retransmit)
+    {
+      // Consent and standby checks leave a succeeded pair usable
+      if (pair.state != IceCandidatePair::State::SUCCEEDED)
+      {
+        pair.state = IceCandidatePair::State::IN_PROGRESS;
+      }
+      pair.last_check_sent = now;
+      pending_checks.push_back(
+          {request.transaction_id(), local, pair.remote.address, now, now, 1, nominate});
+    }
+  }
+
+  void select(IceCandidatePair& pair)
+  {
+    if (selected_pair && same_path(*selected_pair, pair) && !restarting)
+    {
+      return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    selected_pair = pair;
+    selected_pair->route_source = source_of(pair).value_or("");
+    active_checks_lost = 0;
+
+    // Earlier nominations no longer apply
+    for (auto& other : candidate_pairs)
+    {
+      if (&other != &pair) other.nominated = false;
+    }
+
+    if (!has_connected)
+    {
+      has_connected = true;
+      stats.time_to_connected =
+          std::chrono::duration_cast<std::chrono::milliseconds>(now - checking_started);
+    }
+    bool restarted = restarting;
+    if (restarting)
+    {
+      restarting = false;
+      stats.ice_restarts++;
+      stats.last_restart_duration =
+          std::chrono::duration_cast<std::chrono::milliseconds>(now - restart_started);
+    }
+
+    set_connection_state(IceConnectionState::CONNECTED);
+    if (callbacks.on_selected_pair)
+    {
+      callbacks.on_selected_pair(pair);
+    }
+    if (restarted && recovery)
+    {
+      recovery->on_reconnected();
+    }
+  }
+
+  // ICE checks carry both; requests are keyed with the responder's password
+  bool authentic(const StunMessage& message, const std::string& password)
+  {
+    if (message.verify_fingerprint() && message.verify_message_integrity(password))
+    {
+      return true;
+    }
+    stats.unauthenticated_rejected++;
+    return false;
+  }
+
+  void handle_request(const StunMessage& request, const SocketAddress& source,
+                      const SocketAddress& local)
+  {
+    // USERNAME is "<our ufrag>:<their ufrag>"; anything else predates a restart
+    const auto* username = request.find_attribute(StunAttributeType::USERNAME);
+    std::string expected = local_credentials.username_fragment + ":";
+    if (!username || username->value.size() < expected.size() ||
+        !std::equal(expected.begin(), expected.end(), username->value.begin()))
+    {
+      stats.stale_checks_rejected++;
+      return;
+    }
+    if (!authentic(request, local_credentials.password))
+    {
+      return;
+    }
+
+    StunMessage response(StunMessageType::BINDING_RESPONSE);
+    response.set_transaction_id(request.transaction_id());
+    response.add_xor_mapped_address(source);
+    response.add_message_integrity(local_credentials.password);
+    response.add_fingerprint();
+    if (UdpSocket* socket = socket_for(local))
+    {
+      auto bytes = response.serialize();
+      (void)socket->send_to(bytes, source);
+    }
+
+    IceCandidatePair* pair = find_pair(local, source);
+    if (!pair && !local_candidates.empty())
+    {
+      // Peer-reflexive remote candidate learned from the check itself
+      IceCandidate remote;
+      remote.foundation = "prflx";
+      remote.address = source;
+      remote.type = IceCandidateType::PEER_REFLEXIVE;
+      remote.priority =
+          IceCandidate::calculate_priority(IceCandidateType::PEER_REFLEXIVE, 65535, 1);
+      if (const auto* priority = request.find_attribute(StunAttributeType::PRIORITY);
+          priority && priority->value.size() == 4)
+      {
+        remote.priority = (static_cast<uint32_t>(priority->value[0]) << 24) |
+                          (static_cast<uint32_t>(priority->value[1]) << 16) |
+                          (static_cast<uint32_t>(priority->value[2]) << 8) | priority->value[3];
+      }
+      remote_candidates.push_back(remote);
+      add_pairs(remote);
+      pair = find_pair(local, source);
+    }
+    if (!pair) return;
+
+    bool use_candidate = request.find_attribute(StunAttributeType::USE_CANDIDATE) != nullptr;
+    if (use_candidate && config.role == IceRole::CONTROLLED)
+    {
+      pair->nominated = true;
+      if (pair->state == IceCandidatePair::State::SUCCEEDED)
+      {
+        select(*pair);
+        return;
+      }
+    }
+
+    // Triggered check so the pair is validated in our direction too (after
+    // selection this is how a nominated standby gets validated)
+    bool can_check = checks_enabled() ||
+                     (selected_pair && !remote_credentials.username_fragment.empty());
+    if (can_check && (pair->state == IceCandidatePair::State::FROZEN ||
+                      pair->state == IceCandidatePair::State::WAITING ||
+                      pair->state == IceCandidatePair::State::FAILED))
+    {
+      send_check(*pair, aggressive_nomination(*pair));
+    }
+  }
+
+  void handle_response(const StunMessage& response, const SocketAddress& source,
+                       const SocketAddress& local)
+  {
+    auto it = std::find_if(pending_checks.begin(), pending_checks.end(),
+                           [&](const PendingCheck& check)
+                           { return check.transaction == response.transaction_id(); });
+    if (it == pending_checks.end()) return;
+
+    // A forged response leaves the check pending for the real one
+    if (!authentic(response, remote_credentials.password)) return;
+
+    PendingCheck check = *it;
+    pending_checks.erase(it);
+
+    IceCandidatePair* pair = find_pair(check.local, check.remote);
+    if (!pair) return;
+
+    // Answered from or to elsewhere: the path is not symmetric (RFC 8445 7.2.5.2.1)
+    if (!(source == check.remote) || !(local == check.local))
+    {
+      pair->state = IceCandidatePair::State::FAILED;
+      return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    pair->state = IceCandidatePair::State::SUCCEEDED;
+    pair->last_activity = now;
+
+    // Smoothed like RFC 6298 SRTT. A retransmission reuses the transaction
+    // ID, so its response cannot be matched to a send: no sample (Karn)
+    if (check.attempts == 1)
+    {
+      auto sample =
+          std::chrono::duration_cast<std::chrono::milliseconds>(now - check.first_sent);
+      pair->rtt = pair->rtt.count() == 0 ? sample : (pair->rtt * 7 + sample) / 8;
+    }
+
+    if (selected_pair && same_path(*selected_pair, *pair))
+    {
+      active_checks_lost = 0;
+      selected_pair->rtt = pair->rtt;
+    }
+
+    if (pair->nominated)
+    {
+      select(*pair);
+    }
+  }
+
+  void retransmit_checks(std::chrono::steady_clock::time_point now)
+  {
+    // Retransmit unanswered checks, failing pairs that never answer
+    for (auto it = pending_checks.begin(); it != pending_checks.end();)
+    {
+      if (now - it->last_sent < CHECK_RTO)
+      {
+        ++it;
+        continue;
+      }
+
+      IceCandidatePair* pair = find_pair(it->local, it->remote);
+      if (!pair || it->attempts >= MAX_CHECK_ATTEMPTS)
+      {
+        if (pair) pair->state = IceCandidatePair::State::FAILED;
+        it = pending_checks.erase(it);
+        continue;
+      }
+
+      send_check(*pair, it->nominate, &it->transaction);
+      it->last_sent = now;
+      it->attempts++;
+      ++it;
+    }
+  }
+
+  // Most recently answered standby with the lowest RTT
+  IceCandidatePair* best_standby(const IceCandidatePair& active,
+                                 std::chrono::steady_clock::time_point now)
+  {
+    IceCandidatePair* best = nullptr;
+    for (auto& pair : candidate_pairs)
+    {
+      if (&pair == &active || pair.state != IceCandidatePair::State::SUCCEEDED ||
+          now - pair.last_activity > config.standby_check_interval + CHECK_RTO)
+      {
+        continue;
+      }
+      if (!best || pair.rtt < best->rtt ||
+          (pair.rtt == best->rtt && pair.priority > best->priority))
+      {
+        best = &pair;
+      }
+    }
+    return best;
+  }
+
+  // Connected: keep the selected pair and standbys checked, fail over if needed
+  void maintain_paths(std::chrono::steady_clock::time_point now)
+  {
+    IceCandidatePair* active = find_pair(*selected_pair);
+    if (!active) return;
+
+    if (now - active->last_check_sent >= config.consent_check_interval)
+    {
+      send_check(*active, false);
+    }
+
+    // A check on the selected pair unanswered for a few RTTs counts as lost
+    auto lost_after = std::clamp(active->rtt * 3, MIN_LOSS_TIMEOUT, CHECK_RTO);
+    for (auto& check : pending_checks)
+    {
+      if (!check.counted_lost && check.remote == active->remote.address &&
+          check.local == base_address(active->local) && now - check.first_sent >= lost_after)
+      {
+        check.counted_lost = true;
+        active_checks_lost++;
+      }
+    }
+
+    // Low-rate checks on standbys; validate further pairs until there are enough
+    size_t standbys = 0;
+    IceCandidatePair* unchecked = nullptr;
+    for (auto& pair : candidate_pairs)
+    {
+      if (&pair == active) continue;
+      if (pair.state == IceCandidatePair::State::SUCCEEDED && standbys < config.standby_pairs)
+      {
+        standbys++;
+        if (now - pair.last_check_sent >= config.standby_check_interval)
+        {
+          send_check(pair, false);
+        }
+      }
+      else if ((pair.state == IceCandidatePair::State::FROZEN ||
+                pair.state == IceCandidatePair::State::WAITING) &&
+               (!unchecked || pair.priority > unchecked->priority))
+      {
+        unchecked = &pair;
+      }
+    }
+    if (standbys < config.standby_pairs && unchecked &&
+        now - last_check_time >= config.connectivity_check_interval)
+    {
+      send_check(*unchecked, false);
+      last_check_time = now;
+    }
+
+    auto silence = now - active->last_activity;
+    if (active_checks_lost < config.failover_lost_checks && silence < config.failover_silence)
+    {
+      if (connection_state == IceConnectionState::DISCONNECTED)
+      {
+        set_connection_state(IceConnectionState::CONNECTED);  // The path came back
+      }
+      return;
+    }
+
+    IceCandidatePair* standby = best_standby(*active, now);
+    if (!standby)
+    {
+      if (silence >= config.disconnect_timeout)
+      {
+        set_connection_state(IceConnectionState::DISCONNECTED);
+      }
+      return;
+    }
+
+    fail_over(*standby, std::chrono::duration_cast<std::chrono::milliseconds>(silence));
+  }
+
+  void fail_over(IceCandidatePair& standby, std::chrono::milliseconds outage)
+  {
+    // Already validated, so the switch costs no round trip; the controlled
+    // side follows our nomination
+    IceCandidatePair from = *selected_pair;
+    stats.failovers++;
+    stats.last_failover_outage = outage;
+    if (config.role == IceRole::CONTROLLING)
+    {
+      send_check(standby, true);
+    }
+    select(standby);
+    if (callbacks.on_failover)
+    {
+      callbacks.on_failover(from, *selected_pair);
+    }
+    if (recovery)
+    {
+      recovery->on_path_switched(outage,
+                                 "Failover to " + selected_pair->remote.address.to_string());
+    }
+  }
+
+  void add_pairs(const IceCandidate& remote)
+  {
+    // Create pairs with all local candidates
+    for (const auto& local : local_candidates)
+    {
+      IceCandidatePair pair;
+      pair.local = local;
+      pair.remote = remote;
+      // Priority calculation for controlling/controlled
+      if (config.role == IceRole::CONTROLLING)
+      {
+        pair.priority = (static_cast<uint64_t>(local.priority) << 32) + remote.priority;
+      }
+      else
+      {
+        pair.priority = (static_cast<uint64_t>(remote.priority) << 32) + local.priority;
+      }
+      pair.state = IceCandidatePair::State::FROZEN;
+      candidate_pairs.push_back(pair);
     }
   }
 };
@@ -139,6 +737,11 @@ void IceAgent::set_callbacks(IceAgentCallbacks callbacks)
   impl_->callbacks = std::move(callbacks);
 }
 
+void IceAgent::set_recovery(ConnectionRecovery* recovery)
+{
+  impl_->recovery = recovery;
+}
+
 const IceCredentials& IceAgent::local_credentials() const
 {
   return impl_->local_credentials;
@@ -157,16 +760,17 @@ void IceAgent::gather_candidates()
     impl_->callbacks.on_gathering_state_change(impl_->gathering_state);
   }
 
-  // Gather host candidates
-  if (impl_->config.gather_host_candidates && impl_->socket)
+  // Gather host candidates, one per socket, preferred in interface order
+  for (size_t i = 0; impl_->config.gather_host_candidates && i < impl_->sockets.size(); ++i)
   {
     IceCandidate host;
-    host.foundation = "1";
+    host.foundation = std::to_string(i + 1);
     host.component = 1;
     host.protocol = "udp";
-    host.address = impl_->socket->local_address();
+    host.address = impl_->sockets[i].first;
     host.type = IceCandidateType::HOST;
-    host.priority = IceCandidate::calculate_priority(IceCandidateType::HOST, 65535, 1);
+    host.priority = IceCandidate::calculate_priority(IceCandidateType::HOST,
+                                                     65535 - static_cast<uint32_t>(i), 1);
 
     impl_->local_candidates.push_back(host);
     impl_->stats.candidates_gathered++;
@@ -190,34 +794,16 @@ void IceAgent::gather_candidates()
 void IceAgent::add_remote_candidate(const IceCandidate& candidate)
 {
   impl_->remote_candidates.push_back(candidate);
-
-  // Create pairs with all local candidates
-  for (const auto& local : impl_->local_candidates)
-  {
-    IceCandidatePair pair;
-    pair.local = local;
-    pair.remote = candidate;
-    // Priority calculation for controlling/controlled
-    if (impl_->config.role == IceRole::CONTROLLING)
-    {
-      pair.priority = (static_cast<uint64_t>(local.priority) << 32) + candidate.priority;
-    }
-    else
-    {
-      pair.priority = (static_cast<uint64_t>(candidate.priority) << 32) + local.priority;
-    }
-    pair.state = IceCandidatePair::State::FROZEN;
-    impl_->candidate_pairs.push_back(pair);
-  }
+  impl_->add_pairs(candidate);
 }
 
 void IceAgent::set_remote_candidates_complete()
 {
-  // Start connectivity checks
-  impl_->connection_state = IceConnectionState::CHECKING;
-  if (impl_->callbacks.on_connection_state_change)
+  // Start connectivity checks; during a restart the old pair stays CONNECTED
+  impl_->checking_started = std::chrono::steady_clock::now();
+  if (!impl_->restarting)
   {
-    impl_->callbacks.on_connection_state_change(impl_->connection_state);
+    impl_->set_connection_state(IceConnectionState::CHECKING);
   }
 }
 
@@ -241,6 +827,87 @@ std::optional<IceCandidatePair> IceAgent::selected_pair() const
   return impl_->selected_pair;
 }
 
+void IceAgent::restart()
+{
+  impl_->local_credentials = IceCredentials::generate();
+  impl_->remote_credentials = {};
+  impl_->local_candidates.clear();
+  impl_->remote_candidates.clear();
+  impl_->candidate_pairs.clear();
+  impl_->pending_checks.clear();
+
+  // Media keeps flowing over selected_pair until a new pair is nominated
+  impl_->restarting = impl_->selected_pair.has_value();
+  impl_->restart_started = std::chrono::steady_clock::now();
+  if (!impl_->restarting)
+  {
+    impl_->set_connection_state(IceConnectionState::NEW);
+  }
+
+  // Offer the interfaces present now, not those found at construction
+  impl_->refresh_sockets();
+  gather_candidates();
+}
+
+bool IceAgent::is_restarting() const
+{
+  return impl_->restarting;
+}
+
+IceNetworkAction IceAgent::on_network_change(const NetworkChange& change)
+{
+  bool went_away = change.type == NetworkChangeType::ADDRESS_REMOVED ||
+                   change.type == NetworkChangeType::LINK_DOWN;
+  if (!went_away)
+  {
+    if (impl_->restarting) return IceNetworkAction::NONE;
+
+    // A new path may bring back a session that lost its own
+    bool down = impl_->connection_state == IceConnectionState::DISCONNECTED ||
+                impl_->connection_state == IceConnectionState::FAILED;
+    if (down) return IceNetworkAction::RESTART;
+
+    // A new address is only offered by a restart; a session with a live
+    // standby already has a second path, anyone else gathers on it now
+    if (change.type != NetworkChangeType::ADDRESS_ADDED || !impl_->selected_pair ||
+        !impl_->offers_new_host(change.addresses))
+    {
+      return IceNetworkAction::NONE;
+    }
+    IceCandidatePair* active = impl_->find_pair(*impl_->selected_pair);
+    bool standby = active && impl_->best_standby(*active, std::chrono::steady_clock::now());
+    return standby ? IceNetworkAction::NONE : IceNetworkAction::RESTART;
+  }
+
+  if (!impl_->selected_pair || impl_->restarting) return IceNetworkAction::NONE;
+
+  const auto& removed = change.addresses;
+  auto is_removed = [&](const std::string& address)
+  { return std::find(removed.begin(), removed.end(), address) != removed.end(); };
+
+  // Unknown source (no route at selection): affected if it has no route now
+  const std::string& source = impl_->selected_pair->route_source;
+  bool affected =
+      source.empty() ? !impl_->source_of(*impl_->selected_pair) : is_removed(source);
+  if (!affected) return IceNetworkAction::NONE;
+
+  IceCandidatePair* active = impl_->find_pair(*impl_->selected_pair);
+  auto now = std::chrono::steady_clock::now();
+  if (active)
+  {
+    // The kernel already routes around the change; take a standby it can still reach
+    IceCandidatePair* standby = impl_->best_standby(*active, now);
+    auto route = standby ? impl_->source_of(*standby) : std::nullopt;
+    if (route && !is_removed(*route))
+    {
+      impl_->fail_over(*standby, std::chrono::duration_cast<std::chrono::milliseconds>(
+                                     now - active->last_activity));
+      return IceNetworkAction::SWITCHED;
+    }
+  }
+  return IceNetworkAction::RESTART;
+}
+
 bool IceAgent::send(std::span<const uint8_t> data)
 {
   if (!impl_->selected_pair || impl_->connection_state != IceConnectionState::CONNECTED)
@@ -248,7 +915,13 @@ bool IceAgent::send(std::span<const uint8_t> data)
     return false;
   }
 
-  auto [error, sent] = impl_->socket->send_to(data, impl_->selected_pair->remote.address);
+  UdpSocket* socket = impl_->socket_for(base_address(impl_->selected_pair->local));
+  if (!socket)
+  {
+    return false;
+  }
+
+  auto [error, sent] = socket->send_to(data, impl_->selected_pair->remote.address);
   if (!error)
   {
     impl_->selected_pair->bytes_sent += sent;
@@ -258,12 +931,41 @@ bool IceAgent::send(std::span<const uint8_t> data)
 
 bool IceAgent::process_packet(std::span<const uint8_t> data, const SocketAddress& source)
 {
+  return process_packet(data, source,
+                        impl_->sockets.empty() ? SocketAddress{} : impl_->sockets.front().first);
+}
+
+bool IceAgent::process_packet(std::span<const uint8_t> data, const SocketAddress& source,
+                              const SocketAddress& local)
+{
+  // Anything from the remote end shows the path is alive
+  if (IceCandidatePair* pair = impl_->find_pair(local, source))
+  {
+    pair->last_activity = std::chrono::steady_clock::now();
+    pair->bytes_received += data.size();
+  }
+
   // Check if it's a STUN message (first 2 bits should be 00)
   if (data.size() >= 20 && (data[0] & 0xC0) == 0x00)
   {
-    // It's a STUN packet
-    // TODO: Process STUN binding request/response
-    impl_->stats.connectivity_checks_received++;
+    auto message = StunMessage::parse(data);
+    if (!message)
+    {
+      return false;
+    }
+
+    switch (message->type())
+    {
+      case StunMessageType::BINDING_REQUEST:
+        impl_->stats.connectivity_checks_received++;
+        impl_->handle_request(*message, source, local);
+        break;
+      case StunMessageType::BINDING_RESPONSE:
+        impl_->handle_response(*message, source, local);
+        break;
+      default:
+        break;
+    }
     return true;
   }
 
@@ -277,22 +979,70 @@ bool IceAgent::process_packet(std::span<const uint8_t> data, const SocketAddress
 
 void IceAgent::process()
 {
-  // TODO: Implement periodic processing
-  // - Send connectivity checks
-  // - Handle retransmissions
-  // - Update pair states
+  // Deliver whatever arrived on our sockets (STUN and media)
+  for (auto& [address, socket] : impl_->sockets)
+  {
+    while (true)
+    {
+      auto result = socket->recv_from(impl_->recv_buffer);
+      if (!result.success()) break;
+      process_packet(result.data, result.remote_address, address);
+    }
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  impl_->retransmit_checks(now);
+
+  if (!impl_->checks_enabled())
+  {
+    if (impl_->selected_pair && !impl_->restarting &&
+        (impl_->connection_state == IceConnectionState::CONNECTED ||
+         impl_->connection_state == IceConnectionState::DISCONNECTED))
+    {
+      impl_->maintain_paths(now);
+    }
+    return;
+  }
+
+  // One new check per pacing interval, highest priority first
+  if (now - impl_->last_check_time >= impl_->config.connectivity_check_interval)
+  {
+    IceCandidatePair* best = nullptr;
+    for (auto& pair : impl_->candidate_pairs)
+    {
+      if ((pair.state == IceCandidatePair::State::FROZEN ||
+           pair.state == IceCandidatePair::State::WAITING) &&
+          (!best || pair.priority > best->priority))
+      {
+        best = &pair;
+      }
+    }
+    if (best)
+    {
+      impl_->send_check(*best, impl_->aggressive_nomination(*best));
+      impl_->last_check_time = now;
+    }
+  }
+
+  // Every pair failed: a restart keeps its old pair, otherwise give up
+  bool all_failed = !impl_->candidate_pairs.empty() && impl_->pending_checks.empty() &&
+                    std::all_of(impl_->candidate_pairs.begin(), impl_->candidate_pairs.end(),
+                                [](const IceCandidatePair& pair)
+                                { return pair.state == IceCandidatePair::State::FAILED; });
+  if (all_failed && !impl_->restarting)
+  {
+    impl_->set_connection_state(IceConnectionState::FAILED);
+  }
 }
 
 void IceAgent::close()
 {
-  impl_->connection_state = IceConnectionState::CLOSED;
-  if (impl_->callbacks.on_connection_state_change)
-  {
-    impl_->callbacks.on_connection_state_change(impl_->connection_state);
-  }
-  if (impl_->socket)
+  impl_->restarting = false;
+  impl_->pending_checks.clear();
+  impl_->set_connection_state(IceConnectionState::CLOSED);
+  for (auto& [address, socket] : impl_->sockets)
   {
-    impl_->socket->close();
+    socket->close();
   }
 }
 
@@ -5,78 +5,765 @@
 
 #include "rtc/metrics_exporter.h"
 
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <map>
 #include <mutex>
-#include <sstream>
-#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rtc/metrics_http_server.h"
 
 namespace rtc
 {
 
-struct MetricValue
+namespace
 {
-  MetricType type = MetricType::COUNTER;
-  std::atomic<double> value{0.0};
-  std::string help;
-};
 
-struct LabeledMetricKey
+constexpr size_t kCounterShards = 32;     // Threads map onto shards round-robin
+constexpr size_t kSlotsPerPage = 512;     // Counters per shard page (4 KB)
+constexpr size_t kMaxCounterPages = 256;  // Up to 131072 counter series
+constexpr size_t kSeriesPerChunk = 1024;
+constexpr size_t kMaxSeriesChunks = 1024;  // Up to ~1M series in total
+
+// Log-linear histogram layout: values below 2^kSubBucketBits map 1:1,
+// every higher power of two is split into kSubBuckets linear buckets.
+constexpr int kSubBucketBits = 4;
+constexpr uint64_t kSubBuckets = uint64_t{1} << kSubBucketBits;
+constexpr int kMaxOctave = 32;  // Values clamp to 2^32 resolution units
+constexpr uint64_t kMaxHistogramValue = (uint64_t{1} << kMaxOctave) - 1;
+constexpr size_t kHistogramBuckets = (kMaxOctave - kSubBucketBits + 1) * kSubBuckets;
+
+std::atomic<size_t> next_shard{0};
+
+size_t current_shard()
+{
+  thread_local const size_t shard =
+      next_shard.fetch_add(1, std::memory_order_relaxed) % kCounterShards;
+  return shard;
+}
+
+/**
+ * @brief Load a lazily allocated shard, allocating it on first use
+ *
+ * Threads sharing a shard may race to allocate; the loser frees its copy.
+ */
+template <typename T>
+T& get_or_create(std::atomic<T*>& slot)
+{
+  T* current = slot.load(std::memory_order_acquire);
+  if (current) return *current;
+
+  auto* fresh = new T();
+  if (slot.compare_exchange_strong(current, fresh, std::memory_order_acq_rel))
+  {
+    return *fresh;
+  }
+  delete fresh;
+  return *current;
+}
+
+size_t bucket_index(uint64_t v)
+{
+  if (v < kSubBuckets) return static_cast<size_t>(v);
+
+  int shift = std::bit_width(v) - 1 - kSubBucketBits;
+  return static_cast<size_t>((shift + 1) * kSubBuckets + (v >> shift) - kSubBuckets);
+}
+
+uint64_t bucket_lower(size_t index)
+{
+  if (index < kSubBuckets) return index;
+
+  size_t shift = index / kSubBuckets - 1;
+  return (kSubBuckets + index % kSubBuckets) << shift;
+}
+
+uint64_t bucket_width(size_t index)
+{
+  return index < kSubBuckets ? 1 : uint64_t{1} << (index / kSubBuckets - 1);
+}
+
+void append_value(std::string& out, double value)
+{
+  if (std::isnan(value))
+  {
+    out += "NaN";
+    return;
+  }
+  if (std::isinf(value))
+  {
+    out += value > 0 ? "+Inf" : "-Inf";
+    return;
+  }
+
+  char buf[32];
+  std::to_chars_result result;
+
+  // Counters are mostly whole numbers; keep them out of exponent notation
+  if (value == std::trunc(value) && std::fabs(value) < 1e15)
+  {
+    result = std::to_chars(buf, buf + sizeof(buf), static_cast<int64_t>(value));
+  }
+  else
+  {
+    result = std::to_chars(buf, buf + sizeof(buf), value);
+  }
+  out.append(buf, result.ptr);
+}
+
+void append_escaped(std::string& out, const std::string& value)
+{
+  for (char c : value)
+  {
+    switch (c)
+    {
+      case '\\':
+        out += "\\\\";
+        break;
+      case '"':
+        out += "\\\"";
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      default:
+        out += c;
+    }
+  }
+}
+
+/**
+ * @brief Append one sample line, optionally adding an le/quantile label
+ */
+void append_sample(std::string& out, const std::string& name, const char* suffix,
+                   const std::string& label_text, double value, const char* extra_label = nullptr,
+                   double extra_value = 0.0)
+{
+  out += name;
+  out += suffix;
+  if (extra_label)
+  {
+    if (label_text.empty())
+    {
+      out += "{";
+    }
+    else
+    {
+      out.append(label_text, 0, label_text.size() - 1);  // Drop closing brace
+      out += ",";
+    }
+    out += extra_label;
+    out += "=\"";
+    append_value(out, extra_value);
+    out += "\"}";
+  }
+  else
+  {
+    out += label_text;
+  }
+  out += " ";
+  append_value(out, value);
+  out += "\n";
+}
+
+const char* type_name(MetricType type)
+{
+  switch (type)
+  {
+    case MetricType::COUNTER:
+      return "counter";
+    case MetricType::GAUGE:
+      return "gauge";
+    case MetricType::HISTOGRAM:
+      return "histogram";
+    case MetricType::SUMMARY:
+      return "summary";
+  }
+  return "untyped";
+}
+
+}  // namespace
+
+/**
+ * @brief Sharded counter storage
+ *
+ * Shard-major layout: each shard owns lazily allocated pages of slots, so
+ * a thread only ever writes cache lines belonging to its own shard.
+ */
+struct CounterShards
 {
-  std::string name;
-  Labels labels;
+  struct alignas(64) Page
+  {
+    std::array<std::atomic<double>, kSlotsPerPage> slots{};
+  };
 
-  bool operator==(const LabeledMetricKey& other) const
+  struct alignas(64) Shard
   {
-    return name == other.name && labels == other.labels;
+    std::array<std::atomic<Page*>, kMaxCounterPages> pages{};
+  };
+
+  std::array<Shard, kCounterShards> shards;
+
+  CounterShards() = default;
+  CounterShards(const CounterShards&) = delete;
+  CounterShards& operator=(const CounterShards&) = delete;
+
+  ~CounterShards()
+  {
+    for (auto& shard : shards)
+    {
+      for (auto& page : shard.pages)
+      {
+        delete page.load();
+      }
+    }
+  }
+
+  std::atomic<double>& slot(size_t shard, uint32_t index)
+  {
+    Page& page = get_or_create(shards[shard].pages[index / kSlotsPerPage]);
+    return page.slots[index % kSlotsPerPage];
+  }
+
+  double sum(uint32_t index) const
+  {
+    double total = 0.0;
+    for (const auto& shard : shards)
+    {
+      const Page* page = shard.pages[index / kSlotsPerPage].load(std::memory_order_acquire);
+      if (page)
+      {
+        total += page->slots[index % kSlotsPerPage].load(std::memory_order_relaxed);
+      }
+    }
+    return total;
   }
 };
 
-struct LabeledMetricKeyHash
+/**
+ * @brief Sharded log-linear histogram storage
+ *
+ * Integer bucket v holds values in (v, v + 1] * resolution, so the
+ * power-of-two bucket boundaries line up with Prometheus "le" bounds.
+ */
+struct HistogramCells
 {
-  size_t operator()(const LabeledMetricKey& k) const
+  struct alignas(64) Shard
+  {
+    std::array<std::atomic<uint64_t>, kHistogramBuckets> buckets{};
+    std::atomic<double> sum{0.0};
+  };
+
+  struct Snapshot
   {
-    size_t h = std::hash<std::string>{}(k.name);
-    for (const auto& [key, val] : k.labels)
+    std::array<uint64_t, kHistogramBuckets> buckets{};
+    uint64_t count = 0;
+    double sum = 0.0;
+  };
+
+  double resolution = 0.001;
+  std::array<std::atomic<Shard*>, kCounterShards> shards{};
+
+  explicit HistogramCells(double res) : resolution(res) {}
+  HistogramCells(const HistogramCells&) = delete;
+  HistogramCells& operator=(const HistogramCells&) = delete;
+
+  ~HistogramCells()
+  {
+    for (auto& shard : shards)
     {
-      h ^= std::hash<std::string>{}(key) ^ std::hash<std::string>{}(val);
+      delete shard.load();
     }
-    return h;
+  }
+
+  void observe(double value)
+  {
+    if (std::isnan(value)) return;
+
+    double scaled = std::ceil(value / resolution) - 1.0;
+    uint64_t v = 0;
+    if (scaled >= static_cast<double>(kMaxHistogramValue))
+    {
+      v = kMaxHistogramValue;
+    }
+    else if (scaled > 0.0)
+    {
+      v = static_cast<uint64_t>(scaled);
+    }
+
+    Shard& shard = get_or_create(shards[current_shard()]);
+    shard.buckets[bucket_index(v)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  Snapshot snapshot() const
+  {
+    Snapshot snap;
+    for (const auto& shard_ptr : shards)
+    {
+      const Shard* shard = shard_ptr.load(std::memory_order_acquire);
+      if (!shard) continue;
+
+      for (size_t i = 0; i < kHistogramBuckets; ++i)
+      {
+        uint64_t n = shard->buckets[i].load(std::memory_order_relaxed);
+        snap.buckets[i] += n;
+        snap.count += n;
+      }
+      snap.sum += shard->sum.load(std::memory_order_relaxed);
+    }
+    return snap;
+  }
+
+  double quantile(const Snapshot& snap, double q) const
+  {
+    if (snap.count == 0) return std::numeric_limits<double>::quiet_NaN();
+
+    q = std::clamp(q, 0.0, 1.0);
+    auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * snap.count)));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kHistogramBuckets; ++i)
+    {
+      seen += snap.buckets[i];
+      if (seen >= rank)
+      {
+        // Midpoint of the bucket's value range
+        double mid = static_cast<double>(bucket_lower(i)) + bucket_width(i) * 0.5;
+        return mid * resolution;
+      }
+    }
+    return static_cast<double>(kMaxHistogramValue) * resolution;
   }
 };
 
+void MetricCounter::inc(double value) const
+{
+  if (!shards_) return;
+  shards_->slot(current_shard(), index_).fetch_add(value, std::memory_order_relaxed);
+}
+
+void MetricGauge::set(double value) const
+{
+  if (!value_) return;
+  value_->store(value, std::memory_order_relaxed);
+}
+
+void MetricGauge::inc(double value) const
+{
+  if (!value_) return;
+  value_->fetch_add(value, std::memory_order_relaxed);
+}
+
+void MetricHistogram::observe(double value) const
+{
+  if (!cells_) return;
+  cells_->observe(value);
+}
+
+double MetricHistogram::quantile(double q) const
+{
+  if (!cells_) return std::numeric_limits<double>::quiet_NaN();
+  return cells_->quantile(cells_->snapshot(), q);
+}
+
 struct MetricsExporter::Impl
 {
-  MetricsConfig config;
-  mutable std::mutex mutex;
+  /**
+   * @brief Published series; immutable once visible to scrapers
+   *
+   * Except for retired gauges, which are rewritten for reuse under
+   * scrape_mutex while scrapers skip them.
+   */
+  struct Series
+  {
+    const std::string* full_name = nullptr;  // Family name with namespace prefix
+    std::string label_text;
+    MetricType type = MetricType::COUNTER;
+    uint32_t counter_index = 0;
+    std::atomic<double>* gauge = nullptr;
+    HistogramCells* histogram = nullptr;
+    const std::vector<double>* quantiles = nullptr;
+    std::atomic<bool> retired{false};
+  };
+
+  struct SeriesChunk
+  {
+    std::array<Series, kSeriesPerChunk> entries;
+  };
+
+  struct Family
+  {
+    MetricType type = MetricType::COUNTER;
+    std::string full_name;
+    double resolution = 0.001;               // Histograms and summaries
+    std::vector<double> quantiles;           // Summaries only
+    std::map<std::string, uint32_t> series;  // Rendered label set -> series index
+  };
+
+  // Pre-registered handles for the common media types
+  struct MediaCounters
+  {
+    MetricCounter audio;
+    MetricCounter video;
+  };
 
-  std::unordered_map<LabeledMetricKey, MetricValue, LabeledMetricKeyHash> metrics;
-  std::atomic<bool> running{false};
+  MetricsConfig config;
 
-  Impl(MetricsConfig cfg) : config(std::move(cfg)) {}
+  // Guards registration only; updates go through handles
+  mutable std::mutex mutex;
+  std::map<std::string, Family> families;
+
+  // Append-only series table: registration fills a slot and then bumps
+  // published, so scrapers read [0, published) without taking mutex
+  std::array<std::atomic<SeriesChunk*>, kMaxSeriesChunks> series_chunks{};
+  std::atomic<uint32_t> published{0};
+  std::vector<uint32_t> retired_gauges;  // Series indices free for reuse
+
+  // Scrape-side state, never touched by recording or registration
+  mutable std::mutex scrape_mutex;
+  mutable std::vector<uint32_t> scrape_order;  // Sorted by family, then labels
+  mutable size_t scrape_size_hint = 0;
+  CounterShards counters;
+  uint32_t counter_count = 0;
+  std::deque<std::atomic<double>> gauges;
+  std::deque<HistogramCells> histograms;
+
+  MediaCounters packets_sent;
+  MediaCounters packets_received;
+  MediaCounters bytes_sent;
+  MediaCounters bytes_received;
+  MetricGauge active_rooms;
+  MetricGauge active_participants;
+
+  std::unique_ptr<MetricsHttpServer> http_server;
+
+  Impl(MetricsConfig cfg) : config(std::move(cfg))
+  {
+    packets_sent = register_media("packets_sent_total");
+    packets_received = register_media("packets_received_total");
+    bytes_sent = register_media("bytes_sent_total");
+    bytes_received = register_media("bytes_received_total");
+    active_rooms = register_gauge("active_rooms", {});
+    active_participants = register_gauge("active_participants", {});
+  }
 
-  std::string labels_to_string(const Labels& labels) const
+  static std::string labels_to_string(const Labels& labels)
   {
     if (labels.empty()) return "";
 
-    std::ostringstream oss;
-    oss << "{";
+    // Sort so that equal label sets always render (and match) identically
+    std::vector<std::pair<std::string, std::string>> sorted(labels.begin(), labels.end());
+    std::sort(sorted.begin(), sorted.end());
+
+    std::string out = "{";
     bool first = true;
-    for (const auto& [key, val] : labels)
+    for (const auto& [key, val] : sorted)
     {
-      if (!first) oss << ",";
-      oss << key << "=\"" << val << "\"";
+      if (!first) out += ",";
+      out += key;
+      out += "=\"";
+      append_escaped(out, val);
+      out += "\"";
       first = false;
     }
-    oss << "}";
-    return oss.str();
+    out += "}";
+    return out;
+  }
+
+  ~Impl()
+  {
+    for (auto& chunk : series_chunks)
+    {
+      delete chunk.load();
+    }
+  }
+
+  Series& series_at(uint32_t index) const
+  {
+    return series_chunks[index / kSeriesPerChunk].load(std::memory_order_acquire)
+        ->entries[index % kSeriesPerChunk];
+  }
+
+  // Caller must hold mutex
+  const Series* find_or_add(const std::string& name, const Labels& labels, MetricType type,
+                            double resolution = 0.001, std::vector<double> quantiles = {})
+  {
+    auto [family_it, family_added] = families.try_emplace(name);
+    Family& family = family_it->second;
+    if (family_added)
+    {
+      family.type = type;
+      family.full_name = config.namespace_prefix + "_" + name;
+      family.resolution = resolution > 0.0 ? resolution : 0.001;
+      family.quantiles = std::move(quantiles);
+    }
+    else if (family.type != type)
+    {
+      return nullptr;
+    }
+
+    std::string label_text = labels_to_string(labels);
+    auto existing = family.series.find(label_text);
+    if (existing != family.series.end()) return &series_at(existing->second);
+
+    if (type == MetricType::GAUGE && !retired_gauges.empty())
+    {
+      return reuse_gauge(family, std::move(label_text));
+    }
+
+    uint32_t index = published.load(std::memory_order_relaxed);
+    if (index >= kMaxSeriesChunks * kSeriesPerChunk) return nullptr;
+    if (type == MetricType::COUNTER && counter_count >= kMaxCounterPages * kSlotsPerPage)
+    {
+      return nullptr;
+    }
+
+    auto& chunk = series_chunks[index / kSeriesPerChunk];
+    if (!chunk.load(std::memory_order_relaxed))
+    {
+      chunk.store(new SeriesChunk(), std::memory_order_release);
+    }
+
+    Series& series = series_at(index);
+    series.full_name = &family.full_name;
+    series.type = type;
+    series.quantiles = &family.quantiles;
+    if (type == MetricType::COUNTER)
+    {
+      series.counter_index = counter_count++;
+    }
+    else if (type == MetricType::GAUGE)
+    {
+      series.gauge = &gauges.emplace_back(0.0);
+    }
+    else
+    {
+      series.histogram = &histograms.emplace_back(family.resolution);
+    }
+
+    family.series.emplace(label_text, index);
+    series.label_text = std::move(label_text);
+
+    // Make the fully built entry visible to scrapers
+    published.store(index + 1, std::memory_order_release);
+    return &series;
+  }
+
+  // Caller must hold mutex
+  const Series* reuse_gauge(Family& family, std::string label_text)
+  {
+    uint32_t index = retired_gauges.back();
+    retired_gauges.pop_back();
+    Series& series = series_at(index);
+
+    std::lock_guard lock(scrape_mutex);
+    bool merged = index < scrape_order.size();
+    if (merged)
+    {
+      scrape_order.erase(std::find(scrape_order.begin(), scrape_order.end(), index));
+    }
+
+    series.full_name = &family.full_name;
+    series.quantiles = &family.quantiles;
+    series.label_text = label_text;
+    series.gauge->store(0.0, std::memory_order_relaxed);
+
+    // Keep the scrape order sorted; unmerged slots are sorted in by render()
+    if (merged)
+    {
+      auto position = std::lower_bound(scrape_order.begin(), scrape_order.end(), index,
+                                       [this](uint32_t a, uint32_t b)
+                                       { return scrape_less(a, b); });
+      scrape_order.insert(position, index);
+    }
+
+    family.series.emplace(std::move(label_text), index);
+    series.retired.store(false, std::memory_order_release);
+    return &series;
+  }
+
+  void unregister_gauge(const std::string& name, const Labels& labels)
+  {
+    std::lock_guard lock(mutex);
+    auto family = families.find(name);
+    if (family == families.end() || family->second.type != MetricType::GAUGE) return;
+
+    auto existing = family->second.series.find(labels_to_string(labels));
+    if (existing == family->second.series.end()) return;
+
+    series_at(existing->second).retired.store(true, std::memory_order_release);
+    retired_gauges.push_back(existing->second);
+    family->second.series.erase(existing);
+  }
+
+  MetricCounter register_counter(const std::string& name, const Labels& labels)
+  {
+    std::lock_guard lock(mutex);
+    const Series* series = find_or_add(name, labels, MetricType::COUNTER);
+    if (!series) return {};
+    return MetricCounter(&counters, series->counter_index);
+  }
+
+  MetricGauge register_gauge(const std::string& name, const Labels& labels)
+  {
+    std::lock_guard lock(mutex);
+    const Series* series = find_or_add(name, labels, MetricType::GAUGE);
+    if (!series) return {};
+    return MetricGauge(series->gauge);
+  }
+
+  MetricHistogram register_histogram(const std::string& name, const Labels& labels,
+                                     double resolution)
+  {
+    std::lock_guard lock(mutex);
+    const Series* series = find_or_add(name, labels, MetricType::HISTOGRAM, resolution);
+    if (!series) return {};
+    return MetricHistogram(series->histogram);
+  }
+
+  MetricHistogram register_summary(const std::string& name, const Labels& labels,
+                                   std::vector<double> quantiles, double resolution)
+  {
+    std::lock_guard lock(mutex);
+    const Series* series =
+        find_or_add(name, labels, MetricType::SUMMARY, resolution, std::move(quantiles));
+    if (!series) return {};
+    return MetricHistogram(series->histogram);
+  }
+
+  MediaCounters register_media(const std::string& name)
+  {
+    return {register_counter(name, {{"type", "audio"}}),
+            register_counter(name, {{"type", "video"}})};
+  }
+
+  static void render_histogram(std::string& out, const std::string& name,
+                               const std::string& label_text, const HistogramCells& cells)
+  {
+    auto snap = cells.snapshot();
+
+    // Cumulative counts at power-of-two boundaries (exact bucket edges)
+    uint64_t cumulative = 0;
+    size_t next_bucket = 0;
+    for (int octave = 0; octave <= kMaxOctave; ++octave)
+    {
+      uint64_t bound = uint64_t{1} << octave;
+      size_t end = octave == kMaxOctave ? kHistogramBuckets : bucket_index(bound);
+      for (; next_bucket < end; ++next_bucket)
+      {
+        cumulative += snap.buckets[next_bucket];
+      }
+      append_sample(out, name, "_bucket", label_text, static_cast<double>(cumulative), "le",
+                    static_cast<double>(bound) * cells.resolution);
+    }
+    append_sample(out, name, "_bucket", label_text, static_cast<double>(snap.count), "le",
+                  std::numeric_limits<double>::infinity());
+    append_sample(out, name, "_sum", label_text, snap.sum);
+    append_sample(out, name, "_count", label_text, static_cast<double>(snap.count));
+  }
+
+  static void render_summary(std::string& out, const std::string& name,
+                             const std::string& label_text, const std::vector<double>& quantiles,
+                             const HistogramCells& cells)
+  {
+    auto snap = cells.snapshot();
+    for (double q : quantiles)
+    {
+      append_sample(out, name, "", label_text, cells.quantile(snap, q), "quantile", q);
+    }
+    append_sample(out, name, "_sum", label_text, snap.sum);
+    append_sample(out, name, "_count", label_text, static_cast<double>(snap.count));
+  }
+
+  // Scrape order: by family, then labels (scrape_mutex held)
+  bool scrape_less(uint32_t a, uint32_t b) const
+  {
+    const Series& sa = series_at(a);
+    const Series& sb = series_at(b);
+    if (sa.full_name != sb.full_name) return *sa.full_name < *sb.full_name;
+    return sa.label_text < sb.label_text;
+  }
+
+  /**
+   * @brief Render exposition text from the published series
+   *
+   * Only scrape_mutex is held: registration proceeds concurrently (new
+   * series show up in the next scrape) and recorders are never blocked.
+   */
+  void render(std::string& out) const
+  {
+    std::lock_guard lock(scrape_mutex);
+
+    // Merge newly published series into the sorted scrape order
+    uint32_t count = published.load(std::memory_order_acquire);
+    size_t sorted = scrape_order.size();
+    if (count > sorted)
+    {
+      for (uint32_t i = static_cast<uint32_t>(sorted); i < count; ++i)
+      {
+        scrape_order.push_back(i);
+      }
+
+      auto less = [this](uint32_t a, uint32_t b) { return scrape_less(a, b); };
+      auto middle = scrape_order.begin() + static_cast<std::ptrdiff_t>(sorted);
+      std::sort(middle, scrape_order.end(), less);
+      std::inplace_merge(scrape_order.begin(), middle, scrape_order.end(), less);
+    }
+
+    out.reserve(scrape_size_hint);
+
+    const std::string* current_family = nullptr;
+    for (uint32_t index : scrape_order)
+    {
+      const Series& series = series_at(index);
+      if (series.retired.load(std::memory_order_acquire)) continue;
+      const std::string& name = *series.full_name;
+
+      if (series.full_name != current_family)
+      {
+        current_family = series.full_name;
+        out += "# TYPE ";
+        out += name;
+        out += " ";
+        out += type_name(series.type);
+        out += "\n";
+      }
+
+      switch (series.type)
+      {
+        case MetricType::COUNTER:
+          append_sample(out, name, "", series.label_text, counters.sum(series.counter_index));
+          break;
+        case MetricType::GAUGE:
+          append_sample(out, name, "", series.label_text,
+                        series.gauge->load(std::memory_order_relaxed));
+          break;
+        case MetricType::HISTOGRAM:
+          render_histogram(out, name, series.label_text, *series.histogram);
+          break;
+        case MetricType::SUMMARY:
+          render_summary(out, name, series.label_text, *series.quantiles, *series.histogram);
+          break;
+      }
+    }
+
+    scrape_size_hint = std::max(scrape_size_hint, out.size());
   }
 
-  std::string format_metric(const std::string& name, double value, const Labels& labels) const
+  MetricCounter media_counter(const MediaCounters& counters, const std::string& name,
+                              const std::string& media_type)
   {
-    std::ostringstream oss;
-    oss << config.namespace_prefix << "_" << name << labels_to_string(labels) << " " << value
-        << "\n";
-    return oss.str();
+    if (media_type == "audio") return counters.audio;
+    if (media_type == "video") return counters.video;
+    return register_counter(name, {{"type", media_type}});
   }
 };
 
@@ -92,44 +779,70 @@ MetricsExporter::~MetricsExporter()
 
 bool MetricsExporter::start()
 {
-  impl_->running.store(true);
-  // TODO: Start HTTP server on config.port
+  if (impl_->http_server) return false;
+
+  auto server = std::make_unique<MetricsHttpServer>(MetricsHttpServerConfig{
+      .bind_address = impl_->config.bind_address,
+      .port = impl_->config.port,
+      .path = impl_->config.path,
+  });
+  if (!server->start([this](std::string& body) { impl_->render(body); }))
+  {
+    return false;
+  }
+
+  impl_->http_server = std::move(server);
   return true;
 }
 
 void MetricsExporter::stop()
 {
-  impl_->running.store(false);
+  if (!impl_->http_server) return;
+
+  impl_->http_server->stop();
+  impl_->http_server.reset();
 }
 
-void MetricsExporter::counter_inc(const std::string& name, const Labels& labels, double value)
+MetricCounter MetricsExporter::register_counter(const std::string& name, const Labels& labels)
 {
-  LabeledMetricKey key{name, labels};
-  std::lock_guard lock(impl_->mutex);
+  return impl_->register_counter(name, labels);
+}
 
-  auto& metric = impl_->metrics[key];
-  metric.type = MetricType::COUNTER;
-  metric.value.store(metric.value.load() + value);
+MetricGauge MetricsExporter::register_gauge(const std::string& name, const Labels& labels)
+{
+  return impl_->register_gauge(name, labels);
 }
 
-void MetricsExporter::gauge_set(const std::string& name, double value, const Labels& labels)
+void MetricsExporter::unregister_gauge(const std::string& name, const Labels& labels)
 {
-  LabeledMetricKey key{name, labels};
-  std::lock_guard lock(impl_->mutex);
+  impl_->unregister_gauge(name, labels);
+}
 
-  auto& metric = impl_->metrics[key];
-  metric.type = MetricType::GAUGE;
-  metric.value.store(value);
+MetricHistogram MetricsExporter::register_histogram(const std::string& name, const Labels& labels,
+                                                    double resolution)
+{
+  return impl_->register_histogram(name, labels, resolution);
 }
 
-void MetricsExporter::gauge_inc(const std::string& name, const Labels& labels, double value)
+MetricHistogram MetricsExporter::register_summary(const std::string& name, const Labels& labels,
+                                                  std::vector<double> quantiles, double resolution)
 {
-  LabeledMetricKey key{name, labels};
-  std::lock_guard lock(impl_->mutex);
+  return impl_->register_summary(name, labels, std::move(quantiles), resolution);
+}
 
-  auto& metric = impl_->metrics[key];
-  metric.type = MetricType::GAUGE;
-  metric.value.store(metric.value.load() + value);
+void MetricsExporter::counter_inc(const std::string& name, const Labels& labels, double value)
+{
+  impl_->register_counter(name, labels).inc(value);
+}
+
+void MetricsExporter::gauge_set(const std::string& name, double value, const Labels& labels)
+{
+  impl_->register_gauge(name, labels).set(value);
+}
+
+void MetricsExporter::gauge_inc(const std::string& name, const Labels& labels, double value)
+{
+  impl_->register_gauge(name, labels).inc(value);
 }
 
 void MetricsExporter::gauge_dec(const std::string& name, const Labels& labels, double value)
@@ -139,33 +852,35 @@ void MetricsExporter::gauge_dec(const std::string& name, const Labels& labels, d
 
 void MetricsExporter::histogram_observe(const std::string& name, double value, const Labels& labels)
 {
-  // Simplified: just store as gauge for now
-  gauge_set(name, value, labels);
+  impl_->register_histogram(name, labels, 0.001).observe(value);
 }
 
 void MetricsExporter::record_packet_sent(const std::string& media_type)
 {
-  counter_inc("packets_sent_total", {{"type", media_type}});
+  impl_->media_counter(impl_->packets_sent, "packets_sent_total", media_type).inc();
 }
 
 void MetricsExporter::record_packet_received(const std::string& media_type)
 {
-  counter_inc("packets_received_total", {{"type", media_type}});
+  impl_->media_counter(impl_->packets_received, "packets_received_total", media_type).inc();
 }
 
 void MetricsExporter::record_bytes_sent(size_t bytes, const std::string& media_type)
 {
-  counter_inc("bytes_sent_total", {{"type", media_type}}, static_cast<double>(bytes));
+  impl_->media_counter(impl_->bytes_sent, "bytes_sent_total", media_type)
+      .inc(static_cast<double>(bytes));
 }
 
 void MetricsExporter::record_bytes_received(size_t bytes, const std::string& media_type)
 {
-  counter_inc("bytes_received_total", {{"type", media_type}}, static_cast<double>(bytes));
+  impl_->media_counter(impl_->bytes_received, "bytes_received_total", media_type)
+      .inc(static_cast<double>(bytes));
 }
 
 void MetricsExporter::record_latency(double ms, const std::string& operation)
 {
-  histogram_observe("latency_ms", ms, {{"operation", operation}});
+  impl_->register_summary("latency_ms", {{"operation", operation}}, {0.5, 0.9, 0.99}, 0.001)
+      .observe(ms);
 }
 
 void MetricsExporter::record_participant_joined(const std::string& room_id)
@@ -180,25 +895,44 @@ void MetricsExporter::record_participant_left(const std::string& room_id)
 
 void MetricsExporter::set_active_rooms(size_t count)
 {
-  gauge_set("active_rooms", static_cast<double>(count));
+  impl_->active_rooms.set(static_cast<double>(count));
 }
 
 void MetricsExporter::set_active_participants(size_t count)
 {
-  gauge_set("active_participants", static_cast<double>(count));
+  impl_->active_participants.set(static_cast<double>(count));
 }
 
-std::string MetricsExporter::get_metrics() const
+MetricHistogram MetricsExporter::forwarding_latency_histogram()
 {
-  std::lock_guard lock(impl_->mutex);
-  std::ostringstream oss;
+  return register_histogram("forwarding_latency_ms");
+}
 
-  for (const auto& [key, metric] : impl_->metrics)
-  {
-    oss << impl_->format_metric(key.name, metric.value.load(), key.labels);
-  }
+MetricHistogram MetricsExporter::jitter_buffer_delay_histogram()
+{
+  return register_histogram("jitter_buffer_delay_ms");
+}
+
+MetricHistogram MetricsExporter::encode_time_histogram(const std::string& media_type)
+{
+  return register_histogram("encode_time_ms", {{"type", media_type}});
+}
 
-  return oss.str();
+MetricHistogram MetricsExporter::pacer_delay_histogram()
+{
+  return register_histogram("pacer_delay_ms");
+}
+
+MetricHistogram MetricsExporter::pipeline_stage_histogram(const std::string& stage)
+{
+  return register_histogram("pipeline_stage_latency_ms", {{"stage", stage}});
+}
+
+std::string MetricsExporter::get_metrics() const
+{
+  std::string out;
+  impl_->render(out);
+  return out;
 }
 
 }  // namespace rtc
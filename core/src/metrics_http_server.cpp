@@ -0,0 +1,359 @@
+/**
+ * @file metrics_http_server.cpp
+ * @brief Minimal HTTP/1.1 server for Prometheus scrapes
+ */
+
+#include "rtc/metrics_http_server.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+using socket_t = SOCKET;
+constexpr socket_t INVALID_SOCKET_VALUE = INVALID_SOCKET;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+using socket_t = int;
+constexpr socket_t INVALID_SOCKET_VALUE = -1;
+#endif
+
+#include <atomic>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace rtc
+{
+
+namespace
+{
+
+constexpr size_t kMaxRequestBytes = 8192;
+constexpr int kPollIntervalMs = 100;  // Bounds stop() latency
+
+void close_socket(socket_t sock)
+{
+  if (sock == INVALID_SOCKET_VALUE) return;
+#ifdef _WIN32
+  closesocket(sock);
+#else
+  ::close(sock);
+#endif
+}
+
+bool set_non_blocking(socket_t sock)
+{
+#ifdef _WIN32
+  u_long mode = 1;
+  return ioctlsocket(sock, FIONBIO, &mode) == 0;
+#else
+  int flags = fcntl(sock, F_GETFL, 0);
+  return flags >= 0 && fcntl(sock, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+}
+
+bool would_block()
+{
+#ifdef _WIN32
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+int poll_sockets(std::vector<pollfd>& fds, int timeout_ms)
+{
+#ifdef _WIN32
+  return WSAPoll(fds.data(), static_cast<ULONG>(fds.size()), timeout_ms);
+#else
+  return ::poll(fds.data(), fds.size(), timeout_ms);
+#endif
+}
+
+long send_some(socket_t sock, const char* data, size_t size)
+{
+#ifdef _WIN32
+  return ::send(sock, data, static_cast<int>(size), 0);
+#elif defined(MSG_NOSIGNAL)
+  return ::send(sock, data, size, MSG_NOSIGNAL);
+#else
+  return ::send(sock, data, size, 0);
+#endif
+}
+
+}  // namespace
+
+struct MetricsHttpServer::Impl
+{
+  struct Connection
+  {
+    socket_t sock = INVALID_SOCKET_VALUE;
+    std::string request;
+    std::string header;
+    std::string body;
+    size_t sent = 0;  // Bytes of header + body written so far
+    bool responding = false;
+    std::chrono::steady_clock::time_point accepted_at;
+  };
+
+  MetricsHttpServerConfig config;
+  MetricsRenderCallback render;
+
+  socket_t listener = INVALID_SOCKET_VALUE;
+  std::atomic<uint16_t> bound_port{0};
+  std::atomic<bool> running{false};
+  std::thread thread;
+
+  // Server thread only
+  std::vector<Connection> connections;
+  std::vector<pollfd> poll_fds;
+  std::string spare_body;  // Largest finished body, reused for the next scrape
+
+  Impl(MetricsHttpServerConfig cfg) : config(std::move(cfg)) {}
+
+  bool open_listener()
+  {
+    listener = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (listener == INVALID_SOCKET_VALUE) return false;
+
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse),
+               sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(config.port);
+    if (inet_pton(AF_INET, config.bind_address.c_str(), &addr.sin_addr) != 1 ||
+        ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listener, 16) != 0 || !set_non_blocking(listener))
+    {
+      close_socket(listener);
+      listener = INVALID_SOCKET_VALUE;
+      return false;
+    }
+
+    socklen_t len = sizeof(addr);
+    getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len);
+    bound_port.store(ntohs(addr.sin_port));
+    return true;
+  }
+
+  void accept_connections()
+  {
+    while (true)
+    {
+      socket_t sock = ::accept(listener, nullptr, nullptr);
+      if (sock == INVALID_SOCKET_VALUE) return;
+
+      if (connections.size() >= config.max_connections || !set_non_blocking(sock))
+      {
+        close_socket(sock);
+        continue;
+      }
+
+      Connection conn;
+      conn.sock = sock;
+      conn.accepted_at = std::chrono::steady_clock::now();
+      connections.push_back(std::move(conn));
+    }
+  }
+
+  void build_response(Connection& conn)
+  {
+    // Request line: METHOD SP target SP version
+    std::string_view line(conn.request);
+    line = line.substr(0, line.find("\r\n"));
+    auto method_end = line.find(' ');
+    auto target_end = line.find(' ', method_end + 1);
+    std::string_view method = line.substr(0, method_end);
+    std::string_view target = method_end == std::string_view::npos
+                                  ? std::string_view{}
+                                  : line.substr(method_end + 1, target_end - method_end - 1);
+    target = target.substr(0, target.find('?'));
+
+    const char* status = "200 OK";
+    conn.body = std::move(spare_body);
+    conn.body.clear();
+
+    if (method != "GET" && method != "HEAD")
+    {
+      status = "405 Method Not Allowed";
+    }
+    else if (target != config.path)
+    {
+      status = "404 Not Found";
+    }
+    else if (render)
+    {
+      render(conn.body);
+    }
+
+    size_t content_length = conn.body.size();
+    if (method == "HEAD")
+    {
+      conn.body.clear();
+    }
+
+    conn.header = "HTTP/1.1 ";
+    conn.header += status;
+    conn.header += "\r\nContent-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+    conn.header += "Content-Length: " + std::to_string(content_length) + "\r\n";
+    conn.header += "Connection: close\r\n\r\n";
+    conn.responding = true;
+  }
+
+  // Returns false once the connection should be closed
+  bool on_readable(Connection& conn)
+  {
+    char buf[2048];
+    while (!conn.responding)
+    {
+      long n = ::recv(conn.sock, buf, sizeof(buf), 0);
+      if (n == 0) return false;
+      if (n < 0) return would_block();
+
+      conn.request.append(buf, static_cast<size_t>(n));
+      if (conn.request.find("\r\n\r\n") != std::string::npos)
+      {
+        build_response(conn);
+      }
+      else if (conn.request.size() > kMaxRequestBytes)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Returns false once the connection should be closed
+  bool on_writable(Connection& conn)
+  {
+    while (true)
+    {
+      const std::string& chunk = conn.sent < conn.header.size() ? conn.header : conn.body;
+      size_t offset = conn.sent < conn.header.size() ? conn.sent : conn.sent - conn.header.size();
+      if (offset >= chunk.size()) return false;  // Response complete
+
+      long n = send_some(conn.sock, chunk.data() + offset, chunk.size() - offset);
+      if (n < 0) return would_block();
+      conn.sent += static_cast<size_t>(n);
+    }
+  }
+
+  void close_connection(Connection& conn)
+  {
+    close_socket(conn.sock);
+    conn.sock = INVALID_SOCKET_VALUE;
+    if (conn.body.capacity() > spare_body.capacity())
+    {
+      spare_body = std::move(conn.body);
+    }
+  }
+
+  void serve_loop()
+  {
+    while (running.load())
+    {
+      poll_fds.clear();
+      poll_fds.push_back({listener, POLLIN, 0});
+      for (const auto& conn : connections)
+      {
+        poll_fds.push_back({conn.sock, static_cast<short>(conn.responding ? POLLOUT : POLLIN), 0});
+      }
+
+      if (poll_sockets(poll_fds, kPollIntervalMs) < 0 && !would_block())
+      {
+        break;
+      }
+
+      if (poll_fds[0].revents & POLLIN)
+      {
+        accept_connections();
+      }
+
+      auto now = std::chrono::steady_clock::now();
+      for (size_t i = 0; i + 1 < poll_fds.size(); ++i)
+      {
+        Connection& conn = connections[i];
+        short revents = poll_fds[i + 1].revents;
+        bool keep =
+            !(revents & (POLLERR | POLLNVAL)) && now - conn.accepted_at < config.idle_timeout;
+
+        if (keep && (revents & (POLLIN | POLLHUP)))
+        {
+          keep = on_readable(conn);
+        }
+        if (keep && conn.responding)
+        {
+          keep = on_writable(conn);  // Also tries right after the request completes
+        }
+        if (!keep)
+        {
+          close_connection(conn);
+        }
+      }
+
+      std::erase_if(connections,
+                    [](const Connection& conn) { return conn.sock == INVALID_SOCKET_VALUE; });
+    }
+
+    for (auto& conn : connections)
+    {
+      close_connection(conn);
+    }
+    connections.clear();
+  }
+};
+
+MetricsHttpServer::MetricsHttpServer(MetricsHttpServerConfig config)
+    : impl_(std::make_unique<Impl>(std::move(config)))
+{
+}
+
+MetricsHttpServer::~MetricsHttpServer()
+{
+  stop();
+}
+
+bool MetricsHttpServer::start(MetricsRenderCallback render)
+{
+  if (impl_->running.load()) return false;
+  if (!impl_->open_listener()) return false;
+
+  impl_->render = std::move(render);
+  impl_->running.store(true);
+  impl_->thread = std::thread([this]() { impl_->serve_loop(); });
+  return true;
+}
+
+void MetricsHttpServer::stop()
+{
+  if (!impl_->running.exchange(false)) return;
+
+  if (impl_->thread.joinable())
+  {
+    impl_->thread.join();
+  }
+  close_socket(impl_->listener);
+  impl_->listener = INVALID_SOCKET_VALUE;
+  impl_->bound_port.store(0);
+}
+
+bool MetricsHttpServer::is_running() const
+{
+  return impl_->running.load();
+}
+
+uint16_t MetricsHttpServer::port() const
+{
+  return impl_->bound_port.load();
+}
+
+}  // namespace rtc
@@ -0,0 +1,487 @@
+/**
+ * @file network_monitor.cpp
+ * @brief Network monitor implementation
+ */
+
+#include "rtc/network_monitor.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <set>
+#include <utility>
+
+#include "rtc/connection_recovery.h"
+#include "rtc/ice_agent.h"
+#include "rtc/udp_socket.h"
+
+namespace rtc
+{
+
+struct NetworkMonitor::Impl
+{
+  struct Interface
+  {
+    std::string name;
+    bool up = true;
+    std::set<std::string> addresses;
+  };
+
+  mutable std::mutex mutex;
+  int fd = -1;
+
+  std::map<int, Interface> interfaces;  // By interface index
+  std::map<int, Interface> dump;        // Being reloaded
+  bool dumping = false;
+  bool dump_again = false;  // Overflowed while dumping
+  bool initial = true;      // The first dump reports nothing
+  uint32_t sequence = 0;
+
+  std::vector<std::pair<uint64_t, NetworkChangeCallback>> subscribers;
+  uint64_t next_id = 1;
+
+  std::vector<uint8_t> buffer = std::vector<uint8_t>(32768);
+  NetworkMonitorStats stats;
+
+  static std::string interface_name(int index)
+  {
+#ifdef __linux__
+    char name[IF_NAMESIZE] = {};
+    if (::if_indextoname(static_cast<unsigned>(index), name))
+    {
+      return name;
+    }
+#endif
+    return std::to_string(index);
+  }
+
+#ifdef __linux__
+  // Mutex held
+  void request_dump()
+  {
+    struct
+    {
+      nlmsghdr header;
+      ifaddrmsg message;
+    } request{};
+    request.header.nlmsg_len = NLMSG_LENGTH(sizeof(ifaddrmsg));
+    request.header.nlmsg_type = RTM_GETADDR;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq = ++sequence;
+    request.message.ifa_family = AF_UNSPEC;
+
+    if (::send(fd, &request, request.header.nlmsg_len, 0) >= 0)
+    {
+      dumping = true;
+      dump.clear();
+    }
+  }
+
+  // Mutex held: compare the reloaded table with what we had
+  void finish_dump(std::vector<NetworkChange>& changes)
+  {
+    dumping = false;
+
+    for (auto& [index, old_interface] : interfaces)
+    {
+      auto it = dump.find(index);
+      for (const auto& address : old_interface.addresses)
+      {
+        if (it == dump.end() || !it->second.addresses.contains(address))
+        {
+          changes.push_back(
+              {NetworkChangeType::ADDRESS_REMOVED, index, old_interface.name, {address}});
+        }
+      }
+      if (it == dump.end())
+      {
+        old_interface.addresses.clear();  // Keep the link state
+      }
+      else
+      {
+        it->second.up = old_interface.up;
+        if (it->second.name.empty()) it->second.name = old_interface.name;
+      }
+    }
+
+    for (auto& [index, new_interface] : dump)
+    {
+      auto& current = interfaces[index];
+      for (const auto& address : new_interface.addresses)
+      {
+        if (!current.addresses.contains(address))
+        {
+          changes.push_back(
+              {NetworkChangeType::ADDRESS_ADDED, index, new_interface.name, {address}});
+        }
+      }
+      current = std::move(new_interface);
+    }
+    dump.clear();
+
+    if (initial)
+    {
+      initial = false;
+      changes.clear();
+    }
+    if (std::exchange(dump_again, false))
+    {
+      request_dump();
+    }
+  }
+
+  // Mutex held
+  void handle_address(const nlmsghdr* header, std::vector<NetworkChange>& changes)
+  {
+    const auto* message = static_cast<const ifaddrmsg*>(NLMSG_DATA(header));
+    bool added = header->nlmsg_type == RTM_NEWADDR;
+
+    // Still running duplicate address detection: announced again once usable
+    if (added && (message->ifa_flags & IFA_F_TENTATIVE)) return;
+
+    const void* local = nullptr;
+    const void* address = nullptr;
+    int length = static_cast<int>(IFA_PAYLOAD(header));
+    for (auto* attr = IFA_RTA(message); RTA_OK(attr, length); attr = RTA_NEXT(attr, length))
+    {
+      if (attr->rta_type == IFA_LOCAL) local = RTA_DATA(attr);
+      if (attr->rta_type == IFA_ADDRESS) address = RTA_DATA(attr);
+    }
+    // IFA_ADDRESS is the peer on point-to-point links
+    const void* raw = local ? local : address;
+    if (!raw) return;
+
+    char text[INET6_ADDRSTRLEN] = {};
+    if (!::inet_ntop(message->ifa_family, raw, text, sizeof(text))) return;
+
+    int index = static_cast<int>(message->ifa_index);
+    bool from_dump = dumping && header->nlmsg_seq == sequence && header->nlmsg_pid != 0;
+    if (dumping)
+    {
+      // Notifications during a reload are applied to it as well
+      auto& interface = dump[index];
+      if (interface.name.empty()) interface.name = interface_name(index);
+      if (added)
+      {
+        interface.addresses.insert(text);
+      }
+      else
+      {
+        interface.addresses.erase(text);
+      }
+    }
+    if (from_dump) return;
+
+    auto& interface = interfaces[index];
+    if (interface.name.empty()) interface.name = interface_name(index);
+    if (added ? interface.addresses.insert(text).second : interface.addresses.erase(text) > 0)
+    {
+      changes.push_back(
+          {added ? NetworkChangeType::ADDRESS_ADDED : NetworkChangeType::ADDRESS_REMOVED, index,
+           interface.name, {text}});
+    }
+  }
+
+  // Mutex held
+  void handle_link(const nlmsghdr* header, std::vector<NetworkChange>& changes)
+  {
+    const auto* message = static_cast<const ifinfomsg*>(NLMSG_DATA(header));
+    int index = message->ifi_index;
+    bool up = header->nlmsg_type == RTM_NEWLINK && (message->ifi_flags & IFF_RUNNING);
+
+    std::string name;
+    int length = static_cast<int>(IFLA_PAYLOAD(header));
+    for (auto* attr = IFLA_RTA(message); RTA_OK(attr, length); attr = RTA_NEXT(attr, length))
+    {
+      if (attr->rta_type == IFLA_IFNAME) name = static_cast<const char*>(RTA_DATA(attr));
+    }
+
+    auto it = interfaces.find(index);
+    if (it == interfaces.end())
+    {
+      // First sight of this link: nothing to compare against
+      if (header->nlmsg_type == RTM_NEWLINK) interfaces[index] = {name, up, {}};
+      return;
+    }
+
+    auto& interface = it->second;
+    if (!name.empty()) interface.name = name;
+    if (interface.up != up)
+    {
+      interface.up = up;
+      changes.push_back({up ? NetworkChangeType::LINK_UP : NetworkChangeType::LINK_DOWN, index,
+                         interface.name,
+                         {interface.addresses.begin(), interface.addresses.end()}});
+    }
+    if (header->nlmsg_type == RTM_DELLINK)
+    {
+      interfaces.erase(it);
+    }
+  }
+#endif
+};
+
+NetworkMonitor::NetworkMonitor() : impl_(std::make_unique<Impl>()) {}
+
+NetworkMonitor::~NetworkMonitor()
+{
+  stop();
+}
+
+bool NetworkMonitor::start()
+{
+#ifdef __linux__
+  {
+    std::lock_guard lock(impl_->mutex);
+    if (impl_->fd >= 0) return false;
+
+    int fd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (fd < 0) return false;
+
+    sockaddr_nl local{};
+    local.nl_family = AF_NETLINK;
+    local.nl_groups = RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR;
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) < 0)
+    {
+      ::close(fd);
+      return false;
+    }
+
+    impl_->fd = fd;
+    impl_->initial = true;
+    impl_->request_dump();
+  }
+
+  // The kernel answers the dump right away; load it before returning
+  process();
+  return true;
+#else
+  return false;
+#endif
+}
+
+void NetworkMonitor::stop()
+{
+#ifdef __linux__
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->fd >= 0)
+  {
+    ::close(impl_->fd);
+    impl_->fd = -1;
+  }
+  impl_->dumping = false;
+#endif
+}
+
+intptr_t NetworkMonitor::native_handle() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->fd;
+}
+
+size_t NetworkMonitor::process()
+{
+  std::vector<NetworkChange> changes;
+
+#ifdef __linux__
+  {
+    std::lock_guard lock(impl_->mutex);
+    if (impl_->fd < 0) return 0;
+
+    while (true)
+    {
+      ssize_t received = ::recv(impl_->fd, impl_->buffer.data(), impl_->buffer.size(), 0);
+      if (received < 0)
+      {
+        if (errno == EINTR) continue;
+        if (errno == ENOBUFS)
+        {
+          // Notifications were lost: reload the whole table and diff it
+          impl_->stats.resyncs++;
+          if (impl_->dumping)
+          {
+            impl_->dump_again = true;
+          }
+          else
+          {
+            impl_->request_dump();
+          }
+          continue;
+        }
+        break;  // EAGAIN: drained
+      }
+
+      auto length = static_cast<unsigned>(received);
+      for (auto* header = reinterpret_cast<const nlmsghdr*>(impl_->buffer.data());
+           NLMSG_OK(header, length); header = NLMSG_NEXT(header, length))
+      {
+        impl_->stats.messages++;
+        switch (header->nlmsg_type)
+        {
+          case NLMSG_DONE:
+            if (impl_->dumping && header->nlmsg_seq == impl_->sequence)
+            {
+              impl_->finish_dump(changes);
+            }
+            break;
+          case NLMSG_ERROR:
+            if (impl_->dumping && header->nlmsg_seq == impl_->sequence)
+            {
+              impl_->dumping = false;
+            }
+            break;
+          case RTM_NEWADDR:
+          case RTM_DELADDR:
+            impl_->handle_address(header, changes);
+            break;
+          case RTM_NEWLINK:
+          case RTM_DELLINK:
+            impl_->handle_link(header, changes);
+            break;
+          default:
+            break;
+        }
+      }
+    }
+
+    impl_->stats.changes += changes.size();
+  }
+#endif
+
+  if (changes.empty()) return 0;
+
+  std::vector<NetworkChangeCallback> callbacks;
+  {
+    std::lock_guard lock(impl_->mutex);
+    for (const auto& [id, callback] : impl_->subscribers)
+    {
+      callbacks.push_back(callback);
+    }
+  }
+
+  for (const auto& change : changes)
+  {
+    for (const auto& callback : callbacks)
+    {
+      callback(change);
+    }
+  }
+  return changes.size();
+}
+
+uint64_t NetworkMonitor::subscribe(NetworkChangeCallback callback)
+{
+  std::lock_guard lock(impl_->mutex);
+  uint64_t id = impl_->next_id++;
+  impl_->subscribers.emplace_back(id, std::move(callback));
+  return id;
+}
+
+uint64_t NetworkMonitor::watch(IceAgent& agent, ConnectionRecovery& recovery)
+{
+  agent.set_recovery(&recovery);
+  return subscribe(
+      [this, &agent, &recovery](const NetworkChange& change)
+      {
+        if (agent.on_network_change(change) != IceNetworkAction::RESTART) return;
+
+        if (recovery.start_ice_restart("Network change on " + change.interface_name))
+        {
+          std::lock_guard lock(impl_->mutex);
+          impl_->stats.sessions_restarted++;
+        }
+      });
+}
+
+void NetworkMonitor::unsubscribe(uint64_t id)
+{
+  std::lock_guard lock(impl_->mutex);
+  std::erase_if(impl_->subscribers, [id](const auto& entry) { return entry.first == id; });
+}
+
+std::vector<std::string> NetworkMonitor::addresses() const
+{
+  std::lock_guard lock(impl_->mutex);
+  std::vector<std::string> result;
+  for (const auto& [index, interface] : impl_->interfaces)
+  {
+    result.insert(result.end(), interface.addresses.begin(), interface.addresses.end());
+  }
+  return result;
+}
+
+std::optional<std::string> NetworkMonitor::route_source(const SocketAddress& remote)
+{
+#ifndef _WIN32
+  sockaddr_storage storage{};
+  socklen_t length = 0;
+  uint16_t port = htons(remote.port != 0 ? remote.port : 9);
+
+  auto* v4 = reinterpret_cast<sockaddr_in*>(&storage);
+  auto* v6 = reinterpret_cast<sockaddr_in6*>(&storage);
+  if (::inet_pton(AF_INET, remote.ip.c_str(), &v4->sin_addr) == 1)
+  {
+    v4->sin_family = AF_INET;
+    v4->sin_port = port;
+    length = sizeof(sockaddr_in);
+  }
+  else if (::inet_pton(AF_INET6, remote.ip.c_str(), &v6->sin6_addr) == 1)
+  {
+    v6->sin6_family = AF_INET6;
+    v6->sin6_port = port;
+    length = sizeof(sockaddr_in6);
+  }
+  else
+  {
+    return std::nullopt;
+  }
+
+  int fd = ::socket(storage.ss_family, SOCK_DGRAM, 0);
+  if (fd < 0) return std::nullopt;
+
+  // Connecting a UDP socket only selects a route and source address
+  std::optional<std::string> result;
+  sockaddr_storage local{};
+  socklen_t local_length = sizeof(local);
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&storage), length) == 0 &&
+      ::getsockname(fd, reinterpret_cast<sockaddr*>(&local), &local_length) == 0)
+  {
+    char text[INET6_ADDRSTRLEN] = {};
+    const void* raw = &reinterpret_cast<sockaddr_in*>(&local)->sin_addr;
+    if (local.ss_family == AF_INET6)
+    {
+      raw = &reinterpret_cast<sockaddr_in6*>(&local)->sin6_addr;
+    }
+    if (::inet_ntop(local.ss_family, raw, text, sizeof(text)))
+    {
+      result = text;
+    }
+  }
+  ::close(fd);
+  return result;
+#else
+  (void)remote;
+  return std::nullopt;
+#endif
+}
+
+NetworkMonitorStats NetworkMonitor::stats() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->stats;
+}
+
+}  // namespace rtc
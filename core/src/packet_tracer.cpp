@@ -0,0 +1,399 @@
+/**
+ * @file packet_tracer.cpp
+ * @brief Sampled packet tracer implementation
+ */
+
+#include "rtc/packet_tracer.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "rtc/metrics_exporter.h"
+#include "rtc/task_scheduler.h"
+
+namespace rtc
+{
+
+namespace
+{
+
+constexpr uint64_t kValidKey = uint64_t{1} << 48;  // Distinguishes seq 0 / ts 0 from "no key"
+constexpr uint64_t kKeyMask = (uint64_t{1} << 49) - 1;
+constexpr int kStageShift = 56;
+constexpr uint32_t kMaxSampleRate = 1u << 24;
+constexpr int64_t kMatchWindowNs = 2'000'000'000;  // Forget packets idle for 2 s
+
+/**
+ * @brief Key from RTP sequence number and timestamp, 0 if not RTP
+ */
+uint64_t packet_key(std::span<const uint8_t> rtp)
+{
+  if (rtp.size() < 12 || (rtp[0] >> 6) != 2) return 0;
+
+  uint8_t payload_type = rtp[1] & 0x7F;
+  if (payload_type >= 64 && payload_type <= 95) return 0;  // RTCP (RFC 5761)
+
+  uint64_t sequence = (uint64_t{rtp[2]} << 8) | rtp[3];
+  uint64_t timestamp = (uint64_t{rtp[4]} << 24) | (uint64_t{rtp[5]} << 16) |
+                       (uint64_t{rtp[6]} << 8) | rtp[7];
+  return kValidKey | (timestamp << 16) | sequence;
+}
+
+uint64_t sample_hash(uint64_t key)
+{
+  return (key * 0x9E3779B97F4A7C15ull) >> 40;
+}
+
+/**
+ * @brief Single-writer event ring owned by one thread at a time
+ *
+ * The owner bumps claimed before overwriting a slot and committed after,
+ * so the collector can tell which of the slots it just read may have
+ * been overwritten underneath it.
+ */
+struct TraceRing
+{
+  struct Slot
+  {
+    std::atomic<uint64_t> word{0};  // Stage << kStageShift | key
+    std::atomic<int64_t> time_ns{0};
+  };
+
+  std::array<Slot, PacketTracer::RING_CAPACITY> slots;
+  std::atomic<uint64_t> claimed{0};
+  std::atomic<uint64_t> committed{0};
+  std::atomic<bool> in_use{true};
+  uint64_t read = 0;  // Collector only
+  uint32_t id = 0;
+};
+
+/**
+ * @brief Returns the thread's ring to the pool when the thread exits
+ */
+struct RingLease
+{
+  TraceRing* ring = nullptr;
+
+  ~RingLease()
+  {
+    if (ring) ring->in_use.store(false, std::memory_order_release);
+  }
+};
+
+thread_local RingLease tls_lease;
+
+}  // namespace
+
+const char* trace_stage_name(TraceStage stage)
+{
+  switch (stage)
+  {
+    case TraceStage::RECEIVE:
+      return "receive";
+    case TraceStage::FORWARD:
+      return "forward";
+    case TraceStage::PACER_ENQUEUE:
+      return "pacer_enqueue";
+    case TraceStage::PACER_DEQUEUE:
+      return "pacer_dequeue";
+    case TraceStage::SEND:
+      return "send";
+  }
+  return "unknown";
+}
+
+struct PacketTracer::Impl
+{
+  struct Event
+  {
+    uint64_t key = 0;
+    int64_t time_ns = 0;
+    TraceStage stage = TraceStage::RECEIVE;
+    uint32_t tid = 0;
+  };
+
+  struct Span
+  {
+    uint64_t key = 0;
+    int64_t start_ns = 0;
+    int64_t end_ns = 0;
+    TraceStage stage = TraceStage::RECEIVE;
+    uint32_t tid = 0;
+  };
+
+  // Latest stamp of each stage for one packet (-1 = not seen)
+  struct PendingPacket
+  {
+    std::array<int64_t, kTraceStageCount> stage_ns;
+    int64_t last_ns = 0;
+  };
+
+  std::atomic<uint64_t> sample_mask{0};
+  const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+  std::mutex rings_mutex;
+  std::vector<std::unique_ptr<TraceRing>> rings;
+
+  // enable()/disable(); never held while waiting on collect_mutex
+  std::mutex control_mutex;
+  PeriodicTaskId collect_job = 0;
+
+  // Collector state
+  mutable std::mutex collect_mutex;
+  size_t max_spans = PacketTracerConfig{}.max_trace_spans;
+  std::array<MetricHistogram, kTraceStageCount> histograms;
+  std::vector<Event> events;
+  std::unordered_map<uint64_t, PendingPacket> pending;
+  std::deque<Span> spans;
+  PacketTracerStats stats;
+
+  TraceRing* acquire_ring()
+  {
+    std::lock_guard lock(rings_mutex);
+    for (auto& ring : rings)
+    {
+      bool free = !ring->in_use.load(std::memory_order_acquire);
+      if (free && !ring->in_use.exchange(true, std::memory_order_acq_rel))
+      {
+        return ring.get();
+      }
+    }
+
+    rings.push_back(std::make_unique<TraceRing>());
+    rings.back()->id = static_cast<uint32_t>(rings.size());
+    return rings.back().get();
+  }
+
+  void drain(TraceRing& ring)
+  {
+    uint64_t end = ring.committed.load(std::memory_order_acquire);
+    uint64_t begin = std::max(ring.read, end > RING_CAPACITY ? end - RING_CAPACITY : 0);
+    stats.events_dropped += begin - ring.read;
+
+    size_t first = events.size();
+    for (uint64_t i = begin; i < end; ++i)
+    {
+      const auto& slot = ring.slots[i % RING_CAPACITY];
+      uint64_t word = slot.word.load(std::memory_order_relaxed);
+
+      Event event;
+      event.key = word & kKeyMask;
+      event.stage = static_cast<TraceStage>(word >> kStageShift);
+      event.time_ns = slot.time_ns.load(std::memory_order_relaxed);
+      event.tid = ring.id;
+      events.push_back(event);
+    }
+
+    // Discard slots the owner started overwriting while they were read
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t claimed = ring.claimed.load(std::memory_order_relaxed);
+    uint64_t valid_from = claimed > RING_CAPACITY ? claimed - RING_CAPACITY : 0;
+    if (valid_from > begin)
+    {
+      size_t torn = static_cast<size_t>(std::min(valid_from, end) - begin);
+      events.erase(events.begin() + first, events.begin() + first + torn);
+      stats.events_dropped += torn;
+    }
+
+    ring.read = end;
+  }
+
+  void match(const Event& event)
+  {
+    auto [it, inserted] = pending.try_emplace(event.key);
+    PendingPacket& packet = it->second;
+    if (inserted)
+    {
+      packet.stage_ns.fill(-1);
+    }
+
+    auto stage = static_cast<size_t>(event.stage);
+    int64_t start_ns = -1;
+    for (size_t s = 0; s < stage; ++s)
+    {
+      start_ns = std::max(start_ns, packet.stage_ns[s]);
+    }
+
+    if (start_ns >= 0)
+    {
+      histograms[stage].observe(static_cast<double>(event.time_ns - start_ns) / 1e6);
+      spans.push_back({event.key, start_ns, event.time_ns, event.stage, event.tid});
+      if (spans.size() > max_spans)
+      {
+        spans.pop_front();
+      }
+      stats.spans_matched++;
+    }
+
+    packet.stage_ns[stage] = event.time_ns;
+    packet.last_ns = event.time_ns;
+  }
+};
+
+PacketTracer::PacketTracer() : impl_(std::make_unique<Impl>()) {}
+
+PacketTracer::~PacketTracer() = default;
+
+PacketTracer& PacketTracer::shared()
+{
+  // Never destroyed: threads may still be tracing during static destruction
+  static PacketTracer* instance = new PacketTracer();
+  return *instance;
+}
+
+bool PacketTracer::enable(PacketTracerConfig config)
+{
+  std::lock_guard control(impl_->control_mutex);
+  if (enabled_.load())
+  {
+    return false;
+  }
+
+  uint32_t rate = std::bit_ceil(std::clamp(config.sample_rate, 1u, kMaxSampleRate));
+  impl_->sample_mask.store(rate - 1, std::memory_order_relaxed);
+  {
+    std::lock_guard lock(impl_->collect_mutex);
+    impl_->max_spans = config.max_trace_spans;
+  }
+
+  if (config.collect_interval.count() > 0)
+  {
+    impl_->collect_job =
+        TaskScheduler::shared().schedule_periodic(config.collect_interval, [this]() { collect(); });
+  }
+
+  enabled_.store(true);
+  return true;
+}
+
+void PacketTracer::disable()
+{
+  std::lock_guard control(impl_->control_mutex);
+  if (!enabled_.exchange(false))
+  {
+    return;
+  }
+
+  if (impl_->collect_job != 0)
+  {
+    TaskScheduler::shared().cancel_periodic(impl_->collect_job);
+    impl_->collect_job = 0;
+  }
+  collect();
+}
+
+bool PacketTracer::is_enabled() const
+{
+  return enabled_.load();
+}
+
+void PacketTracer::set_stage_histogram(TraceStage stage, MetricHistogram histogram)
+{
+  std::lock_guard lock(impl_->collect_mutex);
+  impl_->histograms[static_cast<size_t>(stage)] = histogram;
+}
+
+void PacketTracer::record(TraceStage stage, std::span<const uint8_t> rtp)
+{
+  uint64_t key = packet_key(rtp);
+  if (key == 0 || (sample_hash(key) & impl_->sample_mask.load(std::memory_order_relaxed)) != 0)
+  {
+    return;
+  }
+
+  TraceRing* ring = tls_lease.ring;
+  if (!ring)
+  {
+    ring = tls_lease.ring = impl_->acquire_ring();
+  }
+
+  int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - impl_->epoch)
+                       .count();
+
+  uint64_t index = ring->committed.load(std::memory_order_relaxed);
+  ring->claimed.store(index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  auto& slot = ring->slots[index % RING_CAPACITY];
+  slot.word.store(key | (static_cast<uint64_t>(stage) << kStageShift), std::memory_order_relaxed);
+  slot.time_ns.store(now_ns, std::memory_order_relaxed);
+  ring->committed.store(index + 1, std::memory_order_release);
+}
+
+void PacketTracer::collect()
+{
+  std::lock_guard lock(impl_->collect_mutex);
+
+  impl_->events.clear();
+  {
+    std::lock_guard rings_lock(impl_->rings_mutex);
+    for (auto& ring : impl_->rings)
+    {
+      impl_->drain(*ring);
+    }
+  }
+  if (impl_->events.empty())
+  {
+    return;
+  }
+
+  // Rings are per thread; stages of one packet can be spread over several
+  std::sort(impl_->events.begin(), impl_->events.end(),
+            [](const Impl::Event& a, const Impl::Event& b) { return a.time_ns < b.time_ns; });
+  for (const auto& event : impl_->events)
+  {
+    impl_->match(event);
+  }
+  impl_->stats.events_collected += impl_->events.size();
+
+  int64_t horizon = impl_->events.back().time_ns - kMatchWindowNs;
+  std::erase_if(impl_->pending,
+                [horizon](const auto& entry) { return entry.second.last_ns < horizon; });
+}
+
+std::string PacketTracer::chrome_trace_json() const
+{
+  std::lock_guard lock(impl_->collect_mutex);
+
+  std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  char buf[256];
+  bool first = true;
+  for (const auto& span : impl_->spans)
+  {
+    int len = std::snprintf(
+        buf, sizeof(buf),
+        "%s{\"name\":\"%s\",\"cat\":\"rtp\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,"
+        "\"dur\":%.3f,\"args\":{\"seq\":%u,\"rtp_ts\":%u}}",
+        first ? "" : ",", trace_stage_name(span.stage), span.tid,
+        static_cast<double>(span.start_ns) / 1e3,
+        static_cast<double>(span.end_ns - span.start_ns) / 1e3,
+        static_cast<unsigned>(span.key & 0xFFFF),
+        static_cast<unsigned>((span.key >> 16) & 0xFFFFFFFF));
+    out.append(buf, static_cast<size_t>(len));
+    first = false;
+  }
+  out += "]}";
+  return out;
+}
+
+void PacketTracer::clear()
+{
+  std::lock_guard lock(impl_->collect_mutex);
+  impl_->spans.clear();
+  impl_->pending.clear();
+}
+
+PacketTracerStats PacketTracer::stats() const
+{
+  std::lock_guard lock(impl_->collect_mutex);
+  return impl_->stats;
+}
+
+}  // namespace rtc
@@ -5,6 +5,8 @@
 
 #include "rtc/rtcp_packet.h"
 
+#include "rtc/flight_recorder.h"
+
 namespace rtc
 {
 
@@ -78,6 +80,13 @@ RtcpPacket RtcpPacket::create_nack(uint32_t sender_ssrc, uint32_t media_ssrc,
   packet.header_.count = static_cast<uint8_t>(RtcpFeedbackType::NACK);
   RtcpNack nack{sender_ssrc, media_ssrc, lost};
   packet.data_ = nack;
+
+  // Recorded when the request is built for sending, not when losses are polled
+  if (!lost.empty())
+  {
+    FlightRecorder::record(FlightEventType::NACK, FlightSource::VIDEO_RECEIVER, media_ssrc,
+                           lost.front(), lost.size());
+  }
   return packet;
 }
 
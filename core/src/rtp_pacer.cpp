@@ -8,6 +8,9 @@
 #include <algorithm>
 #include <queue>
 
+#include "rtc/flight_recorder.h"
+#include "rtc/metrics_exporter.h"
+#include "rtc/packet_tracer.h"
 #include "rtc/udp_socket.h"
 
 
@@ -36,6 +39,7 @@ struct RtpPacer::Impl
 
   // Stats
   Stats stats;
+  MetricHistogram delay_histogram;
 
   Impl(Config cfg) : config(std::move(cfg))
   {
@@ -53,6 +57,12 @@ void RtpPacer::set_send_callback(PacerSendCallback callback)
   impl_->send_callback = std::move(callback);
 }
 
+void RtpPacer::set_delay_histogram(MetricHistogram histogram)
+{
+  std::lock_guard lock(impl_->queue_mutex);
+  impl_->delay_histogram = histogram;
+}
+
 bool RtpPacer::enqueue(std::vector<uint8_t> data, const SocketAddress& destination, int priority)
 {
   std::lock_guard lock(impl_->queue_mutex);
@@ -60,9 +70,16 @@ bool RtpPacer::enqueue(std::vector<uint8_t> data, const SocketAddress& destinati
   if (impl_->queue.size() >= impl_->config.max_queue_size)
   {
     ++impl_->stats.packets_dropped;
+    uint32_t ssrc = data.size() >= 12 ? (uint32_t{data[8]} << 24) | (uint32_t{data[9]} << 16) |
+                                            (uint32_t{data[10]} << 8) | data[11]
+                                      : 0;
+    FlightRecorder::record(FlightEventType::QUEUE_OVERFLOW, FlightSource::PACER, ssrc,
+                           impl_->queue.size(), impl_->config.max_queue_size);
     return false;
   }
 
+  PacketTracer::trace(TraceStage::PACER_ENQUEUE, data);
+
   PacedPacket packet;
   packet.data = std::move(data);
   packet.destination = destination;
@@ -98,12 +115,17 @@ size_t RtpPacer::process()
       break;  // Wait for more tokens
     }
 
+    PacketTracer::trace(TraceStage::PACER_DEQUEUE, packet.data);
+
     // Send the packet
     if (impl_->send_callback)
     {
       impl_->send_callback(packet.data, packet.destination);
     }
 
+    std::chrono::duration<double, std::milli> queued = now - packet.enqueue_time;
+    impl_->delay_histogram.observe(queued.count());
+
     impl_->available_tokens -= packet.data.size();
     impl_->stats.packets_sent++;
     impl_->stats.bytes_sent += packet.data.size();
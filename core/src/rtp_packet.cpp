@@ -5,6 +5,8 @@
 
 #include "rtc/rtp_packet.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 
 namespace rtc
@@ -39,8 +41,146 @@ inline void write_uint32_be(uint8_t* data, uint32_t value)
   data[3] = static_cast<uint8_t>(value);
 }
 
+// RFC 8285 one-byte elements: ID(4) L(4) then L + 1 bytes; 0 is padding, ID 15 ends the list
+constexpr uint8_t ONE_BYTE_ID_RESERVED = 15;
+
+// Calls visit(id, element bytes including the ID/length byte) until it returns false
+template <typename Visit>
+void for_each_one_byte_element(std::span<const uint8_t> elements, Visit visit)
+{
+  size_t offset = 0;
+  while (offset < elements.size())
+  {
+    uint8_t byte = elements[offset];
+    if (byte == 0)
+    {
+      ++offset;
+      continue;
+    }
+
+    uint8_t id = byte >> 4;
+    size_t length = (byte & 0x0F) + 1u;
+    if (id == ONE_BYTE_ID_RESERVED || offset + 1 + length > elements.size() ||
+        !visit(id, elements.subspan(offset, 1 + length)))
+    {
+      return;
+    }
+    offset += 1 + length;
+  }
+}
+
+std::span<const uint8_t> find_one_byte_element(std::span<const uint8_t> elements, uint8_t id)
+{
+  std::span<const uint8_t> found;
+  for_each_one_byte_element(elements, [&](uint8_t element_id, std::span<const uint8_t> element) {
+    if (element_id == id)
+    {
+      found = element.subspan(1);
+    }
+    return found.empty();
+  });
+  return found;
+}
+
 }  // namespace
 
+std::span<const uint8_t> RtpExtension::find_element(uint8_t id) const
+{
+  if (profile != ONE_BYTE_PROFILE || id == 0 || id >= ONE_BYTE_ID_RESERVED)
+  {
+    return {};
+  }
+  return find_one_byte_element(data, id);
+}
+
+bool RtpExtension::set_element(uint8_t id, std::span<const uint8_t> element)
+{
+  if (id == 0 || id >= ONE_BYTE_ID_RESERVED || element.empty() || element.size() > 16)
+  {
+    return false;
+  }
+  if (data.empty())
+  {
+    profile = ONE_BYTE_PROFILE;
+  }
+  if (profile != ONE_BYTE_PROFILE)
+  {
+    return false;
+  }
+
+  // Rebuild without padding or an older copy of the element
+  std::vector<uint8_t> rebuilt;
+  rebuilt.reserve(data.size() + 1 + element.size());
+  for_each_one_byte_element(data, [&](uint8_t element_id, std::span<const uint8_t> existing) {
+    if (element_id != id)
+    {
+      rebuilt.insert(rebuilt.end(), existing.begin(), existing.end());
+    }
+    return true;
+  });
+  rebuilt.push_back(static_cast<uint8_t>((id << 4) | (element.size() - 1)));
+  rebuilt.insert(rebuilt.end(), element.begin(), element.end());
+  data = std::move(rebuilt);
+  return true;
+}
+
+RtpAudioLevel RtpAudioLevel::from_dbov(float dbov, bool voice_activity)
+{
+  float level = std::clamp(std::round(-dbov), 0.0f, 127.0f);
+  return {static_cast<uint8_t>(level), voice_activity};
+}
+
+std::span<const uint8_t> find_rtp_extension_element(std::span<const uint8_t> packet, uint8_t id)
+{
+  if (packet.size() < RtpHeader::MIN_SIZE || (packet[0] >> 6) != 2 || (packet[0] & 0x10) == 0)
+  {
+    return {};
+  }
+
+  size_t offset = RtpHeader::MIN_SIZE + (packet[0] & 0x0F) * 4u;
+  if (packet.size() < offset + 4 ||
+      read_uint16_be(&packet[offset]) != RtpExtension::ONE_BYTE_PROFILE)
+  {
+    return {};
+  }
+  size_t length = read_uint16_be(&packet[offset + 2]) * 4u;
+  offset += 4;
+  if (id == 0 || id >= ONE_BYTE_ID_RESERVED || packet.size() < offset + length)
+  {
+    return {};
+  }
+  return find_one_byte_element(packet.subspan(offset, length), id);
+}
+
+std::span<const uint8_t> rtp_payload_view(std::span<const uint8_t> packet)
+{
+  if (packet.size() < RtpHeader::MIN_SIZE || (packet[0] >> 6) != 2)
+  {
+    return {};
+  }
+
+  size_t offset = RtpHeader::MIN_SIZE + (packet[0] & 0x0F) * 4u;
+  if (packet[0] & 0x10)
+  {
+    if (packet.size() < offset + 4)
+    {
+      return {};
+    }
+    offset += 4 + read_uint16_be(&packet[offset + 2]) * 4u;
+  }
+
+  size_t end = packet.size();
+  if (packet[0] & 0x20)
+  {
+    end -= std::min<size_t>(packet.back(), end);
+  }
+  if (end < offset)
+  {
+    return {};
+  }
+  return packet.subspan(offset, end - offset);
+}
+
 std::optional<RtpPacket> RtpPacket::parse(std::span<const uint8_t> data)
 {
   if (data.size() < RtpHeader::MIN_SIZE)
@@ -267,6 +407,18 @@ RtpPacketBuilder& RtpPacketBuilder::add_extension(uint16_t profile, std::span<co
   return *this;
 }
 
+RtpPacketBuilder& RtpPacketBuilder::add_audio_level(uint8_t id, RtpAudioLevel level)
+{
+  auto& extension = packet_.extension();
+  if (!extension)
+  {
+    extension.emplace();
+  }
+  uint8_t byte = level.encode();
+  extension->set_element(id, std::span<const uint8_t>(&byte, 1));
+  return *this;
+}
+
 RtpPacket RtpPacketBuilder::build() const
 {
   return packet_;
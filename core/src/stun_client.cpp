@@ -5,6 +5,8 @@
 
 #include "rtc/stun_client.h"
 
+#include <array>
+#include <cstring>
 #include <random>
 
 #include "rtc/udp_socket.h"
@@ -12,6 +14,224 @@
 namespace rtc
 {
 
+namespace
+{
+
+constexpr size_t STUN_HEADER_SIZE = 20;
+constexpr size_t INTEGRITY_SIZE = 20;
+constexpr uint32_t FINGERPRINT_XOR = 0x5354554E;
+
+using Sha1Digest = std::array<uint8_t, 20>;
+
+// SHA-1 (RFC 3174), only as the hash of HMAC-SHA1
+class Sha1
+{
+ public:
+  void update(std::span<const uint8_t> data)
+  {
+    for (uint8_t byte : data)
+    {
+      block_[buffered_++] = byte;
+      if (buffered_ == block_.size())
+      {
+        compress();
+        buffered_ = 0;
+      }
+    }
+    bits_ += uint64_t{data.size()} * 8;
+  }
+
+  Sha1Digest finish()
+  {
+    uint64_t bits = bits_;
+    const uint8_t pad = 0x80;
+    update({&pad, 1});
+    const uint8_t zero = 0;
+    while (buffered_ != 56)
+    {
+      update({&zero, 1});
+    }
+    std::array<uint8_t, 8> length;
+    for (size_t i = 0; i < 8; ++i)
+    {
+      length[i] = static_cast<uint8_t>(bits >> (56 - 8 * i));
+    }
+    update(length);
+
+    Sha1Digest digest;
+    for (size_t i = 0; i < 20; ++i)
+    {
+      digest[i] = static_cast<uint8_t>(h_[i / 4] >> (24 - 8 * (i % 4)));
+    }
+    return digest;
+  }
+
+ private:
+  static uint32_t rotl(uint32_t x, int n)
+  {
+    return (x << n) | (x >> (32 - n));
+  }
+
+  void compress()
+  {
+    uint32_t w[80];
+    for (size_t i = 0; i < 16; ++i)
+    {
+      w[i] = (uint32_t{block_[4 * i]} << 24) | (uint32_t{block_[4 * i + 1]} << 16) |
+             (uint32_t{block_[4 * i + 2]} << 8) | block_[4 * i + 3];
+    }
+    for (size_t i = 16; i < 80; ++i)
+    {
+      w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+    }
+
+    uint32_t a = h_[0], b = h_[1], c = h_[2], d = h_[3], e = h_[4];
+    for (size_t i = 0; i < 80; ++i)
+    {
+      uint32_t f;
+      uint32_t k;
+      if (i < 20)
+      {
+        f = (b & c) | (~b & d);
+        k = 0x5A827999;
+      }
+      else if (i < 40)
+      {
+        f = b ^ c ^ d;
+        k = 0x6ED9EBA1;
+      }
+      else if (i < 60)
+      {
+        f = (b & c) | (b & d) | (c & d);
+        k = 0x8F1BBCDC;
+      }
+      else
+      {
+        f = b ^ c ^ d;
+        k = 0xCA62C1D6;
+      }
+      uint32_t t = rotl(a, 5) + f + e + k + w[i];
+      e = d;
+      d = c;
+      c = rotl(b, 30);
+      b = a;
+      a = t;
+    }
+    h_[0] += a;
+    h_[1] += b;
+    h_[2] += c;
+    h_[3] += d;
+    h_[4] += e;
+  }
+
+  uint32_t h_[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+  std::array<uint8_t, 64> block_{};
+  size_t buffered_ = 0;
+  uint64_t bits_ = 0;
+};
+
+// HMAC-SHA1 (RFC 2104)
+Sha1Digest hmac_sha1(std::string_view key, std::span<const uint8_t> message)
+{
+  std::array<uint8_t, 64> padded{};
+  if (key.size() > padded.size())
+  {
+    Sha1 hash;
+    hash.update({reinterpret_cast<const uint8_t*>(key.data()), key.size()});
+    auto digest = hash.finish();
+    std::copy(digest.begin(), digest.end(), padded.begin());
+  }
+  else
+  {
+    std::memcpy(padded.data(), key.data(), key.size());
+  }
+
+  std::array<uint8_t, 64> ipad;
+  std::array<uint8_t, 64> opad;
+  for (size_t i = 0; i < padded.size(); ++i)
+  {
+    ipad[i] = padded[i] ^ 0x36;
+    opad[i] = padded[i] ^ 0x5C;
+  }
+
+  Sha1 inner;
+  inner.update(ipad);
+  inner.update(message);
+  auto inner_digest = inner.finish();
+
+  Sha1 outer;
+  outer.update(opad);
+  outer.update(inner_digest);
+  return outer.finish();
+}
+
+// CRC-32 as used by FINGERPRINT (ISO 3309, reflected 0x04C11DB7)
+constexpr std::array<uint32_t, 256> CRC32_TABLE = []()
+{
+  std::array<uint32_t, 256> table{};
+  for (uint32_t i = 0; i < 256; ++i)
+  {
+    uint32_t crc = i;
+    for (int bit = 0; bit < 8; ++bit)
+    {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+    }
+    table[i] = crc;
+  }
+  return table;
+}();
+
+uint32_t crc32(std::span<const uint8_t> data)
+{
+  uint32_t crc = 0xFFFFFFFF;
+  for (uint8_t byte : data)
+  {
+    crc = CRC32_TABLE[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+  }
+  return crc ^ 0xFFFFFFFF;
+}
+
+// Offset of the first attribute of a type in a serialized message
+std::optional<size_t> attribute_offset(std::span<const uint8_t> message, StunAttributeType type)
+{
+  size_t offset = STUN_HEADER_SIZE;
+  while (offset + 4 <= message.size())
+  {
+    auto attr_type = static_cast<StunAttributeType>((message[offset] << 8) | message[offset + 1]);
+    size_t attr_length = (static_cast<size_t>(message[offset + 2]) << 8) | message[offset + 3];
+    if (attr_type == type)
+    {
+      return offset + 4 + attr_length <= message.size() ? std::optional(offset) : std::nullopt;
+    }
+    offset += 4 + ((attr_length + 3) & ~size_t{3});
+  }
+  return std::nullopt;
+}
+
+// The message up to an attribute, its length field set as though that
+// attribute (attr_size bytes of value) were the last one
+std::vector<uint8_t> covered_prefix(std::span<const uint8_t> message, size_t offset,
+                                    size_t attr_size)
+{
+  std::vector<uint8_t> prefix(message.begin(), message.begin() + static_cast<ptrdiff_t>(offset));
+  size_t length = offset - STUN_HEADER_SIZE + 4 + attr_size;
+  prefix[2] = static_cast<uint8_t>(length >> 8);
+  prefix[3] = static_cast<uint8_t>(length);
+  return prefix;
+}
+
+Sha1Digest integrity_of(std::span<const uint8_t> message, size_t offset, std::string_view key)
+{
+  return hmac_sha1(key, covered_prefix(message, offset, INTEGRITY_SIZE));
+}
+
+uint32_t fingerprint_of(std::span<const uint8_t> message, size_t offset)
+{
+  return crc32(covered_prefix(message, offset, 4)) ^ FINGERPRINT_XOR;
+}
+
+}  // namespace
+
 // StunTransactionId implementation
 bool StunTransactionId::operator==(const StunTransactionId& other) const
 {
@@ -65,6 +285,7 @@ std::optional<StunMessage> StunMessage::parse(std::span<const uint8_t> data)
 
   // Copy transaction ID
   std::memcpy(msg.transaction_id_.data, &data[8], 12);
+  msg.raw_.assign(data.begin(), data.begin() + 20 + msg_length);
 
   // Parse attributes
   size_t offset = 20;
@@ -114,25 +335,72 @@ std::vector<uint8_t> StunMessage::serialize() const
   // Transaction ID (12 bytes)
   result.insert(result.end(), std::begin(transaction_id_.data), std::end(transaction_id_.data));
 
-  // TODO: Serialize attributes
+  // Attributes, each padded to a 4-byte boundary
+  for (const auto& attr : attributes_)
+  {
+    result.push_back(static_cast<uint8_t>(static_cast<uint16_t>(attr.type) >> 8));
+    result.push_back(static_cast<uint8_t>(attr.type));
+    result.push_back(static_cast<uint8_t>(attr.value.size() >> 8));
+    result.push_back(static_cast<uint8_t>(attr.value.size()));
+    result.insert(result.end(), attr.value.begin(), attr.value.end());
+    result.resize((result.size() + 3) & ~size_t{3}, 0);
+  }
+
+  size_t length = result.size() - 20;
+  result[length_offset] = static_cast<uint8_t>(length >> 8);
+  result[length_offset + 1] = static_cast<uint8_t>(length);
 
   return result;
 }
 
-void StunMessage::add_message_integrity(std::string_view /*password*/)
+void StunMessage::add_message_integrity(std::string_view password)
 {
-  // TODO: Implement HMAC-SHA1
+  auto bytes = serialize();
+  auto mac = integrity_of(bytes, bytes.size(), password);
+  add_attribute({StunAttributeType::MESSAGE_INTEGRITY, {mac.begin(), mac.end()}});
 }
 
-bool StunMessage::verify_message_integrity(std::string_view /*password*/) const
+bool StunMessage::verify_message_integrity(std::string_view password) const
 {
-  // TODO: Implement
-  return true;
+  auto bytes = raw_.empty() ? serialize() : raw_;
+  auto offset = attribute_offset(bytes, StunAttributeType::MESSAGE_INTEGRITY);
+  if (!offset || (static_cast<size_t>(bytes[*offset + 2]) << 8 | bytes[*offset + 3]) !=
+                     INTEGRITY_SIZE)
+  {
+    return false;
+  }
+
+  auto expected = integrity_of(bytes, *offset, password);
+  uint8_t diff = 0;  // Compare in constant time
+  for (size_t i = 0; i < INTEGRITY_SIZE; ++i)
+  {
+    diff |= expected[i] ^ bytes[*offset + 4 + i];
+  }
+  return diff == 0;
 }
 
 void StunMessage::add_fingerprint()
 {
-  // TODO: Implement CRC32
+  auto bytes = serialize();
+  uint32_t crc = fingerprint_of(bytes, bytes.size());
+  add_attribute({StunAttributeType::FINGERPRINT,
+                 {static_cast<uint8_t>(crc >> 24), static_cast<uint8_t>(crc >> 16),
+                  static_cast<uint8_t>(crc >> 8), static_cast<uint8_t>(crc)}});
+}
+
+bool StunMessage::verify_fingerprint() const
+{
+  auto bytes = raw_.empty() ? serialize() : raw_;
+  auto offset = attribute_offset(bytes, StunAttributeType::FINGERPRINT);
+  if (!offset || *offset + 8 != bytes.size())
+  {
+    return false;  // Absent, or not the last attribute
+  }
+
+  uint32_t crc = (static_cast<uint32_t>(bytes[*offset + 4]) << 24) |
+                 (static_cast<uint32_t>(bytes[*offset + 5]) << 16) |
+                 (static_cast<uint32_t>(bytes[*offset + 6]) << 8) | bytes[*offset + 7];
+  return crc == fingerprint_of(bytes, *offset);
 }
 
 std::optional<SocketAddress> StunMessage::get_xor_mapped_address() const
@@ -174,9 +442,66 @@ std::optional<SocketAddress> StunMessage::get_xor_mapped_address() const
   return std::nullopt;
 }
 
+void StunMessage::add_xor_mapped_address(const SocketAddress& address)
+{
+  constexpr uint32_t MAGIC_COOKIE = 0x2112A442;
+
+  // Parse dotted-decimal; anything else (e.g. IPv6) is not encoded
+  uint32_t ip = 0;
+  int octets = 0;
+  size_t pos = 0;
+  while (octets < 4 && pos <= address.ip.size())
+  {
+    size_t end = address.ip.find('.', pos);
+    if (end == std::string::npos) end = address.ip.size();
+    if (end == pos || end - pos > 3) return;
+
+    uint32_t octet = 0;
+    for (size_t i = pos; i < end; ++i)
+    {
+      if (address.ip[i] < '0' || address.ip[i] > '9') return;
+      octet = octet * 10 + static_cast<uint32_t>(address.ip[i] - '0');
+    }
+    if (octet > 255) return;
+
+    ip = (ip << 8) | octet;
+    ++octets;
+    pos = end + 1;
+  }
+  if (octets != 4 || pos <= address.ip.size()) return;
+
+  uint16_t xor_port = address.port ^ static_cast<uint16_t>(MAGIC_COOKIE >> 16);
+  uint32_t xor_ip = ip ^ MAGIC_COOKIE;
+
+  StunAttribute attr;
+  attr.type = StunAttributeType::XOR_MAPPED_ADDRESS;
+  attr.value = {0x00,
+                0x01,  // IPv4
+                static_cast<uint8_t>(xor_port >> 8),
+                static_cast<uint8_t>(xor_port),
+                static_cast<uint8_t>(xor_ip >> 24),
+                static_cast<uint8_t>(xor_ip >> 16),
+                static_cast<uint8_t>(xor_ip >> 8),
+                static_cast<uint8_t>(xor_ip)};
+  add_attribute(std::move(attr));
+}
+
+const StunAttribute* StunMessage::find_attribute(StunAttributeType type) const
+{
+  for (const auto& attr : attributes_)
+  {
+    if (attr.type == type)
+    {
+      return &attr;
+    }
+  }
+  return nullptr;
+}
+
 void StunMessage::add_attribute(StunAttribute attr)
 {
   attributes_.push_back(std::move(attr));
+  raw_.clear();
 }
 
 // StunClient implementation
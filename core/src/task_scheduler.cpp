@@ -0,0 +1,525 @@
+/**
+ * @file task_scheduler.cpp
+ * @brief Work-stealing task scheduler implementation
+ */
+
+#include "rtc/task_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "rtc/health_monitor.h"
+#include "rtc/timer_wheel.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace rtc
+{
+
+namespace
+{
+
+/**
+ * @brief Identifies the scheduler/worker/periodic task of the current thread
+ */
+struct WorkerContext
+{
+  const void* owner = nullptr;
+  size_t index = TaskScheduler::NO_AFFINITY;
+  const void* periodic = nullptr;
+};
+
+thread_local WorkerContext tls_context;
+
+}  // namespace
+
+struct TaskScheduler::Impl
+{
+  struct alignas(64) Worker
+  {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    std::thread thread;
+    std::shared_ptr<LoopLagProbe> lag_probe;  // Periodic runs vs. their deadline
+  };
+
+  struct PeriodicTask
+  {
+    Task task;
+    std::chrono::microseconds interval{0};
+    size_t affinity = NO_AFFINITY;
+    TimerId timer = 0;                                // Guarded by timer_mutex
+    std::chrono::steady_clock::time_point next_due;  // Only touched by the timer callback
+    std::atomic<bool> in_flight{false};
+    std::atomic<bool> cancelled{false};
+  };
+
+  TaskSchedulerConfig config;
+  std::vector<std::unique_ptr<Worker>> workers;
+
+  std::atomic<bool> running{false};
+  std::atomic<size_t> pending{0};
+  std::atomic<size_t> next_worker{0};
+
+  // Idle workers sleep here
+  std::mutex sleep_mutex;
+  std::condition_variable sleep_cv;
+
+  // Periodic tasks (timers on the shared wheel dispatch them to the pool)
+  std::mutex timer_mutex;
+  std::unordered_map<PeriodicTaskId, std::shared_ptr<PeriodicTask>> periodic_tasks;
+  PeriodicTaskId next_periodic_id = 1;
+
+  // Stats
+  std::atomic<uint64_t> tasks_submitted{0};
+  std::atomic<uint64_t> tasks_executed{0};
+  std::atomic<uint64_t> tasks_stolen{0};
+  std::atomic<uint64_t> periodic_runs{0};
+  std::atomic<uint64_t> periodic_skipped{0};
+
+  Impl(TaskSchedulerConfig cfg) : config(std::move(cfg))
+  {
+    size_t count = config.num_workers;
+    if (count == 0)
+    {
+      count = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    workers.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      workers.push_back(std::make_unique<Worker>());
+    }
+  }
+
+  size_t own_index() const
+  {
+    return tls_context.owner == this ? tls_context.index : NO_AFFINITY;
+  }
+
+  void push(Task task, size_t affinity)
+  {
+    size_t target = affinity;
+    if (target == NO_AFFINITY)
+    {
+      target = own_index();
+    }
+    if (target == NO_AFFINITY)
+    {
+      target = next_worker.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Count first so a thief never observes a task that `pending` misses
+    pending.fetch_add(1, std::memory_order_release);
+    tasks_submitted.fetch_add(1, std::memory_order_relaxed);
+
+    auto& worker = *workers[target % workers.size()];
+    {
+      std::lock_guard lock(worker.mutex);
+      worker.tasks.push_back(std::move(task));
+    }
+
+    // Taking the lock orders this wakeup against a worker that has just
+    // checked `pending` and is about to block
+    {
+      std::lock_guard lock(sleep_mutex);
+    }
+    sleep_cv.notify_one();
+  }
+
+  std::optional<Task> pop_local(size_t index)
+  {
+    auto& worker = *workers[index];
+    std::lock_guard lock(worker.mutex);
+    if (worker.tasks.empty())
+    {
+      return std::nullopt;
+    }
+
+    Task task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return task;
+  }
+
+  std::optional<Task> steal(size_t thief)
+  {
+    const size_t count = workers.size();
+    const size_t start = thief == NO_AFFINITY ? 0 : thief + 1;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      size_t victim = (start + i) % count;
+      if (victim == thief) continue;
+
+      auto& worker = *workers[victim];
+      std::unique_lock lock(worker.mutex, std::try_to_lock);
+      if (!lock.owns_lock() || worker.tasks.empty()) continue;
+
+      Task task = std::move(worker.tasks.front());
+      worker.tasks.pop_front();
+      tasks_stolen.fetch_add(1, std::memory_order_relaxed);
+      return task;
+    }
+    return std::nullopt;
+  }
+
+  bool run_one(size_t index)
+  {
+    std::optional<Task> task;
+    if (index != NO_AFFINITY)
+    {
+      task = pop_local(index);
+    }
+    if (!task)
+    {
+      task = steal(index);
+    }
+    if (!task)
+    {
+      return false;
+    }
+
+    pending.fetch_sub(1, std::memory_order_acq_rel);
+    (*task)();
+    tasks_executed.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  void pin_to_cpu([[maybe_unused]] size_t index)
+  {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(index % std::max(1u, std::thread::hardware_concurrency()), &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#endif
+  }
+
+  void worker_loop(size_t index)
+  {
+    tls_context.owner = this;
+    tls_context.index = index;
+    workers[index]->lag_probe = LoopLagProbe::create("task_worker_" + std::to_string(index));
+
+    if (config.pin_workers)
+    {
+      pin_to_cpu(index);
+    }
+
+    int idle_rounds = 0;
+    while (true)
+    {
+      if (run_one(index))
+      {
+        idle_rounds = 0;
+        continue;
+      }
+
+      if (++idle_rounds < config.idle_spin_rounds)
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      std::unique_lock lock(sleep_mutex);
+      sleep_cv.wait(lock, [this]()
+                    { return pending.load(std::memory_order_acquire) > 0 || !running.load(); });
+
+      if (!running.load() && pending.load(std::memory_order_acquire) == 0)
+      {
+        break;
+      }
+      idle_rounds = 0;
+    }
+
+    tls_context = {};
+  }
+
+  void dispatch_periodic(const std::shared_ptr<PeriodicTask>& periodic,
+                         std::chrono::steady_clock::time_point due)
+  {
+    if (periodic->in_flight.exchange(true))
+    {
+      periodic_skipped.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    push(
+        [this, periodic, due]()
+        {
+          size_t index = own_index();
+          if (index != NO_AFFINITY)
+          {
+            workers[index]->lag_probe->tick(due);
+          }
+
+          if (!periodic->cancelled.load())
+          {
+            tls_context.periodic = periodic.get();
+            periodic->task();
+            tls_context.periodic = nullptr;
+            periodic_runs.fetch_add(1, std::memory_order_relaxed);
+          }
+          periodic->in_flight.store(false, std::memory_order_release);
+        },
+        periodic->affinity);
+  }
+
+  void arm(const std::shared_ptr<PeriodicTask>& periodic)
+  {
+    periodic->next_due = std::chrono::steady_clock::now() + periodic->interval;
+    periodic->timer = TimerWheel::shared().schedule_periodic(
+        periodic->interval,
+        [this, periodic]()
+        {
+          auto due = periodic->next_due;
+          dispatch_periodic(periodic, due);
+
+          // Mirror the wheel's re-arm so lag is measured against the real deadline
+          auto now = std::chrono::steady_clock::now();
+          periodic->next_due = due + periodic->interval;
+          if (periodic->next_due < now)
+          {
+            periodic->next_due = now + periodic->interval;
+          }
+        });
+  }
+};
+
+TaskScheduler::TaskScheduler(TaskSchedulerConfig config)
+    : impl_(std::make_unique<Impl>(std::move(config)))
+{
+}
+
+TaskScheduler::~TaskScheduler()
+{
+  stop();
+}
+
+TaskScheduler& TaskScheduler::shared()
+{
+  static TaskScheduler instance;
+  static std::once_flag started;
+  std::call_once(started, []() { instance.start(); });
+  return instance;
+}
+
+bool TaskScheduler::start()
+{
+  if (impl_->running.exchange(true))
+  {
+    return false;
+  }
+
+  for (size_t i = 0; i < impl_->workers.size(); ++i)
+  {
+    impl_->workers[i]->thread = std::thread([this, i]() { impl_->worker_loop(i); });
+  }
+
+  {
+    std::lock_guard lock(impl_->timer_mutex);
+    for (auto& [id, periodic] : impl_->periodic_tasks)
+    {
+      impl_->arm(periodic);
+    }
+  }
+
+  return true;
+}
+
+void TaskScheduler::stop()
+{
+  std::vector<TimerId> timers;
+  {
+    std::lock_guard lock(impl_->timer_mutex);
+    if (!impl_->running.exchange(false))
+    {
+      return;
+    }
+
+    // Kept registered so a restart re-arms them
+    for (auto& [id, periodic] : impl_->periodic_tasks)
+    {
+      timers.push_back(std::exchange(periodic->timer, 0));
+    }
+  }
+
+  for (TimerId timer : timers)
+  {
+    TimerWheel::shared().cancel(timer);
+  }
+
+  {
+    std::lock_guard lock(impl_->sleep_mutex);
+  }
+  impl_->sleep_cv.notify_all();
+
+  for (auto& worker : impl_->workers)
+  {
+    if (worker->thread.joinable())
+    {
+      worker->thread.join();
+    }
+  }
+}
+
+bool TaskScheduler::is_running() const
+{
+  return impl_->running.load();
+}
+
+void TaskScheduler::submit(Task task, size_t affinity)
+{
+  impl_->push(std::move(task), affinity);
+}
+
+void TaskScheduler::parallel_for(size_t begin, size_t end, size_t grain, const RangeTask& body)
+{
+  if (end <= begin) return;
+
+  const size_t count = end - begin;
+  const size_t workers = impl_->workers.size();
+  if (grain == 0)
+  {
+    // ~4 chunks per worker balances stealing against per-chunk overhead
+    grain = std::max<size_t>(1, count / (workers * 4));
+  }
+
+  const size_t chunks = (count + grain - 1) / grain;
+  if (chunks == 1 || !impl_->running.load())
+  {
+    body(begin, end);
+    return;
+  }
+
+  // Helpers may be dequeued after we return, so the shared state must
+  // outlive this frame; `body` is only touched while chunks remain.
+  struct ForState
+  {
+    const RangeTask* body = nullptr;
+    size_t begin = 0;
+    size_t end = 0;
+    size_t grain = 0;
+    size_t chunks = 0;
+    std::atomic<size_t> next_chunk{0};
+    std::atomic<size_t> done_chunks{0};
+
+    void run_chunks()
+    {
+      size_t chunk;
+      while ((chunk = next_chunk.fetch_add(1, std::memory_order_relaxed)) < chunks)
+      {
+        size_t chunk_begin = begin + chunk * grain;
+        size_t chunk_end = std::min(end, chunk_begin + grain);
+        (*body)(chunk_begin, chunk_end);
+        done_chunks.fetch_add(1, std::memory_order_acq_rel);
+      }
+    }
+  };
+
+  auto state = std::make_shared<ForState>();
+  state->body = &body;
+  state->begin = begin;
+  state->end = end;
+  state->grain = grain;
+  state->chunks = chunks;
+
+  const size_t helpers = std::min(chunks, workers) - 1;
+  for (size_t i = 0; i < helpers; ++i)
+  {
+    impl_->push([state]() { state->run_chunks(); }, NO_AFFINITY);
+  }
+
+  state->run_chunks();
+
+  while (state->done_chunks.load(std::memory_order_acquire) < chunks)
+  {
+    std::this_thread::yield();
+  }
+}
+
+PeriodicTaskId TaskScheduler::schedule_periodic(std::chrono::microseconds interval, Task task,
+                                                size_t affinity)
+{
+  auto periodic = std::make_shared<Impl::PeriodicTask>();
+  periodic->task = std::move(task);
+  periodic->interval = std::max(interval, std::chrono::microseconds(1));
+  periodic->affinity = affinity;
+
+  std::lock_guard lock(impl_->timer_mutex);
+  PeriodicTaskId id = impl_->next_periodic_id++;
+  impl_->periodic_tasks[id] = periodic;
+  if (impl_->running.load())
+  {
+    impl_->arm(periodic);
+  }
+  return id;
+}
+
+void TaskScheduler::cancel_periodic(PeriodicTaskId id)
+{
+  std::shared_ptr<Impl::PeriodicTask> periodic;
+  TimerId timer;
+  {
+    std::lock_guard lock(impl_->timer_mutex);
+    auto it = impl_->periodic_tasks.find(id);
+    if (it == impl_->periodic_tasks.end()) return;
+
+    periodic = std::move(it->second);
+    impl_->periodic_tasks.erase(it);
+    timer = std::exchange(periodic->timer, 0);
+  }
+
+  // Stops further dispatches; waits if the wheel is dispatching right now
+  TimerWheel::shared().cancel(timer);
+  periodic->cancelled.store(true);
+
+  // Cancelling from inside the task itself must not wait on itself
+  if (tls_context.periodic == periodic.get()) return;
+
+  while (periodic->in_flight.load(std::memory_order_acquire))
+  {
+    std::this_thread::yield();
+  }
+}
+
+size_t TaskScheduler::worker_count() const
+{
+  return impl_->workers.size();
+}
+
+size_t TaskScheduler::affinity_hint(std::string_view key) const
+{
+  return std::hash<std::string_view>{}(key) % impl_->workers.size();
+}
+
+size_t TaskScheduler::current_worker() const
+{
+  return impl_->own_index();
+}
+
+TaskSchedulerStats TaskScheduler::stats() const
+{
+  TaskSchedulerStats s;
+  s.tasks_submitted = impl_->tasks_submitted.load(std::memory_order_relaxed);
+  s.tasks_executed = impl_->tasks_executed.load(std::memory_order_relaxed);
+  s.tasks_stolen = impl_->tasks_stolen.load(std::memory_order_relaxed);
+  s.tasks_pending = impl_->pending.load(std::memory_order_relaxed);
+  s.periodic_runs = impl_->periodic_runs.load(std::memory_order_relaxed);
+  s.periodic_skipped = impl_->periodic_skipped.load(std::memory_order_relaxed);
+  return s;
+}
+
+}  // namespace rtc
@@ -0,0 +1,508 @@
+/**
+ * @file timer_wheel.cpp
+ * @brief Hierarchical timer wheel implementation
+ */
+
+#include "rtc/timer_wheel.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rtc
+{
+
+namespace
+{
+
+constexpr int LEVELS = 4;
+constexpr int SLOT_BITS = 8;
+constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+constexpr uint32_t SLOT_MASK = SLOTS - 1;
+constexpr uint64_t MAX_DELTA = (uint64_t{1} << (LEVELS * SLOT_BITS)) - 1;
+constexpr uint32_t NIL = std::numeric_limits<uint32_t>::max();
+
+}  // namespace
+
+struct TimerWheel::Impl
+{
+  enum class NodeState : uint8_t
+  {
+    FREE,
+    PENDING,
+    RUNNING,
+  };
+
+  struct Node
+  {
+    TimerCallback callback;
+    uint64_t expires = 0;   // Absolute tick
+    uint64_t interval = 0;  // Ticks; 0 = one-shot
+    uint32_t generation = 1;
+    uint32_t prev = NIL;
+    uint32_t next = NIL;
+    uint16_t slot = 0;  // level * SLOTS + index while PENDING
+    NodeState state = NodeState::FREE;
+    bool cancelled = false;  // Cancelled while RUNNING
+  };
+
+  TimerWheelConfig config;
+  std::chrono::steady_clock::time_point epoch;
+
+  mutable std::mutex mutex;
+  std::condition_variable wake_cv;  // Dedicated thread: earlier timer or stop
+  std::condition_variable done_cv;  // cancel() waiting on a running callback
+
+  // Nodes live in a deque so growth never moves them
+  std::deque<Node> nodes;
+  std::vector<uint32_t> free_nodes;
+  std::array<uint32_t, LEVELS * SLOTS> heads;
+  std::array<uint32_t, LEVELS> level_counts{};
+
+  uint64_t current_tick = 0;  // Every tick <= current_tick has been processed
+  uint64_t wake_tick = std::numeric_limits<uint64_t>::max();  // Dedicated thread's next wakeup
+  std::thread::id driver;  // Thread inside advance()
+
+  std::thread thread;
+  bool running = false;
+
+  // Stats
+  size_t active = 0;
+  uint64_t fired = 0;
+  uint64_t cancelled = 0;
+  uint64_t cascaded = 0;
+
+  Impl(TimerWheelConfig cfg) : config(cfg), epoch(std::chrono::steady_clock::now())
+  {
+    config.resolution = std::max(config.resolution, std::chrono::microseconds(1));
+    heads.fill(NIL);
+  }
+
+  static TimerId make_id(uint32_t index, uint32_t generation)
+  {
+    return (static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(index) + 1);
+  }
+
+  Node* lookup(TimerId id)
+  {
+    uint32_t low = static_cast<uint32_t>(id);
+    if (low == 0 || low > nodes.size()) return nullptr;
+
+    Node& node = nodes[low - 1];
+    if (node.state == NodeState::FREE || node.generation != static_cast<uint32_t>(id >> 32))
+    {
+      return nullptr;
+    }
+    return &node;
+  }
+
+  uint64_t tick_at(std::chrono::steady_clock::time_point time) const
+  {
+    if (time <= epoch) return 0;
+    return static_cast<uint64_t>((time - epoch) / config.resolution);
+  }
+
+  uint64_t ticks_for(std::chrono::microseconds delay) const
+  {
+    if (delay.count() <= 0) return 0;
+    // Round up so a timer never fires early
+    return static_cast<uint64_t>((delay.count() + config.resolution.count() - 1) /
+                                 config.resolution.count());
+  }
+
+  void link(uint32_t index)
+  {
+    Node& node = nodes[index];
+    uint64_t expires = std::max(node.expires, current_tick);
+    uint64_t delta = std::min(expires - current_tick, MAX_DELTA);
+    expires = current_tick + delta;
+    node.expires = expires;
+
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (uint64_t{1} << ((level + 1) * SLOT_BITS)))
+    {
+      ++level;
+    }
+    uint32_t slot = static_cast<uint32_t>(level) * SLOTS +
+                    static_cast<uint32_t>((expires >> (level * SLOT_BITS)) & SLOT_MASK);
+
+    node.slot = static_cast<uint16_t>(slot);
+    node.prev = NIL;
+    node.next = heads[slot];
+    if (node.next != NIL)
+    {
+      nodes[node.next].prev = index;
+    }
+    heads[slot] = index;
+    level_counts[level]++;
+  }
+
+  void unlink(uint32_t index)
+  {
+    Node& node = nodes[index];
+    if (node.prev != NIL)
+    {
+      nodes[node.prev].next = node.next;
+    }
+    else
+    {
+      heads[node.slot] = node.next;
+    }
+    if (node.next != NIL)
+    {
+      nodes[node.next].prev = node.prev;
+    }
+    node.prev = node.next = NIL;
+    level_counts[node.slot / SLOTS]--;
+  }
+
+  void release(uint32_t index)
+  {
+    Node& node = nodes[index];
+    node.callback = nullptr;
+    node.state = NodeState::FREE;
+    node.cancelled = false;
+    node.generation++;
+    if (node.generation == 0) node.generation = 1;
+    free_nodes.push_back(index);
+    active--;
+  }
+
+  size_t pending() const
+  {
+    size_t count = 0;
+    for (size_t c : level_counts) count += c;
+    return count;
+  }
+
+  // Ticks from current_tick until delay after now
+  uint64_t ticks_from_now(std::chrono::microseconds delay)
+  {
+    uint64_t now_tick = tick_at(std::chrono::steady_clock::now());
+    if (now_tick > current_tick && pending() == 0 && driver == std::thread::id())
+    {
+      // Idle wheel: skip the empty ticks instead of walking them later
+      current_tick = now_tick;
+    }
+    return std::max(now_tick, current_tick) - current_tick + ticks_for(delay);
+  }
+
+  TimerId add(uint64_t delay_ticks, uint64_t interval_ticks, TimerCallback callback)
+  {
+    uint32_t index;
+    if (!free_nodes.empty())
+    {
+      index = free_nodes.back();
+      free_nodes.pop_back();
+    }
+    else
+    {
+      index = static_cast<uint32_t>(nodes.size());
+      nodes.emplace_back();
+    }
+
+    Node& node = nodes[index];
+    node.callback = std::move(callback);
+    // Never due in the tick that is already being processed
+    node.expires = current_tick + std::max<uint64_t>(delay_ticks, 1);
+    node.interval = interval_ticks;
+    node.state = NodeState::PENDING;
+    node.cancelled = false;
+    link(index);
+    active++;
+
+    return make_id(index, node.generation);
+  }
+
+  void cascade(int level, uint64_t tick)
+  {
+    uint32_t slot =
+        static_cast<uint32_t>(level) * SLOTS +
+        static_cast<uint32_t>((tick >> (level * SLOT_BITS)) & SLOT_MASK);
+
+    uint32_t index = heads[slot];
+    heads[slot] = NIL;
+    while (index != NIL)
+    {
+      uint32_t next = nodes[index].next;
+      level_counts[level]--;
+      link(index);
+      cascaded++;
+      index = next;
+    }
+  }
+
+  // Next tick needing work, at most one level-0 rotation ahead
+  std::optional<uint64_t> next_tick() const
+  {
+    if (active == 0) return std::nullopt;
+
+    bool upper = false;
+    for (int level = 1; level < LEVELS; ++level)
+    {
+      upper = upper || level_counts[level] > 0;
+    }
+
+    for (uint64_t tick = current_tick + 1; tick <= current_tick + SLOTS; ++tick)
+    {
+      if (heads[tick & SLOT_MASK] != NIL) return tick;
+      if (upper && (tick & SLOT_MASK) == 0) return tick;  // Cascade point
+    }
+    return std::nullopt;  // Only timers running right now
+  }
+
+  void thread_loop()
+  {
+    std::unique_lock lock(mutex);
+    while (running)
+    {
+      auto next = next_tick();
+      wake_tick = next.value_or(std::numeric_limits<uint64_t>::max());
+      if (!next)
+      {
+        wake_cv.wait(lock);
+      }
+      else
+      {
+        wake_cv.wait_until(lock, epoch + config.resolution * static_cast<int64_t>(*next));
+      }
+      wake_tick = std::numeric_limits<uint64_t>::max();
+      if (!running) break;
+
+      lock.unlock();
+      advance(std::chrono::steady_clock::now());
+      lock.lock();
+    }
+  }
+
+  size_t advance(std::chrono::steady_clock::time_point now)
+  {
+    const uint64_t target = tick_at(now);
+    size_t ran = 0;
+
+    std::unique_lock lock(mutex);
+    driver = std::this_thread::get_id();
+
+    if (pending() == 0)
+    {
+      current_tick = std::max(current_tick, target);
+    }
+
+    while (current_tick < target)
+    {
+      uint64_t tick = ++current_tick;
+      if ((tick & SLOT_MASK) == 0)
+      {
+        // Higher levels first so their timers can land in the lower ones
+        for (int level = LEVELS - 1; level >= 1; --level)
+        {
+          uint64_t mask = (uint64_t{1} << (level * SLOT_BITS)) - 1;
+          if ((tick & mask) == 0)
+          {
+            cascade(level, tick);
+          }
+        }
+      }
+
+      uint32_t slot = static_cast<uint32_t>(tick & SLOT_MASK);
+      while (heads[slot] != NIL)
+      {
+        uint32_t index = heads[slot];
+        unlink(index);
+
+        Node& node = nodes[index];
+        node.state = NodeState::RUNNING;
+        TimerCallback callback = std::move(node.callback);
+        fired++;
+
+        lock.unlock();
+        callback();
+        ++ran;
+        lock.lock();
+
+        Node& done = nodes[index];
+        if (done.cancelled || done.interval == 0)
+        {
+          release(index);
+          done_cv.notify_all();
+          continue;
+        }
+
+        // Re-arm; if we fell behind by more than one interval, skip ahead
+        done.callback = std::move(callback);
+        done.state = NodeState::PENDING;
+        done.expires += done.interval;
+        if (done.expires <= target)
+        {
+          done.expires = target + done.interval;
+        }
+        link(index);
+        done_cv.notify_all();
+      }
+    }
+
+    driver = std::thread::id();
+    return ran;
+  }
+};
+
+TimerWheel::TimerWheel(TimerWheelConfig config) : impl_(std::make_unique<Impl>(config)) {}
+
+TimerWheel::~TimerWheel()
+{
+  stop();
+}
+
+TimerWheel& TimerWheel::shared()
+{
+  // Never destroyed: other statics may still cancel timers during exit
+  static TimerWheel* instance = []()
+  {
+    auto* wheel = new TimerWheel();
+    wheel->start();
+    return wheel;
+  }();
+  return *instance;
+}
+
+bool TimerWheel::start()
+{
+  std::lock_guard lock(impl_->mutex);
+  if (impl_->running)
+  {
+    return false;
+  }
+
+  impl_->running = true;
+  impl_->thread = std::thread([this]() { impl_->thread_loop(); });
+  return true;
+}
+
+void TimerWheel::stop()
+{
+  {
+    std::lock_guard lock(impl_->mutex);
+    if (!impl_->running)
+    {
+      return;
+    }
+    impl_->running = false;
+  }
+
+  impl_->wake_cv.notify_all();
+  if (impl_->thread.joinable())
+  {
+    impl_->thread.join();
+  }
+}
+
+TimerId TimerWheel::schedule(std::chrono::microseconds delay, TimerCallback callback)
+{
+  TimerId id;
+  bool wake;
+  {
+    std::lock_guard lock(impl_->mutex);
+    uint64_t ticks = impl_->ticks_from_now(delay);
+    id = impl_->add(ticks, 0, std::move(callback));
+    wake = impl_->current_tick + std::max<uint64_t>(ticks, 1) < impl_->wake_tick;
+  }
+
+  if (wake)
+  {
+    impl_->wake_cv.notify_one();
+  }
+  return id;
+}
+
+TimerId TimerWheel::schedule_periodic(std::chrono::microseconds first_delay,
+                                      std::chrono::microseconds interval, TimerCallback callback)
+{
+  TimerId id;
+  bool wake;
+  {
+    std::lock_guard lock(impl_->mutex);
+    uint64_t ticks = impl_->ticks_from_now(first_delay);
+    uint64_t interval_ticks = std::max<uint64_t>(impl_->ticks_for(interval), 1);
+    id = impl_->add(ticks, interval_ticks, std::move(callback));
+    wake = impl_->current_tick + std::max<uint64_t>(ticks, 1) < impl_->wake_tick;
+  }
+
+  if (wake)
+  {
+    impl_->wake_cv.notify_one();
+  }
+  return id;
+}
+
+bool TimerWheel::cancel(TimerId id)
+{
+  std::unique_lock lock(impl_->mutex);
+  Impl::Node* node = impl_->lookup(id);
+  if (!node)
+  {
+    return false;
+  }
+
+  if (node->state == Impl::NodeState::PENDING)
+  {
+    uint32_t index = static_cast<uint32_t>(id) - 1;
+    impl_->unlink(index);
+    impl_->release(index);
+    impl_->cancelled++;
+    return true;
+  }
+
+  // Running: the driver frees it once the callback returns
+  node->cancelled = true;
+  impl_->cancelled++;
+  if (impl_->driver == std::this_thread::get_id())
+  {
+    return true;
+  }
+
+  impl_->done_cv.wait(lock, [&]() { return impl_->lookup(id) == nullptr; });
+  return true;
+}
+
+size_t TimerWheel::advance(std::chrono::steady_clock::time_point now)
+{
+  return impl_->advance(now);
+}
+
+std::optional<std::chrono::microseconds> TimerWheel::next_timeout() const
+{
+  std::lock_guard lock(impl_->mutex);
+  auto next = impl_->next_tick();
+  if (!next)
+  {
+    return std::nullopt;
+  }
+
+  auto due = impl_->epoch + impl_->config.resolution * static_cast<int64_t>(*next);
+  auto now = std::chrono::steady_clock::now();
+  if (due <= now)
+  {
+    return std::chrono::microseconds(0);
+  }
+  // Round up so the caller wakes at or after the tick boundary
+  return std::chrono::ceil<std::chrono::microseconds>(due - now);
+}
+
+TimerWheelStats TimerWheel::stats() const
+{
+  std::lock_guard lock(impl_->mutex);
+  TimerWheelStats s;
+  s.active_timers = impl_->active;
+  s.timers_fired = impl_->fired;
+  s.timers_cancelled = impl_->cancelled;
+  s.cascaded = impl_->cascaded;
+  return s;
+}
+
+}  // namespace rtc
@@ -25,12 +25,17 @@ using socket_t = int;
 constexpr socket_t INVALID_SOCKET_VALUE = -1;
 #endif
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstring>
 #include <mutex>
 #include <queue>
 #include <thread>
 
+#include "rtc/packet_tracer.h"
+#include "rtc/timer_wheel.h"
+
 namespace rtc
 {
 
@@ -62,6 +67,9 @@ class WinsockInit
 // Global Winsock initializer
 static WinsockInit g_winsock_init;
 
+constexpr size_t MAX_DATAGRAM = 65536;  // Event loop receive buffer
+constexpr int MAX_EVENTS = 64;          // Ready sockets taken per epoll_wait
+
 /**
  * @brief Convert SocketAddress to sockaddr_in
  */
@@ -209,6 +217,8 @@ class UdpSocketImpl : public UdpSocket
       return {std::make_error_code(std::errc::bad_file_descriptor), 0};
     }
 
+    PacketTracer::trace(TraceStage::SEND, data);
+
     sockaddr_in addr = to_sockaddr(remote);
     auto sent =
         ::sendto(sock, reinterpret_cast<const char*>(data.data()), static_cast<int>(data.size()), 0,
@@ -239,7 +249,7 @@ class UdpSocketImpl : public UdpSocket
     socket_t sock = socket_.load();
     if (sock == INVALID_SOCKET_VALUE)
     {
-      return {{}, {}, std::make_error_code(std::errc::bad_file_descriptor)};
+      return {{}, {}, std::make_error_code(std::errc::bad_file_descriptor), {}};
     }
 
     // Set timeout if specified
@@ -257,28 +267,12 @@ class UdpSocketImpl : public UdpSocket
 #endif
     }
 
-    sockaddr_in remote_addr{};
-    socklen_t addr_len = sizeof(remote_addr);
-
-    auto received =
-        ::recvfrom(sock, reinterpret_cast<char*>(buffer.data()), static_cast<int>(buffer.size()), 0,
-                   reinterpret_cast<sockaddr*>(&remote_addr), &addr_len);
-
-    if (received < 0)
-    {
-      return {{}, {}, get_socket_error()};
-    }
-
-    RecvResult result;
-    result.data.assign(buffer.begin(), buffer.begin() + received);
-    result.remote_address = from_sockaddr(remote_addr);
-    return result;
+    return receive(sock, buffer, 0);
   }
 
   void async_recv(RecvCallback callback) override
   {
-    // TODO: Implement proper async with IOCP/epoll
-    // For now, store callback for later use
+    // Invoked by a SocketEventLoop this socket is added to
     std::lock_guard lock(callback_mutex_);
     recv_callback_ = std::move(callback);
   }
@@ -371,7 +365,59 @@ class UdpSocketImpl : public UdpSocket
     return static_cast<intptr_t>(socket_.load());
   }
 
+#ifdef __linux__
+  /**
+   * @brief Hand every queued datagram to the async_recv callback
+   * @return Datagrams delivered (0 without a callback, leaving them queued)
+   */
+  size_t deliver_pending(std::span<uint8_t> buffer)
+  {
+    RecvCallback callback;
+    {
+      std::lock_guard lock(callback_mutex_);
+      callback = recv_callback_;
+    }
+    if (!callback) return 0;
+
+    size_t delivered = 0;
+    while (true)
+    {
+      socket_t sock = socket_.load();
+      if (sock == INVALID_SOCKET_VALUE) break;
+
+      RecvResult result = receive(sock, buffer, MSG_DONTWAIT);
+      if (!result.success()) break;
+      callback(std::move(result));
+      delivered++;
+    }
+    return delivered;
+  }
+#endif
+
  private:
+  static RecvResult receive(socket_t sock, std::span<uint8_t> buffer, int flags)
+  {
+    sockaddr_in remote_addr{};
+    socklen_t addr_len = sizeof(remote_addr);
+
+    auto received = ::recvfrom(sock, reinterpret_cast<char*>(buffer.data()),
+                               static_cast<int>(buffer.size()), flags,
+                               reinterpret_cast<sockaddr*>(&remote_addr), &addr_len);
+
+    if (received < 0)
+    {
+      return {{}, {}, get_socket_error(), {}};
+    }
+
+    RecvResult result;
+    result.received_at = std::chrono::steady_clock::now();
+    PacketTracer::trace(TraceStage::RECEIVE, buffer.first(static_cast<size_t>(received)));
+
+    result.data.assign(buffer.begin(), buffer.begin() + received);
+    result.remote_address = from_sockaddr(remote_addr);
+    return result;
+  }
+
   std::atomic<socket_t> socket_;
   SocketAddress local_addr_;
   std::mutex callback_mutex_;
@@ -390,27 +436,69 @@ std::unique_ptr<UdpSocket> UdpSocket::create()
 }
 
 /**
- * @brief Event loop implementation (placeholder for full async support)
+ * @brief Event loop implementation
+ *
+ * Linux: edge-triggered epoll; each ready socket is drained into its
+ * async_recv callback on the polling thread. Elsewhere sockets cannot be
+ * registered yet (IOCP is not implemented) and poll() only waits out the
+ * timeout and runs timers.
  */
 class SocketEventLoopImpl : public SocketEventLoop
 {
  public:
-  SocketEventLoopImpl() : running_(false) {}
+  SocketEventLoopImpl() : running_(false), recv_buffer_(MAX_DATAGRAM)
+  {
+#ifdef __linux__
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+#endif
+  }
 
   ~SocketEventLoopImpl() override
   {
     stop();
+#ifdef __linux__
+    if (epoll_fd_ >= 0)
+    {
+      ::close(epoll_fd_);
+    }
+#endif
   }
 
-  std::error_code add_socket(UdpSocket& /*socket*/) override
+  std::error_code add_socket(UdpSocket& socket) override
   {
-    // TODO: Implement with epoll/IOCP
+#ifdef __linux__
+    if (epoll_fd_ < 0 || !socket.is_open())
+    {
+      return std::make_error_code(std::errc::bad_file_descriptor);
+    }
+
+    // Edge-triggered: without a callback, datagrams stay queued for recv_from.
+    // UdpSocket::create() only makes UdpSocketImpl.
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.ptr = static_cast<UdpSocketImpl*>(&socket);
+    int fd = static_cast<int>(socket.native_handle());
+    if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+      return get_socket_error();
+    }
     return {};
+#else
+    (void)socket;
+    return std::make_error_code(std::errc::operation_not_supported);
+#endif
   }
 
-  void remove_socket(UdpSocket& /*socket*/) override
+  void remove_socket(UdpSocket& socket) override
   {
-    // TODO: Implement with epoll/IOCP
+#ifdef __linux__
+    if (epoll_fd_ >= 0 && socket.is_open())
+    {
+      ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, static_cast<int>(socket.native_handle()), nullptr);
+    }
+#else
+    (void)socket;
+#endif
   }
 
   void run() override
@@ -422,10 +510,50 @@ class SocketEventLoopImpl : public SocketEventLoop
     }
   }
 
-  size_t poll(int /*timeout_ms*/) override
+  size_t poll(int timeout_ms) override
   {
-    // TODO: Implement with epoll/IOCP
-    return 0;
+    TimerWheel* wheel = timer_wheel_.load(std::memory_order_acquire);
+    if (wheel)
+    {
+      if (auto next = wheel->next_timeout())
+      {
+        auto next_ms = std::chrono::ceil<std::chrono::milliseconds>(*next).count();
+        timeout_ms = timeout_ms < 0 ? static_cast<int>(next_ms)
+                                    : std::min(timeout_ms, static_cast<int>(next_ms));
+      }
+    }
+
+    size_t events = 0;
+#ifdef __linux__
+    bool waited = epoll_fd_ >= 0;
+    if (waited)
+    {
+      epoll_event ready[MAX_EVENTS];
+      int count = ::epoll_wait(epoll_fd_, ready, MAX_EVENTS, timeout_ms);
+      for (int i = 0; i < count; ++i)
+      {
+        auto* socket = static_cast<UdpSocketImpl*>(ready[i].data.ptr);
+        events += socket->deliver_pending(recv_buffer_);
+      }
+    }
+#else
+    bool waited = false;
+#endif
+    if (!waited && timeout_ms > 0)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+    }
+
+    if (wheel)
+    {
+      events += wheel->advance();
+    }
+    return events;
+  }
+
+  void set_timer_wheel(TimerWheel* wheel) override
+  {
+    timer_wheel_.store(wheel, std::memory_order_release);
   }
 
   void stop() override
@@ -440,6 +568,11 @@ class SocketEventLoopImpl : public SocketEventLoop
 
  private:
   std::atomic<bool> running_;
+  std::atomic<TimerWheel*> timer_wheel_{nullptr};
+  std::vector<uint8_t> recv_buffer_;  // Only touched by the polling thread
+#ifdef __linux__
+  int epoll_fd_ = -1;
+#endif
 };
 
 std::unique_ptr<SocketEventLoop> SocketEventLoop::create()
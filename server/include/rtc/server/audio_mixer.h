@@ -17,6 +17,9 @@
 
 namespace rtc
 {
+
+class TaskScheduler;
+
 namespace server
 {
 
@@ -102,12 +105,23 @@ class AudioMixer
    */
   void set_active_speaker_callback(ActiveSpeakerCallback callback);
 
+  /**
+   * @brief Spread per-recipient mixes of process() across a scheduler
+   *
+   * The mixed audio callback may then run concurrently for different
+   * recipients. nullptr (default) mixes serially on the calling thread.
+   */
+  void set_task_scheduler(TaskScheduler* scheduler);
+
   /**
    * @brief Add an audio source (participant)
    * @param participant_id Unique identifier
    * @param params Initial mixing parameters
+   * @param sample_rate Rate of the source's samples in Hz (0 = the mixer rate);
+   *        other rates are resampled to the mixer rate on push
    */
-  void add_source(const ParticipantId& participant_id, MixingParams params = {});
+  void add_source(const ParticipantId& participant_id, MixingParams params = {},
+                  int sample_rate = 0);
 
   /**
    * @brief Remove an audio source
@@ -122,7 +136,7 @@ class AudioMixer
   /**
    * @brief Push audio samples from a source
    * @param participant_id Source participant
-   * @param samples PCM samples (16-bit signed)
+   * @param samples PCM samples (16-bit signed) at the source's rate
    * @param timestamp RTP timestamp
    */
   void push_audio(const ParticipantId& participant_id, std::span<const int16_t> samples,
@@ -70,6 +70,7 @@ enum class ClusterEvent
   ROOM_CREATED,
   ROOM_MIGRATED,
   LEADER_CHANGED,
+  NODE_STATUS_CHANGED,  // details: "active" or "draining"
 };
 
 /**
@@ -168,6 +169,11 @@ class ClusterCoordinator
    */
   void update_load(float load_percent);
 
+  /**
+   * @brief Report this node as DRAINING (no new rooms) or back to ACTIVE
+   */
+  void set_draining(bool draining);
+
   /**
    * @brief Get node with lowest load
    */
@@ -15,6 +15,9 @@
 
 namespace rtc
 {
+
+class TaskScheduler;
+
 namespace server
 {
 
@@ -45,7 +48,9 @@ struct BridgeConfig
   int video_width = 1280;
   int video_height = 720;
   int video_fps = 30;
-  int max_participants = 50;  // MCU limit (CPU intensive)
+  int max_participants = 50;           // MCU limit (CPU intensive)
+  RoomId room_id;                      // Scheduling affinity key; set it per room
+  TaskScheduler* scheduler = nullptr;  // nullptr = TaskScheduler::shared()
 };
 
 /**
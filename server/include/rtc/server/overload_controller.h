@@ -0,0 +1,158 @@
+#pragma once
+
+/**
+ * @file overload_controller.h
+ * @brief Graceful media degradation when the node is overloaded
+ *
+ * Turns HealthMonitor signals into an ordered sequence of load-shedding
+ * policies instead of letting every stream degrade at once.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace rtc
+{
+
+struct SystemHealth;
+
+namespace server
+{
+
+class SubscriptionManager;
+class RoomManager;
+class ClusterCoordinator;
+
+/**
+ * @brief Overload policy levels, each including the ones before it
+ */
+enum class OverloadLevel
+{
+  NORMAL,
+  CAP_LAYERS,        // Cap subscriber simulcast layers
+  REDUCE_TEMPORAL,   // Forward fewer temporal layers
+  PAUSE_HIDDEN,      // Suspend video that is not on screen
+  DRAINING,          // Refuse joins, report DRAINING to the cluster
+};
+
+/**
+ * @brief Level name for logs and metrics
+ */
+const char* overload_level_name(OverloadLevel level);
+
+/**
+ * @brief Overload controller configuration
+ *
+ * Each signal is divided by its limit; the load score is the largest
+ * ratio, so 1.0 means some resource is at its limit.
+ */
+struct OverloadConfig
+{
+  float cpu_limit_percent = 85.0f;         // System-wide CPU
+  float thread_cpu_limit_percent = 90.0f;  // Busiest single thread
+  std::chrono::milliseconds loop_lag_limit{20};
+  size_t queue_depth_limit = 2000;  // Per queue depth source
+
+  // Hysteresis: step up one level after the score stays at or above
+  // escalate_score for escalate_after, down one level after it stays at
+  // or below recover_score for recover_after
+  float escalate_score = 1.0f;
+  float recover_score = 0.7f;
+  std::chrono::milliseconds escalate_after{2000};
+  std::chrono::milliseconds recover_after{10000};
+
+  OverloadLevel max_level = OverloadLevel::DRAINING;
+  int capped_spatial_layer = 1;   // At CAP_LAYERS and above
+  int capped_temporal_layer = 0;  // At REDUCE_TEMPORAL and above
+};
+
+/**
+ * @brief Overload controller statistics
+ */
+struct OverloadStats
+{
+  OverloadLevel level = OverloadLevel::NORMAL;
+  float load_score = 0.0f;
+  std::string limiting_signal;  // Signal with the largest ratio
+  uint64_t escalations = 0;
+  uint64_t recoveries = 0;
+};
+
+/**
+ * @brief Queue depth sampled on every evaluation (e.g. pacer queue)
+ */
+using QueueDepthSource = std::function<size_t()>;
+
+/**
+ * @brief Level change callback
+ */
+using OverloadLevelCallback =
+    std::function<void(OverloadLevel old_level, OverloadLevel new_level, const OverloadStats&)>;
+
+/**
+ * @brief Steps through degradation policies with hysteresis
+ *
+ * Levels change one step at a time, so a hot node first caps layers and
+ * only drains once cheaper policies have failed to bring the score down.
+ *
+ * Usage:
+ * @code
+ * OverloadController overload({}, subscriptions, rooms);
+ * overload.set_cluster(&cluster);
+ * // Once per HealthMonitor check interval
+ * overload.evaluate(health_monitor.get_health());
+ * @endcode
+ */
+class OverloadController
+{
+ public:
+  OverloadController(OverloadConfig config, SubscriptionManager& subscriptions,
+                     RoomManager& rooms);
+  ~OverloadController();
+
+  // Disable copy
+  OverloadController(const OverloadController&) = delete;
+  OverloadController& operator=(const OverloadController&) = delete;
+
+  /**
+   * @brief Report DRAINING to the cluster at the last level (nullptr to detach)
+   */
+  void set_cluster(ClusterCoordinator* cluster);
+
+  /**
+   * @brief Add a queue depth to the load signals
+   */
+  void add_queue_depth_source(const std::string& name, QueueDepthSource source);
+
+  /**
+   * @brief Set callback for level changes
+   */
+  void set_level_callback(OverloadLevelCallback callback);
+
+  /**
+   * @brief Score the latest health sample and step the policy level
+   * @return Level in effect after this evaluation
+   */
+  OverloadLevel evaluate(const SystemHealth& health,
+                         std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+  /**
+   * @brief Get current level
+   */
+  [[nodiscard]] OverloadLevel level() const;
+
+  /**
+   * @brief Get statistics
+   */
+  [[nodiscard]] OverloadStats stats() const;
+
+ private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace server
+}  // namespace rtc
@@ -175,12 +175,24 @@ class RoomManager
    */
   [[nodiscard]] std::vector<Room> get_all_rooms() const;
 
+  /**
+   * @brief Open or close admission of new participants node-wide
+   *
+   * Participants already in a room are unaffected.
+   */
+  void set_accepting_joins(bool accepting);
+
+  /**
+   * @brief Check if new participants are admitted
+   */
+  [[nodiscard]] bool is_accepting_joins() const;
+
   /**
    * @brief Add participant to room
    * @param room_id Room to join
    * @param participant Participant info
    * @param password Optional password
-   * @return True if joined successfully
+   * @return True if joined successfully (false while not accepting joins)
    */
   bool join_room(const RoomId& room_id, const Participant& participant,
                  const std::string& password = "");
@@ -196,6 +208,13 @@ class RoomManager
   void update_media_state(const RoomId& room_id, const ParticipantId& participant_id,
                           const MediaState& state);
 
+  /**
+   * @brief Record a participant's new transport address (e.g. after ICE restart)
+   * @return False if the participant is not in the room
+   */
+  bool update_participant_address(const RoomId& room_id, const ParticipantId& participant_id,
+                                  const SocketAddress& address);
+
   /**
    * @brief Get participants in a room
    */
@@ -9,6 +9,7 @@
  * without transcoding.
  */
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -22,6 +23,7 @@ namespace rtc
 
 struct SocketAddress;
 class UdpSocket;
+class MetricHistogram;
 
 namespace server
 {
@@ -44,8 +46,9 @@ struct RtpStreamInfo
   uint32_t ssrc = 0;
   uint8_t payload_type = 0;
   bool is_audio = false;
-  int simulcast_layer = -1;  // -1 if not simulcast, 0-2 for layers
-  std::string codec_name;    // "opus", "h264", "vp8"
+  int simulcast_layer = -1;    // -1 if not simulcast, 0-2 for layers
+  std::string codec_name;      // "opus", "h264", "vp8"
+  uint8_t audio_level_id = 0;  // Negotiated RFC 6464 extension ID, 0 if none
 };
 
 /**
@@ -58,6 +61,11 @@ struct ForwardingRule
   uint32_t rewritten_ssrc = 0;  // SSRC to use when forwarding
   int preferred_simulcast_layer = -1;
   bool is_active = true;
+
+  // Overload limits (SubscriptionManager state), applied to video only
+  int max_temporal_layer = -1;  // VP8/VP9 temporal layers to forward, -1 = all
+  bool is_suspended = false;
+  uint16_t sequence_offset = 0;  // Video packets withheld so far (temporal cap, suspension)
 };
 
 /**
@@ -76,6 +84,9 @@ struct ForwarderStats
 
 /**
  * @brief Callback when sending forwarded packet
+ *
+ * Also carries the RTCP keyframe requests (PLI) the forwarder sends to a
+ * publisher, addressed to the publisher and the address its media comes from.
  */
 using ForwardCallback =
     std::function<void(const ParticipantId& subscriber, std::span<const uint8_t> packet,
@@ -105,6 +116,16 @@ class RtpForwarder
    */
   void set_forward_callback(ForwardCallback callback);
 
+  /**
+   * @brief Record per-packet forwarding latency in milliseconds
+   *
+   * Measured from the packet's arrival (see on_rtp_packet) until it has been
+   * handed to the forward callback for every subscriber.
+   *
+   * @see MetricsExporter::forwarding_latency_histogram
+   */
+  void set_latency_histogram(MetricHistogram histogram);
+
   /**
    * @brief Register a publisher stream
    * @param publisher_id Publisher identifier
@@ -139,13 +160,46 @@ class RtpForwarder
   void set_simulcast_layer(const ParticipantId& publisher_id, const ParticipantId& subscriber_id,
                            int layer);
 
+  /**
+   * @brief Apply a subscription's overload state to forwarding
+   *
+   * Video packets above max_temporal_layer are withheld and later sequence
+   * numbers shifted down to close the gap, so receivers do not NACK them;
+   * streams whose codec carries no temporal layer ID are forwarded whole.
+   * A suspended subscription receives no video at all, with the same
+   * sequence shift. Audio is unaffected.
+   *
+   * Lifting a suspension or raising the temporal cap sends the publisher a
+   * PLI through the forward callback, so the subscriber can decode again
+   * without waiting for the next natural keyframe.
+   *
+   * @param max_temporal_layer Highest temporal layer to forward, -1 = all
+   */
+  void set_subscription_limits(const ParticipantId& publisher_id,
+                               const ParticipantId& subscriber_id, int max_temporal_layer,
+                               bool suspended);
+
+  /**
+   * @brief Point every rule of a subscriber at a new destination
+   *
+   * Used after an ICE restart: SSRC rewriting, layer selection and the
+   * subscription itself are kept, only the transport address changes.
+   *
+   * @return Number of rules updated
+   */
+  size_t update_subscriber_destination(const ParticipantId& subscriber_id,
+                                       const SocketAddress& destination);
+
   /**
    * @brief Process an incoming RTP packet from a publisher
    * @param ssrc Source SSRC
    * @param packet Raw RTP packet
    * @param source Source address
+   * @param arrival When the packet was read off the socket (RecvResult::received_at)
    */
-  void on_rtp_packet(uint32_t ssrc, std::span<const uint8_t> packet, const SocketAddress& source);
+  void on_rtp_packet(
+      uint32_t ssrc, std::span<const uint8_t> packet, const SocketAddress& source,
+      std::chrono::steady_clock::time_point arrival = std::chrono::steady_clock::now());
 
   /**
    * @brief Get current statistics
@@ -157,6 +211,18 @@ class RtpForwarder
    */
   [[nodiscard]] std::vector<ParticipantId> get_publishers() const;
 
+  /**
+   * @brief Publishers currently speaking, loudest first
+   *
+   * Ranked from the RFC 6464 audio level extension of their audio streams
+   * (RtpStreamInfo::audio_level_id), without decoding: a publisher counts
+   * while it sent a voice-flagged packet in the last 500 ms, ordered by its
+   * smoothed level over such packets.
+   *
+   * @param max_count Most publishers to return
+   */
+  [[nodiscard]] std::vector<ParticipantId> get_active_speakers(size_t max_count) const;
+
   /**
    * @brief Get subscribers for a publisher
    */
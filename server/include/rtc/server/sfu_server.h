@@ -11,9 +11,17 @@
 #include <functional>
 #include <memory>
 #include <string>
+#include <vector>
+
+#include "rtc/packet_tracer.h"
+#include "rtc/server/overload_controller.h"
 
 namespace rtc
 {
+
+struct SocketAddress;
+class MetricsExporter;
+
 namespace server
 {
 
@@ -27,9 +35,13 @@ struct SfuServerConfig
   uint16_t rtp_port_max = 20000;
   size_t max_rooms = 1000;
   size_t max_participants_per_room = 100;
-  size_t io_threads = 4;
+  size_t io_threads = 4;  // Each reads its own media port from the RTP range
   bool enable_prometheus_metrics = true;
   uint16_t metrics_port = 9090;
+  bool enable_overload_control = true;
+  OverloadConfig overload;
+  bool enable_packet_tracing = false;  // Stage latencies land in the Prometheus histograms
+  PacketTracerConfig packet_tracing;
 };
 
 /**
@@ -104,6 +116,46 @@ class SfuServer
    */
   class SubscriptionManager& subscription_manager();
 
+  /**
+   * @brief Get overload controller (e.g. to attach a ClusterCoordinator)
+   */
+  OverloadController& overload_controller();
+
+  /**
+   * @brief Get the Prometheus exporter, e.g. to pass in AudioStreamConfig::metrics
+   * @return nullptr unless enable_prometheus_metrics is set
+   */
+  MetricsExporter* metrics_exporter();
+
+  /**
+   * @brief Export the sampled packet spans in Chrome trace event format
+   *
+   * Empty unless enable_packet_tracing is set; spans are kept after stop().
+   */
+  [[nodiscard]] std::string packet_trace_json() const;
+
+  /**
+   * @brief Apply a subscriber's layout signalling
+   *
+   * Publishers not listed are off screen; under OverloadLevel::PAUSE_HIDDEN
+   * their video to this subscriber is suspended until they are shown again.
+   *
+   * @param visible_publishers Publishers the subscriber currently renders
+   */
+  void update_layout(const std::string& subscriber_id,
+                     const std::vector<std::string>& visible_publishers);
+
+  /**
+   * @brief Move a participant to a new transport address after an ICE restart
+   *
+   * Room membership, subscriptions and forwarding state stay in place, so
+   * media resumes without renegotiating streams or resetting layers.
+   *
+   * @return False if the participant is not in the room
+   */
+  bool migrate_participant(const std::string& room_id, const std::string& participant_id,
+                           const SocketAddress& address);
+
   /**
    * @brief Allocate an RTP port
    * @return Allocated port or 0 on failure
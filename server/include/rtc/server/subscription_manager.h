@@ -44,10 +44,25 @@ struct Subscription
   StreamId stream_id;
   int target_layer = -1;  // Auto-select if -1
   int current_layer = 0;
+  int temporal_layer = -1;  // Highest temporal layer to forward, -1 = all
   bool is_paused = false;
+  bool is_visible = true;     // Rendered on the subscriber's screen
+  bool is_suspended = false;  // Paused by SubscriptionLimits::pause_hidden
   uint64_t bytes_received = 0;
 };
 
+/**
+ * @brief Node-wide caps applied on top of per-subscription choices
+ *
+ * Used to shed load when the node is overloaded (see OverloadController).
+ */
+struct SubscriptionLimits
+{
+  int max_spatial_layer = -1;   // -1 = no cap
+  int max_temporal_layer = -1;  // -1 = no cap
+  bool pause_hidden = false;    // Suspend subscriptions that are not visible
+};
+
 /**
  * @brief Subscriber bandwidth info (from REMB)
  */
@@ -65,6 +80,12 @@ using LayerSwitchCallback =
     std::function<void(const ParticipantId& subscriber_id, const ParticipantId& publisher_id,
                        int old_layer, int new_layer)>;
 
+/**
+ * @brief Temporal layer or suspension change callback
+ */
+using SubscriptionStateCallback =
+    std::function<void(const ParticipantId& subscriber_id, const Subscription& subscription)>;
+
 /**
  * @brief Subscription manager for simulcast layer selection
  */
@@ -83,6 +104,14 @@ class SubscriptionManager
    */
   void set_layer_switch_callback(LayerSwitchCallback callback);
 
+  /**
+   * @brief Set callback for temporal layer and suspension changes
+   *
+   * Called under the manager's lock; forward the state to RtpForwarder,
+   * which is what enforces it.
+   */
+  void set_state_callback(SubscriptionStateCallback callback);
+
   /**
    * @brief Register available layers for a publisher stream
    */
@@ -113,6 +142,22 @@ class SubscriptionManager
   void set_target_layer(const ParticipantId& subscriber_id, const ParticipantId& publisher_id,
                         int layer);
 
+  /**
+   * @brief Mark whether the subscriber currently renders a publisher
+   */
+  void set_visible(const ParticipantId& subscriber_id, const ParticipantId& publisher_id,
+                   bool visible);
+
+  /**
+   * @brief Apply node-wide limits; takes effect on the next process()
+   */
+  void set_limits(const SubscriptionLimits& limits);
+
+  /**
+   * @brief Get node-wide limits
+   */
+  [[nodiscard]] SubscriptionLimits limits() const;
+
   /**
    * @brief Update subscriber bandwidth info (from REMB)
    */
@@ -120,7 +165,7 @@ class SubscriptionManager
 
   /**
    * @brief Process layer selections (call periodically)
-   * This automatically adjusts layers based on bandwidth
+   * This automatically adjusts layers based on bandwidth, capped by limits()
    */
   void process();
 
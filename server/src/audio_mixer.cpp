@@ -11,6 +11,9 @@
 #include <unordered_map>
 #include <vector>
 
+#include "rtc/audio/resampler.h"
+#include "rtc/task_scheduler.h"
+
 namespace rtc
 {
 namespace server
@@ -24,6 +27,19 @@ struct AudioSource
   uint32_t last_timestamp = 0;
   float audio_level_db = -96.0f;
   bool has_data = false;
+
+  // Sources at another rate: resampled output queues in `resampled` until a
+  // whole mixer frame is ready
+  std::unique_ptr<audio::Resampler> resampler;
+  std::vector<int16_t> resampled;
+  std::vector<int16_t> staging;
+};
+
+// Per-thread mixing buffers so recipients can be mixed in parallel
+struct MixScratch
+{
+  std::vector<int32_t> mix_buffer;  // 32-bit for mixing headroom
+  std::vector<int16_t> output_buffer;
 };
 
 struct AudioMixer::Impl
@@ -38,16 +54,89 @@ struct AudioMixer::Impl
   ParticipantId active_speaker;
   AudioMixerStats stats;
 
-  // Mixing buffers
-  std::vector<int32_t> mix_buffer;  // 32-bit for mixing headroom
-  std::vector<int16_t> output_buffer;
+  // Mixing buffers, one per scheduler worker plus one for the caller
+  TaskScheduler* scheduler = nullptr;
+  std::vector<MixScratch> scratch;
+  std::vector<const AudioSource*> recipients;
   int frame_size = 0;
 
   Impl(AudioSourceConfig cfg) : config(std::move(cfg))
   {
     frame_size = config.sample_rate * config.frame_duration_ms / 1000 * config.channels;
-    mix_buffer.resize(frame_size, 0);
-    output_buffer.resize(frame_size, 0);
+    resize_scratch(1);
+  }
+
+  void resize_scratch(size_t count)
+  {
+    scratch.resize(count);
+    for (auto& s : scratch)
+    {
+      s.mix_buffer.resize(frame_size, 0);
+      s.output_buffer.resize(frame_size, 0);
+    }
+  }
+
+  MixScratch& current_scratch()
+  {
+    if (!scheduler) return scratch[0];
+
+    size_t worker = scheduler->current_worker();
+    return worker == TaskScheduler::NO_AFFINITY ? scratch.back() : scratch[worker];
+  }
+
+  void mix_for(const AudioSource& recipient, MixScratch& buffers)
+  {
+    auto& mix_buffer = buffers.mix_buffer;
+    auto& output_buffer = buffers.output_buffer;
+
+    // Reset mix buffer
+    std::fill(mix_buffer.begin(), mix_buffer.end(), 0);
+
+    // Add all sources except recipient
+    for (const auto& [source_id, source] : sources)
+    {
+      if (&source == &recipient) continue;
+      if (!source.has_data) continue;
+      if (source.params.muted) continue;
+
+      // Mix mono or stereo
+      if (config.channels == 1)
+      {
+        for (size_t i = 0; i < source.buffer.size(); ++i)
+        {
+          mix_buffer[i] += static_cast<int32_t>(source.buffer[i] * source.params.volume);
+        }
+      }
+      else
+      {
+        // Stereo with pan
+        for (size_t i = 0; i < source.buffer.size(); i += 2)
+        {
+          int32_t left = 0, right = 0;
+          apply_volume_and_pan(left, right, source.params, source.buffer[i]);
+          mix_buffer[i] += left;
+          if (i + 1 < mix_buffer.size())
+          {
+            apply_volume_and_pan(left, right, source.params, source.buffer[i + 1]);
+            mix_buffer[i + 1] += right;
+          }
+        }
+      }
+    }
+
+    // Convert to 16-bit with saturation
+    for (size_t i = 0; i < mix_buffer.size(); ++i)
+    {
+      int32_t val = mix_buffer[i];
+      val = std::clamp(val, static_cast<int32_t>(-32768), static_cast<int32_t>(32767));
+      output_buffer[i] = static_cast<int16_t>(val);
+    }
+
+    // Send to recipient
+    if (mixed_callback)
+    {
+      mixed_callback(recipient.id, output_buffer, recipient.last_timestamp);
+    }
   }
 
   float calculate_level(const std::vector<int16_t>& samples)
@@ -131,7 +220,15 @@ void AudioMixer::set_active_speaker_callback(ActiveSpeakerCallback callback)
   impl_->speaker_callback = std::move(callback);
 }
 
-void AudioMixer::add_source(const ParticipantId& participant_id, MixingParams params)
+void AudioMixer::set_task_scheduler(TaskScheduler* scheduler)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->scheduler = scheduler;
+  impl_->resize_scratch(scheduler ? scheduler->worker_count() + 1 : 1);
+}
+
+void AudioMixer::add_source(const ParticipantId& participant_id, MixingParams params,
+                            int sample_rate)
 {
   std::lock_guard lock(impl_->mutex);
 
@@ -139,6 +236,11 @@ void AudioMixer::add_source(const ParticipantId& participant_id, MixingParams pa
   source.id = participant_id;
   source.params = params;
   source.buffer.resize(impl_->frame_size, 0);
+  if (sample_rate > 0 && sample_rate != impl_->config.sample_rate)
+  {
+    source.resampler = std::make_unique<audio::Resampler>(audio::ResamplerConfig{
+        sample_rate, impl_->config.sample_rate, impl_->config.channels});
+  }
 
   impl_->sources[participant_id] = std::move(source);
   impl_->stats.active_sources = impl_->sources.size();
@@ -177,9 +279,32 @@ void AudioMixer::push_audio(const ParticipantId& participant_id, std::span<const
 
   auto& source = it->second;
 
-  // Copy samples (truncate if needed)
-  size_t copy_size = std::min(samples.size(), source.buffer.size());
-  std::copy_n(samples.begin(), copy_size, source.buffer.begin());
+  if (source.resampler)
+  {
+    auto channels = static_cast<size_t>(impl_->config.channels);
+    source.staging.resize(source.resampler->max_output_frames(samples.size() / channels) *
+                          channels);
+    size_t frames = source.resampler->process(samples, source.staging);
+    source.resampled.insert(source.resampled.end(), source.staging.begin(),
+                            source.staging.begin() +
+                                static_cast<std::ptrdiff_t>(frames * channels));
+    if (source.resampled.size() < source.buffer.size()) return;
+
+    // A source running ahead of the mix loses its oldest frames
+    size_t excess = source.resampled.size() - source.buffer.size();
+    size_t start = excess - excess % source.buffer.size();
+    std::copy_n(source.resampled.begin() + static_cast<std::ptrdiff_t>(start),
+                source.buffer.size(), source.buffer.begin());
+    source.resampled.erase(source.resampled.begin(),
+                           source.resampled.begin() +
+                               static_cast<std::ptrdiff_t>(start + source.buffer.size()));
+  }
+  else
+  {
+    // Copy samples (truncate if needed)
+    size_t copy_size = std::min(samples.size(), source.buffer.size());
+    std::copy_n(samples.begin(), copy_size, source.buffer.begin());
+  }
 
   // Calculate audio level
   source.audio_level_db = impl_->calculate_level(source.buffer);
@@ -196,62 +321,28 @@ void AudioMixer::process()
   impl_->update_active_speaker();
 
   // For each participant, create a mix excluding their own audio
-  for (const auto& [recipient_id, _] : impl_->sources)
+  impl_->recipients.clear();
+  for (const auto& [_, source] : impl_->sources)
   {
-    // Reset mix buffer
-    std::fill(impl_->mix_buffer.begin(), impl_->mix_buffer.end(), 0);
-
-    // Add all sources except recipient
-    for (const auto& [source_id, source] : impl_->sources)
-    {
-      if (source_id == recipient_id) continue;
-      if (!source.has_data) continue;
-      if (source.params.muted) continue;
+    impl_->recipients.push_back(&source);
+  }
 
-      // Mix mono or stereo
-      if (impl_->config.channels == 1)
-      {
-        for (size_t i = 0; i < source.buffer.size(); ++i)
-        {
-          impl_->mix_buffer[i] += static_cast<int32_t>(source.buffer[i] * source.params.volume);
-        }
-      }
-      else
-      {
-        // Stereo with pan
-        for (size_t i = 0; i < source.buffer.size(); i += 2)
-        {
-          int32_t left = 0, right = 0;
-          impl_->apply_volume_and_pan(left, right, source.params, source.buffer[i]);
-          impl_->mix_buffer[i] += left;
-          if (i + 1 < impl_->mix_buffer.size())
+  if (impl_->scheduler)
+  {
+    impl_->scheduler->parallel_for(
+        0, impl_->recipients.size(), 1, [this](size_t begin, size_t end) {
+          auto& buffers = impl_->current_scratch();
+          for (size_t i = begin; i < end; ++i)
           {
-            impl_->apply_volume_and_pan(left, right, source.params, source.buffer[i + 1]);
-            impl_->mix_buffer[i + 1] += right;
+            impl_->mix_for(*impl_->recipients[i], buffers);
           }
-        }
-      }
-    }
-
-    // Convert to 16-bit with saturation
-    for (size_t i = 0; i < impl_->mix_buffer.size(); ++i)
-    {
-      int32_t val = impl_->mix_buffer[i];
-      val = std::clamp(val, static_cast<int32_t>(-32768), static_cast<int32_t>(32767));
-      impl_->output_buffer[i] = static_cast<int16_t>(val);
-    }
-
-    // Send to recipient
-    if (impl_->mixed_callback)
+        });
+  }
+  else
+  {
+    for (const AudioSource* recipient : impl_->recipients)
     {
-      uint32_t timestamp = 0;
-      auto it = impl_->sources.find(recipient_id);
-      if (it != impl_->sources.end())
-      {
-        timestamp = it->second.last_timestamp;
-      }
-
-      impl_->mixed_callback(recipient_id, impl_->output_buffer, timestamp);
+      impl_->mix_for(*recipient, impl_->scratch[0]);
     }
   }
 
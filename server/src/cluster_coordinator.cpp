@@ -9,8 +9,10 @@
 #include <atomic>
 #include <mutex>
 #include <random>
-#include <thread>
 #include <unordered_map>
+#include <utility>
+
+#include "rtc/timer_wheel.h"
 
 namespace rtc
 {
@@ -28,7 +30,7 @@ struct ClusterCoordinator::Impl
 
   NodeId leader_id;
   std::atomic<bool> running{false};
-  std::thread heartbeat_thread;
+  TimerId heartbeat_timer = 0;  // Periodic heartbeat() on the shared wheel
   ClusterNode self_node;
 
   Impl(ClusterConfig cfg) : config(std::move(cfg))
@@ -70,48 +72,43 @@ struct ClusterCoordinator::Impl
     return active_nodes.front();
   }
 
-  void heartbeat_loop()
+  void heartbeat()
   {
-    while (running.load())
+    auto now = std::chrono::steady_clock::now();
+
     {
-      auto now = std::chrono::steady_clock::now();
+      std::lock_guard lock(mutex);
 
-      {
-        std::lock_guard lock(mutex);
+      // Update self
+      self_node.last_heartbeat = now;
 
-        // Update self
-        self_node.last_heartbeat = now;
+      // Check for dead nodes
+      for (auto it = nodes.begin(); it != nodes.end();)
+      {
+        auto age =
+            std::chrono::duration_cast<std::chrono::seconds>(now - it->second.last_heartbeat);
 
-        // Check for dead nodes
-        for (auto it = nodes.begin(); it != nodes.end();)
+        if (age > config.node_timeout)
         {
-          auto age =
-              std::chrono::duration_cast<std::chrono::seconds>(now - it->second.last_heartbeat);
-
-          if (age > config.node_timeout)
-          {
-            emit_event(ClusterEvent::NODE_FAILED, it->first);
-
-            // Re-elect leader if needed
-            if (it->first == leader_id)
-            {
-              leader_id = elect_leader();
-              emit_event(ClusterEvent::LEADER_CHANGED, leader_id);
-            }
+          emit_event(ClusterEvent::NODE_FAILED, it->first);
 
-            it = nodes.erase(it);
-          }
-          else
+          // Re-elect leader if needed
+          if (it->first == leader_id)
           {
-            ++it;
+            leader_id = elect_leader();
+            emit_event(ClusterEvent::LEADER_CHANGED, leader_id);
           }
+
+          it = nodes.erase(it);
+        }
+        else
+        {
+          ++it;
         }
       }
-
-      // TODO: Send heartbeat to other nodes
-
-      std::this_thread::sleep_for(config.heartbeat_interval);
     }
+
+    // TODO: Send heartbeat to other nodes
   }
 };
 
@@ -139,7 +136,9 @@ bool ClusterCoordinator::join()
   }
 
   impl_->running.store(true);
-  impl_->heartbeat_thread = std::thread([this]() { impl_->heartbeat_loop(); });
+  impl_->heartbeat_timer = TimerWheel::shared().schedule_periodic(
+      std::chrono::microseconds(0), impl_->config.heartbeat_interval,
+      [this]() { impl_->heartbeat(); });
 
   impl_->emit_event(ClusterEvent::NODE_JOINED, impl_->config.node_id);
 
@@ -158,10 +157,7 @@ void ClusterCoordinator::leave()
   impl_->emit_event(ClusterEvent::NODE_LEFT, impl_->config.node_id);
 
   impl_->running.store(false);
-  if (impl_->heartbeat_thread.joinable())
-  {
-    impl_->heartbeat_thread.join();
-  }
+  TimerWheel::shared().cancel(std::exchange(impl_->heartbeat_timer, 0));
 
   {
     std::lock_guard lock(impl_->mutex);
@@ -248,6 +244,28 @@ void ClusterCoordinator::update_load(float load_percent)
   impl_->nodes[impl_->config.node_id].load_percent = load_percent;
 }
 
+void ClusterCoordinator::set_draining(bool draining)
+{
+  std::lock_guard lock(impl_->mutex);
+
+  NodeStatus current = impl_->self_node.status;
+  if (current != NodeStatus::ACTIVE && current != NodeStatus::DRAINING)
+  {
+    return;  // Not joined, or leaving
+  }
+
+  NodeStatus status = draining ? NodeStatus::DRAINING : NodeStatus::ACTIVE;
+  if (status == current)
+  {
+    return;
+  }
+
+  impl_->self_node.status = status;
+  impl_->nodes[impl_->config.node_id].status = status;
+  impl_->emit_event(ClusterEvent::NODE_STATUS_CHANGED, impl_->config.node_id,
+                    draining ? "draining" : "active");
+}
+
 NodeId ClusterCoordinator::get_least_loaded_node() const
 {
   std::lock_guard lock(impl_->mutex);
@@ -6,12 +6,13 @@
 #include "rtc/server/conference_bridge.h"
 
 #include <atomic>
+#include <chrono>
 #include <mutex>
-#include <thread>
 #include <unordered_set>
 
 #include "rtc/server/audio_mixer.h"
 #include "rtc/server/video_compositor.h"
+#include "rtc/task_scheduler.h"
 
 
 namespace rtc
@@ -31,11 +32,14 @@ struct ConferenceBridge::Impl
   BridgeOutputCallback output_callback;
 
   std::atomic<bool> running{false};
-  std::thread processing_thread;
+  TaskScheduler* scheduler = nullptr;
+  PeriodicTaskId tick_id = 0;
   BridgeStats stats;
 
   Impl(BridgeConfig cfg) : config(std::move(cfg))
   {
+    scheduler = config.scheduler ? config.scheduler : &TaskScheduler::shared();
+
     audio_mixer = std::make_unique<AudioMixer>(AudioSourceConfig{
         .sample_rate = config.audio_sample_rate,
         .channels = config.audio_channels,
@@ -50,33 +54,30 @@ struct ConferenceBridge::Impl
           .output_fps = config.video_fps,
       });
     }
+
+    audio_mixer->set_task_scheduler(scheduler);
   }
 
-  void processing_loop()
+  // Mixer and compositor guard their own state; running them side by side
+  // keeps video compositing from delaying the audio mix.
+  void tick()
   {
-    auto frame_duration = std::chrono::milliseconds(1000 / config.video_fps);
-
-    while (running.load())
+    if (!video_compositor)
     {
-      auto start = std::chrono::steady_clock::now();
+      audio_mixer->process();
+      return;
+    }
 
+    scheduler->parallel_for(0, 2, 1, [this](size_t begin, size_t /*end*/) {
+      if (begin == 0)
       {
-        std::lock_guard lock(mutex);
         audio_mixer->process();
-
-        if (video_compositor)
-        {
-          video_compositor->process();
-        }
       }
-
-      auto elapsed = std::chrono::steady_clock::now() - start;
-      auto sleep_time = frame_duration - elapsed;
-      if (sleep_time > std::chrono::milliseconds(0))
+      else
       {
-        std::this_thread::sleep_for(sleep_time);
+        video_compositor->process();
       }
-    }
+    });
   }
 };
 
@@ -95,7 +96,13 @@ bool ConferenceBridge::start()
   if (impl_->running.load()) return false;
 
   impl_->running.store(true);
-  impl_->processing_thread = std::thread([this]() { impl_->processing_loop(); });
+  // Bridges without a room are spread round-robin rather than all hashed to one worker
+  size_t affinity = impl_->config.room_id.empty()
+                        ? TaskScheduler::NO_AFFINITY
+                        : impl_->scheduler->affinity_hint(impl_->config.room_id);
+  impl_->tick_id = impl_->scheduler->schedule_periodic(
+      std::chrono::milliseconds(1000 / impl_->config.video_fps), [this]() { impl_->tick(); },
+      affinity);
 
   return true;
 }
@@ -105,10 +112,8 @@ void ConferenceBridge::stop()
   if (!impl_->running.load()) return;
 
   impl_->running.store(false);
-  if (impl_->processing_thread.joinable())
-  {
-    impl_->processing_thread.join();
-  }
+  impl_->scheduler->cancel_periodic(impl_->tick_id);
+  impl_->tick_id = 0;
 }
 
 bool ConferenceBridge::is_running() const
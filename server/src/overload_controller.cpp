@@ -0,0 +1,249 @@
+/**
+ * @file overload_controller.cpp
+ * @brief Overload controller implementation
+ */
+
+#include "rtc/server/overload_controller.h"
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "rtc/flight_recorder.h"
+#include "rtc/health_monitor.h"
+#include "rtc/server/cluster_coordinator.h"
+#include "rtc/server/room_manager.h"
+#include "rtc/server/subscription_manager.h"
+
+namespace rtc
+{
+namespace server
+{
+
+const char* overload_level_name(OverloadLevel level)
+{
+  switch (level)
+  {
+    case OverloadLevel::NORMAL:
+      return "normal";
+    case OverloadLevel::CAP_LAYERS:
+      return "cap_layers";
+    case OverloadLevel::REDUCE_TEMPORAL:
+      return "reduce_temporal";
+    case OverloadLevel::PAUSE_HIDDEN:
+      return "pause_hidden";
+    case OverloadLevel::DRAINING:
+      return "draining";
+  }
+  return "unknown";
+}
+
+struct OverloadController::Impl
+{
+  OverloadConfig config;
+  SubscriptionManager& subscriptions;
+  RoomManager& rooms;
+
+  mutable std::mutex mutex;
+  ClusterCoordinator* cluster = nullptr;
+  std::vector<std::pair<std::string, QueueDepthSource>> queue_sources;
+  OverloadLevelCallback level_callback;
+
+  OverloadStats stats;
+  std::optional<std::chrono::steady_clock::time_point> hot_since;
+  std::optional<std::chrono::steady_clock::time_point> cool_since;
+
+  Impl(OverloadConfig cfg, SubscriptionManager& subs, RoomManager& room_manager)
+      : config(std::move(cfg)), subscriptions(subs), rooms(room_manager)
+  {
+  }
+
+  void score(const SystemHealth& health)
+  {
+    float best = 0.0f;
+    std::string signal = "none";
+
+    auto consider = [&](float ratio, std::string name)
+    {
+      if (ratio > best)
+      {
+        best = ratio;
+        signal = std::move(name);
+      }
+    };
+
+    if (config.cpu_limit_percent > 0.0f)
+    {
+      consider(health.cpu_usage_percent / config.cpu_limit_percent, "cpu");
+    }
+
+    for (const auto& thread : health.threads)
+    {
+      if (config.thread_cpu_limit_percent > 0.0f)
+      {
+        consider(thread.cpu_percent / config.thread_cpu_limit_percent, "thread:" + thread.name);
+      }
+      if (config.loop_lag_limit.count() > 0)
+      {
+        consider(std::chrono::duration<float>(thread.loop_lag) /
+                     std::chrono::duration<float>(config.loop_lag_limit),
+                 "loop_lag:" + thread.name);
+      }
+    }
+
+    if (config.queue_depth_limit > 0)
+    {
+      for (const auto& [name, source] : queue_sources)
+      {
+        consider(static_cast<float>(source()) / static_cast<float>(config.queue_depth_limit),
+                 "queue:" + name);
+      }
+    }
+
+    stats.load_score = best;
+    stats.limiting_signal = std::move(signal);
+  }
+
+  void apply(OverloadLevel level)
+  {
+    SubscriptionLimits limits;
+    if (level >= OverloadLevel::CAP_LAYERS)
+    {
+      limits.max_spatial_layer = config.capped_spatial_layer;
+    }
+    if (level >= OverloadLevel::REDUCE_TEMPORAL)
+    {
+      limits.max_temporal_layer = config.capped_temporal_layer;
+    }
+    if (level >= OverloadLevel::PAUSE_HIDDEN)
+    {
+      limits.pause_hidden = true;
+    }
+    subscriptions.set_limits(limits);
+
+    bool draining = level >= OverloadLevel::DRAINING;
+    rooms.set_accepting_joins(!draining);
+    if (cluster)
+    {
+      cluster->set_draining(draining);
+    }
+  }
+};
+
+OverloadController::OverloadController(OverloadConfig config, SubscriptionManager& subscriptions,
+                                       RoomManager& rooms)
+    : impl_(std::make_unique<Impl>(std::move(config), subscriptions, rooms))
+{
+}
+
+OverloadController::~OverloadController() = default;
+
+void OverloadController::set_cluster(ClusterCoordinator* cluster)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->cluster = cluster;
+  if (cluster && impl_->stats.level >= OverloadLevel::DRAINING)
+  {
+    cluster->set_draining(true);
+  }
+}
+
+void OverloadController::add_queue_depth_source(const std::string& name, QueueDepthSource source)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->queue_sources.emplace_back(name, std::move(source));
+}
+
+void OverloadController::set_level_callback(OverloadLevelCallback callback)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->level_callback = std::move(callback);
+}
+
+OverloadLevel OverloadController::evaluate(const SystemHealth& health,
+                                           std::chrono::steady_clock::time_point now)
+{
+  OverloadLevelCallback callback;
+  OverloadStats snapshot;
+  OverloadLevel old_level;
+
+  {
+    std::lock_guard lock(impl_->mutex);
+    const auto& config = impl_->config;
+
+    impl_->score(health);
+    old_level = impl_->stats.level;
+    OverloadLevel level = old_level;
+
+    if (impl_->stats.load_score >= config.escalate_score)
+    {
+      impl_->cool_since.reset();
+      if (!impl_->hot_since) impl_->hot_since = now;
+
+      if (now - *impl_->hot_since >= config.escalate_after && level < config.max_level)
+      {
+        level = static_cast<OverloadLevel>(static_cast<int>(level) + 1);
+        impl_->hot_since = now;  // Next step needs another full window
+        impl_->stats.escalations++;
+      }
+    }
+    else if (impl_->stats.load_score <= config.recover_score)
+    {
+      impl_->hot_since.reset();
+      if (!impl_->cool_since) impl_->cool_since = now;
+
+      if (now - *impl_->cool_since >= config.recover_after && level > OverloadLevel::NORMAL)
+      {
+        level = static_cast<OverloadLevel>(static_cast<int>(level) - 1);
+        impl_->cool_since = now;
+        impl_->stats.recoveries++;
+      }
+    }
+    else
+    {
+      // Between the thresholds: hold the current level
+      impl_->hot_since.reset();
+      impl_->cool_since.reset();
+    }
+
+    if (level == old_level)
+    {
+      return level;
+    }
+
+    impl_->stats.level = level;
+    impl_->apply(level);
+    callback = impl_->level_callback;
+    snapshot = impl_->stats;
+  }
+
+  FlightRecorder::record(FlightEventType::STATE_CHANGE, FlightSource::OVERLOAD, 0,
+                         static_cast<uint64_t>(old_level), static_cast<uint64_t>(snapshot.level));
+  if (snapshot.level == OverloadLevel::DRAINING)
+  {
+    FlightRecorder::shared().trigger("overload_draining");
+  }
+
+  if (callback)
+  {
+    callback(old_level, snapshot.level, snapshot);
+  }
+  return snapshot.level;
+}
+
+OverloadLevel OverloadController::level() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->stats.level;
+}
+
+OverloadStats OverloadController::stats() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->stats;
+}
+
+}  // namespace server
+}  // namespace rtc
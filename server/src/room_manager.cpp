@@ -6,6 +6,7 @@
 #include "rtc/server/room_manager.h"
 
 #include <algorithm>
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 
@@ -19,6 +20,7 @@ struct RoomManager::Impl
   mutable std::mutex mutex;
   std::unordered_map<RoomId, Room> rooms;
   RoomEventCallback event_callback;
+  std::atomic<bool> accepting_joins{true};
 
   void emit_event(const RoomId& room_id, RoomEvent event, const ParticipantId& participant_id = "")
   {
@@ -107,9 +109,24 @@ std::vector<Room> RoomManager::get_all_rooms() const
   return result;
 }
 
+void RoomManager::set_accepting_joins(bool accepting)
+{
+  impl_->accepting_joins.store(accepting);
+}
+
+bool RoomManager::is_accepting_joins() const
+{
+  return impl_->accepting_joins.load();
+}
+
 bool RoomManager::join_room(const RoomId& room_id, const Participant& participant,
                             const std::string& password)
 {
+  if (!impl_->accepting_joins.load())
+  {
+    return false;  // Node is shedding load
+  }
+
   std::lock_guard lock(impl_->mutex);
 
   auto it = impl_->rooms.find(room_id);
@@ -196,6 +213,27 @@ void RoomManager::update_media_state(const RoomId& room_id, const ParticipantId&
   }
 }
 
+bool RoomManager::update_participant_address(const RoomId& room_id,
+                                             const ParticipantId& participant_id,
+                                             const SocketAddress& address)
+{
+  std::lock_guard lock(impl_->mutex);
+
+  auto it = impl_->rooms.find(room_id);
+  if (it == impl_->rooms.end()) return false;
+
+  for (auto& p : it->second.participants)
+  {
+    if (p.id == participant_id)
+    {
+      p.address = address;
+      p.is_connected = true;
+      return true;
+    }
+  }
+  return false;
+}
+
 std::vector<Participant> RoomManager::get_participants(const RoomId& room_id) const
 {
   std::lock_guard lock(impl_->mutex);
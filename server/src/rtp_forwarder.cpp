@@ -6,10 +6,17 @@
 #include "rtc/server/rtp_forwarder.h"
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <mutex>
 #include <unordered_map>
 #include <vector>
 
+#include "rtc/flight_recorder.h"
+#include "rtc/metrics_exporter.h"
+#include "rtc/packet_tracer.h"
+#include "rtc/rtcp_packet.h"
+#include "rtc/rtp_packet.h"
 #include "rtc/udp_socket.h"
 
 
@@ -18,12 +25,76 @@ namespace rtc
 namespace server
 {
 
+namespace
+{
+
+constexpr auto SPEAKER_TIMEOUT = std::chrono::milliseconds(500);
+constexpr float SPEAKER_LEVEL_SMOOTHING = 0.3f;  // Weight of each new voiced packet
+
+// Skip a 7- or 15-bit picture ID starting at offset
+size_t skip_picture_id(std::span<const uint8_t> payload, size_t offset)
+{
+  return offset < payload.size() && (payload[offset] & 0x80) ? offset + 2 : offset + 1;
+}
+
+// TID from the VP8 (RFC 7741) or VP9 payload descriptor, -1 if absent
+int temporal_layer_id(const std::string& codec, std::span<const uint8_t> payload)
+{
+  if (codec == "vp8" && payload.size() >= 2 && (payload[0] & 0x80))
+  {
+    uint8_t flags = payload[1];  // I L T K
+    size_t offset = 2;
+    if (flags & 0x80) offset = skip_picture_id(payload, offset);
+    if (flags & 0x40) offset++;  // TL0PICIDX
+    if ((flags & 0x20) && offset < payload.size())
+    {
+      return payload[offset] >> 6;
+    }
+  }
+  else if (codec == "vp9" && !payload.empty())
+  {
+    uint8_t flags = payload[0];  // I P L F B E V Z
+    size_t offset = 1;
+    if (flags & 0x80) offset = skip_picture_id(payload, offset);
+    if ((flags & 0x20) && offset < payload.size())
+    {
+      return payload[offset] >> 5;
+    }
+  }
+  return -1;
+}
+
+// RFC 4585 PLI for media_ssrc. The SFU sends no media of its own, so the
+// sender SSRC is left 0.
+std::array<uint8_t, 12> pli_packet(uint32_t media_ssrc)
+{
+  return {static_cast<uint8_t>(0x80 | static_cast<uint8_t>(RtcpFeedbackType::PLI)),
+          static_cast<uint8_t>(RtcpType::PSFB),
+          0,
+          2,  // Length in 32-bit words minus one
+          0,
+          0,
+          0,
+          0,
+          static_cast<uint8_t>(media_ssrc >> 24),
+          static_cast<uint8_t>(media_ssrc >> 16),
+          static_cast<uint8_t>(media_ssrc >> 8),
+          static_cast<uint8_t>(media_ssrc)};
+}
+
+}  // namespace
+
 struct PublisherStream
 {
   ParticipantId publisher_id;
   StreamId stream_id;
   RtpStreamInfo info;
   std::vector<ForwardingRule> subscribers;
+  SocketAddress source;  // Where the publisher's packets last came from
+
+  // From the RFC 6464 extension of voiced packets
+  float speech_level_dbov = -127.0f;
+  std::chrono::steady_clock::time_point last_voice;
 };
 
 struct RtpForwarder::Impl
@@ -38,6 +109,7 @@ struct RtpForwarder::Impl
   std::unordered_map<ParticipantId, std::vector<uint32_t>> publisher_ssrcs;
 
   ForwarderStats stats;
+  MetricHistogram latency_histogram;
 
   // Scratch buffer for SSRC rewriting
   std::vector<uint8_t> forward_buffer;
@@ -47,12 +119,23 @@ struct RtpForwarder::Impl
     forward_buffer.reserve(1500);  // MTU size
   }
 
-  void forward_packet(const PublisherStream& stream, std::span<const uint8_t> packet)
+  void forward_packet(PublisherStream& stream, std::span<const uint8_t> packet)
   {
-    for (const auto& rule : stream.subscribers)
+    bool is_video = !stream.info.is_audio;
+    int temporal_layer =
+        is_video ? temporal_layer_id(stream.info.codec_name, rtp_payload_view(packet)) : -1;
+
+    for (auto& rule : stream.subscribers)
     {
       if (!rule.is_active) continue;
 
+      if ((is_video && rule.is_suspended) ||
+          (rule.max_temporal_layer >= 0 && temporal_layer > rule.max_temporal_layer))
+      {
+        rule.sequence_offset++;
+        continue;
+      }
+
       // Check simulcast layer preference
       if (rule.preferred_simulcast_layer >= 0 && stream.info.simulcast_layer >= 0 &&
           stream.info.simulcast_layer != rule.preferred_simulcast_layer)
@@ -62,17 +145,21 @@ struct RtpForwarder::Impl
 
       if (forward_callback)
       {
-        if (rule.rewritten_ssrc != 0 && rule.rewritten_ssrc != stream.info.ssrc)
+        bool rewrite_ssrc = rule.rewritten_ssrc != 0 && rule.rewritten_ssrc != stream.info.ssrc;
+        if ((rewrite_ssrc || rule.sequence_offset != 0) && packet.size() >= 12)
         {
-          // Rewrite SSRC
           forward_buffer.assign(packet.begin(), packet.end());
-          if (forward_buffer.size() >= 12)
+          if (rewrite_ssrc)
           {
             forward_buffer[8] = (rule.rewritten_ssrc >> 24) & 0xFF;
             forward_buffer[9] = (rule.rewritten_ssrc >> 16) & 0xFF;
             forward_buffer[10] = (rule.rewritten_ssrc >> 8) & 0xFF;
             forward_buffer[11] = rule.rewritten_ssrc & 0xFF;
           }
+          auto sequence = static_cast<uint16_t>(((forward_buffer[2] << 8) | forward_buffer[3]) -
+                                                rule.sequence_offset);
+          forward_buffer[2] = static_cast<uint8_t>(sequence >> 8);
+          forward_buffer[3] = static_cast<uint8_t>(sequence & 0xFF);
           forward_callback(rule.subscriber_id, forward_buffer, rule.destination);
         }
         else
@@ -86,6 +173,16 @@ struct RtpForwarder::Impl
       }
     }
   }
+
+  // Ask the publisher for a keyframe on this stream (PLI)
+  void request_keyframe(const PublisherStream& stream)
+  {
+    if (!forward_callback || stream.source.port == 0) return;
+
+    auto pli = pli_packet(stream.info.ssrc);
+    FlightRecorder::record(FlightEventType::PLI, FlightSource::FORWARDER, stream.info.ssrc);
+    forward_callback(stream.publisher_id, pli, stream.source);
+  }
 };
 
 RtpForwarder::RtpForwarder() : impl_(std::make_unique<Impl>()) {}
@@ -98,6 +195,12 @@ void RtpForwarder::set_forward_callback(ForwardCallback callback)
   impl_->forward_callback = std::move(callback);
 }
 
+void RtpForwarder::set_latency_histogram(MetricHistogram histogram)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->latency_histogram = histogram;
+}
+
 void RtpForwarder::add_publisher(const ParticipantId& publisher_id, const StreamId& stream_id,
                                  const RtpStreamInfo& info)
 {
@@ -205,8 +308,11 @@ void RtpForwarder::set_simulcast_layer(const ParticipantId& publisher_id,
     {
       for (auto& rule : stream_it->second.subscribers)
       {
-        if (rule.subscriber_id == subscriber_id)
+        if (rule.subscriber_id == subscriber_id && rule.preferred_simulcast_layer != layer)
         {
+          FlightRecorder::record(FlightEventType::LAYER_SWITCH, FlightSource::FORWARDER, ssrc,
+                                 static_cast<uint64_t>(rule.preferred_simulcast_layer),
+                                 static_cast<uint64_t>(layer));
           rule.preferred_simulcast_layer = layer;
         }
       }
@@ -214,9 +320,68 @@ void RtpForwarder::set_simulcast_layer(const ParticipantId& publisher_id,
   }
 }
 
+void RtpForwarder::set_subscription_limits(const ParticipantId& publisher_id,
+                                           const ParticipantId& subscriber_id,
+                                           int max_temporal_layer, bool suspended)
+{
+  std::lock_guard lock(impl_->mutex);
+
+  auto pub_it = impl_->publisher_ssrcs.find(publisher_id);
+  if (pub_it == impl_->publisher_ssrcs.end()) return;
+
+  for (uint32_t ssrc : pub_it->second)
+  {
+    auto stream_it = impl_->ssrc_to_stream.find(ssrc);
+    if (stream_it != impl_->ssrc_to_stream.end())
+    {
+      auto& stream = stream_it->second;
+      bool keyframe_needed = false;
+      for (auto& rule : stream.subscribers)
+      {
+        if (rule.subscriber_id == subscriber_id)
+        {
+          bool resumed = rule.is_suspended && !suspended;
+          bool raised = rule.max_temporal_layer >= 0 &&
+                        (max_temporal_layer < 0 || max_temporal_layer > rule.max_temporal_layer);
+          keyframe_needed |= rule.is_active && (resumed || raised);
+          rule.max_temporal_layer = max_temporal_layer;
+          rule.is_suspended = suspended;
+        }
+      }
+      if (keyframe_needed && !stream.info.is_audio)
+      {
+        impl_->request_keyframe(stream);
+      }
+    }
+  }
+}
+
+size_t RtpForwarder::update_subscriber_destination(const ParticipantId& subscriber_id,
+                                                   const SocketAddress& destination)
+{
+  std::lock_guard lock(impl_->mutex);
+
+  size_t updated = 0;
+  for (auto& [ssrc, stream] : impl_->ssrc_to_stream)
+  {
+    for (auto& rule : stream.subscribers)
+    {
+      if (rule.subscriber_id == subscriber_id)
+      {
+        rule.destination = destination;
+        updated++;
+      }
+    }
+  }
+  return updated;
+}
+
 void RtpForwarder::on_rtp_packet(uint32_t ssrc, std::span<const uint8_t> packet,
-                                 const SocketAddress& /*source*/)
+                                 const SocketAddress& source,
+                                 std::chrono::steady_clock::time_point arrival)
 {
+  PacketTracer::trace(TraceStage::FORWARD, packet);
+
   std::lock_guard lock(impl_->mutex);
 
   impl_->stats.packets_received++;
@@ -225,11 +390,43 @@ void RtpForwarder::on_rtp_packet(uint32_t ssrc, std::span<const uint8_t> packet,
   auto it = impl_->ssrc_to_stream.find(ssrc);
   if (it != impl_->ssrc_to_stream.end())
   {
-    impl_->forward_packet(it->second, packet);
+    auto& stream = it->second;
+    if (!(stream.source == source))
+    {
+      stream.source = source;
+    }
+    if (stream.info.is_audio && stream.info.audio_level_id != 0)
+    {
+      auto element = find_rtp_extension_element(packet, stream.info.audio_level_id);
+      if (!element.empty())
+      {
+        auto level = RtpAudioLevel::decode(element[0]);
+        if (level.voice_activity)
+        {
+          auto now = std::chrono::steady_clock::now();
+          float dbov = -static_cast<float>(level.level);
+          bool fresh = now - stream.last_voice > SPEAKER_TIMEOUT;
+          stream.speech_level_dbov = fresh ? dbov
+                                           : stream.speech_level_dbov +
+                                                 SPEAKER_LEVEL_SMOOTHING *
+                                                     (dbov - stream.speech_level_dbov);
+          stream.last_voice = now;
+        }
+      }
+    }
+    impl_->forward_packet(stream, packet);
   }
   else
   {
     impl_->stats.packets_dropped++;
+    FlightRecorder::record(FlightEventType::PACKET_DROP, FlightSource::FORWARDER, ssrc,
+                           static_cast<uint64_t>(FlightDropReason::UNKNOWN_SSRC));
+  }
+
+  if (impl_->latency_histogram.valid())
+  {
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - arrival;
+    impl_->latency_histogram.observe(elapsed.count());
   }
 }
 
@@ -250,6 +447,40 @@ std::vector<ParticipantId> RtpForwarder::get_publishers() const
   return result;
 }
 
+std::vector<ParticipantId> RtpForwarder::get_active_speakers(size_t max_count) const
+{
+  std::lock_guard lock(impl_->mutex);
+  auto now = std::chrono::steady_clock::now();
+
+  // Loudest voiced audio stream per publisher
+  std::vector<std::pair<float, ParticipantId>> speakers;
+  for (const auto& [_, stream] : impl_->ssrc_to_stream)
+  {
+    if (!stream.info.is_audio || now - stream.last_voice > SPEAKER_TIMEOUT) continue;
+
+    auto it = std::find_if(speakers.begin(), speakers.end(),
+                           [&](const auto& s) { return s.second == stream.publisher_id; });
+    if (it == speakers.end())
+    {
+      speakers.emplace_back(stream.speech_level_dbov, stream.publisher_id);
+    }
+    else
+    {
+      it->first = std::max(it->first, stream.speech_level_dbov);
+    }
+  }
+
+  std::sort(speakers.begin(), speakers.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+
+  std::vector<ParticipantId> result;
+  for (size_t i = 0; i < speakers.size() && i < max_count; ++i)
+  {
+    result.push_back(speakers[i].second);
+  }
+  return result;
+}
+
 std::vector<ParticipantId> RtpForwarder::get_subscribers(const ParticipantId& publisher_id) const
 {
   std::lock_guard lock(impl_->mutex);
@@ -5,15 +5,26 @@
 
 #include "rtc/server/sfu_server.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <mutex>
+#include <optional>
 #include <set>
+#include <span>
 #include <thread>
+#include <utility>
 #include <vector>
 
+#include "rtc/health_monitor.h"
+#include "rtc/metrics_exporter.h"
+#include "rtc/packet_tracer.h"
+#include "rtc/server/overload_controller.h"
 #include "rtc/server/room_manager.h"
 #include "rtc/server/rtp_forwarder.h"
 #include "rtc/server/subscription_manager.h"
+#include "rtc/task_scheduler.h"
+#include "rtc/timer_wheel.h"
 #include "rtc/udp_socket.h"
 
 
@@ -22,6 +33,24 @@ namespace rtc
 namespace server
 {
 
+namespace
+{
+
+constexpr auto IO_TICK = std::chrono::milliseconds(10);
+
+// SSRC of an RTP packet; nullopt for RTCP and anything too short to be RTP
+std::optional<uint32_t> rtp_ssrc(std::span<const uint8_t> data)
+{
+  if (data.size() < 12 || (data[0] >> 6) != 2 || (data[1] >= 200 && data[1] <= 204))
+  {
+    return std::nullopt;
+  }
+  return (uint32_t{data[8]} << 24) | (uint32_t{data[9]} << 16) | (uint32_t{data[10]} << 8) |
+         data[11];
+}
+
+}  // namespace
+
 struct SfuServer::Impl
 {
   SfuServerConfig config;
@@ -31,10 +60,25 @@ struct SfuServer::Impl
   std::unique_ptr<RtpForwarder> rtp_forwarder;
   std::unique_ptr<SubscriptionManager> subscription_manager;
 
-  // Networking
+  // Load shedding
+  HealthMonitor health_monitor;
+  OverloadController overload_controller;
+
+  // Prometheus endpoint, null when disabled
+  std::unique_ptr<MetricsExporter> metrics;
+
+  // Whether this server turned the process-wide packet tracer on
+  bool tracing = false;
+
+  // Networking: IO thread i reads sockets[i]
   std::vector<std::unique_ptr<UdpSocket>> sockets;
   std::vector<std::thread> io_threads;
 
+  // Room jobs on the shared scheduler
+  PeriodicTaskId subscription_job = 0;
+  PeriodicTaskId cleanup_job = 0;
+  PeriodicTaskId overload_job = 0;
+
   // Port allocation
   std::mutex port_mutex;
   std::set<uint16_t> allocated_ports;
@@ -48,10 +92,42 @@ struct SfuServer::Impl
       : config(std::move(cfg)),
         room_manager(std::make_unique<RoomManager>()),
         rtp_forwarder(std::make_unique<RtpForwarder>()),
-        subscription_manager(std::make_unique<SubscriptionManager>())
+        subscription_manager(std::make_unique<SubscriptionManager>()),
+        health_monitor({.check_interval = std::chrono::seconds(1)}),
+        overload_controller(config.overload, *subscription_manager, *room_manager)
   {
     next_port = config.rtp_port_min;
 
+    if (config.enable_prometheus_metrics)
+    {
+      MetricsConfig metrics_config;
+      metrics_config.port = config.metrics_port;
+      metrics = std::make_unique<MetricsExporter>(metrics_config);
+      rtp_forwarder->set_latency_histogram(metrics->forwarding_latency_histogram());
+      health_monitor.set_metrics_exporter(metrics.get());
+    }
+
+    // Apply (possibly capped) layer choices to forwarding
+    subscription_manager->set_layer_switch_callback(
+        [this](const ParticipantId& subscriber_id, const ParticipantId& publisher_id,
+               int /*old_layer*/, int new_layer)
+        { rtp_forwarder->set_simulcast_layer(publisher_id, subscriber_id, new_layer); });
+
+    // Temporal caps and hidden-video suspension are enforced by the forwarder
+    subscription_manager->set_state_callback(
+        [this](const ParticipantId& subscriber_id, const Subscription& subscription)
+        {
+          rtp_forwarder->set_subscription_limits(subscription.publisher_id, subscriber_id,
+                                                 subscription.temporal_layer,
+                                                 subscription.is_suspended);
+        });
+
+    // Room jobs waiting for a worker count towards overload; the forwarder
+    // runs inline on the IO threads and has no queue of its own
+    overload_controller.add_queue_depth_source(
+        "task_scheduler",
+        []() { return static_cast<size_t>(TaskScheduler::shared().stats().tasks_pending); });
+
     // Set up forwarder callback
     rtp_forwarder->set_forward_callback(
         [](const ParticipantId& /*subscriber*/, std::span<const uint8_t> /*packet*/,
@@ -99,21 +175,111 @@ struct SfuServer::Impl
     allocated_ports.erase(port);
   }
 
+  bool open_sockets()
+  {
+    for (size_t i = 0; i < config.io_threads; ++i)
+    {
+      uint16_t port = allocate_port();
+      auto socket = port != 0 ? UdpSocket::create() : nullptr;
+      if (!socket || socket->bind(config.bind_address, port))
+      {
+        release_port(port);
+        close_sockets();
+        return false;
+      }
+      sockets.push_back(std::move(socket));
+    }
+    return !sockets.empty();
+  }
+
+  void close_sockets()
+  {
+    for (auto& socket : sockets)
+    {
+      uint16_t port = socket->local_address().port;
+      socket->close();
+      release_port(port);
+    }
+    sockets.clear();
+  }
+
+  void start_tracing()
+  {
+    auto& tracer = PacketTracer::shared();
+    tracing = tracer.enable(config.packet_tracing);
+    if (!tracing || !metrics)
+    {
+      return;
+    }
+    for (size_t i = 0; i < kTraceStageCount; ++i)
+    {
+      auto stage = static_cast<TraceStage>(i);
+      tracer.set_stage_histogram(stage,
+                                 metrics->pipeline_stage_histogram(trace_stage_name(stage)));
+    }
+  }
+
+  void stop_tracing()
+  {
+    if (!std::exchange(tracing, false))
+    {
+      return;
+    }
+    // Collects what is left, then lets go of this server's histograms
+    auto& tracer = PacketTracer::shared();
+    tracer.disable();
+    for (size_t i = 0; i < kTraceStageCount; ++i)
+    {
+      tracer.set_stage_histogram(static_cast<TraceStage>(i), {});
+    }
+  }
+
   void io_loop(size_t thread_id)
   {
-    (void)thread_id;  // Unused for now
+    auto lag_probe = LoopLagProbe::create("sfu_io_" + std::to_string(thread_id));
+    UdpSocket& socket = *sockets[thread_id];
 
-    while (running.load())
+    // Socket reads and this thread's timers share one epoll wait
+    auto loop = SocketEventLoop::create();
+    TimerWheel wheel;
+    loop->set_timer_wheel(&wheel);
+
+    // Missed ticks are skipped by the wheel, so the next one is due after now
+    auto due = std::chrono::steady_clock::now() + IO_TICK;
+    auto report_lag = [&]()
     {
-      // TODO: epoll-based IO loop
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      auto now = std::chrono::steady_clock::now();
+      lag_probe->tick(due);
+      while (due <= now)
+      {
+        due += IO_TICK;
+      }
+    };
+    TimerId lag_timer = wheel.schedule_periodic(IO_TICK, report_lag);
+
+    socket.async_recv(
+        [this](RecvResult result)
+        {
+          if (auto ssrc = rtp_ssrc(result.data))
+          {
+            rtp_forwarder->on_rtp_packet(*ssrc, result.data, result.remote_address,
+                                         result.received_at);
+          }
+        });
+    bool registered = !loop->add_socket(socket);
 
-      // Process subscriptions periodically
-      subscription_manager->process();
+    while (running.load())
+    {
+      loop->poll(static_cast<int>(IO_TICK.count()));
+    }
 
-      // Cleanup rooms periodically
-      room_manager->cleanup();
+    if (registered)
+    {
+      loop->remove_socket(socket);
     }
+    socket.async_recv(nullptr);
+    wheel.cancel(lag_timer);
+    loop->set_timer_wheel(nullptr);
   }
 };
 
@@ -131,6 +297,11 @@ bool SfuServer::start()
     return false;
   }
 
+  if (!impl_->open_sockets())
+  {
+    return false;
+  }
+
   impl_->running.store(true);
 
   // Start IO threads
@@ -139,6 +310,31 @@ bool SfuServer::start()
     impl_->io_threads.emplace_back([this, i]() { impl_->io_loop(i); });
   }
 
+  // Process subscriptions and cleanup rooms periodically
+  auto& scheduler = TaskScheduler::shared();
+  impl_->subscription_job = scheduler.schedule_periodic(
+      std::chrono::milliseconds(10), [this]() { impl_->subscription_manager->process(); });
+  impl_->cleanup_job = scheduler.schedule_periodic(
+      std::chrono::seconds(1), [this]() { impl_->room_manager->cleanup(); });
+
+  if (impl_->metrics)
+  {
+    impl_->metrics->start();
+  }
+
+  if (impl_->config.enable_packet_tracing)
+  {
+    impl_->start_tracing();
+  }
+
+  if (impl_->config.enable_overload_control)
+  {
+    impl_->health_monitor.start();
+    impl_->overload_job = scheduler.schedule_periodic(
+        std::chrono::seconds(1),
+        [this]() { impl_->overload_controller.evaluate(impl_->health_monitor.get_health()); });
+  }
+
   return true;
 }
 
@@ -151,6 +347,19 @@ void SfuServer::stop()
 
   impl_->running.store(false);
 
+  auto& scheduler = TaskScheduler::shared();
+  scheduler.cancel_periodic(impl_->subscription_job);
+  scheduler.cancel_periodic(impl_->cleanup_job);
+  scheduler.cancel_periodic(impl_->overload_job);
+  impl_->subscription_job = 0;
+  impl_->cleanup_job = 0;
+  impl_->overload_job = 0;
+  impl_->health_monitor.stop();
+  if (impl_->metrics)
+  {
+    impl_->metrics->stop();
+  }
+
   for (auto& thread : impl_->io_threads)
   {
     if (thread.joinable())
@@ -159,6 +368,8 @@ void SfuServer::stop()
     }
   }
   impl_->io_threads.clear();
+  impl_->stop_tracing();
+  impl_->close_sockets();
 }
 
 bool SfuServer::is_running() const
@@ -194,11 +405,51 @@ SubscriptionManager& SfuServer::subscription_manager()
   return *impl_->subscription_manager;
 }
 
+OverloadController& SfuServer::overload_controller()
+{
+  return impl_->overload_controller;
+}
+
+MetricsExporter* SfuServer::metrics_exporter()
+{
+  return impl_->metrics.get();
+}
+
+std::string SfuServer::packet_trace_json() const
+{
+  return PacketTracer::shared().chrome_trace_json();
+}
+
 uint16_t SfuServer::allocate_port()
 {
   return impl_->allocate_port();
 }
 
+void SfuServer::update_layout(const std::string& subscriber_id,
+                              const std::vector<std::string>& visible_publishers)
+{
+  auto& subscriptions = *impl_->subscription_manager;
+  for (const auto& subscription : subscriptions.get_subscriptions(subscriber_id))
+  {
+    bool visible = std::find(visible_publishers.begin(), visible_publishers.end(),
+                             subscription.publisher_id) != visible_publishers.end();
+    subscriptions.set_visible(subscriber_id, subscription.publisher_id, visible);
+  }
+}
+
+bool SfuServer::migrate_participant(const std::string& room_id,
+                                    const std::string& participant_id,
+                                    const SocketAddress& address)
+{
+  if (!impl_->room_manager->update_participant_address(room_id, participant_id, address))
+  {
+    return false;
+  }
+
+  impl_->rtp_forwarder->update_subscriber_destination(participant_id, address);
+  return true;
+}
+
 void SfuServer::release_port(uint16_t port)
 {
   impl_->release_port(port);
@@ -63,6 +63,8 @@ struct SubscriptionManager::Impl
 {
   mutable std::mutex mutex;
   LayerSwitchCallback layer_switch_callback;
+  SubscriptionStateCallback state_callback;
+  SubscriptionLimits limits;
 
   // All subscriptions
   std::unordered_map<SubscriptionKey, Subscription, SubscriptionKeyHash> subscriptions;
@@ -101,6 +103,21 @@ struct SubscriptionManager::Impl
 
     return best_layer;
   }
+
+  int cap_layer(int layer) const
+  {
+    return limits.max_spatial_layer >= 0 ? std::min(layer, limits.max_spatial_layer) : layer;
+  }
+
+  // Apply temporal cap and hidden-stream suspension; true if anything changed
+  bool apply_limits(Subscription& sub) const
+  {
+    bool suspended = limits.pause_hidden && !sub.is_visible;
+    bool changed = sub.temporal_layer != limits.max_temporal_layer || sub.is_suspended != suspended;
+    sub.temporal_layer = limits.max_temporal_layer;
+    sub.is_suspended = suspended;
+    return changed;
+  }
 };
 
 SubscriptionManager::SubscriptionManager() : impl_(std::make_unique<Impl>()) {}
@@ -113,6 +130,12 @@ void SubscriptionManager::set_layer_switch_callback(LayerSwitchCallback callback
   impl_->layer_switch_callback = std::move(callback);
 }
 
+void SubscriptionManager::set_state_callback(SubscriptionStateCallback callback)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->state_callback = std::move(callback);
+}
+
 void SubscriptionManager::set_available_layers(const ParticipantId& publisher_id,
                                                const StreamId& stream_id,
                                                const std::vector<SimulcastLayerInfo>& layers)
@@ -133,8 +156,15 @@ void SubscriptionManager::subscribe(const ParticipantId& subscriber_id,
   sub.publisher_id = publisher_id;
   sub.stream_id = stream_id;
   sub.target_layer = target_layer;
-  sub.current_layer = target_layer >= 0 ? target_layer : 2;
+  sub.current_layer = impl_->cap_layer(target_layer >= 0 ? target_layer : 2);
   sub.is_paused = false;
+  impl_->apply_limits(sub);
+
+  // Already limited: process() sees no change, so report it here
+  if ((sub.temporal_layer >= 0 || sub.is_suspended) && impl_->state_callback)
+  {
+    impl_->state_callback(subscriber_id, sub);
+  }
 
   impl_->subscriptions[key] = std::move(sub);
 }
@@ -174,6 +204,32 @@ void SubscriptionManager::set_target_layer(const ParticipantId& subscriber_id,
   }
 }
 
+void SubscriptionManager::set_visible(const ParticipantId& subscriber_id,
+                                      const ParticipantId& publisher_id, bool visible)
+{
+  std::lock_guard lock(impl_->mutex);
+
+  for (auto& [key, sub] : impl_->subscriptions)
+  {
+    if (key.subscriber_id == subscriber_id && key.publisher_id == publisher_id)
+    {
+      sub.is_visible = visible;
+    }
+  }
+}
+
+void SubscriptionManager::set_limits(const SubscriptionLimits& limits)
+{
+  std::lock_guard lock(impl_->mutex);
+  impl_->limits = limits;
+}
+
+SubscriptionLimits SubscriptionManager::limits() const
+{
+  std::lock_guard lock(impl_->mutex);
+  return impl_->limits;
+}
+
 void SubscriptionManager::update_bandwidth(const ParticipantId& subscriber_id,
                                            const BandwidthInfo& info)
 {
@@ -187,12 +243,22 @@ void SubscriptionManager::process()
 
   for (auto& [key, sub] : impl_->subscriptions)
   {
-    if (sub.is_paused || sub.target_layer >= 0)
+    if (impl_->apply_limits(sub) && impl_->state_callback)
+    {
+      impl_->state_callback(key.subscriber_id, sub);
+    }
+
+    if (sub.is_paused || sub.is_suspended)
     {
-      continue;  // Don't auto-adjust if paused or manually set
+      continue;  // Don't auto-adjust if paused
     }
 
-    int best_layer = impl_->select_best_layer(key.subscriber_id, {key.publisher_id, key.stream_id});
+    // Manually set layers are still subject to the node-wide cap
+    int best_layer = sub.target_layer >= 0
+                         ? sub.target_layer
+                         : impl_->select_best_layer(key.subscriber_id,
+                                                    {key.publisher_id, key.stream_id});
+    best_layer = impl_->cap_layer(best_layer);
 
     if (best_layer != sub.current_layer)
     {
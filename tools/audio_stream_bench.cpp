@@ -0,0 +1,219 @@
+/**
+ * @file audio_stream_bench.cpp
+ * @brief Full AudioStream pipeline cost on the file device backend
+ *
+ * Capture reads a WAV file (a synthetic voice when none is given) through
+ * processing and the encoder. By default packets are looped back into
+ * receive_packet from the main thread every few ms, playout is paced by the file playback device in
+ * real time, and the decoded audio is written to the output WAV; the figure
+ * of merit is CPU time per second of audio. With --fast only the send path
+ * runs, as fast as the CPU allows, and the result is in multiples of real
+ * time.
+ *
+ * Usage: audio_stream_bench [--seconds <n>] [--input <wav>] [--output <wav>] [--fast]
+ *   --seconds is the length of the synthetic input, or of the --input file
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "rtc/audio/audio_capture.h"
+#include "rtc/audio/audio_stream.h"
+
+namespace
+{
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr auto IDLE_TIMEOUT = std::chrono::milliseconds(300);  // --fast: input used up
+constexpr auto LOOPBACK_INTERVAL = std::chrono::milliseconds(5);
+
+struct Packet
+{
+  std::vector<uint8_t> data;
+  uint32_t timestamp;
+  uint16_t sequence;
+};
+
+// Gliding harmonic voice with a syllable envelope over background noise
+bool write_voice(const std::string& path, int seconds)
+{
+  const double pi = std::acos(-1.0);
+  std::mt19937 rng(1234);
+  std::normal_distribution<double> noise(0.0, 300.0);
+
+  std::vector<int16_t> pcm(static_cast<size_t>(seconds) * SAMPLE_RATE);
+  double phase = 0.0;
+  for (size_t i = 0; i < pcm.size(); ++i)
+  {
+    double t = static_cast<double>(i) / SAMPLE_RATE;
+    phase += 2.0 * pi * (150.0 + 50.0 * std::sin(2.0 * pi * 0.7 * t)) / SAMPLE_RATE;
+    double envelope = std::max(0.0, std::sin(2.0 * pi * 2.0 * t));
+    double voice = 0.0;
+    for (int harmonic = 1; harmonic <= 10; ++harmonic)
+    {
+      voice += std::sin(phase * harmonic) / harmonic;
+    }
+    pcm[i] = static_cast<int16_t>(std::clamp(6000.0 * envelope * voice + noise(rng), -32768.0,
+                                             32767.0));
+  }
+
+  rtc::audio::AudioPlayback file;
+  rtc::audio::AudioPlaybackConfig config;
+  config.backend = rtc::audio::AudioBackend::FILE;
+  config.sample_rate = SAMPLE_RATE;
+  config.file_path = path;
+  return file.open(config) && file.start() && file.write(pcm) == pcm.size();
+}
+
+double cpu_seconds()
+{
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int seconds = 10;
+  std::string input;
+  std::string output = "audio_stream_bench_out.wav";
+  bool fast = false;
+  for (int i = 1; i < argc; ++i)
+  {
+    bool has_value = i + 1 < argc;
+    if (std::strcmp(argv[i], "--seconds") == 0 && has_value)
+    {
+      seconds = std::max(1, std::atoi(argv[++i]));
+    }
+    else if (std::strcmp(argv[i], "--input") == 0 && has_value)
+    {
+      input = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--output") == 0 && has_value)
+    {
+      output = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--fast") == 0)
+    {
+      fast = true;
+    }
+    else
+    {
+      std::fprintf(stderr,
+                   "usage: %s [--seconds <n>] [--input <wav>] [--output <wav>] [--fast]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  if (input.empty())
+  {
+    input = "audio_stream_bench_in.wav";
+    if (!write_voice(input, seconds))
+    {
+      std::fprintf(stderr, "cannot write %s\n", input.c_str());
+      return 1;
+    }
+  }
+
+  rtc::audio::AudioStreamConfig config;
+  config.sample_rate = SAMPLE_RATE;
+  config.backend = rtc::audio::AudioBackend::FILE;
+  config.capture_file = input;
+  config.playback_file = output;
+  config.device_playout = !fast;
+  config.realtime = !fast;
+  auto stream = rtc::audio::create_audio_stream(config);
+
+  // The send callback runs under the stream's lock, so packets are looped back from here
+  std::atomic<int64_t> last_packet_ns{0};
+  std::mutex loop_mutex;
+  std::vector<Packet> in_flight;
+  stream->set_send_callback(
+      [&](std::span<const uint8_t> data, uint32_t timestamp, uint16_t sequence,
+          rtc::RtpAudioLevel /*level*/)
+      {
+        last_packet_ns.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch())
+                                 .count());
+        if (!fast)
+        {
+          std::lock_guard lock(loop_mutex);
+          in_flight.push_back({{data.begin(), data.end()}, timestamp, sequence});
+        }
+      });
+
+  double cpu_start = cpu_seconds();
+  auto start = std::chrono::steady_clock::now();
+  if (!stream->start())
+  {
+    std::fprintf(stderr, "cannot start the stream on %s\n", input.c_str());
+    return 1;
+  }
+
+  if (fast)
+  {
+    // Capture ends with the file; the last packet marks the end of the work
+    while (last_packet_ns.load() == 0 ||
+           std::chrono::steady_clock::now().time_since_epoch() -
+                   std::chrono::nanoseconds(last_packet_ns.load()) <
+               IDLE_TIMEOUT)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  else
+  {
+    auto end = start + std::chrono::seconds(seconds) + std::chrono::milliseconds(500);
+    std::vector<Packet> arrived;
+    while (std::chrono::steady_clock::now() < end)
+    {
+      std::this_thread::sleep_for(LOOPBACK_INTERVAL);
+      {
+        std::lock_guard lock(loop_mutex);
+        arrived.swap(in_flight);
+      }
+      for (const auto& packet : arrived)
+      {
+        stream->receive_packet(packet.data, packet.timestamp, packet.sequence);
+      }
+      arrived.clear();
+    }
+  }
+  stream->stop();
+  double cpu = cpu_seconds() - cpu_start;
+
+  auto stats = stream->stats();
+  if (fast)
+  {
+    std::chrono::duration<double> busy =
+        std::chrono::nanoseconds(last_packet_ns.load()) - start.time_since_epoch();
+    std::printf("send path: %llu packets in %.3f s, %.1fx real time, %.3f CPU s per audio s\n",
+                static_cast<unsigned long long>(stats.packets_sent), busy.count(),
+                seconds / busy.count(), cpu / seconds);
+  }
+  else
+  {
+    std::printf("send + receive: %llu packets, %.1f%% of one core, %.3f CPU s per audio s\n",
+                static_cast<unsigned long long>(stats.packets_sent),
+                100.0 * cpu / (seconds + 0.5), cpu / seconds);
+    std::printf("  concealed %llu, stretched +%llu/-%llu samples, delay %.1f ms -> %s\n",
+                static_cast<unsigned long long>(stats.concealed_frames),
+                static_cast<unsigned long long>(stats.expanded_samples),
+                static_cast<unsigned long long>(stats.accelerated_samples),
+                stats.playout_delay_ms, output.c_str());
+  }
+  return 0;
+}
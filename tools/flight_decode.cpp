@@ -0,0 +1,37 @@
+/**
+ * @file flight_decode.cpp
+ * @brief Print a flight recorder dump as a readable timeline
+ *
+ * Usage: flight_decode <dump.bin> [--ssrc <hex>]
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "rtc/flight_recorder.h"
+
+int main(int argc, char** argv)
+{
+  if (argc != 2 && !(argc == 4 && std::strcmp(argv[2], "--ssrc") == 0))
+  {
+    std::fprintf(stderr, "usage: %s <dump.bin> [--ssrc <hex>]\n", argv[0]);
+    return 2;
+  }
+
+  uint32_t ssrc = argc == 4 ? static_cast<uint32_t>(std::strtoul(argv[3], nullptr, 16)) : 0;
+
+  rtc::FlightDumpHeader header;
+  std::vector<rtc::FlightRecord> records;
+  if (!rtc::read_flight_dump(argv[1], header, records))
+  {
+    std::fprintf(stderr, "%s: not a readable flight recorder dump\n", argv[1]);
+    return 1;
+  }
+
+  std::string timeline = rtc::format_flight_timeline(header, records, ssrc);
+  std::fwrite(timeline.data(), 1, timeline.size(), stdout);
+  return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file opus_bench.cpp
+ * @brief Opus encode/decode cost per frame at each complexity level
+ *
+ * Encodes a synthetic speech-like signal (a gliding harmonic voice with
+ * syllable envelope and background noise) and decodes the packets again.
+ *
+ * Usage: opus_bench [--seconds <n>] [--bitrate <bps>] [--channels <1|2>]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "rtc/audio/opus_codec.h"
+
+namespace
+{
+
+constexpr int SAMPLE_RATE = 48000;
+constexpr int FRAME_MS = 20;
+
+std::vector<int16_t> make_signal(int seconds, int channels)
+{
+  const double pi = std::acos(-1.0);
+  std::mt19937 rng(1234);
+  std::normal_distribution<double> noise(0.0, 300.0);
+
+  size_t frames = static_cast<size_t>(seconds) * SAMPLE_RATE;
+  std::vector<int16_t> pcm(frames * static_cast<size_t>(channels));
+  double phase = 0.0;
+  for (size_t i = 0; i < frames; ++i)
+  {
+    double t = static_cast<double>(i) / SAMPLE_RATE;
+    double pitch = 150.0 + 50.0 * std::sin(2.0 * pi * 0.7 * t);
+    phase += 2.0 * pi * pitch / SAMPLE_RATE;
+
+    // About four syllables a second with pauses in between
+    double envelope = std::max(0.0, std::sin(2.0 * pi * 2.0 * t));
+    double voice = 0.0;
+    for (int harmonic = 1; harmonic <= 10; ++harmonic)
+    {
+      voice += std::sin(phase * harmonic) / harmonic;
+    }
+
+    double sample = 6000.0 * envelope * voice + noise(rng);
+    auto value = static_cast<int16_t>(std::clamp(sample, -32768.0, 32767.0));
+    for (int c = 0; c < channels; ++c)
+    {
+      pcm[i * static_cast<size_t>(channels) + static_cast<size_t>(c)] = value;
+    }
+  }
+  return pcm;
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int seconds = 10;
+  int bitrate = 32000;
+  int channels = 1;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    if (std::strcmp(argv[i], "--seconds") == 0)
+    {
+      seconds = std::max(1, std::atoi(argv[i + 1]));
+    }
+    else if (std::strcmp(argv[i], "--bitrate") == 0)
+    {
+      bitrate = std::atoi(argv[i + 1]);
+    }
+    else if (std::strcmp(argv[i], "--channels") == 0)
+    {
+      channels = std::atoi(argv[i + 1]) == 2 ? 2 : 1;
+    }
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--seconds <n>] [--bitrate <bps>] [--channels <1|2>]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  if (!rtc::audio::OpusEncoder::has_libopus())
+  {
+    std::fprintf(stderr, "warning: built without libopus, timing the stub codec\n");
+  }
+
+  auto pcm = make_signal(seconds, channels);
+  size_t frame_samples = static_cast<size_t>(SAMPLE_RATE / 1000 * FRAME_MS * channels);
+  size_t frame_count = pcm.size() / frame_samples;
+
+  std::vector<uint8_t> packet(rtc::audio::OpusEncoder::MAX_PACKET_BYTES);
+  std::vector<int16_t> decoded(static_cast<size_t>(rtc::audio::OpusDecoder::MAX_FRAME_SIZE) *
+                               static_cast<size_t>(channels));
+
+  std::printf("%d s, %d ch, %d bps, %d ms frames\n", seconds, channels, bitrate, FRAME_MS);
+  std::printf("complexity  encode us/frame  decode us/frame  bytes/frame\n");
+
+  for (int complexity = 0; complexity <= 10; ++complexity)
+  {
+    rtc::audio::OpusEncoder encoder({.sample_rate = SAMPLE_RATE,
+                                     .channels = channels,
+                                     .bitrate = bitrate,
+                                     .frame_duration_ms = FRAME_MS,
+                                     .use_dtx = false,
+                                     .complexity = complexity});
+    rtc::audio::OpusDecoder decoder({.sample_rate = SAMPLE_RATE, .channels = channels});
+    if (!encoder.initialize() || !decoder.initialize())
+    {
+      std::fprintf(stderr, "codec initialization failed\n");
+      return 1;
+    }
+
+    std::chrono::nanoseconds encode_time{0};
+    std::chrono::nanoseconds decode_time{0};
+    size_t total_bytes = 0;
+    for (size_t f = 0; f < frame_count; ++f)
+    {
+      std::span<const int16_t> frame(pcm.data() + f * frame_samples, frame_samples);
+
+      auto start = std::chrono::steady_clock::now();
+      auto encoded = encoder.encode(frame, packet);
+      auto middle = std::chrono::steady_clock::now();
+      auto result = decoder.decode(std::span<const uint8_t>(packet).first(encoded.bytes), decoded);
+      auto end = std::chrono::steady_clock::now();
+
+      if (!encoded.success() || !result.success())
+      {
+        std::fprintf(stderr, "frame %zu failed\n", f);
+        return 1;
+      }
+      encode_time += middle - start;
+      decode_time += end - middle;
+      total_bytes += encoded.bytes;
+    }
+
+    auto per_frame = [&](std::chrono::nanoseconds total)
+    { return std::chrono::duration<double, std::micro>(total).count() / frame_count; };
+    std::printf("%10d  %15.1f  %15.1f  %11.1f\n", complexity, per_frame(encode_time),
+                per_frame(decode_time), static_cast<double>(total_bytes) / frame_count);
+  }
+  return 0;
+}
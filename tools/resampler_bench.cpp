@@ -0,0 +1,185 @@
+/**
+ * @file resampler_bench.cpp
+ * @brief Resampler throughput and frequency response for common rate pairs
+ *
+ * Throughput resamples white noise in 10 ms blocks and reports input
+ * MSamples/s per channel. Quality runs steady tones through and fits a sine
+ * at the tone frequency to the settled output:
+ *   - passband ripple: max - min tone gain up to 0.8 of the lower Nyquist
+ *   - stopband: worst rejection, in dB below the input tone, of inputs above
+ *     the output Nyquist (aliases) and of everything but the tone (images)
+ *
+ * Usage: resampler_bench [--seconds <n>]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "rtc/audio/resampler.h"
+
+namespace
+{
+
+constexpr int BLOCK_MS = 10;
+constexpr int TONES = 48;
+
+struct RatePair
+{
+  int input_rate;
+  int output_rate;
+};
+
+std::vector<float> run(rtc::audio::Resampler& resampler, const std::vector<float>& input,
+                       size_t block)
+{
+  std::vector<float> output;
+  std::vector<float> scratch(resampler.max_output_frames(block));
+  for (size_t at = 0; at + block <= input.size(); at += block)
+  {
+    size_t produced = resampler.process(std::span<const float>(input.data() + at, block), scratch);
+    output.insert(output.end(), scratch.begin(),
+                  scratch.begin() + static_cast<std::ptrdiff_t>(produced));
+  }
+  return output;
+}
+
+// Least-squares fit of a sin + b cos at `frequency`; returns the fitted
+// amplitude and the power of what is left over
+void fit_tone(const std::vector<float>& signal, size_t skip, double frequency, double& amplitude,
+              double& residual_power)
+{
+  const double pi = std::acos(-1.0);
+  double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0;
+  for (size_t n = skip; n < signal.size(); ++n)
+  {
+    double s = std::sin(2.0 * pi * frequency * static_cast<double>(n));
+    double c = std::cos(2.0 * pi * frequency * static_cast<double>(n));
+    ss += s * s;
+    sc += s * c;
+    cc += c * c;
+    ys += signal[n] * s;
+    yc += signal[n] * c;
+  }
+  double det = ss * cc - sc * sc;
+  double a = (ys * cc - yc * sc) / det;
+  double b = (yc * ss - ys * sc) / det;
+  amplitude = std::sqrt(a * a + b * b);
+
+  double energy = 0.0;
+  for (size_t n = skip; n < signal.size(); ++n)
+  {
+    double s = std::sin(2.0 * pi * frequency * static_cast<double>(n));
+    double c = std::cos(2.0 * pi * frequency * static_cast<double>(n));
+    double error = signal[n] - a * s - b * c;
+    energy += error * error;
+  }
+  residual_power = energy / static_cast<double>(signal.size() - skip);
+}
+
+double to_db(double power_ratio)
+{
+  return 10.0 * std::log10(std::max(power_ratio, 1e-30));
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  int seconds = 10;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    if (std::strcmp(argv[i], "--seconds") == 0)
+    {
+      seconds = std::max(1, std::atoi(argv[i + 1]));
+    }
+    else
+    {
+      std::fprintf(stderr, "usage: %s [--seconds <n>]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  std::printf("%d s of noise in %d ms blocks, %d tones per rate pair\n", seconds, BLOCK_MS, TONES);
+  std::printf("  in -> out     MSamples/s  ripple dB  stopband dB\n");
+
+  const double pi = std::acos(-1.0);
+  for (RatePair pair : {RatePair{48000, 16000}, RatePair{16000, 48000}, RatePair{44100, 48000},
+                        RatePair{48000, 44100}, RatePair{48000, 8000}, RatePair{32000, 48000}})
+  {
+    rtc::audio::ResamplerConfig config{pair.input_rate, pair.output_rate, 1};
+    auto block = static_cast<size_t>(pair.input_rate * BLOCK_MS / 1000);
+
+    // Throughput
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::vector<float> input(static_cast<size_t>(seconds) * static_cast<size_t>(pair.input_rate));
+    for (auto& sample : input)
+    {
+      sample = noise(rng);
+    }
+    rtc::audio::Resampler timed(config);
+    std::vector<float> scratch(timed.max_output_frames(block));
+    auto start = std::chrono::steady_clock::now();
+    for (size_t at = 0; at + block <= input.size(); at += block)
+    {
+      timed.process(std::span<const float>(input.data() + at, block), scratch);
+    }
+    double elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double msamples = static_cast<double>(input.size()) / elapsed / 1e6;
+
+    // Quality: 200 ms tones, the first 50 ms of output skipped while the filter fills
+    double lower_nyquist = std::min(pair.input_rate, pair.output_rate) / 2.0;
+    double input_nyquist = pair.input_rate / 2.0;
+    size_t tone_length = static_cast<size_t>(pair.input_rate / 5);
+    auto skip = static_cast<size_t>(pair.output_rate / 20);
+    double gain_min = 1e9, gain_max = 0.0, worst_rejection = 1e9;
+    for (int t = 0; t < TONES; ++t)
+    {
+      // Half the tones span the passband, the rest the band above the output Nyquist
+      bool passband = t < TONES / 2 || pair.output_rate >= pair.input_rate;
+      double frequency = passband
+                             ? 0.8 * lower_nyquist * (t % (TONES / 2) + 1) / (TONES / 2)
+                             : pair.output_rate / 2.0 +
+                                   (input_nyquist - pair.output_rate / 2.0) *
+                                       (t - TONES / 2 + 0.5) / (TONES / 2);
+
+      std::vector<float> tone(tone_length);
+      for (size_t n = 0; n < tone_length; ++n)
+      {
+        tone[n] = 0.5f * static_cast<float>(
+                             std::sin(2.0 * pi * frequency * static_cast<double>(n) /
+                                      pair.input_rate));
+      }
+      rtc::audio::Resampler resampler(config);
+      auto resampled = run(resampler, tone, block);
+
+      double amplitude = 0.0, residual = 0.0;
+      fit_tone(resampled, skip, frequency / pair.output_rate, amplitude, residual);
+      double tone_power = 0.5 * 0.5 * 0.5;
+      if (passband)
+      {
+        gain_min = std::min(gain_min, amplitude / 0.5);
+        gain_max = std::max(gain_max, amplitude / 0.5);
+        worst_rejection = std::min(worst_rejection, -to_db(residual / tone_power));
+      }
+      else
+      {
+        // Anything left is aliasing
+        double total = residual + 0.5 * amplitude * amplitude;
+        worst_rejection = std::min(worst_rejection, -to_db(total / tone_power));
+      }
+    }
+
+    std::printf("%5d -> %5d  %10.1f  %9.4f  %11.1f\n", pair.input_rate, pair.output_rate,
+                msamples, 20.0 * std::log10(gain_max / gain_min), worst_rejection);
+  }
+  return 0;
+}
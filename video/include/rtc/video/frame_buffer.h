@@ -55,7 +55,8 @@ struct FrameBufferConfig
   std::chrono::milliseconds max_delay{200};    // Max playout delay
   std::chrono::milliseconds target_delay{50};  // Target delay
   bool enable_nack = true;                     // Request retransmission
-  bool wait_for_keyframe = true;               // Wait for keyframe on start
+  bool wait_for_keyframe = true;               // Wait for keyframe on start and after lost frames
+  uint16_t max_nack_gap = 100;  // Larger sequence gaps are beyond NACK and need a keyframe
 };
 
 /**
@@ -112,7 +113,11 @@ class FrameBuffer
   [[nodiscard]] std::vector<uint16_t> get_nack_list(size_t max_count = 10) const;
 
   /**
-   * @brief Request keyframe (when too many frames lost)
+   * @brief Check whether decoding needs a keyframe
+   *
+   * True before the first keyframe, after a sequence gap wider than
+   * max_nack_gap, or once a frame since the last keyframe is lost for
+   * good. Shorter gaps (e.g. across an ICE restart) are left to NACK.
    */
   [[nodiscard]] bool should_request_keyframe() const;
 
@@ -12,6 +12,10 @@
 
 namespace rtc
 {
+
+class MetricHistogram;
+class MetricsExporter;
+
 namespace video
 {
 
@@ -31,6 +35,8 @@ struct VideoStreamConfig
   int bitrate_kbps = 1500;
   bool enable_simulcast = false;
   bool use_hardware = false;
+  MetricsExporter* metrics = nullptr;  // Record encode time into its predefined histogram
+  uint32_t remote_ssrc = 0;            // Of the received stream, for flight recorder events
 };
 
 /**
@@ -147,6 +153,12 @@ class VideoStream
    */
   virtual bool is_enabled() const = 0;
 
+  /**
+   * @brief Record per-frame encode time in milliseconds
+   * @see MetricsExporter::encode_time_histogram
+   */
+  virtual void set_encode_time_histogram(MetricHistogram histogram) = 0;
+
  protected:
   VideoStream() = default;
 };
@@ -80,11 +80,19 @@ struct FrameBuffer::Impl
   std::set<uint16_t> received_sequences;
   uint16_t highest_sequence = 0;
   bool has_keyframe = false;
+  bool keyframe_needed = false;  // Decoding chain broken since the last keyframe
+  uint32_t keyframe_timestamp = 0;
 
   FrameBufferStats stats;
 
   Impl(FrameBufferConfig cfg) : config(std::move(cfg)) {}
 
+  // Frames from before the last keyframe are not needed any more
+  bool after_keyframe(uint32_t timestamp) const
+  {
+    return has_keyframe && static_cast<int32_t>(timestamp - keyframe_timestamp) > 0;
+  }
+
   void cleanup_old_frames()
   {
     // Remove frames older than max_delay
@@ -96,6 +104,10 @@ struct FrameBuffer::Impl
           now - complete_frames.front().arrival_time);
       if (age > config.max_delay)
       {
+        if (after_keyframe(complete_frames.front().rtp_timestamp))
+        {
+          keyframe_needed = true;
+        }
         complete_frames.pop_front();
         stats.frames_dropped++;
       }
@@ -112,6 +124,11 @@ struct FrameBuffer::Impl
           std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.first_arrival);
       if (age > config.max_delay * 2)
       {
+        // NACK did not complete it in time
+        if (after_keyframe(it->first))
+        {
+          keyframe_needed = true;
+        }
         it = assemblers.erase(it);
       }
       else
@@ -134,13 +151,20 @@ void FrameBuffer::insert_packet(std::span<const uint8_t> data, uint16_t sequence
 {
   std::lock_guard lock(impl_->mutex);
 
+  bool first_packet = impl_->received_sequences.empty();
+
   // Track sequence numbers
   impl_->received_sequences.insert(sequence);
 
   // Track highest sequence for NACK
   int16_t diff = static_cast<int16_t>(sequence - impl_->highest_sequence);
-  if (diff > 0)
+  if (diff > 0 || first_packet)
   {
+    // A gap NACK cannot cover leaves frames that will never complete
+    if (!first_packet && diff > impl_->config.max_nack_gap + 1 && !is_keyframe_packet)
+    {
+      impl_->keyframe_needed = true;
+    }
     impl_->highest_sequence = sequence;
   }
 
@@ -178,14 +202,19 @@ void FrameBuffer::insert_packet(std::span<const uint8_t> data, uint16_t sequence
   if (assembler.is_complete())
   {
     // If waiting for keyframe and this isn't one, skip
-    if (impl_->config.wait_for_keyframe && !impl_->has_keyframe && !assembler.is_keyframe)
+    if (impl_->config.wait_for_keyframe && (!impl_->has_keyframe || impl_->keyframe_needed) &&
+        !assembler.is_keyframe)
     {
+      impl_->assemblers.erase(timestamp);
+      impl_->stats.frames_dropped++;
       return;
     }
 
     if (assembler.is_keyframe)
     {
       impl_->has_keyframe = true;
+      impl_->keyframe_needed = false;
+      impl_->keyframe_timestamp = timestamp;
     }
 
     impl_->complete_frames.push_back(assembler.assemble());
@@ -246,7 +275,7 @@ std::vector<uint16_t> FrameBuffer::get_nack_list(size_t max_count) const
   std::vector<uint16_t> nacks;
 
   // Find missing sequences in recent range
-  uint16_t start = impl_->highest_sequence - 100;
+  uint16_t start = impl_->highest_sequence - impl_->config.max_nack_gap;
   for (uint16_t seq = start; seq != impl_->highest_sequence && nacks.size() < max_count; ++seq)
   {
     if (impl_->received_sequences.find(seq) == impl_->received_sequences.end())
@@ -263,13 +292,8 @@ bool FrameBuffer::should_request_keyframe() const
 {
   std::lock_guard lock(impl_->mutex);
 
-  // Request keyframe if too many frames lost or no keyframe received
-  if (!impl_->has_keyframe)
-  {
-    return true;
-  }
-
-  return impl_->stats.frames_dropped > 10;
+  // Request keyframe if no keyframe received or a lost frame broke the chain
+  return !impl_->has_keyframe || impl_->keyframe_needed;
 }
 
 FrameBufferStats FrameBuffer::stats() const
@@ -285,6 +309,7 @@ void FrameBuffer::reset()
   impl_->complete_frames.clear();
   impl_->received_sequences.clear();
   impl_->has_keyframe = false;
+  impl_->keyframe_needed = false;
   impl_->stats = {};
 }
 
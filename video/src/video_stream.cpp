@@ -6,9 +6,14 @@
 #include "rtc/video/video_stream.h"
 
 #include <atomic>
+#include <chrono>
 #include <mutex>
-#include <thread>
+#include <utility>
 
+#include "rtc/flight_recorder.h"
+#include "rtc/health_monitor.h"
+#include "rtc/metrics_exporter.h"
+#include "rtc/task_scheduler.h"
 #include "rtc/video/bitrate_controller.h"
 #include "rtc/video/frame_buffer.h"
 #include "rtc/video/video_capture.h"
@@ -20,6 +25,14 @@ namespace rtc
 namespace video
 {
 
+namespace
+{
+
+constexpr std::chrono::milliseconds KEYFRAME_REQUEST_INTERVAL{300};  // About one RTT plus encode
+constexpr std::chrono::milliseconds DECODE_INTERVAL{5};
+
+}  // namespace
+
 class VideoStreamImpl : public VideoStream
 {
  public:
@@ -75,8 +88,11 @@ class VideoStreamImpl : public VideoStream
     // Start capture
     capture_.start([this](const VideoFrame& frame) { on_capture_frame(frame); });
 
-    // Start decode thread
-    decode_thread_ = std::thread([this]() { decode_loop(); });
+    // Poll the frame buffer every 5ms on the shared pool
+    lag_probe_ = LoopLagProbe::create("video_decode");
+    next_decode_ = std::chrono::steady_clock::now() + DECODE_INTERVAL;
+    decode_task_ = TaskScheduler::shared().schedule_periodic(DECODE_INTERVAL,
+                                                             [this]() { decode(); });
 
     return true;
   }
@@ -86,10 +102,11 @@ class VideoStreamImpl : public VideoStream
     running_.store(false);
     capture_.stop();
 
-    if (decode_thread_.joinable())
+    if (decode_task_)
     {
-      decode_thread_.join();
+      TaskScheduler::shared().cancel_periodic(std::exchange(decode_task_, 0));
     }
+    lag_probe_.reset();
   }
 
   void set_send_callback(VideoSendCallback callback) override
@@ -160,15 +177,27 @@ class VideoStreamImpl : public VideoStream
     return enabled_.load();
   }
 
+  void set_encode_time_histogram(MetricHistogram histogram) override
+  {
+    std::lock_guard lock(mutex_);
+    encode_time_histogram_ = histogram;
+  }
+
  private:
   void on_capture_frame(const VideoFrame& frame)
   {
     if (!enabled_.load()) return;
 
+    auto encode_start = std::chrono::steady_clock::now();
     auto result = encoder_.encode(frame);
+    std::chrono::duration<double, std::milli> encode_time =
+        std::chrono::steady_clock::now() - encode_start;
+
     if (result.success())
     {
       std::lock_guard lock(mutex_);
+      stats_.encode_time_ms = static_cast<float>(encode_time.count());
+      encode_time_histogram_.observe(encode_time.count());
       if (send_callback_)
       {
         send_callback_(result.data, timestamp_, sequence_, result.is_keyframe);
@@ -187,43 +216,56 @@ class VideoStreamImpl : public VideoStream
     bitrate_controller_.process();
   }
 
-  void decode_loop()
+  void decode()
   {
-    while (running_.load())
+    auto now = std::chrono::steady_clock::now();
+
+    // Runs are due every DECODE_INTERVAL; a late or skipped one shows as lag
+    lag_probe_->tick(next_decode_);
+    while (next_decode_ <= now)
     {
-      // Check for keyframe request
-      if (frame_buffer_.should_request_keyframe())
+      next_decode_ += DECODE_INTERVAL;
+    }
+
+    // Check for keyframe request; the frame buffer keeps asking until one
+    // arrives, so repeat the PLI at most every KEYFRAME_REQUEST_INTERVAL
+    if (frame_buffer_.should_request_keyframe() &&
+        now - last_keyframe_request_ >= KEYFRAME_REQUEST_INTERVAL)
+    {
+      last_keyframe_request_ = now;
+      FlightRecorder::record(FlightEventType::PLI, FlightSource::VIDEO_RECEIVER,
+                             config_.remote_ssrc);
+      std::lock_guard lock(mutex_);
+      if (keyframe_request_callback_)
       {
-        std::lock_guard lock(mutex_);
-        if (keyframe_request_callback_)
-        {
-          keyframe_request_callback_();
-        }
+        keyframe_request_callback_();
       }
+    }
 
+    // Decode everything that is complete; when nothing is, wait for the next run
+    while (running_.load())
+    {
       auto buffered = frame_buffer_.pop_frame();
-      if (buffered)
+      if (!buffered)
       {
-        EncodedFrame encoded;
-        encoded.data = std::move(buffered->data);
-        encoded.is_keyframe = buffered->is_keyframe;
-        encoded.codec = config_.codec;
-        encoded.width = config_.width;
-        encoded.height = config_.height;
-
-        auto decoded = decoder_.decode(encoded);
-        if (decoded)
-        {
-          std::lock_guard lock(mutex_);
-          if (render_callback_)
-          {
-            render_callback_(*decoded);
-          }
-        }
+        break;
       }
-      else
+
+      EncodedFrame encoded;
+      encoded.data = std::move(buffered->data);
+      encoded.is_keyframe = buffered->is_keyframe;
+      encoded.codec = config_.codec;
+      encoded.width = config_.width;
+      encoded.height = config_.height;
+
+      auto decoded = decoder_.decode(encoded);
+      if (decoded)
       {
-        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        std::lock_guard lock(mutex_);
+        if (render_callback_)
+        {
+          render_callback_(*decoded);
+        }
       }
     }
   }
@@ -246,13 +288,23 @@ class VideoStreamImpl : public VideoStream
   VideoRenderCallback render_callback_;
   KeyframeRequestCallback keyframe_request_callback_;
   VideoStreamStats stats_;
+  MetricHistogram encode_time_histogram_;
 
-  std::thread decode_thread_;
+  PeriodicTaskId decode_task_ = 0;
+  std::chrono::steady_clock::time_point last_keyframe_request_;  // Only touched by decode()
+  std::chrono::steady_clock::time_point next_decode_;            // Only touched by decode()
+  std::shared_ptr<LoopLagProbe> lag_probe_;
 };
 
 std::unique_ptr<VideoStream> create_video_stream(VideoStreamConfig config)
 {
-  return std::make_unique<VideoStreamImpl>(std::move(config));
+  MetricsExporter* metrics = config.metrics;
+  auto stream = std::make_unique<VideoStreamImpl>(std::move(config));
+  if (metrics)
+  {
+    stream->set_encode_time_histogram(metrics->encode_time_histogram("video"));
+  }
+  return stream;
 }
 
 }  // namespace video